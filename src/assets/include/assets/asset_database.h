@@ -3,30 +3,226 @@
 
 #pragma once
 
+#include "asset_pool.h"
+#include "handle.h"
 #include "prefab.h"
+#include "residency.h"
 #include "skybox.h"
 
-#include <memory>
+#include <optional>
+#include <string>
+#include <type_traits>
 #include <unordered_map>
+#include <vector>
+
+namespace core
+{
+class FileReadQueue;
+class JobSystem;
+} // namespace core
 
 namespace assets
 {
+class ImageCache;
+
+// Totals for the content shared between prefabs instead of being stored (and uploaded) again
+struct DeduplicationReport
+{
+    uint32_t uniqueImages{0};
+    uint32_t duplicateImages{0};
+    uint32_t uniqueMaterials{0};
+    uint32_t duplicateMaterials{0};
+    uint32_t uniqueSubMeshes{0};
+    uint32_t duplicateSubMeshes{0};
+    size_t bytesSaved{0};
+};
+
+// Assets removed from the database by eviction. Their handles are stale, but the GPU copies still need freeing.
+struct EvictedAssets
+{
+    std::vector<Handle<Prefab>> prefabs;
+    std::vector<Handle<Image>> images;
+    std::vector<Handle<Material>> materials;
+    std::vector<Handle<SubMesh>> subMeshes;
+
+    bool empty() const;
+    void append(const EvictedAssets& other);
+};
+
+// Owns every loaded asset in one contiguous pool per type. Assets reference each other by handle and names are only
+// used to find prefabs and skyboxes while a scene is being set up.
+//
+// Every asset is reference counted by the assets that use it, and prefabs by the world entities that render them.
+// Adding an asset that refers to another takes a reference, so an evicted prefab frees exactly the content no other
+// prefab or skybox shares.
 class AssetDatabase
 {
   public:
+    // Images, materials and meshes whose content matches an asset already in the database return its handle instead
+    Handle<Image> addImage(Image&& image);
+    Handle<Material> addMaterial(Material&& material);
+    Handle<SubMesh> addSubMesh(SubMesh&& subMesh);
+    Handle<Mesh> addMesh(Mesh&& mesh);
+
+    // Names must be unique; use replacePrefab to swap in a new version of a loaded prefab
+    Handle<Prefab> addPrefab(const std::string& name, Prefab&& prefab);
+
+    // Adds a prefab loaded into another database, e.g. by a background load, deduplicating its content against what's
+    // already loaded. Its name must not already be loaded either.
+    Handle<Prefab> addPrefab(const std::string& name, AssetDatabase& source, const Prefab& sourcePrefab);
+
+    // Swaps in a newly loaded version of a prefab, keeping its handle and references. The prefab is read from the
+    // database it was loaded into, e.g. by a background reload, and content it shares with what's already loaded is
+    // deduplicated. Returns the old content that nothing uses any more.
+    EvictedAssets replacePrefab(Handle<Prefab> handle, AssetDatabase& source, const Prefab& sourcePrefab);
+
+    // Names must be unique
+    Handle<Skybox> addSkybox(const std::string& name, Skybox&& skybox);
+
+    // Invalid handle if there's no asset with this name
+    Handle<Prefab> findPrefab(const std::string& name) const;
+    Handle<Skybox> findSkybox(const std::string& name) const;
+
+    const std::unordered_map<std::string, Handle<Prefab>>& prefabNames() const;
+    const std::unordered_map<std::string, Handle<Skybox>>& skyboxNames() const;
+
+    template <typename AssetType>
+    const AssetType& get(Handle<AssetType> handle) const
+    {
+        return pool<AssetType>().get(handle);
+    }
+
+    template <typename AssetType>
+    AssetType& get(Handle<AssetType> handle)
+    {
+        return pool<AssetType>().get(handle);
+    }
+
     template <typename AssetType>
-    using AssetStorage = std::unordered_map<std::string, std::unique_ptr<AssetType>>;
+    const AssetPool<AssetType>& pool() const
+    {
+        return const_cast<AssetDatabase*>(this)->pool<AssetType>();
+    }
 
-    void addPrefab(const std::string& name, std::unique_ptr<Prefab> prefab);
-    void addSkybox(const std::string& name, std::unique_ptr<Skybox> skybox);
+    template <typename AssetType>
+    AssetPool<AssetType>& pool()
+    {
+        if constexpr (std::is_same_v<AssetType, Image>)
+        {
+            return images_;
+        }
+        else if constexpr (std::is_same_v<AssetType, Material>)
+        {
+            return materials_;
+        }
+        else if constexpr (std::is_same_v<AssetType, SubMesh>)
+        {
+            return subMeshes_;
+        }
+        else if constexpr (std::is_same_v<AssetType, Mesh>)
+        {
+            return meshes_;
+        }
+        else if constexpr (std::is_same_v<AssetType, Prefab>)
+        {
+            return prefabs_;
+        }
+        else
+        {
+            static_assert(std::is_same_v<AssetType, Skybox>, "Asset type unknown");
+            return skyboxes_;
+        }
+    }
+
+    // World references to a prefab. A prefab with none stays loaded until the memory budget needs its memory back.
+    void acquire(Handle<Prefab> prefab, uint32_t count = 1);
+    void release(Handle<Prefab> prefab, uint32_t count = 1);
+    uint32_t referenceCount(Handle<Prefab> prefab) const;
+
+    // Stamps a prefab with the frame it was last drawn in, which orders eviction
+    void markUsed(Handle<Prefab> prefab, uint64_t frame);
+
+    // Decoded image store used when loading into this database, or null to always decode. Not owned.
+    void setImageCache(ImageCache* cache);
+    ImageCache* imageCache() const;
+
+    // Threads loaders spread decoding across, or null to load on the calling thread alone. Not owned.
+    void setJobSystem(core::JobSystem* jobSystem);
+    core::JobSystem* jobSystem() const;
+
+    // Queue background loads read their files through, or null for loads to read on their own thread. Not owned.
+    void setFileReadQueue(core::FileReadQueue* readQueue);
+    core::FileReadQueue* fileReadQueue() const;
+
+    void setMemoryBudget(const MemoryBudget& budget);
+    const MemoryBudget& memoryBudget() const;
+
+    // CPU memory held by image and mesh payloads
+    size_t cpuMemoryUsage() const;
+
+    // Unloads the least recently used prefab with no references, along with everything only it was using. Empty if
+    // every loaded prefab is still referenced.
+    std::optional<EvictedAssets> evictLeastRecentlyUsed();
+
+    // Unloads a prefab no longer needed, such as one generated for a population that was rebuilt, adding what it was
+    // using alone to evicted. Throws std::logic_error if it's still referenced.
+    void evict(Handle<Prefab> prefab, EvictedAssets& evicted);
+
+    const DeduplicationReport& deduplicationReport() const;
 
-    const AssetStorage<Prefab>& prefabs() const;
-    const AssetStorage<Skybox>& skyboxes() const;
+    void setResidencyPolicy(const ResidencyPolicy& policy);
+    const ResidencyPolicy& residencyPolicy() const;
+
+    // Drops the CPU copies of prefab images and meshes as the policy allows. Call once they are resident on the GPU.
+    void applyResidencyPolicy();
+
+    // Reloads a prefab's source file and restores any released CPU data, e.g. before uploading it again
+    void restoreCpuData(Handle<Prefab> prefab);
 
     void clear();
 
   private:
-    AssetStorage<Prefab> prefabs_;
-    AssetStorage<Skybox> skyboxes_;
+    Prefab importPrefab(AssetDatabase& source, const Prefab& sourcePrefab);
+    void referencePrefabContent(const Prefab& prefab);
+    void releasePrefabContent(const Prefab& prefab, EvictedAssets& evicted);
+    void removePrefab(Handle<Prefab> prefab, EvictedAssets& evicted);
+    void releaseAsset(Handle<Image> image, EvictedAssets& evicted);
+    void releaseAsset(Handle<Material> material, EvictedAssets& evicted);
+    void releaseAsset(Handle<SubMesh> subMesh, EvictedAssets& evicted);
+    void releaseAsset(Handle<Mesh> mesh, EvictedAssets& evicted);
+
+  private:
+    // Assets by content hash. CPU payloads can be released once assets are resident, so each entry also keeps a
+    // second hash of the content taken with a different seed, which stands in for comparing the payloads.
+    template <typename AssetType>
+    struct ContentEntry
+    {
+        Handle<AssetType> handle;
+        uint64_t digest;
+    };
+
+    template <typename AssetType>
+    using ContentIndex = std::unordered_multimap<uint64_t, ContentEntry<AssetType>>;
+
+    AssetPool<Image> images_;
+    AssetPool<Material> materials_;
+    AssetPool<SubMesh> subMeshes_;
+    AssetPool<Mesh> meshes_;
+    AssetPool<Prefab> prefabs_;
+    AssetPool<Skybox> skyboxes_;
+
+    std::unordered_map<std::string, Handle<Prefab>> prefabNames_;
+    std::unordered_map<std::string, Handle<Skybox>> skyboxNames_;
+
+    ContentIndex<Image> imagesByContent_;
+    ContentIndex<Material> materialsByContent_;
+    ContentIndex<SubMesh> subMeshesByContent_;
+    ContentIndex<Mesh> meshesByContent_;
+    DeduplicationReport deduplicationReport_;
+    ResidencyPolicy residencyPolicy_;
+    MemoryBudget memoryBudget_;
+    ImageCache* imageCache_{nullptr};
+    core::JobSystem* jobSystem_{nullptr};
+    core::FileReadQueue* fileReadQueue_{nullptr};
 };
 } // namespace assets
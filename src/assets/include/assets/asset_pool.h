@@ -0,0 +1,163 @@
+/// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Mark Rapson
+
+#pragma once
+
+#include "handle.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+namespace assets
+{
+// Contiguous storage for one asset type. Slots of removed assets are reused with a new generation, so indices stay
+// small enough for per-slot arrays (such as the renderer's GPU resources) to be indexed directly. Each slot also
+// carries a reference count and the tick it was last used at, which the database uses to decide what to unload.
+template <typename AssetType>
+class AssetPool
+{
+  public:
+    Handle<AssetType> add(AssetType&& asset)
+    {
+        if (!freeSlots_.empty())
+        {
+            const auto index = freeSlots_.back();
+            freeSlots_.pop_back();
+
+            assets_[index] = std::move(asset);
+            alive_[index] = true;
+            referenceCounts_[index] = 0;
+            lastUsed_[index] = 0;
+            return Handle<AssetType>{index, generations_[index]};
+        }
+
+        const auto index = static_cast<uint32_t>(assets_.size());
+        assets_.push_back(std::move(asset));
+        generations_.push_back(0);
+        alive_.push_back(true);
+        referenceCounts_.push_back(0);
+        lastUsed_.push_back(0);
+        return Handle<AssetType>{index, 0};
+    }
+
+    void remove(Handle<AssetType> handle)
+    {
+        if (!contains(handle))
+        {
+            return;
+        }
+
+        assets_[handle.index] = AssetType{};
+        alive_[handle.index] = false;
+        generations_[handle.index]++;
+        freeSlots_.push_back(handle.index);
+    }
+
+    bool contains(Handle<AssetType> handle) const
+    {
+        return handle.index < assets_.size() && alive_[handle.index] && generations_[handle.index] == handle.generation;
+    }
+
+    AssetType& get(Handle<AssetType> handle)
+    {
+        validate(handle);
+        return assets_[handle.index];
+    }
+
+    const AssetType& get(Handle<AssetType> handle) const
+    {
+        validate(handle);
+        return assets_[handle.index];
+    }
+
+    // Returns the new count
+    uint32_t addReference(Handle<AssetType> handle, uint32_t count = 1)
+    {
+        validate(handle);
+        return referenceCounts_[handle.index] += count;
+    }
+
+    // Returns the new count. Releasing an asset with no references leaves it at zero.
+    uint32_t releaseReference(Handle<AssetType> handle, uint32_t count = 1)
+    {
+        validate(handle);
+        referenceCounts_[handle.index] -= std::min(referenceCounts_[handle.index], count);
+        return referenceCounts_[handle.index];
+    }
+
+    uint32_t referenceCount(Handle<AssetType> handle) const
+    {
+        return contains(handle) ? referenceCounts_[handle.index] : 0;
+    }
+
+    void markUsed(Handle<AssetType> handle, uint64_t tick)
+    {
+        validate(handle);
+        lastUsed_[handle.index] = tick;
+    }
+
+    uint64_t lastUsed(Handle<AssetType> handle) const
+    {
+        return contains(handle) ? lastUsed_[handle.index] : 0;
+    }
+
+    // Number of slots, live or free. Handle indices are always below this.
+    uint32_t slotCount() const
+    {
+        return static_cast<uint32_t>(assets_.size());
+    }
+
+    // Calls function(handle, asset) for every live asset in slot order
+    template <typename Function>
+    void forEach(Function&& function) const
+    {
+        for (auto index = uint32_t{0}; index < assets_.size(); ++index)
+        {
+            if (alive_[index])
+            {
+                function(Handle<AssetType>{index, generations_[index]}, assets_[index]);
+            }
+        }
+    }
+
+    template <typename Function>
+    void forEach(Function&& function)
+    {
+        for (auto index = uint32_t{0}; index < assets_.size(); ++index)
+        {
+            if (alive_[index])
+            {
+                function(Handle<AssetType>{index, generations_[index]}, assets_[index]);
+            }
+        }
+    }
+
+    // Removes every asset; slots are kept so handles from before the clear stay stale
+    void clear()
+    {
+        for (auto index = uint32_t{0}; index < assets_.size(); ++index)
+        {
+            remove(Handle<AssetType>{index, generations_[index]});
+        }
+    }
+
+  private:
+    void validate(Handle<AssetType> handle) const
+    {
+        if (!contains(handle))
+        {
+            throw std::out_of_range("Invalid or stale asset handle");
+        }
+    }
+
+  private:
+    std::vector<AssetType> assets_;
+    std::vector<uint32_t> generations_;
+    std::vector<bool> alive_;
+    std::vector<uint32_t> referenceCounts_;
+    std::vector<uint64_t> lastUsed_;
+    std::vector<uint32_t> freeSlots_;
+};
+} // namespace assets
@@ -3,12 +3,44 @@
 
 #pragma once
 
+#include "prefab.h"
+
+#include <cstddef>
 #include <filesystem>
-#include <memory>
+#include <span>
+
+namespace core
+{
+template <typename T>
+class Task;
+}
 
 namespace assets
 {
-class Prefab;
+class AssetDatabase;
+
+// Where an import allocates its working data. Arena frees it in one go when the import returns; Heap allocates each
+// buffer separately, and is only kept for the import benchmark to compare against.
+enum class ImportScratch
+{
+    Arena,
+    Heap
+};
+
+// Adds the file's images, materials and meshes to the database and returns the prefab referencing them
+Prefab loadGLTFModel(const std::filesystem::path& path,
+                     AssetDatabase& db,
+                     ImportScratch scratch = ImportScratch::Arena);
+
+// As above, for a .glb already read into memory from path. Files it references, such as external images, are still
+// read from beside path.
+Prefab loadGLTFModel(std::span<const std::byte> bytes,
+                     const std::filesystem::path& path,
+                     AssetDatabase& db,
+                     ImportScratch scratch = ImportScratch::Arena);
 
-std::unique_ptr<Prefab> loadGLTFModel(const std::filesystem::path& path);
+// Reads the file on the database's read queue and imports it on its job system, so no thread waits on the read. Without
+// a read queue the file is read synchronously on the job system, and without a job system the import runs on the
+// thread that finished the read, which is the calling thread if neither is set.
+core::Task<Prefab> loadGLTFModelAsync(std::filesystem::path path, AssetDatabase& db);
 } // namespace assets
@@ -0,0 +1,27 @@
+/// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Mark Rapson
+
+#pragma once
+
+#include <limits>
+#include <stdint.h>
+
+namespace assets
+{
+// Typed reference to an asset in an AssetPool. The generation detects handles to slots that have since been reused.
+template <typename AssetType>
+struct Handle
+{
+    static constexpr auto invalidIndex = std::numeric_limits<uint32_t>::max();
+
+    uint32_t index{invalidIndex};
+    uint32_t generation{0};
+
+    bool valid() const
+    {
+        return index != invalidIndex;
+    }
+
+    bool operator==(const Handle&) const = default;
+};
+} // namespace assets
@@ -3,15 +3,58 @@
 
 #pragma once
 
+#include "image_data.h"
+
+#include <cstddef>
 #include <stdint.h>
 #include <vector>
 
 namespace assets
 {
+// Pixel formats an image can be stored in. Values match VkFormat so KTX2 files and the renderer can use them as-is.
+enum class ImageFormat : uint32_t
+{
+    R8G8B8A8Unorm = 37,
+    R8G8B8A8Srgb = 43,
+    R16G16B16A16Sfloat = 97,
+    R32G32B32A32Sfloat = 109,
+    Bc1RgbaUnorm = 133,
+    Bc1RgbaSrgb = 134,
+    Bc3Unorm = 137,
+    Bc3Srgb = 138,
+    Bc4Unorm = 139,
+    Bc5Unorm = 141,
+    Bc6hUfloat = 143,
+    Bc7Unorm = 145,
+    Bc7Srgb = 146,
+    Etc2R8G8B8A8Unorm = 151,
+    Etc2R8G8B8A8Srgb = 152,
+    Astc4x4Unorm = 157,
+    Astc4x4Srgb = 158
+};
+
+// Location of one mip level in Image::data. A level holds every layer (or cubemap face) of that level back to back.
+struct ImageLevel
+{
+    size_t offset;
+    size_t size;
+};
+
 struct Image
 {
     uint32_t width;
     uint32_t height;
-    std::vector<std::byte> data;
+    ImageData data;
+    ImageFormat format{ImageFormat::R8G8B8A8Srgb};
+    uint32_t mipLevels{1};
+    uint32_t layers{1};
+
+    // 8-bit RGBA images may be stored as RGB (channels == 3) and in the opposite row order (flipVertically). Both
+    // are resolved as the pixels are written to GPU staging memory.
+    uint32_t channels{4};
+    bool flipVertically{false};
+
+    // Empty for single level images, whose data is one tightly packed level
+    std::vector<ImageLevel> levels;
 };
 } // namespace assets
@@ -0,0 +1,58 @@
+/// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Mark Rapson
+
+#pragma once
+
+#include "image.h"
+
+#include <atomic>
+#include <cstddef>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <stdint.h>
+
+namespace assets
+{
+// On-disk store of decoded images, so a warm start maps pixels straight from the cache instead of decoding the
+// source again. Entries are keyed by the encoded bytes and the decoder settings, written under a temporary name and
+// renamed into place, so processes sharing the directory never see a partial entry. Once the cache outgrows its size
+// cap the least recently used entries are deleted. Cache failures are logged and treated as misses.
+// Safe to use from several threads.
+class ImageCache
+{
+  public:
+    ImageCache(const std::filesystem::path& directory, uint64_t maxBytes);
+    ~ImageCache() = default;
+
+    ImageCache(const ImageCache&) = delete;
+    ImageCache& operator=(const ImageCache&) = delete;
+
+    ImageCache(ImageCache&& other) = delete;
+    ImageCache& operator=(ImageCache&& other) = delete;
+
+    // decoderSeed must change whenever decoding the same bytes would produce a different image
+    static uint64_t key(std::span<const std::byte> encoded, uint64_t decoderSeed);
+
+    // Memory maps the cached image, or returns null on a miss. A hit marks the entry as recently used.
+    std::unique_ptr<Image> load(uint64_t key);
+
+    void store(uint64_t key, const Image& image);
+
+    // Deletes least recently used entries until the cache is comfortably under its cap, along with temporary files
+    // abandoned by processes that died mid-write
+    void trim();
+
+  private:
+    std::filesystem::path entryPath(uint64_t key) const;
+
+  private:
+    std::filesystem::path directory_;
+    uint64_t maxBytes_;
+    uint64_t instanceId_;
+    std::atomic<uint64_t> nextTemporary_{0};
+    std::atomic<uint64_t> approximateSize_{0};
+    std::mutex trimMutex_;
+};
+} // namespace assets
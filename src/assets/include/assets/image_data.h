@@ -0,0 +1,34 @@
+/// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Mark Rapson
+
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace assets
+{
+// Owning pixel storage. Besides allocating its own memory it can adopt buffers handed out by decoders (stb_image,
+// tinygltf) so decoded pixels are never copied before they reach the GPU staging memory.
+class ImageData
+{
+  public:
+    using Deleter = std::function<void(std::byte*)>;
+
+    ImageData() = default;
+    explicit ImageData(size_t size);
+    ImageData(std::byte* data, size_t size, Deleter deleter);
+    explicit ImageData(std::vector<unsigned char>&& data);
+
+    std::byte* data();
+    const std::byte* data() const;
+    size_t size() const;
+    bool empty() const;
+
+  private:
+    std::unique_ptr<std::byte[], Deleter> data_{nullptr, [](std::byte*) {}};
+    size_t size_{0};
+};
+} // namespace assets
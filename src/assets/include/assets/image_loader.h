@@ -5,11 +5,33 @@
 
 #include "assets/image.h"
 
+#include <array>
 #include <filesystem>
 #include <memory>
+#include <span>
+#include <vector>
+
+namespace core
+{
+class FileReadQueue;
+}
 
 namespace assets
 {
-std::unique_ptr<Image> createImageFromPath(const std::filesystem::path& path);
-std::unique_ptr<Image> createImageFromData(int width, int height, const std::vector<unsigned char>& data);
+class ImageCache;
+
+// Images stb_image has to decode are looked up in the cache, if one is given, and added to it on a miss
+std::unique_ptr<Image> createImageFromPath(const std::filesystem::path& path, ImageCache* cache = nullptr);
+
+// Loads a batch of images, queueing every file read up front and decoding each image as its file arrives. KTX2 files
+// are memory mapped rather than queued. Images are returned in the order of paths.
+std::vector<std::unique_ptr<Image>> createImagesFromPaths(std::span<const std::filesystem::path> paths,
+                                                          core::FileReadQueue& readQueue,
+                                                          ImageCache* cache = nullptr);
+
+// Decodes an encoded (PNG, JPEG, ...) image held in memory, such as one embedded in a glTF file, to 8-bit RGBA
+std::unique_ptr<Image> createImageFromMemory(std::span<const std::byte> encoded, ImageCache* cache = nullptr);
+
+// Combines six equally sized single level faces, ordered +X, -X, +Y, -Y, +Z, -Z, into one cubemap image
+std::unique_ptr<Image> createCubemapFromFaces(std::array<std::unique_ptr<Image>, 6> faces);
 } // namespace assets
@@ -0,0 +1,30 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Mark Rapson
+
+#pragma once
+
+#include "assets/image.h"
+
+#include <filesystem>
+#include <memory>
+
+namespace assets
+{
+// Block compressed formats the device can sample, which Basis Universal textures are transcoded to. BC7 is preferred,
+// then ASTC 4x4, then ETC2; with none of them they're transcoded to uncompressed RGBA.
+struct TranscodeTargets
+{
+    bool bc7{false};
+    bool astc4x4{false};
+    bool etc2{false};
+};
+
+// Must be called before any KTX2 texture is loaded
+void setTranscodeTargets(const TranscodeTargets& targets);
+
+// Loads a 2D or cubemap KTX2 texture with all of its mip levels and cubemap faces. Array textures are rejected.
+// Images stored in a GPU format (uncompressed or block compressed) are copied as they are. Supercompressed payloads
+// are inflated and Basis Universal (ETC1S/UASTC) payloads transcoded to one of the transcode targets, which needs a
+// build with libktx from KTX-Software; without it they're rejected.
+std::unique_ptr<Image> loadKtx2Image(const std::filesystem::path& path);
+} // namespace assets
@@ -3,6 +3,8 @@
 
 #pragma once
 
+#include "handle.h"
+
 #include <glm/glm.hpp>
 
 namespace assets
@@ -11,9 +13,9 @@ struct Image;
 
 struct Material
 {
-    glm::vec3 ambient;
-    glm::vec3 diffuse;
-    glm::vec3 specular;
-    Image* diffuseTexture;
+    glm::vec3 ambient{0.0f};
+    glm::vec3 diffuse{0.0f};
+    glm::vec3 specular{0.0f};
+    Handle<Image> diffuseTexture;
 };
 } // namespace assets
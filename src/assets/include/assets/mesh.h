@@ -3,9 +3,11 @@
 
 #pragma once
 
+#include "handle.h"
+#include "meshlet.h"
+
 #include <core/vertex.h>
 
-#include <memory>
 #include <vector>
 
 namespace assets
@@ -16,11 +18,12 @@ struct SubMesh
 {
     std::vector<core::Vertex> vertices;
     std::vector<uint32_t> indices;
-    Material* material{nullptr};
+    std::vector<Meshlet> meshlets;
+    Handle<Material> material;
 };
 
 struct Mesh
 {
-    std::vector<std::unique_ptr<SubMesh>> subMeshes;
+    std::vector<Handle<SubMesh>> subMeshes;
 };
 } // namespace assets
@@ -3,15 +3,24 @@
 
 #pragma once
 
+#include "handle.h"
+
 #include <glm/glm.hpp>
 
+#include <cstdint>
+
 namespace assets
 {
 struct Mesh;
 
 struct MeshInstance
 {
-    Mesh* mesh;
+    Handle<Mesh> mesh;
     glm::mat4 transform;
+
+    // Range of the owning prefab's instance transforms (EXT_mesh_gpu_instancing), applied before transform.
+    // An instanceCount of zero draws the mesh once.
+    uint32_t instanceOffset{0};
+    uint32_t instanceCount{0};
 };
 } // namespace assets
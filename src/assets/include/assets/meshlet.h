@@ -0,0 +1,29 @@
+/// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Mark Rapson
+
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <stdint.h>
+
+namespace assets
+{
+// A cluster of up to maxMeshletVertices vertices and maxMeshletTriangles triangles. The triangles of a meshlet are
+// stored contiguously in the owning SubMesh's index buffer, starting at indexOffset.
+struct Meshlet
+{
+    uint32_t indexOffset;
+    uint32_t indexCount;
+    uint32_t vertexCount;
+
+    // Bounding sphere in mesh space
+    glm::vec3 center;
+    float radius;
+
+    // Normal cone in mesh space. The meshlet is entirely back-facing for a viewer at position p when
+    // dot(center - p, coneAxis) >= coneCutoff * length(center - p) + radius
+    glm::vec3 coneAxis;
+    float coneCutoff;
+};
+} // namespace assets
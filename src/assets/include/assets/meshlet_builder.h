@@ -0,0 +1,20 @@
+/// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Mark Rapson
+
+#pragma once
+
+#include <memory_resource>
+#include <stdint.h>
+
+namespace assets
+{
+struct SubMesh;
+
+constexpr auto maxMeshletVertices = uint32_t{64};
+constexpr auto maxMeshletTriangles = uint32_t{124};
+
+// Splits the sub-mesh into meshlets, reordering its indices so each meshlet's triangles are contiguous, and
+// computes the per-meshlet culling bounds. Working buffers are allocated from scratch, which only needs to outlive
+// the call.
+void buildMeshlets(SubMesh& subMesh, std::pmr::memory_resource* scratch = std::pmr::get_default_resource());
+} // namespace assets
@@ -3,41 +3,32 @@
 
 #pragma once
 
+#include "handle.h"
 #include "image.h"
 #include "material.h"
 #include "mesh.h"
 #include "mesh_instance.h"
 
-#include <memory>
-#include <string>
-#include <unordered_map>
+#include <glm/glm.hpp>
+
+#include <filesystem>
 #include <vector>
 
 namespace assets
 {
-class Prefab
+// Handles of the assets loaded from one file, in file order. Assets are stored in the AssetDatabase, so identical
+// content loaded by several prefabs is stored once.
+struct Prefab
 {
-  public:
-    void addMaterial(const std::string& name, std::unique_ptr<Material> material);
-    void addMesh(std::unique_ptr<Mesh> mesh);
-    void addImage(const std::string& name, std::unique_ptr<Image> image);
-
-    void addMeshInstance(MeshInstance&& instance);
-
-    Material* getMaterial(const std::string& name) const;
-    Mesh* getMesh(int index) const;
-    Image* getImage(const std::string& name) const;
-
-    const std::unordered_map<std::string, std::unique_ptr<Material>>& materials() const;
-    const std::vector<std::unique_ptr<Mesh>>& meshes() const;
-    const std::unordered_map<std::string, std::unique_ptr<Image>>& images() const;
+    std::vector<Handle<Image>> images;
+    std::vector<Handle<Material>> materials;
+    std::vector<Handle<Mesh>> meshes;
+    std::vector<MeshInstance> meshInstances;
 
-    const std::vector<MeshInstance>& meshInstances() const;
+    // EXT_mesh_gpu_instancing transforms, referenced by range from meshInstances
+    std::vector<glm::mat4> instanceTransforms;
 
-  private:
-    std::unordered_map<std::string, std::unique_ptr<Material>> materials_;
-    std::vector<std::unique_ptr<Mesh>> meshes_;
-    std::unordered_map<std::string, std::unique_ptr<Image>> images_;
-    std::vector<MeshInstance> meshInstances_;
+    // File the prefab was loaded from, used to reload released CPU data
+    std::filesystem::path sourcePath;
 };
 } // namespace assets
@@ -0,0 +1,56 @@
+/// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Mark Rapson
+
+#pragma once
+
+#include "asset_database.h"
+#include "handle.h"
+#include "prefab.h"
+
+#include <future>
+#include <memory>
+#include <optional>
+#include <vector>
+
+namespace core
+{
+class FileWatcher;
+}
+
+namespace assets
+{
+// Watches the source files of every prefab in a database and reloads a prefab when its glTF, or a file next to it such
+// as a texture or buffer, changes. Files are re-imported on a background thread into a scratch database and only
+// swapped in once loaded, so rendering carries on with the old version in the meantime.
+class PrefabReloader
+{
+  public:
+    explicit PrefabReloader(const AssetDatabase& db);
+    ~PrefabReloader();
+
+    PrefabReloader(const PrefabReloader&) = delete;
+    PrefabReloader& operator=(const PrefabReloader&) = delete;
+
+    PrefabReloader(PrefabReloader&& other) = delete;
+    PrefabReloader& operator=(PrefabReloader&& other) = delete;
+
+    // Starts reloads for changed files and swaps in the ones that have finished. Returns the content the swapped out
+    // versions no longer share, for the renderer to retire, or nothing if no prefab was replaced.
+    std::optional<EvictedAssets> update(AssetDatabase& db);
+
+  private:
+    struct PendingReload
+    {
+        Handle<Prefab> prefab;
+        std::unique_ptr<AssetDatabase> source;
+        std::future<Prefab> result;
+        bool changedAgain{false};
+    };
+
+    void startReload(Handle<Prefab> prefab, const std::filesystem::path& path, const AssetDatabase& db);
+
+  private:
+    std::unique_ptr<core::FileWatcher> watcher_;
+    std::vector<PendingReload> pending_;
+};
+} // namespace assets
@@ -0,0 +1,48 @@
+/// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Mark Rapson
+
+#pragma once
+
+#include <cstddef>
+#include <limits>
+
+namespace assets
+{
+struct Image;
+struct SubMesh;
+
+enum class CpuResidency
+{
+    Keep,
+    Release
+};
+
+// Which CPU payloads stay in memory once assets are resident on the GPU. Rendering only needs the GPU copies, so
+// everything is released by default; keep mesh vertices and indices for CPU side collision or picking. Streamed
+// images are the exception, as their finer mips are uploaded from the CPU copy when they're needed.
+struct ResidencyPolicy
+{
+    CpuResidency images{CpuResidency::Release};
+    CpuResidency streamedImages{CpuResidency::Keep};
+    CpuResidency meshVertices{CpuResidency::Release};
+    CpuResidency meshIndices{CpuResidency::Release};
+    CpuResidency meshlets{CpuResidency::Release};
+};
+
+// Upper limits on asset memory. Past either one, prefabs that nothing references are unloaded least recently used
+// first until usage is back under budget. Unlimited by default.
+struct MemoryBudget
+{
+    size_t cpuBytes{std::numeric_limits<size_t>::max()};
+    size_t gpuBytes{std::numeric_limits<size_t>::max()};
+};
+
+// Mipmapped 2D images with their levels stored separately, which the renderer streams mip by mip
+bool isStreamable(const Image& image);
+
+size_t cpuMemoryUsage(const Image& image);
+size_t cpuMemoryUsage(const SubMesh& subMesh);
+
+void releaseCpuData(Image& image, const ResidencyPolicy& policy);
+void releaseCpuData(SubMesh& subMesh, const ResidencyPolicy& policy);
+} // namespace assets
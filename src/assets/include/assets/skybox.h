@@ -3,7 +3,7 @@
 
 #pragma once
 
-#include <memory>
+#include "handle.h"
 
 namespace assets
 {
@@ -11,6 +11,7 @@ struct Image;
 
 struct Skybox
 {
-    std::array<std::unique_ptr<Image>, 6> images;
+    // Six layer image with faces in +X, -X, +Y, -Y, +Z, -Z order
+    Handle<Image> cubemap;
 };
 } // namespace assets
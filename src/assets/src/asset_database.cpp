@@ -2,32 +2,711 @@
 // Copyright (c) 2025 Mark Rapson
 
 #include "assets/asset_database.h"
+#include "assets/gltf_loader.h"
+
+#include <core/hash.h>
+
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <array>
+#include <iterator>
+#include <stdexcept>
+#include <utility>
 
 namespace assets
 {
-void AssetDatabase::addPrefab(const std::string& name, std::unique_ptr<Prefab> prefab)
+template <typename AssetType>
+std::array<uint32_t, 2> handleBits(Handle<AssetType> handle)
+{
+    return {handle.index, handle.generation};
+}
+
+// Seed of the second hash kept with each indexed asset. Together with the first that's 128 bits, so two different
+// payloads matching both is too unlikely to guard against.
+constexpr auto digestSeed = uint64_t{0x9e3779b97f4a7c15};
+
+uint64_t contentHash(const Image& image, uint64_t seed = 0)
+{
+    const auto header = std::array<uint32_t, 7>{image.width,
+                                                image.height,
+                                                static_cast<uint32_t>(image.format),
+                                                image.mipLevels,
+                                                image.layers,
+                                                image.channels,
+                                                image.flipVertically ? 1u : 0u};
+
+    return core::xxHash64(std::span<const std::byte>{image.data.data(), image.data.size()},
+                          core::xxHash64(header, seed));
+}
+
+// The description stays after the pixels are released; the pixels themselves are compared by digest
+bool sameContent(const Image& a, const Image& b)
+{
+    return a.width == b.width && a.height == b.height && a.format == b.format && a.mipLevels == b.mipLevels
+           && a.layers == b.layers && a.channels == b.channels && a.flipVertically == b.flipVertically;
+}
+
+// Materials compare by value; textures are compared by handle, which is why images are deduplicated first
+std::array<float, 9> materialFactors(const Material& material)
+{
+    return {material.ambient.x,
+            material.ambient.y,
+            material.ambient.z,
+            material.diffuse.x,
+            material.diffuse.y,
+            material.diffuse.z,
+            material.specular.x,
+            material.specular.y,
+            material.specular.z};
+}
+
+uint64_t contentHash(const Material& material, uint64_t seed = 0)
+{
+    return core::xxHash64(materialFactors(material), core::xxHash64(handleBits(material.diffuseTexture), seed));
+}
+
+bool sameContent(const Material& a, const Material& b)
+{
+    return materialFactors(a) == materialFactors(b) && a.diffuseTexture == b.diffuseTexture;
+}
+
+// Meshlets are derived from the vertices and indices so they don't need hashing
+uint64_t contentHash(const SubMesh& subMesh, uint64_t seed = 0)
+{
+    auto hash = core::xxHash64(handleBits(subMesh.material), seed);
+    hash = core::xxHash64(subMesh.vertices, hash);
+    return core::xxHash64(subMesh.indices, hash);
+}
+
+// Geometry may have been released, so it's compared by digest
+bool sameContent(const SubMesh& a, const SubMesh& b)
+{
+    return a.material == b.material;
+}
+
+uint64_t contentHash(const Mesh& mesh, uint64_t seed = 0)
+{
+    auto hash = core::xxHash64(std::array{mesh.subMeshes.size()}, seed);
+    for (const auto& subMesh : mesh.subMeshes)
+    {
+        hash = core::xxHash64(handleBits(subMesh), hash);
+    }
+
+    return hash;
+}
+
+bool sameContent(const Mesh& a, const Mesh& b)
+{
+    return a.subMeshes == b.subMeshes;
+}
+
+// Handle of an asset in the pool with the same content, or an invalid handle if there is none. Matches on both
+// hashes, so assets whose CPU payload has been released are still found.
+template <typename AssetType, typename Index>
+Handle<AssetType> findContent(const Index& index,
+                              const AssetPool<AssetType>& pool,
+                              uint64_t hash,
+                              uint64_t digest,
+                              const AssetType& asset)
+{
+    auto [first, last] = index.equal_range(hash);
+    for (auto itr = first; itr != last; ++itr)
+    {
+        const auto& entry = itr->second;
+        if (entry.digest == digest && pool.contains(entry.handle) && sameContent(pool.get(entry.handle), asset))
+        {
+            return entry.handle;
+        }
+    }
+
+    return {};
+}
+
+template <typename AssetType, typename Index>
+void eraseContent(Index& index, Handle<AssetType> handle)
+{
+    std::erase_if(index, [handle](const auto& entry) { return entry.second.handle == handle; });
+}
+
+bool EvictedAssets::empty() const
+{
+    return prefabs.empty() && images.empty() && materials.empty() && subMeshes.empty();
+}
+
+void EvictedAssets::append(const EvictedAssets& other)
+{
+    prefabs.insert(prefabs.end(), other.prefabs.begin(), other.prefabs.end());
+    images.insert(images.end(), other.images.begin(), other.images.end());
+    materials.insert(materials.end(), other.materials.begin(), other.materials.end());
+    subMeshes.insert(subMeshes.end(), other.subMeshes.begin(), other.subMeshes.end());
+}
+
+Handle<Image> AssetDatabase::addImage(Image&& image)
+{
+    const auto hash = contentHash(image);
+    const auto digest = contentHash(image, digestSeed);
+    if (auto existing = findContent(imagesByContent_, images_, hash, digest, image); existing.valid())
+    {
+        deduplicationReport_.duplicateImages++;
+        deduplicationReport_.bytesSaved += assets::cpuMemoryUsage(image);
+        return existing;
+    }
+
+    deduplicationReport_.uniqueImages++;
+    const auto handle = images_.add(std::move(image));
+    imagesByContent_.emplace(hash, ContentEntry<Image>{handle, digest});
+    return handle;
+}
+
+Handle<Material> AssetDatabase::addMaterial(Material&& material)
+{
+    const auto hash = contentHash(material);
+    const auto digest = contentHash(material, digestSeed);
+    if (auto existing = findContent(materialsByContent_, materials_, hash, digest, material); existing.valid())
+    {
+        deduplicationReport_.duplicateMaterials++;
+        deduplicationReport_.bytesSaved += sizeof(Material);
+        return existing;
+    }
+
+    if (material.diffuseTexture.valid())
+    {
+        images_.addReference(material.diffuseTexture);
+    }
+
+    deduplicationReport_.uniqueMaterials++;
+    const auto handle = materials_.add(std::move(material));
+    materialsByContent_.emplace(hash, ContentEntry<Material>{handle, digest});
+    return handle;
+}
+
+Handle<SubMesh> AssetDatabase::addSubMesh(SubMesh&& subMesh)
+{
+    const auto hash = contentHash(subMesh);
+    const auto digest = contentHash(subMesh, digestSeed);
+    if (auto existing = findContent(subMeshesByContent_, subMeshes_, hash, digest, subMesh); existing.valid())
+    {
+        deduplicationReport_.duplicateSubMeshes++;
+        deduplicationReport_.bytesSaved += assets::cpuMemoryUsage(subMesh);
+        return existing;
+    }
+
+    if (subMesh.material.valid())
+    {
+        materials_.addReference(subMesh.material);
+    }
+
+    deduplicationReport_.uniqueSubMeshes++;
+    const auto handle = subMeshes_.add(std::move(subMesh));
+    subMeshesByContent_.emplace(hash, ContentEntry<SubMesh>{handle, digest});
+    return handle;
+}
+
+Handle<Mesh> AssetDatabase::addMesh(Mesh&& mesh)
+{
+    const auto hash = contentHash(mesh);
+    const auto digest = contentHash(mesh, digestSeed);
+    if (auto existing = findContent(meshesByContent_, meshes_, hash, digest, mesh); existing.valid())
+    {
+        return existing;
+    }
+
+    for (const auto& subMesh : mesh.subMeshes)
+    {
+        subMeshes_.addReference(subMesh);
+    }
+
+    const auto handle = meshes_.add(std::move(mesh));
+    meshesByContent_.emplace(hash, ContentEntry<Mesh>{handle, digest});
+    return handle;
+}
+
+Handle<Prefab> AssetDatabase::addPrefab(const std::string& name, Prefab&& prefab)
+{
+    // Replacing it here would drop the old content without the renderer retiring its GPU copies; replacePrefab does
+    if (findPrefab(name).valid())
+    {
+        throw std::runtime_error("A prefab named " + name + " is already loaded");
+    }
+
+    referencePrefabContent(prefab);
+
+    const auto handle = prefabs_.add(std::move(prefab));
+    prefabNames_[name] = handle;
+    return handle;
+}
+
+Handle<Prefab> AssetDatabase::addPrefab(const std::string& name, AssetDatabase& source, const Prefab& sourcePrefab)
+{
+    return addPrefab(name, importPrefab(source, sourcePrefab));
+}
+
+EvictedAssets AssetDatabase::replacePrefab(Handle<Prefab> handle, AssetDatabase& source, const Prefab& sourcePrefab)
+{
+    auto prefab = importPrefab(source, sourcePrefab);
+
+    // Reference the new content before releasing the old so anything unchanged stays loaded
+    referencePrefabContent(prefab);
+
+    auto& current = prefabs_.get(handle);
+    const auto previous = std::exchange(current, std::move(prefab));
+
+    auto evicted = EvictedAssets{};
+    releasePrefabContent(previous, evicted);
+    return evicted;
+}
+
+// Adds a prefab's content from another database to this one and returns the prefab with its handles remapped
+Prefab AssetDatabase::importPrefab(AssetDatabase& source, const Prefab& sourcePrefab)
+{
+    auto images = std::vector<Handle<Image>>(source.images_.slotCount());
+    auto materials = std::vector<Handle<Material>>(source.materials_.slotCount());
+    auto subMeshes = std::vector<Handle<SubMesh>>(source.subMeshes_.slotCount());
+    auto meshes = std::vector<Handle<Mesh>>(source.meshes_.slotCount());
+
+    auto importImage = [&](Handle<Image> handle)
+    {
+        if (handle.valid() && !images[handle.index].valid())
+        {
+            images[handle.index] = addImage(std::move(source.images_.get(handle)));
+        }
+
+        return handle.valid() ? images[handle.index] : Handle<Image>{};
+    };
+
+    auto importMaterial = [&](Handle<Material> handle)
+    {
+        if (handle.valid() && !materials[handle.index].valid())
+        {
+            auto material = source.materials_.get(handle);
+            material.diffuseTexture = importImage(material.diffuseTexture);
+            materials[handle.index] = addMaterial(std::move(material));
+        }
+
+        return handle.valid() ? materials[handle.index] : Handle<Material>{};
+    };
+
+    auto importMesh = [&](Handle<Mesh> handle)
+    {
+        if (handle.valid() && !meshes[handle.index].valid())
+        {
+            auto mesh = Mesh{};
+            for (const auto& subMeshHandle : source.meshes_.get(handle).subMeshes)
+            {
+                if (!subMeshes[subMeshHandle.index].valid())
+                {
+                    auto subMesh = std::move(source.subMeshes_.get(subMeshHandle));
+                    subMesh.material = importMaterial(subMesh.material);
+                    subMeshes[subMeshHandle.index] = addSubMesh(std::move(subMesh));
+                }
+
+                mesh.subMeshes.push_back(subMeshes[subMeshHandle.index]);
+            }
+
+            meshes[handle.index] = addMesh(std::move(mesh));
+        }
+
+        return handle.valid() ? meshes[handle.index] : Handle<Mesh>{};
+    };
+
+    auto prefab = Prefab{};
+    prefab.sourcePath = sourcePrefab.sourcePath;
+    prefab.instanceTransforms = sourcePrefab.instanceTransforms;
+    std::ranges::transform(sourcePrefab.images, std::back_inserter(prefab.images), importImage);
+    std::ranges::transform(sourcePrefab.materials, std::back_inserter(prefab.materials), importMaterial);
+    std::ranges::transform(sourcePrefab.meshes, std::back_inserter(prefab.meshes), importMesh);
+
+    for (auto instance : sourcePrefab.meshInstances)
+    {
+        instance.mesh = importMesh(instance.mesh);
+        prefab.meshInstances.push_back(instance);
+    }
+
+    return prefab;
+}
+
+Handle<Skybox> AssetDatabase::addSkybox(const std::string& name, Skybox&& skybox)
+{
+    if (findSkybox(name).valid())
+    {
+        throw std::runtime_error("A skybox named " + name + " is already loaded");
+    }
+
+    if (skybox.cubemap.valid())
+    {
+        images_.addReference(skybox.cubemap);
+    }
+
+    const auto handle = skyboxes_.add(std::move(skybox));
+    skyboxNames_[name] = handle;
+    return handle;
+}
+
+Handle<Prefab> AssetDatabase::findPrefab(const std::string& name) const
+{
+    if (auto itr = prefabNames_.find(name); itr != prefabNames_.end())
+    {
+        return itr->second;
+    }
+
+    return {};
+}
+
+Handle<Skybox> AssetDatabase::findSkybox(const std::string& name) const
+{
+    if (auto itr = skyboxNames_.find(name); itr != skyboxNames_.end())
+    {
+        return itr->second;
+    }
+
+    return {};
+}
+
+const std::unordered_map<std::string, Handle<Prefab>>& AssetDatabase::prefabNames() const
+{
+    return prefabNames_;
+}
+
+const std::unordered_map<std::string, Handle<Skybox>>& AssetDatabase::skyboxNames() const
+{
+    return skyboxNames_;
+}
+
+void AssetDatabase::acquire(Handle<Prefab> prefab, uint32_t count)
+{
+    prefabs_.addReference(prefab, count);
+}
+
+void AssetDatabase::release(Handle<Prefab> prefab, uint32_t count)
+{
+    if (prefabs_.contains(prefab))
+    {
+        prefabs_.releaseReference(prefab, count);
+    }
+}
+
+uint32_t AssetDatabase::referenceCount(Handle<Prefab> prefab) const
+{
+    return prefabs_.referenceCount(prefab);
+}
+
+void AssetDatabase::markUsed(Handle<Prefab> prefab, uint64_t frame)
+{
+    prefabs_.markUsed(prefab, frame);
+}
+
+void AssetDatabase::setImageCache(ImageCache* cache)
+{
+    imageCache_ = cache;
+}
+
+ImageCache* AssetDatabase::imageCache() const
+{
+    return imageCache_;
+}
+
+void AssetDatabase::setJobSystem(core::JobSystem* jobSystem)
+{
+    jobSystem_ = jobSystem;
+}
+
+core::JobSystem* AssetDatabase::jobSystem() const
+{
+    return jobSystem_;
+}
+
+void AssetDatabase::setFileReadQueue(core::FileReadQueue* readQueue)
+{
+    fileReadQueue_ = readQueue;
+}
+
+core::FileReadQueue* AssetDatabase::fileReadQueue() const
+{
+    return fileReadQueue_;
+}
+
+void AssetDatabase::setMemoryBudget(const MemoryBudget& budget)
+{
+    memoryBudget_ = budget;
+}
+
+const MemoryBudget& AssetDatabase::memoryBudget() const
+{
+    return memoryBudget_;
+}
+
+size_t AssetDatabase::cpuMemoryUsage() const
+{
+    auto bytes = size_t{0};
+    images_.forEach([&bytes](Handle<Image>, const Image& image) { bytes += assets::cpuMemoryUsage(image); });
+    subMeshes_.forEach([&bytes](Handle<SubMesh>, const SubMesh& subMesh)
+                       { bytes += assets::cpuMemoryUsage(subMesh); });
+
+    return bytes;
+}
+
+std::optional<EvictedAssets> AssetDatabase::evictLeastRecentlyUsed()
+{
+    auto candidate = Handle<Prefab>{};
+    auto candidateLastUsed = uint64_t{0};
+    prefabs_.forEach(
+        [&](Handle<Prefab> handle, const Prefab&)
+        {
+            if (prefabs_.referenceCount(handle) > 0)
+            {
+                return;
+            }
+
+            const auto lastUsed = prefabs_.lastUsed(handle);
+            if (!candidate.valid() || lastUsed < candidateLastUsed)
+            {
+                candidate = handle;
+                candidateLastUsed = lastUsed;
+            }
+        });
+
+    if (!candidate.valid())
+    {
+        return std::nullopt;
+    }
+
+    auto evicted = EvictedAssets{};
+    removePrefab(candidate, evicted);
+
+    spdlog::debug("Evicted prefab {} with {} images and {} sub-meshes",
+                  candidate.index,
+                  evicted.images.size(),
+                  evicted.subMeshes.size());
+
+    return evicted;
+}
+
+void AssetDatabase::evict(Handle<Prefab> prefab, EvictedAssets& evicted)
+{
+    if (prefabs_.referenceCount(prefab) > 0)
+    {
+        throw std::logic_error("Evicting a prefab that is still referenced");
+    }
+
+    removePrefab(prefab, evicted);
+}
+
+void AssetDatabase::removePrefab(Handle<Prefab> handle, EvictedAssets& evicted)
 {
-    prefabs_[name] = std::move(prefab);
+    const auto prefab = std::move(prefabs_.get(handle));
+    prefabs_.remove(handle);
+    std::erase_if(prefabNames_, [handle](const auto& entry) { return entry.second == handle; });
+    evicted.prefabs.push_back(handle);
+
+    releasePrefabContent(prefab, evicted);
 }
 
-void AssetDatabase::addSkybox(const std::string& name, std::unique_ptr<Skybox> skybox)
+void AssetDatabase::referencePrefabContent(const Prefab& prefab)
 {
-    skyboxes_[name] = std::move(skybox);
+    for (const auto& image : prefab.images)
+    {
+        images_.addReference(image);
+    }
+
+    for (const auto& material : prefab.materials)
+    {
+        materials_.addReference(material);
+    }
+
+    for (const auto& mesh : prefab.meshes)
+    {
+        meshes_.addReference(mesh);
+    }
 }
 
-const AssetDatabase::AssetStorage<Prefab>& AssetDatabase::prefabs() const
+void AssetDatabase::releasePrefabContent(const Prefab& prefab, EvictedAssets& evicted)
 {
-    return prefabs_;
+    for (const auto& image : prefab.images)
+    {
+        releaseAsset(image, evicted);
+    }
+
+    for (const auto& material : prefab.materials)
+    {
+        releaseAsset(material, evicted);
+    }
+
+    for (const auto& mesh : prefab.meshes)
+    {
+        releaseAsset(mesh, evicted);
+    }
+}
+
+// Assets are removed when their last user releases them, then release whatever they were using in turn
+void AssetDatabase::releaseAsset(Handle<Image> handle, EvictedAssets& evicted)
+{
+    if (!images_.contains(handle) || images_.releaseReference(handle) > 0)
+    {
+        return;
+    }
+
+    eraseContent(imagesByContent_, handle);
+    images_.remove(handle);
+    evicted.images.push_back(handle);
+}
+
+void AssetDatabase::releaseAsset(Handle<Material> handle, EvictedAssets& evicted)
+{
+    if (!materials_.contains(handle) || materials_.releaseReference(handle) > 0)
+    {
+        return;
+    }
+
+    const auto texture = materials_.get(handle).diffuseTexture;
+    eraseContent(materialsByContent_, handle);
+    materials_.remove(handle);
+    evicted.materials.push_back(handle);
+
+    releaseAsset(texture, evicted);
+}
+
+void AssetDatabase::releaseAsset(Handle<SubMesh> handle, EvictedAssets& evicted)
+{
+    if (!subMeshes_.contains(handle) || subMeshes_.releaseReference(handle) > 0)
+    {
+        return;
+    }
+
+    const auto material = subMeshes_.get(handle).material;
+    eraseContent(subMeshesByContent_, handle);
+    subMeshes_.remove(handle);
+    evicted.subMeshes.push_back(handle);
+
+    releaseAsset(material, evicted);
 }
 
-const AssetDatabase::AssetStorage<Skybox>& AssetDatabase::skyboxes() const
+void AssetDatabase::releaseAsset(Handle<Mesh> handle, EvictedAssets& evicted)
 {
-    return skyboxes_;
+    if (!meshes_.contains(handle) || meshes_.releaseReference(handle) > 0)
+    {
+        return;
+    }
+
+    const auto subMeshes = std::move(meshes_.get(handle).subMeshes);
+    eraseContent(meshesByContent_, handle);
+    meshes_.remove(handle);
+
+    for (const auto& subMesh : subMeshes)
+    {
+        releaseAsset(subMesh, evicted);
+    }
+}
+
+const DeduplicationReport& AssetDatabase::deduplicationReport() const
+{
+    return deduplicationReport_;
+}
+
+void AssetDatabase::setResidencyPolicy(const ResidencyPolicy& policy)
+{
+    residencyPolicy_ = policy;
+}
+
+const ResidencyPolicy& AssetDatabase::residencyPolicy() const
+{
+    return residencyPolicy_;
+}
+
+void AssetDatabase::applyResidencyPolicy()
+{
+    // Skybox images aren't loaded from a prefab so they can't be restored and are always kept
+    prefabs_.forEach(
+        [this](Handle<Prefab>, const Prefab& prefab)
+        {
+            for (const auto& image : prefab.images)
+            {
+                releaseCpuData(images_.get(image), residencyPolicy_);
+            }
+
+            for (const auto& mesh : prefab.meshes)
+            {
+                for (const auto& subMesh : meshes_.get(mesh).subMeshes)
+                {
+                    releaseCpuData(subMeshes_.get(subMesh), residencyPolicy_);
+                }
+            }
+        });
+}
+
+void AssetDatabase::restoreCpuData(Handle<Prefab> handle)
+{
+    const auto& prefab = prefabs_.get(handle);
+    if (prefab.sourcePath.empty())
+    {
+        throw std::runtime_error("Prefab has no source to restore from");
+    }
+
+    spdlog::info("Restoring CPU data from {}", prefab.sourcePath.string());
+
+    // The source is loaded into its own database, whose prefab lists assets in the same file order
+    auto sourceDatabase = AssetDatabase{};
+    sourceDatabase.setImageCache(imageCache_);
+    sourceDatabase.setJobSystem(jobSystem_);
+    sourceDatabase.setFileReadQueue(fileReadQueue_);
+    const auto source = loadGLTFModel(prefab.sourcePath, sourceDatabase);
+    if (source.images.size() != prefab.images.size() || source.meshes.size() != prefab.meshes.size())
+    {
+        throw std::runtime_error("Prefab source " + prefab.sourcePath.string() + " changed since it was loaded");
+    }
+
+    // Shared assets are identical in every prefab using them, so any of its sources can restore them
+    for (auto imageIndex = size_t{0}; imageIndex < prefab.images.size(); ++imageIndex)
+    {
+        auto& image = images_.get(prefab.images[imageIndex]);
+        if (image.data.empty())
+        {
+            image.data = std::move(sourceDatabase.get(source.images[imageIndex]).data);
+        }
+    }
+
+    for (auto meshIndex = size_t{0}; meshIndex < prefab.meshes.size(); ++meshIndex)
+    {
+        const auto& mesh = meshes_.get(prefab.meshes[meshIndex]);
+        const auto& sourceMesh = sourceDatabase.get(source.meshes[meshIndex]);
+
+        for (auto subMeshIndex = size_t{0}; subMeshIndex < mesh.subMeshes.size(); ++subMeshIndex)
+        {
+            auto& subMesh = subMeshes_.get(mesh.subMeshes[subMeshIndex]);
+            auto& sourceSubMesh = sourceDatabase.get(sourceMesh.subMeshes.at(subMeshIndex));
+
+            if (subMesh.vertices.empty())
+            {
+                subMesh.vertices = std::move(sourceSubMesh.vertices);
+            }
+
+            if (subMesh.indices.empty())
+            {
+                subMesh.indices = std::move(sourceSubMesh.indices);
+            }
+
+            if (subMesh.meshlets.empty())
+            {
+                subMesh.meshlets = std::move(sourceSubMesh.meshlets);
+            }
+        }
+    }
 }
 
 void AssetDatabase::clear()
 {
+    images_.clear();
+    materials_.clear();
+    subMeshes_.clear();
+    meshes_.clear();
     prefabs_.clear();
     skyboxes_.clear();
+    prefabNames_.clear();
+    skyboxNames_.clear();
+    imagesByContent_.clear();
+    materialsByContent_.clear();
+    subMeshesByContent_.clear();
+    meshesByContent_.clear();
+    deduplicationReport_ = DeduplicationReport{};
 }
 } // namespace assets
@@ -0,0 +1,374 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Mark Rapson
+
+#include "gltf_accessor.h"
+
+#ifdef __GNUC__
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wconversion"
+#pragma GCC diagnostic ignored "-Wmissing-field-initializers"
+#endif
+#include <tiny_gltf.h>
+#ifdef __GNUC__
+#pragma GCC diagnostic pop
+#endif
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+namespace assets
+{
+// Integer to float conversion as defined for normalized accessors in the glTF 2.0 specification
+template <typename Component, bool Normalized>
+float componentToFloat(Component value)
+{
+    if constexpr (std::is_same_v<Component, float> || !Normalized)
+    {
+        return static_cast<float>(value);
+    }
+    else if constexpr (std::is_signed_v<Component>)
+    {
+        return std::max(static_cast<float>(value) / static_cast<float>(std::numeric_limits<Component>::max()), -1.0f);
+    }
+    else
+    {
+        return static_cast<float>(value) / static_cast<float>(std::numeric_limits<Component>::max());
+    }
+}
+
+// Branch-free inner loop over a fixed component count so the compiler can vectorise it. Elements are copied
+// through std::memcpy as strided views don't guarantee component alignment.
+template <typename Component, bool Normalized, uint32_t Components>
+void convertElements(const std::byte* source,
+                     size_t sourceStride,
+                     std::byte* destination,
+                     size_t destinationStride,
+                     size_t count)
+{
+    for (auto i = size_t{0}; i < count; ++i)
+    {
+        auto components = std::array<Component, Components>{};
+        std::memcpy(components.data(), source + i * sourceStride, sizeof(components));
+
+        auto values = std::array<float, Components>{};
+        for (auto c = uint32_t{0}; c < Components; ++c)
+        {
+            values[c] = componentToFloat<Component, Normalized>(components[c]);
+        }
+
+        std::memcpy(destination + i * destinationStride, values.data(), sizeof(values));
+    }
+}
+
+template <typename Component, bool Normalized>
+void convertElements(const std::byte* source,
+                     size_t sourceStride,
+                     std::byte* destination,
+                     size_t destinationStride,
+                     size_t count,
+                     uint32_t components)
+{
+    switch (components)
+    {
+        case 1:
+            convertElements<Component, Normalized, 1>(source, sourceStride, destination, destinationStride, count);
+            break;
+        case 2:
+            convertElements<Component, Normalized, 2>(source, sourceStride, destination, destinationStride, count);
+            break;
+        case 3:
+            convertElements<Component, Normalized, 3>(source, sourceStride, destination, destinationStride, count);
+            break;
+        case 4:
+            convertElements<Component, Normalized, 4>(source, sourceStride, destination, destinationStride, count);
+            break;
+        default:
+            throw std::runtime_error("Unsupported glTF accessor component count");
+    }
+}
+
+template <typename Component>
+void convertElements(const std::byte* source,
+                     size_t sourceStride,
+                     std::byte* destination,
+                     size_t destinationStride,
+                     size_t count,
+                     uint32_t components,
+                     bool normalized)
+{
+    if (normalized)
+    {
+        convertElements<Component, true>(source, sourceStride, destination, destinationStride, count, components);
+    }
+    else
+    {
+        convertElements<Component, false>(source, sourceStride, destination, destinationStride, count, components);
+    }
+}
+
+void convertElements(int componentType,
+                     const std::byte* source,
+                     size_t sourceStride,
+                     std::byte* destination,
+                     size_t destinationStride,
+                     size_t count,
+                     uint32_t components,
+                     bool normalized)
+{
+    switch (componentType)
+    {
+        case TINYGLTF_COMPONENT_TYPE_FLOAT:
+            convertElements<float>(source, sourceStride, destination, destinationStride, count, components, false);
+            break;
+        case TINYGLTF_COMPONENT_TYPE_BYTE:
+            convertElements<int8_t>(source, sourceStride, destination, destinationStride, count, components, normalized);
+            break;
+        case TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE:
+            convertElements<uint8_t>(source, sourceStride, destination, destinationStride, count, components, normalized);
+            break;
+        case TINYGLTF_COMPONENT_TYPE_SHORT:
+            convertElements<int16_t>(source, sourceStride, destination, destinationStride, count, components, normalized);
+            break;
+        case TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT:
+            convertElements<uint16_t>(source,
+                                      sourceStride,
+                                      destination,
+                                      destinationStride,
+                                      count,
+                                      components,
+                                      normalized);
+            break;
+        case TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT:
+            convertElements<uint32_t>(source,
+                                      sourceStride,
+                                      destination,
+                                      destinationStride,
+                                      count,
+                                      components,
+                                      normalized);
+            break;
+        default:
+            throw std::runtime_error("Unsupported glTF accessor component type");
+    }
+}
+
+template <typename Component>
+void convertIndices(const std::byte* source, size_t sourceStride, uint32_t* destination, size_t count)
+{
+    for (auto i = size_t{0}; i < count; ++i)
+    {
+        auto index = Component{};
+        std::memcpy(&index, source + i * sourceStride, sizeof(Component));
+        destination[i] = static_cast<uint32_t>(index);
+    }
+}
+
+void convertIndices(int componentType, const std::byte* source, size_t sourceStride, uint32_t* destination, size_t count)
+{
+    switch (componentType)
+    {
+        case TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE:
+            convertIndices<uint8_t>(source, sourceStride, destination, count);
+            break;
+        case TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT:
+            convertIndices<uint16_t>(source, sourceStride, destination, count);
+            break;
+        case TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT:
+            convertIndices<uint32_t>(source, sourceStride, destination, count);
+            break;
+        default:
+            throw std::runtime_error("Unsupported glTF index component type");
+    }
+}
+
+// Returns the start of count elements in a buffer view, checking that all of them lie inside it
+const std::byte* bufferViewData(const tinygltf::Model& model,
+                                int bufferViewIndex,
+                                size_t byteOffset,
+                                size_t stride,
+                                size_t elementSize,
+                                size_t count)
+{
+    const auto& bufferView = model.bufferViews.at(bufferViewIndex);
+    const auto& buffer = model.buffers.at(bufferView.buffer);
+
+    const auto requiredSize = count == 0 ? 0 : stride * (count - 1) + elementSize;
+    if (byteOffset + requiredSize > bufferView.byteLength
+        || bufferView.byteOffset + byteOffset + requiredSize > buffer.data.size())
+    {
+        throw std::runtime_error("glTF accessor exceeds its buffer view");
+    }
+
+    return reinterpret_cast<const std::byte*>(buffer.data.data() + bufferView.byteOffset + byteOffset);
+}
+
+size_t elementSize(const tinygltf::Accessor& accessor)
+{
+    return static_cast<size_t>(tinygltf::GetComponentSizeInBytes(accessor.componentType))
+           * static_cast<size_t>(tinygltf::GetNumComponentsInType(accessor.type));
+}
+
+std::vector<uint32_t> readSparseIndices(const tinygltf::Model& model, const tinygltf::Accessor& accessor)
+{
+    const auto& sparseIndices = accessor.sparse.indices;
+    const auto count = static_cast<size_t>(accessor.sparse.count);
+    const auto stride = static_cast<size_t>(tinygltf::GetComponentSizeInBytes(sparseIndices.componentType));
+
+    auto indices = std::vector<uint32_t>(count);
+    convertIndices(sparseIndices.componentType,
+                   bufferViewData(model,
+                                  sparseIndices.bufferView,
+                                  static_cast<size_t>(sparseIndices.byteOffset),
+                                  stride,
+                                  stride,
+                                  count),
+                   stride,
+                   indices.data(),
+                   count);
+
+    for (const auto index : indices)
+    {
+        if (index >= accessor.count)
+        {
+            throw std::runtime_error("glTF sparse accessor index out of range");
+        }
+    }
+
+    return indices;
+}
+
+const std::byte* readSparseValues(const tinygltf::Model& model, const tinygltf::Accessor& accessor)
+{
+    const auto size = elementSize(accessor);
+    return bufferViewData(model,
+                          accessor.sparse.values.bufferView,
+                          static_cast<size_t>(accessor.sparse.values.byteOffset),
+                          size,
+                          size,
+                          static_cast<size_t>(accessor.sparse.count));
+}
+
+size_t accessorCount(const tinygltf::Model& model, int accessorIndex)
+{
+    return model.accessors.at(accessorIndex).count;
+}
+
+void readFloatAccessor(const tinygltf::Model& model,
+                       int accessorIndex,
+                       std::byte* destination,
+                       size_t destinationStride,
+                       size_t destinationCount,
+                       uint32_t componentCount)
+{
+    const auto& accessor = model.accessors.at(accessorIndex);
+    if (accessor.count > destinationCount)
+    {
+        throw std::runtime_error("glTF accessor has more elements than its destination");
+    }
+
+    const auto sourceComponents = static_cast<uint32_t>(tinygltf::GetNumComponentsInType(accessor.type));
+    const auto components = std::min(sourceComponents, componentCount);
+
+    if (accessor.bufferView >= 0)
+    {
+        const auto& bufferView = model.bufferViews.at(accessor.bufferView);
+        const auto stride = accessor.ByteStride(bufferView);
+        if (stride <= 0)
+        {
+            throw std::runtime_error("Invalid glTF buffer view stride");
+        }
+
+        const auto* source = bufferViewData(model,
+                                            accessor.bufferView,
+                                            accessor.byteOffset,
+                                            static_cast<size_t>(stride),
+                                            elementSize(accessor),
+                                            accessor.count);
+
+        convertElements(accessor.componentType,
+                        source,
+                        static_cast<size_t>(stride),
+                        destination,
+                        destinationStride,
+                        accessor.count,
+                        components,
+                        accessor.normalized);
+    }
+    else
+    {
+        // Accessors without a buffer view are initialised to zero (and usually sparse)
+        for (auto i = size_t{0}; i < accessor.count; ++i)
+        {
+            std::memset(destination + i * destinationStride, 0, components * sizeof(float));
+        }
+    }
+
+    if (accessor.sparse.isSparse)
+    {
+        const auto indices = readSparseIndices(model, accessor);
+        const auto* values = readSparseValues(model, accessor);
+        const auto valueSize = elementSize(accessor);
+
+        for (auto i = size_t{0}; i < indices.size(); ++i)
+        {
+            convertElements(accessor.componentType,
+                            values + i * valueSize,
+                            valueSize,
+                            destination + indices[i] * destinationStride,
+                            destinationStride,
+                            1,
+                            components,
+                            accessor.normalized);
+        }
+    }
+}
+
+void readIndexAccessor(const tinygltf::Model& model, int accessorIndex, std::span<uint32_t> destination)
+{
+    const auto& accessor = model.accessors.at(accessorIndex);
+    if (accessor.count > destination.size())
+    {
+        throw std::runtime_error("glTF accessor has more elements than its destination");
+    }
+
+    if (accessor.bufferView >= 0)
+    {
+        const auto& bufferView = model.bufferViews.at(accessor.bufferView);
+        const auto stride = accessor.ByteStride(bufferView);
+        if (stride <= 0)
+        {
+            throw std::runtime_error("Invalid glTF buffer view stride");
+        }
+
+        const auto* source = bufferViewData(model,
+                                            accessor.bufferView,
+                                            accessor.byteOffset,
+                                            static_cast<size_t>(stride),
+                                            elementSize(accessor),
+                                            accessor.count);
+
+        convertIndices(accessor.componentType, source, static_cast<size_t>(stride), destination.data(), accessor.count);
+    }
+    else
+    {
+        std::fill_n(destination.begin(), accessor.count, uint32_t{0});
+    }
+
+    if (accessor.sparse.isSparse)
+    {
+        const auto indices = readSparseIndices(model, accessor);
+        const auto* values = readSparseValues(model, accessor);
+        const auto valueSize = elementSize(accessor);
+
+        for (auto i = size_t{0}; i < indices.size(); ++i)
+        {
+            convertIndices(accessor.componentType, values + i * valueSize, valueSize, &destination[indices[i]], 1);
+        }
+    }
+}
+} // namespace assets
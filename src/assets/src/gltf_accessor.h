@@ -0,0 +1,56 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Mark Rapson
+
+#pragma once
+
+#include <cstddef>
+#include <span>
+#include <stdint.h>
+
+namespace tinygltf
+{
+class Model;
+}
+
+namespace assets
+{
+size_t accessorCount(const tinygltf::Model& model, int accessorIndex);
+
+// Decodes the first componentCount components of every element of an accessor to float, writing element i to
+// destination + i * destinationStride. Interleaved and strided buffer views, sparse accessors and (normalized)
+// integer component types are all handled.
+void readFloatAccessor(const tinygltf::Model& model,
+                       int accessorIndex,
+                       std::byte* destination,
+                       size_t destinationStride,
+                       size_t destinationCount,
+                       uint32_t componentCount);
+
+void readIndexAccessor(const tinygltf::Model& model, int accessorIndex, std::span<uint32_t> destination);
+
+template <typename Element>
+void readAccessor(const tinygltf::Model& model, int accessorIndex, std::span<Element> destination)
+{
+    static_assert(sizeof(Element) % sizeof(float) == 0, "Accessor elements must be made of floats");
+
+    readFloatAccessor(model,
+                      accessorIndex,
+                      reinterpret_cast<std::byte*>(destination.data()),
+                      sizeof(Element),
+                      destination.size(),
+                      sizeof(Element) / sizeof(float));
+}
+
+// Decodes straight into one member of an interleaved destination, e.g. &core::Vertex::normal
+template <typename Element, typename Member>
+void readAccessor(const tinygltf::Model& model,
+                  int accessorIndex,
+                  std::span<Element> destination,
+                  Member Element::*member)
+{
+    static_assert(sizeof(Member) % sizeof(float) == 0, "Accessor elements must be made of floats");
+
+    auto* first = destination.empty() ? nullptr : reinterpret_cast<std::byte*>(&(destination.front().*member));
+    readFloatAccessor(model, accessorIndex, first, sizeof(Element), destination.size(), sizeof(Member) / sizeof(float));
+}
+} // namespace assets
@@ -3,12 +3,22 @@
 
 #include "assets/gltf_loader.h"
 
+#include "assets/asset_database.h"
 #include "assets/image.h"
+#include "assets/image_cache.h"
 #include "assets/image_loader.h"
 #include "assets/material.h"
 #include "assets/mesh.h"
+#include "assets/meshlet_builder.h"
 #include "assets/prefab.h"
-
+#include "gltf_accessor.h"
+#include "meshopt_codec.h"
+
+#include <core/arena.h>
+#include <core/file_read_queue.h>
+#include <core/job_system.h>
+#include <core/mapped_file.h>
+#include <core/task.h>
 #include <core/vertex.h>
 
 #ifdef __GNUC__
@@ -17,6 +27,7 @@
 #pragma GCC diagnostic ignored "-Wmissing-field-initializers"
 #endif
 #define TINYGLTF_IMPLEMENTATION
+#define TINYGLTF_NO_STB_IMAGE
 #define STB_IMAGE_WRITE_IMPLEMENTATION
 #include <tiny_gltf.h>
 #ifdef __GNUC__
@@ -31,6 +42,16 @@
 
 #include <spdlog/spdlog.h>
 
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <memory_resource>
+#include <numeric>
+#include <span>
+#include <stdexcept>
+#include <string>
 #include <vector>
 
 namespace assets
@@ -45,84 +66,304 @@ glm::vec3 readColor(const std::vector<double>& color)
     return glm::vec3(color.at(0), color.at(1), color.at(2));
 }
 
-std::vector<uint32_t> readIndices(tinygltf::Primitive& primitive, tinygltf::Model& model)
+std::vector<uint32_t> readIndices(const tinygltf::Primitive& primitive,
+                                  const tinygltf::Model& model,
+                                  size_t vertexCount)
 {
-    const auto& indexAcessor = model.accessors[primitive.indices];
-    const auto& indexBufferView = model.bufferViews[indexAcessor.bufferView];
-    const auto& indexBuffer = model.buffers[indexBufferView.buffer];
+    if (primitive.indices < 0)
+    {
+        auto indices = std::vector<uint32_t>(vertexCount);
+        std::iota(indices.begin(), indices.end(), uint32_t{0});
+        return indices;
+    }
 
-    auto indices = std::vector<uint32_t>{};
+    auto indices = std::vector<uint32_t>(accessorCount(model, primitive.indices));
+    readIndexAccessor(model, primitive.indices, indices);
+    return indices;
+}
 
-    if (indexAcessor.componentType == TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT)
+std::vector<core::Vertex> readVertices(const tinygltf::Primitive& primitive, const tinygltf::Model& model)
+{
+    const auto position = primitive.attributes.find("POSITION");
+    if (position == primitive.attributes.end())
     {
-        const auto* indexData = reinterpret_cast<const uint16_t*>(
-            &indexBuffer.data[indexBufferView.byteOffset + indexAcessor.byteOffset]);
-        for (auto i = size_t{0}; i < indexAcessor.count; ++i)
-        {
-            indices.push_back(static_cast<uint32_t>(indexData[i]));
-        }
+        throw std::runtime_error("glTF primitive has no POSITION attribute");
     }
-    else
+
+    auto vertices = std::vector<core::Vertex>(accessorCount(model, position->second));
+    readAccessor(model, position->second, std::span{vertices}, &core::Vertex::position);
+
+    if (const auto normal = primitive.attributes.find("NORMAL"); normal != primitive.attributes.end())
+    {
+        readAccessor(model, normal->second, std::span{vertices}, &core::Vertex::normal);
+    }
+
+    if (const auto texcoord = primitive.attributes.find("TEXCOORD_0"); texcoord != primitive.attributes.end())
+    {
+        readAccessor(model, texcoord->second, std::span{vertices}, &core::Vertex::textureUV);
+    }
+
+    return vertices;
+}
+
+// Runs body(i) for every i in [0, count), spread across the job system's threads when there is one. Each index is
+// a whole image or primitive, so they are handed out one at a time.
+void parallelFor(core::JobSystem* jobSystem, size_t count, const std::function<void(size_t)>& body)
+{
+    if (!jobSystem)
     {
-        const auto* indexData = reinterpret_cast<const uint32_t*>(
-            &indexBuffer.data[indexBufferView.byteOffset + indexAcessor.byteOffset]);
-        for (auto i = size_t{0}; i < indexAcessor.count; ++i)
+        for (auto i = size_t{0}; i < count; ++i)
         {
-            indices.push_back(static_cast<uint32_t>(indexData[i]));
+            body(i);
         }
+        return;
     }
 
-    return indices;
+    jobSystem->parallelFor(count,
+                           1,
+                           [&body](size_t begin, size_t end)
+                           {
+                               for (auto i = begin; i < end; ++i)
+                               {
+                                   body(i);
+                               }
+                           });
 }
 
-std::vector<core::Vertex> readVertices(tinygltf::Primitive& primitive, tinygltf::Model& model)
+// Keeps the encoded bytes of each image instead of decoding them while the file is parsed, so they can be decoded in
+// parallel, or fetched from the image cache, afterwards
+bool keepEncodedImage(tinygltf::Image* image,
+                      const int,
+                      std::string*,
+                      std::string*,
+                      int,
+                      int,
+                      const unsigned char* bytes,
+                      int size,
+                      void*)
 {
-    const auto& posAcessor = model.accessors[primitive.attributes.at("POSITION")];
-    const auto& posBufferView = model.bufferViews[posAcessor.bufferView];
-    const auto& posBuffer = model.buffers[posBufferView.buffer];
+    image->image.assign(bytes, bytes + size);
+    image->as_is = true;
+    return true;
+}
 
-    const float* positions = reinterpret_cast<const float*>(
-        &posBuffer.data[posBufferView.byteOffset + posAcessor.byteOffset]);
+// Required glTF extensions the loader understands; quantized attributes are handled by the accessor layer
+bool isSupportedExtension(const std::string& extension)
+{
+    return extension == "KHR_mesh_quantization" || extension == "EXT_meshopt_compression"
+           || extension == "EXT_mesh_gpu_instancing";
+}
 
-    const auto& normalAcessor = model.accessors[primitive.attributes.at("NORMAL")];
-    const auto& normalBufferView = model.bufferViews[normalAcessor.bufferView];
-    const auto& normalBuffer = model.buffers[normalBufferView.buffer];
+MeshoptFilter parseMeshoptFilter(const tinygltf::Value& extension)
+{
+    if (!extension.Has("filter"))
+    {
+        return MeshoptFilter::None;
+    }
 
-    const float* normals = reinterpret_cast<const float*>(
-        &normalBuffer.data[normalBufferView.byteOffset + normalAcessor.byteOffset]);
+    const auto& filter = extension.Get("filter").Get<std::string>();
+    if (filter == "NONE")
+    {
+        return MeshoptFilter::None;
+    }
+    if (filter == "OCTAHEDRAL")
+    {
+        return MeshoptFilter::Octahedral;
+    }
+    if (filter == "QUATERNION")
+    {
+        return MeshoptFilter::Quaternion;
+    }
+    if (filter == "EXPONENTIAL")
+    {
+        return MeshoptFilter::Exponential;
+    }
 
-    const auto& texAcessor = model.accessors[primitive.attributes.at("TEXCOORD_0")];
-    const auto& texBufferView = model.bufferViews[texAcessor.bufferView];
-    const auto& texBuffer = model.buffers[texBufferView.buffer];
+    throw std::runtime_error("Unsupported EXT_meshopt_compression filter: " + filter);
+}
+
+// Decodes every EXT_meshopt_compression buffer view into the range it describes in its own (fallback) buffer, so
+// the rest of the loader can read it like any other view
+void decodeMeshoptBufferViews(tinygltf::Model& model,
+                              std::pmr::memory_resource* scratch,
+                              core::JobSystem* jobSystem)
+{
+    struct MeshoptJob
+    {
+        std::span<const std::byte> source;
+        std::span<std::byte> destination;
+        size_t count;
+        size_t stride;
+        std::string mode;
+        MeshoptFilter filter;
+    };
+
+    // Fallback buffers usually carry no data, so storage for the decoded views is allocated up front. Spans into
+    // the buffers are only taken once none of them will be resized again.
+    for (const auto& bufferView : model.bufferViews)
+    {
+        if (bufferView.extensions.contains("EXT_meshopt_compression"))
+        {
+            auto& destination = model.buffers.at(bufferView.buffer);
+            destination.data.resize(std::max(destination.data.size(), bufferView.byteOffset + bufferView.byteLength));
+        }
+    }
 
-    const float* texcoords = reinterpret_cast<const float*>(
-        &texBuffer.data[texBufferView.byteOffset + texAcessor.byteOffset]);
+    auto jobs = std::pmr::vector<MeshoptJob>{scratch};
+    jobs.reserve(model.bufferViews.size());
 
-    auto vertices = std::vector<core::Vertex>{};
-    for (auto i = size_t{0}; i < posAcessor.count; ++i)
+    for (const auto& bufferView : model.bufferViews)
     {
-        auto v = core::Vertex{};
-        v.position = glm::vec3(positions[i * 3 + 0], positions[i * 3 + 1], positions[i * 3 + 2]);
-        v.normal = glm::vec3(normals[i * 3 + 0], normals[i * 3 + 1], normals[i * 3 + 2]);
-        v.textureUV = glm::vec2(texcoords[i * 2 + 0], texcoords[i * 2 + 1]);
-        vertices.push_back(v);
+        const auto extensionItr = bufferView.extensions.find("EXT_meshopt_compression");
+        if (extensionItr == bufferView.extensions.end())
+        {
+            continue;
+        }
+
+        const auto& extension = extensionItr->second;
+        auto& source = model.buffers.at(extension.Get("buffer").GetNumberAsInt());
+        auto& destination = model.buffers.at(bufferView.buffer);
+        const auto sourceOffset = extension.Has("byteOffset")
+                                      ? static_cast<size_t>(extension.Get("byteOffset").GetNumberAsInt())
+                                      : size_t{0};
+        const auto sourceLength = static_cast<size_t>(extension.Get("byteLength").GetNumberAsInt());
+        const auto count = static_cast<size_t>(extension.Get("count").GetNumberAsInt());
+        const auto stride = static_cast<size_t>(extension.Get("byteStride").GetNumberAsInt());
+
+        if (sourceOffset + sourceLength > source.data.size())
+        {
+            throw std::runtime_error("EXT_meshopt_compression data exceeds its buffer");
+        }
+
+        if (count * stride > bufferView.byteLength)
+        {
+            throw std::runtime_error("EXT_meshopt_compression decoded size exceeds its buffer view");
+        }
+
+        jobs.push_back(MeshoptJob{
+            .source = std::as_bytes(std::span{source.data}).subspan(sourceOffset, sourceLength),
+            .destination = std::as_writable_bytes(std::span{destination.data})
+                               .subspan(bufferView.byteOffset, bufferView.byteLength),
+            .count = count,
+            .stride = stride,
+            .mode = extension.Get("mode").Get<std::string>(),
+            .filter = parseMeshoptFilter(extension),
+        });
     }
 
-    return vertices;
+    parallelFor(jobSystem,
+                jobs.size(),
+                [&](size_t index)
+                {
+                    const auto& job = jobs[index];
+                    if (job.mode == "ATTRIBUTES")
+                    {
+                        decodeMeshoptVertices(job.destination, job.count, job.stride, job.source);
+                        applyMeshoptFilter(job.filter, job.destination, job.count, job.stride);
+                    }
+                    else if (job.mode == "TRIANGLES")
+                    {
+                        decodeMeshoptTriangles(job.destination, job.count, job.stride, job.source);
+                    }
+                    else if (job.mode == "INDICES")
+                    {
+                        decodeMeshoptIndices(job.destination, job.count, job.stride, job.source);
+                    }
+                    else
+                    {
+                        throw std::runtime_error("Unsupported EXT_meshopt_compression mode: " + job.mode);
+                    }
+                });
 }
 
-Image* readBaseColorTexture(tinygltf::Material& material, tinygltf::Model& model, Prefab& prefab)
+Handle<Image> readBaseColorTexture(const tinygltf::Material& material,
+                                   const tinygltf::Model& model,
+                                   const Prefab& prefab)
 {
     const auto texIndex = material.pbrMetallicRoughness.baseColorTexture.index;
     if (texIndex < 0)
     {
-        return nullptr;
+        return {};
     }
 
-    return prefab.getImage(model.images[model.textures[texIndex].source].name);
+    return prefab.images.at(model.textures.at(texIndex).source);
 }
 
-void parseNode(int index, tinygltf::Model& model, const glm::mat4& parentTransform, Prefab& prefab)
+// Instance attribute accessor of an EXT_mesh_gpu_instancing node, or -1 if the attribute isn't present
+int instancingAttribute(const tinygltf::Value& attributes, const std::string& name)
+{
+    if (!attributes.IsObject() || !attributes.Has(name))
+    {
+        return -1;
+    }
+
+    return attributes.Get(name).GetNumberAsInt();
+}
+
+// Per-instance node-local transforms of a node using EXT_mesh_gpu_instancing, empty if the node isn't instanced
+std::pmr::vector<glm::mat4> readInstanceTransforms(const tinygltf::Node& node,
+                                                   const tinygltf::Model& model,
+                                                   std::pmr::memory_resource* scratch)
+{
+    const auto extension = node.extensions.find("EXT_mesh_gpu_instancing");
+    if (extension == node.extensions.end())
+    {
+        return std::pmr::vector<glm::mat4>{scratch};
+    }
+
+    const auto& attributes = extension->second.Get("attributes");
+    const auto translationAccessor = instancingAttribute(attributes, "TRANSLATION");
+    const auto rotationAccessor = instancingAttribute(attributes, "ROTATION");
+    const auto scaleAccessor = instancingAttribute(attributes, "SCALE");
+
+    auto count = size_t{0};
+    for (const auto accessor : {translationAccessor, rotationAccessor, scaleAccessor})
+    {
+        if (accessor >= 0)
+        {
+            if (count != 0 && accessorCount(model, accessor) != count)
+            {
+                throw std::runtime_error("Mismatched EXT_mesh_gpu_instancing attribute counts in node " + node.name);
+            }
+            count = accessorCount(model, accessor);
+        }
+    }
+
+    auto translations = std::pmr::vector<glm::vec3>(count, glm::vec3{0.0f}, scratch);
+    auto rotations = std::pmr::vector<glm::vec4>(count, glm::vec4{0.0f, 0.0f, 0.0f, 1.0f}, scratch);
+    auto scales = std::pmr::vector<glm::vec3>(count, glm::vec3{1.0f}, scratch);
+
+    if (translationAccessor >= 0)
+    {
+        readAccessor(model, translationAccessor, std::span{translations});
+    }
+
+    if (rotationAccessor >= 0)
+    {
+        readAccessor(model, rotationAccessor, std::span{rotations});
+    }
+
+    if (scaleAccessor >= 0)
+    {
+        readAccessor(model, scaleAccessor, std::span{scales});
+    }
+
+    auto transforms = std::pmr::vector<glm::mat4>(count, scratch);
+    for (auto i = size_t{0}; i < count; ++i)
+    {
+        const auto rotation = glm::quat(rotations[i].w, rotations[i].x, rotations[i].y, rotations[i].z);
+        transforms[i] = glm::translate(glm::mat4{1.0f}, translations[i]) * glm::mat4_cast(rotation)
+                        * glm::scale(glm::mat4{1.0f}, scales[i]);
+    }
+
+    return transforms;
+}
+
+void parseNode(int index,
+               tinygltf::Model& model,
+               const glm::mat4& parentTransform,
+               Prefab& prefab,
+               std::pmr::memory_resource* scratch)
 {
     const auto& node = model.nodes[index];
 
@@ -158,34 +399,71 @@ void parseNode(int index, tinygltf::Model& model, const glm::mat4& parentTransfo
 
     if (node.mesh >= 0)
     {
-        if (auto mesh = prefab.getMesh(node.mesh))
+        auto meshInstance = MeshInstance{};
+        meshInstance.mesh = prefab.meshes.at(node.mesh);
+        meshInstance.transform = nodeToPrefab;
+
+        // Instanced nodes keep a single mesh instance that references a range of the prefab's transforms
+        if (const auto instanceTransforms = readInstanceTransforms(node, model, scratch); !instanceTransforms.empty())
         {
-            auto meshInstance = MeshInstance{};
-            meshInstance.mesh = mesh;
-            meshInstance.transform = nodeToPrefab;
-            prefab.addMeshInstance(std::move(meshInstance));
+            meshInstance.instanceOffset = static_cast<uint32_t>(prefab.instanceTransforms.size());
+            meshInstance.instanceCount = static_cast<uint32_t>(instanceTransforms.size());
+            prefab.instanceTransforms.insert(prefab.instanceTransforms.end(),
+                                             instanceTransforms.begin(),
+                                             instanceTransforms.end());
         }
+
+        prefab.meshInstances.push_back(meshInstance);
     }
 
     for (const auto& childIndex : node.children)
     {
-        parseNode(childIndex, model, nodeToPrefab, prefab);
+        parseNode(childIndex, model, nodeToPrefab, prefab, scratch);
     }
 }
 
-std::unique_ptr<Prefab> loadGLTFModel(const std::filesystem::path& path)
+Prefab loadGLTFModel(const std::filesystem::path& path, AssetDatabase& db, ImportScratch scratch)
+{
+    // tinygltf copies the chunks it needs out of the mapping, so it can be released as soon as loading is done
+    const auto file = core::MappedFile{path};
+    return loadGLTFModel(file.bytes(), path, db, scratch);
+}
+
+Prefab loadGLTFModel(std::span<const std::byte> bytes,
+                     const std::filesystem::path& path,
+                     AssetDatabase& db,
+                     ImportScratch scratch)
 {
     if (path.extension() != ".glb")
     {
         throw std::runtime_error("Unsupported gltf file: " + path.string());
     }
 
+    const auto startTime = std::chrono::steady_clock::now();
+
+    // Import-time working data lives here and is freed in one go when the import returns. Assets themselves are
+    // moved into the database's pools.
+    auto arena = core::Arena{};
+    auto* const resource = scratch == ImportScratch::Arena ? static_cast<std::pmr::memory_resource*>(&arena)
+                                                           : std::pmr::new_delete_resource();
+
     auto model = tinygltf::Model{};
     auto loader = tinygltf::TinyGLTF{};
     auto err = std::string{};
     auto warn = std::string{};
 
-    const auto ret = loader.LoadBinaryFromFile(&model, &err, &warn, path);
+    if (bytes.size() > std::numeric_limits<unsigned int>::max())
+    {
+        throw std::runtime_error("glTF file is too large: " + path.string());
+    }
+
+    loader.SetImageLoader(&keepEncodedImage, nullptr);
+    const auto ret = loader.LoadBinaryFromMemory(&model,
+                                                 &err,
+                                                 &warn,
+                                                 reinterpret_cast<const unsigned char*>(bytes.data()),
+                                                 static_cast<unsigned int>(bytes.size()),
+                                                 path.parent_path().string());
 
     if (!warn.empty())
     {
@@ -199,46 +477,139 @@ std::unique_ptr<Prefab> loadGLTFModel(const std::filesystem::path& path)
 
     if (!ret)
     {
-        spdlog::critical("Failed to parse glTF {}", path.string());
-        return nullptr;
+        throw std::runtime_error("Failed to parse glTF " + path.string());
+    }
+
+    for (const auto& extension : model.extensionsRequired)
+    {
+        if (!isSupportedExtension(extension))
+        {
+            throw std::runtime_error("Unsupported required glTF extension " + extension + " in " + path.string());
+        }
     }
 
-    auto prefab = std::make_unique<Prefab>();
+    decodeMeshoptBufferViews(model, resource, db.jobSystem());
+
+    // glTF indices are resolved to database handles as each asset is added, so names are never looked up
+    auto prefab = Prefab{};
+    prefab.sourcePath = path;
+
+    auto images = std::pmr::vector<std::unique_ptr<Image>>(model.images.size(), resource);
+    parallelFor(db.jobSystem(),
+                images.size(),
+                [&](size_t index)
+                {
+                    const auto encoded = std::as_bytes(std::span{model.images[index].image});
+                    images[index] = createImageFromMemory(encoded, db.imageCache());
+                });
 
-    for (auto& image : model.images)
+    for (auto& image : images)
     {
-        prefab->addImage(image.name, createImageFromData(image.width, image.height, image.image));
+        prefab.images.push_back(db.addImage(std::move(*image)));
     }
 
-    for (auto& gltfMaterial : model.materials)
+    for (const auto& gltfMaterial : model.materials)
     {
-        auto material = std::make_unique<Material>();
-        material->diffuse = readColor(gltfMaterial.pbrMetallicRoughness.baseColorFactor);
-        material->diffuseTexture = readBaseColorTexture(gltfMaterial, model, *prefab);
-        prefab->addMaterial(gltfMaterial.name, std::move(material));
+        auto material = Material{};
+        material.diffuse = readColor(gltfMaterial.pbrMetallicRoughness.baseColorFactor);
+        material.diffuseTexture = readBaseColorTexture(gltfMaterial, model, prefab);
+        prefab.materials.push_back(db.addMaterial(std::move(material)));
     }
 
-    for (auto& gltfMesh : model.meshes)
+    // Primitives are decoded in parallel, then added to the database in file order
+    struct PrimitiveJob
     {
-        auto mesh = std::make_unique<Mesh>();
-        for (auto& primitive : gltfMesh.primitives)
+        const tinygltf::Primitive* primitive;
+        size_t meshIndex;
+        SubMesh subMesh;
+    };
+
+    auto primitiveCount = size_t{0};
+    for (const auto& gltfMesh : model.meshes)
+    {
+        primitiveCount += gltfMesh.primitives.size();
+    }
+
+    auto jobs = std::pmr::vector<PrimitiveJob>{resource};
+    jobs.reserve(primitiveCount);
+
+    for (auto meshIndex = size_t{0}; meshIndex < model.meshes.size(); ++meshIndex)
+    {
+        const auto& gltfMesh = model.meshes[meshIndex];
+        for (const auto& primitive : gltfMesh.primitives)
         {
-            auto subMesh = std::make_unique<SubMesh>();
-            subMesh->vertices = readVertices(primitive, model);
-            subMesh->indices = readIndices(primitive, model);
-            subMesh->material = prefab->getMaterial(model.materials[primitive.material].name);
-            mesh->subMeshes.emplace_back(std::move(subMesh));
+            if (primitive.mode != TINYGLTF_MODE_TRIANGLES)
+            {
+                spdlog::warn("Skipping non-triangle primitive in mesh '{}' of {}", gltfMesh.name, path.string());
+                continue;
+            }
+
+            auto job = PrimitiveJob{.primitive = &primitive, .meshIndex = meshIndex, .subMesh = SubMesh{}};
+            if (primitive.material >= 0)
+            {
+                job.subMesh.material = prefab.materials.at(primitive.material);
+            }
+            jobs.push_back(std::move(job));
         }
-        prefab->addMesh(std::move(mesh));
+    }
+
+    parallelFor(db.jobSystem(),
+                jobs.size(),
+                [&](size_t jobIndex)
+                {
+                    // The shared arena isn't thread safe, so each primitive gets its own for meshlet building
+                    auto primitiveArena = core::Arena{};
+                    auto& job = jobs[jobIndex];
+                    job.subMesh.vertices = readVertices(*job.primitive, model);
+                    job.subMesh.indices = readIndices(*job.primitive, model, job.subMesh.vertices.size());
+                    buildMeshlets(job.subMesh,
+                                  scratch == ImportScratch::Arena ? &primitiveArena : std::pmr::new_delete_resource());
+                });
+
+    auto meshes = std::pmr::vector<Mesh>(model.meshes.size(), resource);
+    for (auto& job : jobs)
+    {
+        meshes[job.meshIndex].subMeshes.push_back(db.addSubMesh(std::move(job.subMesh)));
+    }
+
+    for (auto& mesh : meshes)
+    {
+        prefab.meshes.push_back(db.addMesh(std::move(mesh)));
     }
 
     auto& gltfScene = model.scenes[model.defaultScene];
 
     for (auto& nodeIndex : gltfScene.nodes)
     {
-        parseNode(nodeIndex, model, glm::mat4{1.0f}, *prefab);
+        parseNode(nodeIndex, model, glm::mat4{1.0f}, prefab, resource);
     }
 
+    spdlog::debug("Imported {} in {:.1f} ms using {} KiB of scratch memory",
+                  path.string(),
+                  std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count(),
+                  arena.peakBytesUsed() / 1024);
+
     return prefab;
 }
+
+core::Task<Prefab> loadGLTFModelAsync(std::filesystem::path path, AssetDatabase& db)
+{
+    auto* jobSystem = db.jobSystem();
+    auto* readQueue = db.fileReadQueue();
+    if (!readQueue)
+    {
+        if (jobSystem)
+        {
+            co_await jobSystem->schedule();
+        }
+        co_return loadGLTFModel(path, db);
+    }
+
+    const auto bytes = co_await readQueue->readAsync(path);
+    if (jobSystem)
+    {
+        co_await jobSystem->schedule();
+    }
+    co_return loadGLTFModel(bytes, path, db);
+}
 } // namespace assets
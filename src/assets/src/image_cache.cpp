@@ -0,0 +1,346 @@
+/// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Mark Rapson
+
+#include "assets/image_cache.h"
+
+#include <core/hash.h>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <spdlog/fmt/fmt.h>
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <random>
+#include <vector>
+
+namespace assets
+{
+constexpr auto cacheMagic = uint32_t{0x4943'4C56}; // "VLCI"
+
+// Bump whenever the entry layout changes
+constexpr auto cacheFormatVersion = uint32_t{1};
+
+constexpr auto entryExtension = ".image";
+constexpr auto temporaryExtension = ".tmp";
+
+// Pixel data starts on this boundary so mapped entries can be copied with aligned loads
+constexpr auto dataAlignment = uint64_t{16};
+
+// Temporary files this old belong to a process that died before renaming them
+constexpr auto abandonedTemporaryAge = std::chrono::hours{1};
+
+// Entries are written as this header, then one CacheLevel per entry in Image::levels, then the pixel data
+struct CacheHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint64_t key;
+    uint32_t width;
+    uint32_t height;
+    uint32_t format;
+    uint32_t mipLevels;
+    uint32_t layers;
+    uint32_t channels;
+    uint32_t flipVertically;
+    uint32_t levelCount;
+    uint64_t dataOffset;
+    uint64_t dataSize;
+};
+
+struct CacheLevel
+{
+    uint64_t offset;
+    uint64_t size;
+};
+
+uint64_t alignUp(uint64_t value, uint64_t alignment)
+{
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+// Maps a whole file copy-on-write, so callers may write to the pixels without touching the cache. Null if the file
+// can't be opened.
+std::unique_ptr<std::byte[], ImageData::Deleter> mapFile(const std::filesystem::path& path, size_t& size)
+{
+#ifndef _WIN32
+    const auto fileDescriptor = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fileDescriptor < 0)
+    {
+        return {nullptr, [](std::byte*) {}};
+    }
+
+    struct stat status{};
+    if (fstat(fileDescriptor, &status) != 0 || status.st_size <= 0)
+    {
+        close(fileDescriptor);
+        return {nullptr, [](std::byte*) {}};
+    }
+
+    size = static_cast<size_t>(status.st_size);
+    auto* mapping = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fileDescriptor, 0);
+    close(fileDescriptor);
+
+    if (mapping == MAP_FAILED)
+    {
+        return {nullptr, [](std::byte*) {}};
+    }
+
+    const auto mappedSize = size;
+    return {static_cast<std::byte*>(mapping), [mappedSize](std::byte* data) { munmap(data, mappedSize); }};
+#else
+    auto file = std::ifstream(path, std::ios::ate | std::ios::binary);
+    if (!file.is_open())
+    {
+        return {nullptr, [](std::byte*) {}};
+    }
+
+    size = static_cast<size_t>(file.tellg());
+    auto* data = new std::byte[size];
+    file.seekg(0, std::ios::beg);
+    file.read(reinterpret_cast<char*>(data), static_cast<std::streamsize>(size));
+
+    return {data, [](std::byte* bytes) { delete[] bytes; }};
+#endif
+}
+
+bool isValidEntry(const CacheHeader& header, uint64_t key, size_t fileSize)
+{
+    const auto levelsEnd = sizeof(CacheHeader) + uint64_t{header.levelCount} * sizeof(CacheLevel);
+    return header.magic == cacheMagic && header.version == cacheFormatVersion && header.key == key
+           && levelsEnd <= header.dataOffset && header.dataOffset <= fileSize
+           && header.dataSize <= fileSize - header.dataOffset && header.dataOffset % dataAlignment == 0;
+}
+
+ImageCache::ImageCache(const std::filesystem::path& directory, uint64_t maxBytes)
+    : directory_{directory}
+    , maxBytes_{maxBytes}
+{
+    // Distinguishes this instance's temporary files from those of other processes writing to the same directory
+    auto random = std::random_device{};
+    instanceId_ = (uint64_t{random()} << 32) | random();
+
+    auto error = std::error_code{};
+    std::filesystem::create_directories(directory_, error);
+    if (error)
+    {
+        spdlog::warn("Failed to create image cache {}: {}", directory_.string(), error.message());
+    }
+
+    trim();
+}
+
+uint64_t ImageCache::key(std::span<const std::byte> encoded, uint64_t decoderSeed)
+{
+    return core::xxHash64(encoded, core::xxHash64(std::span{&cacheFormatVersion, 1}, decoderSeed));
+}
+
+std::unique_ptr<Image> ImageCache::load(uint64_t key)
+{
+    const auto path = entryPath(key);
+
+    auto fileSize = size_t{0};
+    auto mapping = mapFile(path, fileSize);
+    if (!mapping)
+    {
+        return nullptr;
+    }
+
+    auto header = CacheHeader{};
+    if (fileSize >= sizeof(CacheHeader))
+    {
+        std::memcpy(&header, mapping.get(), sizeof(CacheHeader));
+    }
+
+    // Entries are only ever renamed into place complete, so an invalid one was written by an incompatible build
+    const auto discard = [&path]()
+    {
+        spdlog::warn("Discarding invalid image cache entry {}", path.string());
+        auto error = std::error_code{};
+        std::filesystem::remove(path, error);
+        return nullptr;
+    };
+
+    if (fileSize < sizeof(CacheHeader) || !isValidEntry(header, key, fileSize))
+    {
+        return discard();
+    }
+
+    auto image = std::make_unique<Image>();
+    image->width = header.width;
+    image->height = header.height;
+    image->format = static_cast<ImageFormat>(header.format);
+    image->mipLevels = header.mipLevels;
+    image->layers = header.layers;
+    image->channels = header.channels;
+    image->flipVertically = header.flipVertically != 0;
+
+    image->levels.resize(header.levelCount);
+    for (auto i = size_t{0}; i < image->levels.size(); ++i)
+    {
+        auto level = CacheLevel{};
+        std::memcpy(&level, mapping.get() + sizeof(CacheHeader) + i * sizeof(CacheLevel), sizeof(CacheLevel));
+        if (level.offset + level.size > header.dataSize)
+        {
+            return discard();
+        }
+        image->levels[i] = ImageLevel{.offset = level.offset, .size = level.size};
+    }
+
+    // The pixels point into the mapping, which is released along with them
+    auto* pixels = mapping.get() + header.dataOffset;
+    auto deleter = mapping.get_deleter();
+    auto* base = mapping.release();
+    image->data = ImageData{pixels,
+                            header.dataSize,
+                            [base, deleter = std::move(deleter)](std::byte*) mutable { deleter(base); }};
+
+    // Eviction is least recently used first, and the modification time is the only timestamp every platform keeps
+    auto error = std::error_code{};
+    std::filesystem::last_write_time(path, std::filesystem::file_time_type::clock::now(), error);
+
+    return image;
+}
+
+void ImageCache::store(uint64_t key, const Image& image)
+{
+    auto header = CacheHeader{};
+    header.magic = cacheMagic;
+    header.version = cacheFormatVersion;
+    header.key = key;
+    header.width = image.width;
+    header.height = image.height;
+    header.format = static_cast<uint32_t>(image.format);
+    header.mipLevels = image.mipLevels;
+    header.layers = image.layers;
+    header.channels = image.channels;
+    header.flipVertically = image.flipVertically ? 1 : 0;
+    header.levelCount = static_cast<uint32_t>(image.levels.size());
+    header.dataOffset = alignUp(sizeof(CacheHeader) + image.levels.size() * sizeof(CacheLevel), dataAlignment);
+    header.dataSize = image.data.size();
+
+    auto levels = std::vector<CacheLevel>{};
+    levels.reserve(image.levels.size());
+    for (const auto& level : image.levels)
+    {
+        levels.push_back(CacheLevel{.offset = level.offset, .size = level.size});
+    }
+
+    const auto temporary = directory_ / fmt::format("{:016x}.{:016x}.{}{}",
+                                                    key,
+                                                    instanceId_,
+                                                    nextTemporary_.fetch_add(1),
+                                                    temporaryExtension);
+    {
+        auto file = std::ofstream(temporary, std::ios::binary | std::ios::trunc);
+        const auto levelsEnd = sizeof(CacheHeader) + levels.size() * sizeof(CacheLevel);
+        const auto padding = std::vector<char>(header.dataOffset - levelsEnd);
+
+        file.write(reinterpret_cast<const char*>(&header), sizeof(CacheHeader));
+        file.write(reinterpret_cast<const char*>(levels.data()),
+                   static_cast<std::streamsize>(levels.size() * sizeof(CacheLevel)));
+        file.write(padding.data(), static_cast<std::streamsize>(padding.size()));
+        file.write(reinterpret_cast<const char*>(image.data.data()), static_cast<std::streamsize>(image.data.size()));
+
+        if (!file.good())
+        {
+            spdlog::warn("Failed to write image cache entry {}", temporary.string());
+            file.close();
+            auto error = std::error_code{};
+            std::filesystem::remove(temporary, error);
+            return;
+        }
+    }
+
+    // Renaming over an entry another process wrote for the same key is fine; both hold the same image
+    auto error = std::error_code{};
+    std::filesystem::rename(temporary, entryPath(key), error);
+    if (error)
+    {
+        spdlog::warn("Failed to add image cache entry {}: {}", entryPath(key).string(), error.message());
+        std::filesystem::remove(temporary, error);
+        return;
+    }
+
+    if (approximateSize_.fetch_add(header.dataOffset + header.dataSize) + header.dataOffset + header.dataSize
+        > maxBytes_)
+    {
+        trim();
+    }
+}
+
+void ImageCache::trim()
+{
+    auto lock = std::lock_guard{trimMutex_};
+
+    struct Entry
+    {
+        std::filesystem::path path;
+        uint64_t size;
+        std::filesystem::file_time_type lastUsed;
+    };
+
+    auto entries = std::vector<Entry>{};
+    auto totalSize = uint64_t{0};
+    const auto now = std::filesystem::file_time_type::clock::now();
+
+    auto error = std::error_code{};
+    for (const auto& file : std::filesystem::directory_iterator{directory_, error})
+    {
+        // Other processes may delete files while this one iterates, so every query tolerates a missing file
+        auto fileError = std::error_code{};
+        const auto lastUsed = file.last_write_time(fileError);
+        const auto size = file.file_size(fileError);
+        if (fileError)
+        {
+            continue;
+        }
+
+        const auto extension = file.path().extension();
+        if (extension == temporaryExtension && now - lastUsed > abandonedTemporaryAge)
+        {
+            std::filesystem::remove(file.path(), fileError);
+        }
+        else if (extension == entryExtension)
+        {
+            entries.push_back(Entry{.path = file.path(), .size = size, .lastUsed = lastUsed});
+            totalSize += size;
+        }
+    }
+
+    // Trimming below the cap leaves room for new entries before the directory has to be scanned again
+    const auto targetSize = maxBytes_ / 4 * 3;
+    if (totalSize > maxBytes_)
+    {
+        std::ranges::sort(entries, {}, &Entry::lastUsed);
+        for (const auto& entry : entries)
+        {
+            if (totalSize <= targetSize)
+            {
+                break;
+            }
+
+            // Processes that have the entry mapped keep their pages after it is deleted
+            std::filesystem::remove(entry.path, error);
+            totalSize -= entry.size;
+        }
+
+        spdlog::debug("Trimmed image cache {} to {} bytes", directory_.string(), totalSize);
+    }
+
+    approximateSize_ = totalSize;
+}
+
+std::filesystem::path ImageCache::entryPath(uint64_t key) const
+{
+    return directory_ / fmt::format("{:016x}{}", key, entryExtension);
+}
+} // namespace assets
@@ -0,0 +1,48 @@
+/// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Mark Rapson
+
+#include "assets/image_data.h"
+
+namespace assets
+{
+ImageData::ImageData(size_t size)
+    : data_{new std::byte[size], [](std::byte* data) { delete[] data; }},
+      size_{size}
+{
+}
+
+ImageData::ImageData(std::byte* data, size_t size, Deleter deleter)
+    : data_{data, std::move(deleter)},
+      size_{size}
+{
+}
+
+ImageData::ImageData(std::vector<unsigned char>&& data)
+{
+    // The vector is moved to the heap so its allocation can be adopted as-is
+    auto* owner = new std::vector<unsigned char>(std::move(data));
+    data_ = std::unique_ptr<std::byte[], Deleter>{reinterpret_cast<std::byte*>(owner->data()),
+                                                  [owner](std::byte*) { delete owner; }};
+    size_ = owner->size();
+}
+
+std::byte* ImageData::data()
+{
+    return data_.get();
+}
+
+const std::byte* ImageData::data() const
+{
+    return data_.get();
+}
+
+size_t ImageData::size() const
+{
+    return size_;
+}
+
+bool ImageData::empty() const
+{
+    return size_ == 0;
+}
+} // namespace assets
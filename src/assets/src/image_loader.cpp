@@ -3,6 +3,13 @@
 
 #include "assets/image_loader.h"
 
+#include "assets/image_cache.h"
+#include "assets/ktx2_loader.h"
+
+#include <core/file_read_queue.h>
+#include <core/hash.h>
+#include <core/mapped_file.h>
+
 #ifdef __GNUC__
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wconversion"
@@ -15,40 +22,168 @@
 
 #include <spdlog/spdlog.h>
 
+#include <array>
 #include <cstring>
+#include <future>
+#include <limits>
 
 namespace assets
 {
-std::unique_ptr<Image> createImageFromPath(const std::filesystem::path& path)
+// Bump whenever decoding the same file would produce a different image, so stale cache entries are never used
+constexpr auto imageDecoderVersion = uint32_t{1};
+
+// Decodes with stb_image. RGB images are kept as RGB when keepRgb is set and expanded during upload; everything else
+// is decoded to RGBA.
+std::unique_ptr<Image> decodeImage(std::span<const std::byte> encoded,
+                                   bool keepRgb,
+                                   bool flipVertically,
+                                   ImageCache* cache)
 {
+    if (encoded.size() > static_cast<size_t>(std::numeric_limits<int>::max()))
+    {
+        throw std::runtime_error("Encoded image is too large");
+    }
+
+    const auto* bytes = reinterpret_cast<const stbi_uc*>(encoded.data());
+    const auto length = static_cast<int>(encoded.size());
+
+    const auto decoderSettings = std::array{imageDecoderVersion, uint32_t{keepRgb}, uint32_t{flipVertically}};
+    const auto key = ImageCache::key(encoded, core::xxHash64(decoderSettings));
+    if (cache)
+    {
+        if (auto image = cache->load(key))
+        {
+            return image;
+        }
+    }
+
     int width;
     int height;
     int channels;
 
-    spdlog::info("Loading image {}", path.string());
+    if (!stbi_info_from_memory(bytes, length, &width, &height, &channels))
+    {
+        throw std::runtime_error(std::string{"Failed to decode image: "} + stbi_failure_reason());
+    }
+    const auto desiredChannels = keepRgb && channels == STBI_rgb ? STBI_rgb : STBI_rgb_alpha;
 
-    stbi_set_flip_vertically_on_load(true);
-    auto stbiData = stbi_load(path.c_str(), &width, &height, &channels, STBI_rgb_alpha);
+    auto stbiData = stbi_load_from_memory(bytes, length, &width, &height, &channels, desiredChannels);
     if (!stbiData)
     {
-        throw std::runtime_error("Failed to load image: " + path.string());
+        throw std::runtime_error(std::string{"Failed to decode image: "} + stbi_failure_reason());
     }
 
-    const auto imageSize = static_cast<size_t>(width) * height * STBI_rgb_alpha;
+    const auto imageSize = static_cast<size_t>(width) * height * desiredChannels;
 
-    auto data = std::vector<std::byte>(imageSize);
-    std::memcpy(data.data(), stbiData, imageSize);
+    auto image = std::make_unique<Image>();
+    image->width = static_cast<uint32_t>(width);
+    image->height = static_cast<uint32_t>(height);
+    image->data = ImageData{reinterpret_cast<std::byte*>(stbiData),
+                            imageSize,
+                            [](std::byte* data) { stbi_image_free(data); }};
+    image->channels = static_cast<uint32_t>(desiredChannels);
+    image->flipVertically = flipVertically;
 
-    stbi_image_free(stbiData);
+    if (cache)
+    {
+        cache->store(key, *image);
+    }
 
-    return std::make_unique<Image>(static_cast<uint32_t>(width), static_cast<uint32_t>(height), std::move(data));
+    return image;
 }
 
-std::unique_ptr<Image> createImageFromData(int width, int height, const std::vector<unsigned char>& data)
+std::unique_ptr<Image> createImageFromPath(const std::filesystem::path& path, ImageCache* cache)
 {
-    auto byteData = std::vector<std::byte>(data.size());
-    std::memcpy(byteData.data(), data.data(), data.size());
+    if (path.extension() == ".ktx2")
+    {
+        return loadKtx2Image(path);
+    }
+
+    spdlog::info("Loading image {}", path.string());
+
+    try
+    {
+        // Reading the file is cheap next to decoding it, and its bytes are what the cache is keyed on
+        const auto file = core::MappedFile{path};
+        return decodeImage(file.bytes(), true, true, cache);
+    }
+    catch (const std::exception& ex)
+    {
+        throw std::runtime_error("Failed to load image " + path.string() + ": " + ex.what());
+    }
+}
+
+std::vector<std::unique_ptr<Image>> createImagesFromPaths(std::span<const std::filesystem::path> paths,
+                                                          core::FileReadQueue& readQueue,
+                                                          ImageCache* cache)
+{
+    auto reads = std::vector<std::future<std::vector<std::byte>>>(paths.size());
+    for (auto i = size_t{0}; i < paths.size(); ++i)
+    {
+        if (paths[i].extension() != ".ktx2")
+        {
+            reads[i] = readQueue.read(paths[i]);
+        }
+    }
+
+    auto images = std::vector<std::unique_ptr<Image>>(paths.size());
+    for (auto i = size_t{0}; i < paths.size(); ++i)
+    {
+        if (!reads[i].valid())
+        {
+            images[i] = loadKtx2Image(paths[i]);
+            continue;
+        }
+
+        spdlog::info("Loading image {}", paths[i].string());
+
+        try
+        {
+            const auto encoded = reads[i].get();
+            images[i] = decodeImage(encoded, true, true, cache);
+        }
+        catch (const std::exception& ex)
+        {
+            throw std::runtime_error("Failed to load image " + paths[i].string() + ": " + ex.what());
+        }
+    }
+
+    return images;
+}
+
+std::unique_ptr<Image> createImageFromMemory(std::span<const std::byte> encoded, ImageCache* cache)
+{
+    return decodeImage(encoded, false, false, cache);
+}
+
+std::unique_ptr<Image> createCubemapFromFaces(std::array<std::unique_ptr<Image>, 6> faces)
+{
+    const auto& first = *faces[0];
+    for (const auto& face : faces)
+    {
+        if (!face || face->width != first.width || face->height != first.height || face->format != first.format
+            || face->channels != first.channels || face->flipVertically != first.flipVertically
+            || face->mipLevels != 1 || face->layers != 1)
+        {
+            throw std::runtime_error("Cubemap faces must be single level images of equal size and format");
+        }
+    }
+
+    auto cubemap = std::make_unique<Image>();
+    cubemap->width = first.width;
+    cubemap->height = first.height;
+    cubemap->format = first.format;
+    cubemap->layers = 6;
+    cubemap->channels = first.channels;
+    cubemap->flipVertically = first.flipVertically;
+
+    const auto faceSize = first.data.size();
+    cubemap->data = ImageData{faceSize * faces.size()};
+    for (auto face = size_t{0}; face < faces.size(); ++face)
+    {
+        std::memcpy(cubemap->data.data() + face * faceSize, faces[face]->data.data(), faceSize);
+    }
 
-    return std::make_unique<Image>(static_cast<uint32_t>(width), static_cast<uint32_t>(height), std::move(byteData));
+    return cubemap;
 }
 } // namespace assets
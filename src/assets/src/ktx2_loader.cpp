@@ -0,0 +1,300 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Mark Rapson
+
+#include "assets/ktx2_loader.h"
+
+#include <core/mapped_file.h>
+
+#include <spdlog/spdlog.h>
+
+#ifdef VULKAN_DEMO_KTX_TRANSCODING
+#include <ktx.h>
+#endif
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <span>
+#include <stdexcept>
+
+namespace assets
+{
+// Set once from the device's features before textures are loaded
+TranscodeTargets transcodeTargets;
+
+constexpr auto ktx2Identifier = std::array<uint8_t, 12>{0xab, 'K', 'T', 'X', ' ', '2', '0', 0xbb, '\r', '\n', 0x1a, '\n'};
+
+struct Ktx2Header
+{
+    uint32_t vkFormat;
+    uint32_t typeSize;
+    uint32_t pixelWidth;
+    uint32_t pixelHeight;
+    uint32_t pixelDepth;
+    uint32_t layerCount;
+    uint32_t faceCount;
+    uint32_t levelCount;
+    uint32_t supercompressionScheme;
+    uint32_t dfdByteOffset;
+    uint32_t dfdByteLength;
+    uint32_t kvdByteOffset;
+    uint32_t kvdByteLength;
+};
+
+// The header is followed by the supercompression global data offset and length (unused), then the level index
+constexpr auto ktx2LevelIndexOffset = size_t{80};
+
+struct Ktx2Level
+{
+    uint64_t byteOffset;
+    uint64_t byteLength;
+    uint64_t uncompressedByteLength;
+};
+
+// Texel block dimensions and size in bytes
+struct ImageFormatBlock
+{
+    uint32_t width;
+    uint32_t height;
+    uint32_t size;
+};
+
+ImageFormatBlock formatBlock(ImageFormat format)
+{
+    switch (format)
+    {
+        case ImageFormat::R8G8B8A8Unorm:
+        case ImageFormat::R8G8B8A8Srgb:
+            return {1, 1, 4};
+        case ImageFormat::R16G16B16A16Sfloat:
+            return {1, 1, 8};
+        case ImageFormat::R32G32B32A32Sfloat:
+            return {1, 1, 16};
+        case ImageFormat::Bc1RgbaUnorm:
+        case ImageFormat::Bc1RgbaSrgb:
+        case ImageFormat::Bc4Unorm:
+            return {4, 4, 8};
+        case ImageFormat::Bc3Unorm:
+        case ImageFormat::Bc3Srgb:
+        case ImageFormat::Bc5Unorm:
+        case ImageFormat::Bc6hUfloat:
+        case ImageFormat::Bc7Unorm:
+        case ImageFormat::Bc7Srgb:
+        case ImageFormat::Etc2R8G8B8A8Unorm:
+        case ImageFormat::Etc2R8G8B8A8Srgb:
+        case ImageFormat::Astc4x4Unorm:
+        case ImageFormat::Astc4x4Srgb:
+            return {4, 4, 16};
+    }
+
+    throw std::runtime_error("Unknown image format");
+}
+
+bool isSupportedFormat(uint32_t vkFormat)
+{
+    switch (static_cast<ImageFormat>(vkFormat))
+    {
+        case ImageFormat::R8G8B8A8Unorm:
+        case ImageFormat::R8G8B8A8Srgb:
+        case ImageFormat::R16G16B16A16Sfloat:
+        case ImageFormat::R32G32B32A32Sfloat:
+        case ImageFormat::Bc1RgbaUnorm:
+        case ImageFormat::Bc1RgbaSrgb:
+        case ImageFormat::Bc3Unorm:
+        case ImageFormat::Bc3Srgb:
+        case ImageFormat::Bc4Unorm:
+        case ImageFormat::Bc5Unorm:
+        case ImageFormat::Bc6hUfloat:
+        case ImageFormat::Bc7Unorm:
+        case ImageFormat::Bc7Srgb:
+        case ImageFormat::Etc2R8G8B8A8Unorm:
+        case ImageFormat::Etc2R8G8B8A8Srgb:
+        case ImageFormat::Astc4x4Unorm:
+        case ImageFormat::Astc4x4Srgb:
+            return true;
+    }
+
+    return false;
+}
+
+// Size of one layer (or face) of a mip level
+size_t levelLayerSize(ImageFormat format, uint32_t width, uint32_t height)
+{
+    const auto block = formatBlock(format);
+    const auto blocksX = static_cast<size_t>((width + block.width - 1) / block.width);
+    const auto blocksY = static_cast<size_t>((height + block.height - 1) / block.height);
+    return blocksX * blocksY * block.size;
+}
+
+template <typename T>
+T readValue(std::span<const std::byte> file, size_t offset)
+{
+    if (offset + sizeof(T) > file.size())
+    {
+        throw std::runtime_error("Truncated KTX2 file");
+    }
+
+    auto value = T{};
+    std::memcpy(&value, file.data() + offset, sizeof(T));
+    return value;
+}
+
+#ifdef VULKAN_DEMO_KTX_TRANSCODING
+// Decodes the payload with libktx: supercompression is inflated and Basis Universal (ETC1S/UASTC) is transcoded to
+// the best block format the device can sample, or to RGBA if it can sample none of them
+std::unique_ptr<Image> transcodeKtx2Image(const std::filesystem::path& path, std::span<const std::byte> file)
+{
+    auto* texture = static_cast<ktxTexture2*>(nullptr);
+    auto result = ktxTexture2_CreateFromMemory(reinterpret_cast<const ktx_uint8_t*>(file.data()),
+                                               file.size(),
+                                               KTX_TEXTURE_CREATE_LOAD_IMAGE_DATA_BIT,
+                                               &texture);
+    if (result != KTX_SUCCESS)
+    {
+        throw std::runtime_error("Failed to decode KTX2 file " + path.string() + ": " + ktxErrorString(result));
+    }
+
+    const auto destroyTexture = std::unique_ptr<ktxTexture2, void (*)(ktxTexture2*)>{texture, ktxTexture2_Destroy};
+
+    if (ktxTexture2_NeedsTranscoding(texture))
+    {
+        auto target = KTX_TTF_RGBA32;
+        if (transcodeTargets.bc7)
+        {
+            target = KTX_TTF_BC7_RGBA;
+        }
+        else if (transcodeTargets.astc4x4)
+        {
+            target = KTX_TTF_ASTC_4x4_RGBA;
+        }
+        else if (transcodeTargets.etc2)
+        {
+            target = KTX_TTF_ETC2_RGBA;
+        }
+
+        result = ktxTexture2_TranscodeBasis(texture, target, 0);
+        if (result != KTX_SUCCESS)
+        {
+            throw std::runtime_error("Failed to transcode KTX2 file " + path.string() + ": " + ktxErrorString(result));
+        }
+    }
+
+    if (!isSupportedFormat(texture->vkFormat))
+    {
+        throw std::runtime_error("Unsupported KTX2 format " + std::to_string(texture->vkFormat) + ": " + path.string());
+    }
+
+    auto image = std::make_unique<Image>();
+    image->width = texture->baseWidth;
+    image->height = texture->baseHeight;
+    image->format = static_cast<ImageFormat>(texture->vkFormat);
+    image->mipLevels = std::max(texture->numLevels, 1u);
+    image->layers = texture->numFaces;
+
+    // Each level's faces are contiguous in libktx's data too, so levels are copied whole
+    auto dataSize = size_t{0};
+    for (auto level = uint32_t{0}; level < image->mipLevels; ++level)
+    {
+        const auto levelSize = ktxTexture_GetImageSize(ktxTexture(texture), level) * image->layers;
+        image->levels.push_back(ImageLevel{.offset = dataSize, .size = levelSize});
+        dataSize = (dataSize + levelSize + 15) & ~size_t{15};
+    }
+
+    image->data = ImageData{dataSize};
+    for (auto level = uint32_t{0}; level < image->mipLevels; ++level)
+    {
+        auto offset = ktx_size_t{0};
+        ktxTexture_GetImageOffset(ktxTexture(texture), level, 0, 0, &offset);
+        std::memcpy(image->data.data() + image->levels[level].offset,
+                    ktxTexture_GetData(ktxTexture(texture)) + offset,
+                    image->levels[level].size);
+    }
+
+    return image;
+}
+#endif
+
+void setTranscodeTargets(const TranscodeTargets& targets)
+{
+    transcodeTargets = targets;
+}
+
+std::unique_ptr<Image> loadKtx2Image(const std::filesystem::path& path)
+{
+    spdlog::info("Loading KTX2 image {}", path.string());
+
+    const auto mappedFile = core::MappedFile{path};
+    const auto file = mappedFile.bytes();
+
+    if (file.size() < ktx2Identifier.size()
+        || std::memcmp(file.data(), ktx2Identifier.data(), ktx2Identifier.size()) != 0)
+    {
+        throw std::runtime_error("Not a KTX2 file: " + path.string());
+    }
+
+    const auto header = readValue<Ktx2Header>(file, ktx2Identifier.size());
+
+    if (header.pixelDepth > 1 || header.pixelHeight == 0 || (header.faceCount != 1 && header.faceCount != 6))
+    {
+        throw std::runtime_error("Only 2D and cubemap KTX2 textures are supported: " + path.string());
+    }
+
+    // The renderer only creates single layer and cubemap images
+    if (header.layerCount > 1)
+    {
+        throw std::runtime_error("KTX2 array textures are not supported: " + path.string());
+    }
+
+    // VK_FORMAT_UNDEFINED marks Basis Universal (ETC1S/UASTC) payloads
+    if (header.vkFormat == 0 || header.supercompressionScheme != 0)
+    {
+#ifdef VULKAN_DEMO_KTX_TRANSCODING
+        return transcodeKtx2Image(path, file);
+#else
+        throw std::runtime_error("Basis Universal and supercompressed KTX2 files need a build with libktx: "
+                                 + path.string());
+#endif
+    }
+
+    if (!isSupportedFormat(header.vkFormat))
+    {
+        throw std::runtime_error("Unsupported KTX2 format " + std::to_string(header.vkFormat) + ": " + path.string());
+    }
+
+    auto image = std::make_unique<Image>();
+    image->width = header.pixelWidth;
+    image->height = header.pixelHeight;
+    image->format = static_cast<ImageFormat>(header.vkFormat);
+    image->mipLevels = std::max(header.levelCount, 1u);
+    image->layers = header.faceCount;
+
+    // Levels are repacked largest first, each aligned for buffer to image copies
+    auto levels = std::vector<Ktx2Level>(image->mipLevels);
+    auto dataSize = size_t{0};
+    for (auto level = uint32_t{0}; level < image->mipLevels; ++level)
+    {
+        levels[level] = readValue<Ktx2Level>(file, ktx2LevelIndexOffset + level * sizeof(Ktx2Level));
+
+        const auto levelWidth = std::max(image->width >> level, 1u);
+        const auto levelHeight = std::max(image->height >> level, 1u);
+        const auto expectedSize = levelLayerSize(image->format, levelWidth, levelHeight) * image->layers;
+        if (levels[level].byteLength != expectedSize || levels[level].byteOffset + expectedSize > file.size())
+        {
+            throw std::runtime_error("Malformed KTX2 level index: " + path.string());
+        }
+
+        image->levels.push_back(ImageLevel{.offset = dataSize, .size = expectedSize});
+        dataSize = (dataSize + expectedSize + 15) & ~size_t{15};
+    }
+
+    image->data = ImageData{dataSize};
+    for (auto level = uint32_t{0}; level < image->mipLevels; ++level)
+    {
+        std::memcpy(image->data.data() + image->levels[level].offset,
+                    file.data() + levels[level].byteOffset,
+                    image->levels[level].size);
+    }
+
+    return image;
+}
+} // namespace assets
@@ -0,0 +1,301 @@
+/// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Mark Rapson
+
+#include "assets/meshlet_builder.h"
+
+#include "assets/mesh.h"
+#include "assets/meshlet.h"
+
+#include <glm/glm.hpp>
+
+#include <cmath>
+#include <limits>
+#include <memory_resource>
+#include <stdexcept>
+#include <vector>
+
+namespace assets
+{
+constexpr auto noTriangle = std::numeric_limits<uint32_t>::max();
+
+// Triangles adjacent to each vertex, stored as a flattened list with per-vertex offsets
+struct TriangleAdjacency
+{
+    std::pmr::vector<uint32_t> offsets;
+    std::pmr::vector<uint32_t> triangles;
+};
+
+TriangleAdjacency buildTriangleAdjacency(const std::vector<uint32_t>& indices,
+                                         size_t vertexCount,
+                                         std::pmr::memory_resource* scratch)
+{
+    auto adjacency = TriangleAdjacency{.offsets = std::pmr::vector<uint32_t>{scratch},
+                                       .triangles = std::pmr::vector<uint32_t>{scratch}};
+    adjacency.offsets.resize(vertexCount + 1, 0);
+    adjacency.triangles.resize(indices.size());
+
+    for (const auto index : indices)
+    {
+        ++adjacency.offsets[index + 1];
+    }
+
+    for (auto i = size_t{1}; i < adjacency.offsets.size(); ++i)
+    {
+        adjacency.offsets[i] += adjacency.offsets[i - 1];
+    }
+
+    auto cursor = std::pmr::vector<uint32_t>(adjacency.offsets.begin(), adjacency.offsets.end() - 1, scratch);
+    for (auto i = size_t{0}; i < indices.size(); ++i)
+    {
+        adjacency.triangles[cursor[indices[i]]++] = static_cast<uint32_t>(i / 3);
+    }
+
+    return adjacency;
+}
+
+// normals is working storage reused across meshlets
+void computeMeshletBounds(const SubMesh& subMesh,
+                          const std::pmr::vector<uint32_t>& meshletVertices,
+                          const std::pmr::vector<uint32_t>& meshletTriangles,
+                          std::pmr::vector<glm::vec3>& normals,
+                          Meshlet& meshlet)
+{
+    auto minBounds = glm::vec3{std::numeric_limits<float>::max()};
+    auto maxBounds = glm::vec3{std::numeric_limits<float>::lowest()};
+    for (const auto vertex : meshletVertices)
+    {
+        minBounds = glm::min(minBounds, subMesh.vertices[vertex].position);
+        maxBounds = glm::max(maxBounds, subMesh.vertices[vertex].position);
+    }
+
+    meshlet.center = (minBounds + maxBounds) * 0.5f;
+    meshlet.radius = 0.0f;
+    for (const auto vertex : meshletVertices)
+    {
+        meshlet.radius = std::max(meshlet.radius, glm::length(subMesh.vertices[vertex].position - meshlet.center));
+    }
+
+    normals.clear();
+
+    auto normalSum = glm::vec3{0.0f};
+    for (const auto triangle : meshletTriangles)
+    {
+        const auto& a = subMesh.vertices[subMesh.indices[triangle * 3 + 0]].position;
+        const auto& b = subMesh.vertices[subMesh.indices[triangle * 3 + 1]].position;
+        const auto& c = subMesh.vertices[subMesh.indices[triangle * 3 + 2]].position;
+
+        const auto normal = glm::cross(b - a, c - a);
+        const auto area = glm::length(normal);
+        if (area <= std::numeric_limits<float>::epsilon())
+        {
+            continue;
+        }
+
+        normals.push_back(normal / area);
+        normalSum += normals.back();
+    }
+
+    // Degenerate or wide cones can never be rejected, so give them a cutoff the test can't reach
+    meshlet.coneAxis = glm::vec3{0.0f, 0.0f, 1.0f};
+    meshlet.coneCutoff = 1.0f;
+
+    const auto normalSumLength = glm::length(normalSum);
+    if (normals.empty() || normalSumLength <= std::numeric_limits<float>::epsilon())
+    {
+        return;
+    }
+
+    const auto axis = normalSum / normalSumLength;
+
+    auto minDot = 1.0f;
+    for (const auto& normal : normals)
+    {
+        minDot = std::min(minDot, glm::dot(normal, axis));
+    }
+
+    meshlet.coneAxis = axis;
+    if (minDot > 0.1f)
+    {
+        meshlet.coneCutoff = std::sqrt(1.0f - minDot * minDot);
+    }
+}
+
+void buildMeshlets(SubMesh& subMesh, std::pmr::memory_resource* scratch)
+{
+    subMesh.meshlets.clear();
+
+    const auto vertexCount = subMesh.vertices.size();
+    const auto triangleCount = subMesh.indices.size() / 3;
+
+    if (triangleCount == 0)
+    {
+        return;
+    }
+
+    for (const auto index : subMesh.indices)
+    {
+        if (index >= vertexCount)
+        {
+            throw std::runtime_error("Sub-mesh index out of range");
+        }
+    }
+
+    const auto adjacency = buildTriangleAdjacency(subMesh.indices, vertexCount, scratch);
+
+    auto emitted = std::pmr::vector<bool>(triangleCount, false, scratch);
+    auto inMeshlet = std::pmr::vector<bool>(vertexCount, false, scratch);
+
+    auto reorderedIndices = std::vector<uint32_t>{};
+    reorderedIndices.reserve(triangleCount * 3);
+
+    auto meshletVertices = std::pmr::vector<uint32_t>{scratch};
+    meshletVertices.reserve(maxMeshletVertices);
+
+    auto meshletTriangles = std::pmr::vector<uint32_t>{scratch};
+    meshletTriangles.reserve(maxMeshletTriangles);
+
+    auto normals = std::pmr::vector<glm::vec3>{scratch};
+    normals.reserve(maxMeshletTriangles);
+
+    auto candidates = std::pmr::vector<uint32_t>{scratch};
+    auto nextSeed = size_t{0};
+    auto pendingSeed = noTriangle;
+
+    const auto newVertexCount = [&](uint32_t triangle)
+    {
+        auto count = uint32_t{0};
+        for (auto corner = 0; corner < 3; ++corner)
+        {
+            count += inMeshlet[subMesh.indices[triangle * 3 + corner]] ? 0 : 1;
+        }
+        return count;
+    };
+
+    const auto flushMeshlet = [&]()
+    {
+        if (meshletTriangles.empty())
+        {
+            return;
+        }
+
+        auto meshlet = Meshlet{};
+        meshlet.indexOffset = static_cast<uint32_t>(reorderedIndices.size());
+        meshlet.indexCount = static_cast<uint32_t>(meshletTriangles.size() * 3);
+        meshlet.vertexCount = static_cast<uint32_t>(meshletVertices.size());
+        computeMeshletBounds(subMesh, meshletVertices, meshletTriangles, normals, meshlet);
+
+        for (const auto triangle : meshletTriangles)
+        {
+            reorderedIndices.push_back(subMesh.indices[triangle * 3 + 0]);
+            reorderedIndices.push_back(subMesh.indices[triangle * 3 + 1]);
+            reorderedIndices.push_back(subMesh.indices[triangle * 3 + 2]);
+        }
+
+        subMesh.meshlets.push_back(meshlet);
+
+        for (const auto vertex : meshletVertices)
+        {
+            inMeshlet[vertex] = false;
+        }
+
+        // Start the next meshlet next to this one to keep clusters spatially coherent
+        pendingSeed = noTriangle;
+        for (const auto candidate : candidates)
+        {
+            if (!emitted[candidate])
+            {
+                pendingSeed = candidate;
+                break;
+            }
+        }
+
+        meshletVertices.clear();
+        meshletTriangles.clear();
+        candidates.clear();
+    };
+
+    while (true)
+    {
+        // Prefer the adjacent triangle that shares the most vertices with the current meshlet
+        auto bestTriangle = noTriangle;
+        auto bestNewVertices = uint32_t{4};
+        auto liveCandidates = size_t{0};
+        for (const auto candidate : candidates)
+        {
+            if (emitted[candidate])
+            {
+                continue;
+            }
+
+            candidates[liveCandidates++] = candidate;
+
+            const auto newVertices = newVertexCount(candidate);
+            if (meshletVertices.size() + newVertices <= maxMeshletVertices && newVertices < bestNewVertices)
+            {
+                bestTriangle = candidate;
+                bestNewVertices = newVertices;
+            }
+        }
+        candidates.resize(liveCandidates);
+
+        if (bestTriangle == noTriangle)
+        {
+            if (!meshletTriangles.empty())
+            {
+                flushMeshlet();
+                continue;
+            }
+
+            if (pendingSeed != noTriangle)
+            {
+                bestTriangle = pendingSeed;
+                pendingSeed = noTriangle;
+            }
+            else
+            {
+                while (nextSeed < triangleCount && emitted[nextSeed])
+                {
+                    ++nextSeed;
+                }
+
+                if (nextSeed == triangleCount)
+                {
+                    break;
+                }
+
+                bestTriangle = static_cast<uint32_t>(nextSeed);
+            }
+        }
+
+        emitted[bestTriangle] = true;
+        meshletTriangles.push_back(bestTriangle);
+
+        for (auto corner = 0; corner < 3; ++corner)
+        {
+            const auto vertex = subMesh.indices[bestTriangle * 3 + corner];
+            if (!inMeshlet[vertex])
+            {
+                inMeshlet[vertex] = true;
+                meshletVertices.push_back(vertex);
+            }
+
+            for (auto i = adjacency.offsets[vertex]; i < adjacency.offsets[vertex + 1]; ++i)
+            {
+                if (!emitted[adjacency.triangles[i]])
+                {
+                    candidates.push_back(adjacency.triangles[i]);
+                }
+            }
+        }
+
+        if (meshletTriangles.size() == maxMeshletTriangles)
+        {
+            flushMeshlet();
+        }
+    }
+
+    flushMeshlet();
+
+    subMesh.indices = std::move(reorderedIndices);
+}
+} // namespace assets
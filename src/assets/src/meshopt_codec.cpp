@@ -0,0 +1,570 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Mark Rapson
+
+#include "meshopt_codec.h"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+namespace assets
+{
+constexpr auto vertexHeader = uint8_t{0xa0};
+constexpr auto triangleHeader = uint8_t{0xe0};
+constexpr auto sequenceHeader = uint8_t{0xd0};
+
+constexpr auto byteGroupSize = size_t{16};
+constexpr auto byteGroupDecodeLimit = size_t{24};
+constexpr auto vertexBlockSizeBytes = size_t{8192};
+constexpr auto vertexBlockMaxSize = size_t{256};
+constexpr auto vertexTailMinSize = size_t{32};
+constexpr auto maxVertexStride = size_t{256};
+
+// Cursor over the encoded stream, kept as raw bytes to match the bit-twiddling in the decoders
+struct ByteReader
+{
+    const uint8_t* data;
+    const uint8_t* end;
+
+    size_t remaining() const
+    {
+        return static_cast<size_t>(end - data);
+    }
+};
+
+uint8_t unzigzag8(uint8_t value)
+{
+    return static_cast<uint8_t>(-(value & 1) ^ (value >> 1));
+}
+
+uint32_t unzigzag32(uint32_t value)
+{
+    return (value >> 1) ^ (0u - (value & 1));
+}
+
+uint32_t decodeVByte(ByteReader& reader)
+{
+    const auto lead = *reader.data++;
+    if (lead < 128)
+    {
+        return lead;
+    }
+
+    // Varints are at most five bytes; callers guarantee those bytes are readable
+    auto result = uint32_t{lead & 127u};
+    auto shift = 7u;
+    for (auto i = 0; i < 4; ++i)
+    {
+        const auto group = *reader.data++;
+        result |= uint32_t{group & 127u} << shift;
+        shift += 7;
+
+        if (group < 128)
+        {
+            break;
+        }
+    }
+
+    return result;
+}
+
+// Expands one group of 16 bytes packed at 0, 2, 4 or 8 bits per byte. Values equal to the maximum for the bit
+// width are escapes, whose real value follows the packed bits.
+const uint8_t* decodeBytesGroup(const uint8_t* data, uint8_t* output, int bitsLog2)
+{
+    switch (bitsLog2)
+    {
+        case 0:
+            std::fill_n(output, byteGroupSize, uint8_t{0});
+            return data;
+        case 1:
+        case 2:
+        {
+            const auto bits = 1u << bitsLog2;
+            const auto escape = static_cast<uint8_t>((1u << bits) - 1);
+            const auto valuesPerByte = 8u / bits;
+            const auto* variable = data + byteGroupSize / valuesPerByte;
+
+            for (auto i = size_t{0}; i < byteGroupSize; ++i)
+            {
+                const auto packed = data[i / valuesPerByte];
+                const auto shift = 8u - bits * (static_cast<uint32_t>(i % valuesPerByte) + 1);
+                const auto value = static_cast<uint8_t>((packed >> shift) & escape);
+
+                output[i] = value == escape ? *variable : value;
+                variable += value == escape ? 1 : 0;
+            }
+
+            return variable;
+        }
+        default:
+            std::memcpy(output, data, byteGroupSize);
+            return data + byteGroupSize;
+    }
+}
+
+void decodeBytes(ByteReader& reader, uint8_t* output, size_t size)
+{
+    // Two header bits per group select its bit width
+    const auto* header = reader.data;
+    const auto headerSize = (size / byteGroupSize + 3) / 4;
+    if (reader.remaining() < headerSize)
+    {
+        throw std::runtime_error("Truncated meshopt vertex data");
+    }
+    reader.data += headerSize;
+
+    for (auto i = size_t{0}; i < size; i += byteGroupSize)
+    {
+        if (reader.remaining() < byteGroupDecodeLimit)
+        {
+            throw std::runtime_error("Truncated meshopt vertex data");
+        }
+
+        const auto group = i / byteGroupSize;
+        const auto bitsLog2 = (header[group / 4] >> ((group % 4) * 2)) & 3;
+        reader.data = decodeBytesGroup(reader.data, output + i, bitsLog2);
+    }
+}
+
+size_t vertexBlockSize(size_t stride)
+{
+    const auto size = (vertexBlockSizeBytes / stride) & ~(byteGroupSize - 1);
+    return std::min(size, vertexBlockMaxSize);
+}
+
+void decodeMeshoptVertices(std::span<std::byte> destination,
+                           size_t count,
+                           size_t stride,
+                           std::span<const std::byte> source)
+{
+    if (stride == 0 || stride > maxVertexStride || stride % 4 != 0)
+    {
+        throw std::runtime_error("Invalid meshopt vertex stride");
+    }
+
+    if (destination.size() < count * stride)
+    {
+        throw std::runtime_error("meshopt vertex destination is too small");
+    }
+
+    auto reader = ByteReader{reinterpret_cast<const uint8_t*>(source.data()),
+                             reinterpret_cast<const uint8_t*>(source.data()) + source.size()};
+
+    if (reader.remaining() < 1 + stride)
+    {
+        throw std::runtime_error("Truncated meshopt vertex data");
+    }
+
+    if ((reader.data[0] & 0xf0) != vertexHeader || (reader.data[0] & 0x0f) != 0)
+    {
+        throw std::runtime_error("Unsupported meshopt vertex encoding");
+    }
+    ++reader.data;
+
+    // Deltas of the first vertex are relative to the baseline stored in the tail
+    auto previous = std::array<uint8_t, maxVertexStride>{};
+    std::memcpy(previous.data(), reader.end - stride, stride);
+
+    const auto blockSize = vertexBlockSize(stride);
+    auto lane = std::array<uint8_t, vertexBlockMaxSize>{};
+    auto deltas = std::vector<uint8_t>(blockSize * stride);
+    auto* output = reinterpret_cast<uint8_t*>(destination.data());
+
+    for (auto blockStart = size_t{0}; blockStart < count; blockStart += blockSize)
+    {
+        const auto blockCount = std::min(blockSize, count - blockStart);
+        const auto alignedCount = (blockCount + byteGroupSize - 1) & ~(byteGroupSize - 1);
+
+        // Each byte lane is stored separately; scatter them back into vertex order
+        for (auto byte = size_t{0}; byte < stride; ++byte)
+        {
+            decodeBytes(reader, lane.data(), alignedCount);
+            for (auto i = size_t{0}; i < blockCount; ++i)
+            {
+                deltas[i * stride + byte] = lane[i];
+            }
+        }
+
+        // The inner loop runs across the lanes of a vertex, which are independent, so it vectorises
+        auto* blockOutput = output + blockStart * stride;
+        for (auto i = size_t{0}; i < blockCount; ++i)
+        {
+            for (auto byte = size_t{0}; byte < stride; ++byte)
+            {
+                previous[byte] = static_cast<uint8_t>(previous[byte] + unzigzag8(deltas[i * stride + byte]));
+                blockOutput[i * stride + byte] = previous[byte];
+            }
+        }
+    }
+
+    if (reader.remaining() != std::max(stride, vertexTailMinSize))
+    {
+        throw std::runtime_error("Malformed meshopt vertex data");
+    }
+}
+
+void writeIndex(uint8_t* destination, size_t stride, size_t index, uint32_t value)
+{
+    if (stride == 2)
+    {
+        const auto shortValue = static_cast<uint16_t>(value);
+        std::memcpy(destination + index * 2, &shortValue, sizeof(shortValue));
+    }
+    else
+    {
+        std::memcpy(destination + index * 4, &value, sizeof(value));
+    }
+}
+
+void decodeMeshoptTriangles(std::span<std::byte> destination,
+                            size_t count,
+                            size_t stride,
+                            std::span<const std::byte> source)
+{
+    if ((stride != 2 && stride != 4) || count % 3 != 0)
+    {
+        throw std::runtime_error("Invalid meshopt triangle stream layout");
+    }
+
+    if (destination.size() < count * stride)
+    {
+        throw std::runtime_error("meshopt index destination is too small");
+    }
+
+    // Smallest valid stream: header, one code byte per triangle and the 16 byte auxiliary code table
+    const auto* buffer = reinterpret_cast<const uint8_t*>(source.data());
+    if (source.size() < 1 + count / 3 + 16)
+    {
+        throw std::runtime_error("Truncated meshopt index data");
+    }
+
+    const auto version = buffer[0] & 0x0f;
+    if ((buffer[0] & 0xf0) != triangleHeader || version > 1)
+    {
+        throw std::runtime_error("Unsupported meshopt index encoding");
+    }
+
+    auto edgeFifo = std::array<std::array<uint32_t, 2>, 16>{};
+    auto vertexFifo = std::array<uint32_t, 16>{};
+    edgeFifo.fill({~0u, ~0u});
+    vertexFifo.fill(~0u);
+
+    auto edgeFifoOffset = size_t{0};
+    auto vertexFifoOffset = size_t{0};
+
+    const auto pushVertex = [&](uint32_t vertex, bool advance = true)
+    {
+        vertexFifo[vertexFifoOffset] = vertex;
+        vertexFifoOffset = (vertexFifoOffset + (advance ? 1 : 0)) & 15;
+    };
+
+    const auto pushEdge = [&](uint32_t a, uint32_t b)
+    {
+        edgeFifo[edgeFifoOffset] = {a, b};
+        edgeFifoOffset = (edgeFifoOffset + 1) & 15;
+    };
+
+    const auto decodeIndex = [](ByteReader& reader, uint32_t last)
+    {
+        return last + unzigzag32(decodeVByte(reader));
+    };
+
+    auto next = uint32_t{0};
+    auto last = uint32_t{0};
+    const auto maxFifoCode = version >= 1 ? 13u : 15u;
+
+    const auto* code = buffer + 1;
+    const auto* safeEnd = buffer + source.size() - 16;
+    const auto* auxTable = safeEnd;
+    auto reader = ByteReader{code + count / 3, buffer + source.size()};
+    auto* output = reinterpret_cast<uint8_t*>(destination.data());
+
+    for (auto i = size_t{0}; i < count; i += 3)
+    {
+        // A triangle reads at most 16 data bytes, which the auxiliary table guarantees are addressable
+        if (reader.data > safeEnd)
+        {
+            throw std::runtime_error("Truncated meshopt index data");
+        }
+
+        const auto codeTri = *code++;
+        auto a = uint32_t{0};
+        auto b = uint32_t{0};
+        auto c = uint32_t{0};
+
+        if (codeTri < 0xf0)
+        {
+            // Triangle sharing a recent edge; the third vertex is new, recent or explicitly encoded
+            const auto& edge = edgeFifo[(edgeFifoOffset - 1 - (codeTri >> 4)) & 15];
+            a = edge[0];
+            b = edge[1];
+
+            const auto fec = codeTri & 15u;
+            if (fec < maxFifoCode)
+            {
+                c = fec == 0 ? next : vertexFifo[(vertexFifoOffset - 1 - fec) & 15];
+                next += fec == 0 ? 1 : 0;
+                pushVertex(c, fec == 0);
+            }
+            else
+            {
+                // Version 1 encodes 13 and 14 as the previous free index minus and plus one
+                c = fec != 15 ? last + (fec == 13 ? uint32_t(-1) : 1u) : decodeIndex(reader, last);
+                last = c;
+                pushVertex(c);
+            }
+
+            pushEdge(c, b);
+            pushEdge(a, c);
+        }
+        else
+        {
+            auto feb = uint32_t{0};
+            auto fec = uint32_t{0};
+
+            if (codeTri < 0xfe)
+            {
+                // Common vertex reuse patterns come from the auxiliary table
+                const auto codeAux = auxTable[codeTri & 15];
+                feb = codeAux >> 4;
+                fec = codeAux & 15u;
+
+                a = next++;
+                b = feb == 0 ? next : vertexFifo[(vertexFifoOffset - feb) & 15];
+                next += feb == 0 ? 1 : 0;
+                c = fec == 0 ? next : vertexFifo[(vertexFifoOffset - fec) & 15];
+                next += fec == 0 ? 1 : 0;
+            }
+            else
+            {
+                const auto codeAux = *reader.data++;
+                const auto fea = codeTri == 0xfe ? 0u : 15u;
+                feb = codeAux >> 4;
+                fec = codeAux & 15u;
+
+                // An explicit zero code resets the running vertex counter
+                if (codeAux == 0)
+                {
+                    next = 0;
+                }
+
+                a = fea == 0 ? next++ : 0;
+                b = feb == 0 ? next++ : vertexFifo[(vertexFifoOffset - feb) & 15];
+                c = fec == 0 ? next++ : vertexFifo[(vertexFifoOffset - fec) & 15];
+
+                if (fea == 15)
+                {
+                    last = a = decodeIndex(reader, last);
+                }
+
+                if (feb == 15)
+                {
+                    last = b = decodeIndex(reader, last);
+                }
+
+                if (fec == 15)
+                {
+                    last = c = decodeIndex(reader, last);
+                }
+            }
+
+            pushVertex(a);
+            pushVertex(b, feb == 0 || feb == 15);
+            pushVertex(c, fec == 0 || fec == 15);
+            pushEdge(b, a);
+            pushEdge(c, b);
+            pushEdge(a, c);
+        }
+
+        writeIndex(output, stride, i + 0, a);
+        writeIndex(output, stride, i + 1, b);
+        writeIndex(output, stride, i + 2, c);
+    }
+
+    if (reader.data != safeEnd)
+    {
+        throw std::runtime_error("Malformed meshopt index data");
+    }
+}
+
+void decodeMeshoptIndices(std::span<std::byte> destination,
+                          size_t count,
+                          size_t stride,
+                          std::span<const std::byte> source)
+{
+    if (stride != 2 && stride != 4)
+    {
+        throw std::runtime_error("Invalid meshopt index stride");
+    }
+
+    if (destination.size() < count * stride)
+    {
+        throw std::runtime_error("meshopt index destination is too small");
+    }
+
+    // Smallest valid stream: header, one byte per index and a 4 byte tail
+    const auto* buffer = reinterpret_cast<const uint8_t*>(source.data());
+    if (source.size() < 1 + count + 4)
+    {
+        throw std::runtime_error("Truncated meshopt index data");
+    }
+
+    if ((buffer[0] & 0xf0) != sequenceHeader || (buffer[0] & 0x0f) > 1)
+    {
+        throw std::runtime_error("Unsupported meshopt index encoding");
+    }
+
+    const auto* safeEnd = buffer + source.size() - 4;
+    auto reader = ByteReader{buffer + 1, buffer + source.size()};
+    auto* output = reinterpret_cast<uint8_t*>(destination.data());
+
+    // Indices are deltas against one of two baselines, selected by the low bit
+    auto baselines = std::array<uint32_t, 2>{};
+    for (auto i = size_t{0}; i < count; ++i)
+    {
+        if (reader.data >= safeEnd)
+        {
+            throw std::runtime_error("Truncated meshopt index data");
+        }
+
+        const auto value = decodeVByte(reader);
+        auto& baseline = baselines[value & 1];
+        baseline += unzigzag32(value >> 1);
+
+        writeIndex(output, stride, i, baseline);
+    }
+
+    if (reader.data != safeEnd)
+    {
+        throw std::runtime_error("Malformed meshopt index data");
+    }
+}
+
+template <typename Component>
+Component roundToComponent(float value)
+{
+    return static_cast<Component>(static_cast<int>(value + (value >= 0.0f ? 0.5f : -0.5f)));
+}
+
+// Octahedral encoded unit vectors: x and y on the octahedron, z holding the encoding's one
+template <typename Component>
+void decodeOctahedralFilter(std::byte* data, size_t count)
+{
+    const auto maxValue = static_cast<float>((1 << (sizeof(Component) * 8 - 1)) - 1);
+
+    for (auto i = size_t{0}; i < count; ++i)
+    {
+        auto components = std::array<Component, 4>{};
+        std::memcpy(components.data(), data + i * sizeof(components), sizeof(components));
+
+        auto x = static_cast<float>(components[0]);
+        auto y = static_cast<float>(components[1]);
+        const auto z = static_cast<float>(components[2]) - std::fabs(x) - std::fabs(y);
+
+        // Unfold the lower hemisphere
+        const auto t = std::min(z, 0.0f);
+        x += x >= 0.0f ? t : -t;
+        y += y >= 0.0f ? t : -t;
+
+        const auto scale = maxValue / std::sqrt(x * x + y * y + z * z);
+        components[0] = roundToComponent<Component>(x * scale);
+        components[1] = roundToComponent<Component>(y * scale);
+        components[2] = roundToComponent<Component>(z * scale);
+
+        std::memcpy(data + i * sizeof(components), components.data(), sizeof(components));
+    }
+}
+
+// Unit quaternions stored as their three smallest components, with the index of the largest in the low bits of w
+void decodeQuaternionFilter(std::byte* data, size_t count)
+{
+    const auto scale = 1.0f / std::sqrt(2.0f);
+
+    for (auto i = size_t{0}; i < count; ++i)
+    {
+        auto components = std::array<int16_t, 4>{};
+        std::memcpy(components.data(), data + i * sizeof(components), sizeof(components));
+
+        const auto range = scale / static_cast<float>(components[3] | 3);
+        const auto x = static_cast<float>(components[0]) * range;
+        const auto y = static_cast<float>(components[1]) * range;
+        const auto z = static_cast<float>(components[2]) * range;
+        const auto w = std::sqrt(std::max(1.0f - x * x - y * y - z * z, 0.0f));
+
+        const auto largest = static_cast<size_t>(components[3] & 3);
+        components[(largest + 1) & 3] = roundToComponent<int16_t>(x * 32767.0f);
+        components[(largest + 2) & 3] = roundToComponent<int16_t>(y * 32767.0f);
+        components[(largest + 3) & 3] = roundToComponent<int16_t>(z * 32767.0f);
+        components[(largest + 0) & 3] = roundToComponent<int16_t>(w * 32767.0f);
+
+        std::memcpy(data + i * sizeof(components), components.data(), sizeof(components));
+    }
+}
+
+// Floats stored as a 24 bit signed mantissa and an 8 bit signed exponent
+void decodeExponentialFilter(std::byte* data, size_t count)
+{
+    for (auto i = size_t{0}; i < count; ++i)
+    {
+        auto value = uint32_t{0};
+        std::memcpy(&value, data + i * sizeof(value), sizeof(value));
+
+        const auto mantissa = static_cast<int32_t>(value << 8) >> 8;
+        const auto exponent = static_cast<int32_t>(value) >> 24;
+
+        // ldexp(mantissa, exponent) by building 2^exponent directly
+        const auto power = std::bit_cast<float>(static_cast<uint32_t>(exponent + 127) << 23);
+        const auto result = power * static_cast<float>(mantissa);
+
+        std::memcpy(data + i * sizeof(result), &result, sizeof(result));
+    }
+}
+
+void applyMeshoptFilter(MeshoptFilter filter, std::span<std::byte> data, size_t count, size_t stride)
+{
+    if (data.size() < count * stride)
+    {
+        throw std::runtime_error("meshopt filter data is too small");
+    }
+
+    switch (filter)
+    {
+        case MeshoptFilter::None:
+            break;
+        case MeshoptFilter::Octahedral:
+            if (stride == 4)
+            {
+                decodeOctahedralFilter<int8_t>(data.data(), count);
+            }
+            else if (stride == 8)
+            {
+                decodeOctahedralFilter<int16_t>(data.data(), count);
+            }
+            else
+            {
+                throw std::runtime_error("Invalid stride for meshopt octahedral filter");
+            }
+            break;
+        case MeshoptFilter::Quaternion:
+            if (stride != 8)
+            {
+                throw std::runtime_error("Invalid stride for meshopt quaternion filter");
+            }
+            decodeQuaternionFilter(data.data(), count);
+            break;
+        case MeshoptFilter::Exponential:
+            if (stride % 4 != 0)
+            {
+                throw std::runtime_error("Invalid stride for meshopt exponential filter");
+            }
+            decodeExponentialFilter(data.data(), count * stride / 4);
+            break;
+    }
+}
+} // namespace assets
@@ -0,0 +1,38 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Mark Rapson
+
+#pragma once
+
+#include <cstddef>
+#include <span>
+
+namespace assets
+{
+// Decoders for the meshoptimizer bitstreams used by EXT_meshopt_compression. Each writes count * stride bytes
+// to destination and throws std::runtime_error if the source data is malformed.
+void decodeMeshoptVertices(std::span<std::byte> destination,
+                           size_t count,
+                           size_t stride,
+                           std::span<const std::byte> source);
+
+void decodeMeshoptTriangles(std::span<std::byte> destination,
+                            size_t count,
+                            size_t stride,
+                            std::span<const std::byte> source);
+
+void decodeMeshoptIndices(std::span<std::byte> destination,
+                          size_t count,
+                          size_t stride,
+                          std::span<const std::byte> source);
+
+enum class MeshoptFilter
+{
+    None,
+    Octahedral,
+    Quaternion,
+    Exponential
+};
+
+// Reverses a filter applied to already decoded vertex data in place
+void applyMeshoptFilter(MeshoptFilter filter, std::span<std::byte> data, size_t count, size_t stride);
+} // namespace assets
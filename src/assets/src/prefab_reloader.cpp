@@ -0,0 +1,167 @@
+/// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Mark Rapson
+
+#include "assets/prefab_reloader.h"
+#include "assets/gltf_loader.h"
+
+#include <core/file_watcher.h>
+#include <core/job_system.h>
+#include <core/task.h>
+
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <chrono>
+#include <unordered_set>
+
+namespace assets
+{
+// A change to a prefab's own source, or to a file beside it that isn't the source of another prefab
+bool affectsPrefab(const std::filesystem::path& changed, const Prefab& prefab, const AssetDatabase& db)
+{
+    const auto sourcePath = prefab.sourcePath.lexically_normal();
+    if (changed == sourcePath)
+    {
+        return true;
+    }
+
+    if (changed.parent_path() != sourcePath.parent_path())
+    {
+        return false;
+    }
+
+    auto isOtherSource = false;
+    db.pool<Prefab>().forEach([&](Handle<Prefab>, const Prefab& other)
+                              { isOtherSource = isOtherSource || other.sourcePath.lexically_normal() == changed; });
+
+    return !isOtherSource;
+}
+
+PrefabReloader::PrefabReloader(const AssetDatabase& db)
+    : watcher_{std::make_unique<core::FileWatcher>()}
+{
+    auto directories = std::unordered_set<std::filesystem::path>{};
+    db.pool<Prefab>().forEach(
+        [&directories](Handle<Prefab>, const Prefab& prefab)
+        {
+            if (!prefab.sourcePath.empty())
+            {
+                directories.insert(prefab.sourcePath.parent_path());
+            }
+        });
+
+    for (const auto& directory : directories)
+    {
+        spdlog::info("Watching {} for prefab changes", directory.string());
+        watcher_->watchDirectory(directory);
+    }
+}
+
+// Futures from std::async wait for their load when destroyed but those of tasks don't, and a load still running
+// writes to its scratch database
+PrefabReloader::~PrefabReloader()
+{
+    for (auto& reload : pending_)
+    {
+        reload.result.wait();
+    }
+}
+
+std::optional<EvictedAssets> PrefabReloader::update(AssetDatabase& db)
+{
+    for (const auto& changed : watcher_->poll())
+    {
+        const auto path = changed.lexically_normal();
+        db.pool<Prefab>().forEach(
+            [&](Handle<Prefab> handle, const Prefab& prefab)
+            {
+                if (prefab.sourcePath.empty() || !affectsPrefab(path, prefab, db))
+                {
+                    return;
+                }
+
+                auto itr = std::ranges::find(pending_, handle, &PendingReload::prefab);
+                if (itr != pending_.end())
+                {
+                    // The load in progress may have read the old file, so go again once it's done
+                    itr->changedAgain = true;
+                    return;
+                }
+
+                spdlog::info("{} changed, reloading {}", path.string(), prefab.sourcePath.string());
+                startReload(handle, prefab.sourcePath, db);
+            });
+    }
+
+    auto removed = std::optional<EvictedAssets>{};
+    for (auto itr = pending_.begin(); itr != pending_.end();)
+    {
+        if (itr->result.wait_for(std::chrono::seconds{0}) != std::future_status::ready)
+        {
+            ++itr;
+            continue;
+        }
+
+        auto reload = std::move(*itr);
+        itr = pending_.erase(itr);
+
+        // The prefab may have been evicted while it was loading
+        if (!db.pool<Prefab>().contains(reload.prefab))
+        {
+            continue;
+        }
+
+        try
+        {
+            const auto prefab = reload.result.get();
+            auto evicted = db.replacePrefab(reload.prefab, *reload.source, prefab);
+
+            if (!removed)
+            {
+                removed = EvictedAssets{};
+            }
+
+            std::ranges::move(evicted.images, std::back_inserter(removed->images));
+            std::ranges::move(evicted.materials, std::back_inserter(removed->materials));
+            std::ranges::move(evicted.subMeshes, std::back_inserter(removed->subMeshes));
+            spdlog::info("Reloaded {}", prefab.sourcePath.string());
+        }
+        catch (const std::exception& ex)
+        {
+            // Keep the version already loaded; the next save will try again
+            spdlog::error("Failed to reload prefab: {}", ex.what());
+        }
+
+        if (reload.changedAgain)
+        {
+            const auto sourcePath = db.get(reload.prefab).sourcePath;
+            startReload(reload.prefab, sourcePath, db);
+            itr = pending_.begin();
+        }
+    }
+
+    return removed;
+}
+
+void PrefabReloader::startReload(Handle<Prefab> prefab, const std::filesystem::path& path, const AssetDatabase& db)
+{
+    // The scratch database loads with the same cache and threads as the one it will be swapped into
+    auto source = std::make_unique<AssetDatabase>();
+    source->setImageCache(db.imageCache());
+    source->setJobSystem(db.jobSystem());
+    source->setFileReadQueue(db.fileReadQueue());
+
+    auto result = std::future<Prefab>{};
+    if (source->jobSystem() && source->fileReadQueue())
+    {
+        result = core::startTask(loadGLTFModelAsync(path, *source));
+    }
+    else
+    {
+        result = std::async(std::launch::async,
+                            [path, database = source.get()] { return loadGLTFModel(path, *database); });
+    }
+
+    pending_.push_back(PendingReload{.prefab = prefab, .source = std::move(source), .result = std::move(result)});
+}
+} // namespace assets
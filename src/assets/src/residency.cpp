@@ -0,0 +1,54 @@
+/// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Mark Rapson
+
+#include "assets/residency.h"
+
+#include "assets/image.h"
+#include "assets/mesh.h"
+
+namespace assets
+{
+bool isStreamable(const Image& image)
+{
+    return image.mipLevels > 1 && image.layers == 1 && image.levels.size() == image.mipLevels;
+}
+
+size_t cpuMemoryUsage(const Image& image)
+{
+    return image.data.size();
+}
+
+size_t cpuMemoryUsage(const SubMesh& subMesh)
+{
+    return subMesh.vertices.capacity() * sizeof(core::Vertex) + subMesh.indices.capacity() * sizeof(uint32_t)
+           + subMesh.meshlets.capacity() * sizeof(Meshlet);
+}
+
+void releaseCpuData(Image& image, const ResidencyPolicy& policy)
+{
+    const auto residency = isStreamable(image) ? policy.streamedImages : policy.images;
+    if (residency == CpuResidency::Release)
+    {
+        image.data = ImageData{};
+    }
+}
+
+// Swapping with an empty vector frees the allocation, which clear() would keep
+void releaseCpuData(SubMesh& subMesh, const ResidencyPolicy& policy)
+{
+    if (policy.meshVertices == CpuResidency::Release)
+    {
+        std::vector<core::Vertex>{}.swap(subMesh.vertices);
+    }
+
+    if (policy.meshIndices == CpuResidency::Release)
+    {
+        std::vector<uint32_t>{}.swap(subMesh.indices);
+    }
+
+    if (policy.meshlets == CpuResidency::Release)
+    {
+        std::vector<Meshlet>{}.swap(subMesh.meshlets);
+    }
+}
+} // namespace assets
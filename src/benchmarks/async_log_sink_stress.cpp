@@ -0,0 +1,131 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Mark Rapson
+
+// Logs and flushes from many threads at once through AsyncLogSink and checks that every flush returns and every
+// message is either written or counted as dropped. Threads log in rounds and all flush at the end of each one, so
+// often no later flush comes along to unstick one that missed its messages. Exits with a failure if a flush hasn't
+// returned within the timeout.
+
+#include <core/async_log_sink.h>
+
+#include <spdlog/details/null_mutex.h>
+#include <spdlog/sinks/base_sink.h>
+#include <spdlog/spdlog.h>
+
+#include <atomic>
+#include <barrier>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <thread>
+#include <vector>
+
+constexpr auto producerCount = 8;
+constexpr auto roundCount = 500;
+constexpr auto messagesPerRound = 20;
+constexpr auto timeout = std::chrono::seconds{60};
+
+// Small enough that producers regularly find it full
+constexpr auto ringCapacity = size_t{64};
+
+// Counts what reaches it. Only the flusher thread writes to it.
+class CountingSink final : public spdlog::sinks::base_sink<spdlog::details::null_mutex>
+{
+  public:
+    std::atomic<uint64_t> written{0};
+
+  protected:
+    void sink_it_(const spdlog::details::log_msg&) override
+    {
+        written.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void flush_() override
+    {
+    }
+};
+
+int main()
+{
+    auto target = std::make_shared<CountingSink>();
+    auto sink = std::make_shared<core::AsyncLogSink>(target, ringCapacity);
+    auto logger = spdlog::logger{"stress", sink};
+    logger.set_level(spdlog::level::trace);
+
+    auto finished = std::atomic<int>{0};
+    auto flushes = std::atomic<uint64_t>{0};
+
+    // A hung flush never returns, so it's caught from outside the producers
+    auto watchdog = std::jthread(
+        [&](std::stop_token stopToken)
+        {
+            const auto deadline = std::chrono::steady_clock::now() + timeout;
+            while (!stopToken.stop_requested())
+            {
+                if (std::chrono::steady_clock::now() > deadline)
+                {
+                    std::fprintf(stderr,
+                                 "FAILED: %d of %d producers finished after %lld s, %llu flushes returned\n",
+                                 finished.load(),
+                                 producerCount,
+                                 static_cast<long long>(timeout.count()),
+                                 static_cast<unsigned long long>(flushes.load()));
+                    std::_Exit(EXIT_FAILURE);
+                }
+                std::this_thread::sleep_for(std::chrono::milliseconds{100});
+            }
+        });
+
+    const auto start = std::chrono::steady_clock::now();
+    {
+        auto roundStart = std::barrier{producerCount};
+        auto producers = std::vector<std::jthread>{};
+        for (auto producer = 0; producer < producerCount; ++producer)
+        {
+            producers.emplace_back(
+                [&, producer]
+                {
+                    for (auto round = 0; round < roundCount; ++round)
+                    {
+                        roundStart.arrive_and_wait();
+
+                        // Every message is distinct, so none are held back as repeats
+                        for (auto i = 0; i < messagesPerRound; ++i)
+                        {
+                            logger.info("producer {} round {} message {}", producer, round, i);
+                        }
+
+                        logger.flush();
+                        flushes.fetch_add(1, std::memory_order_relaxed);
+                    }
+
+                    finished.fetch_add(1);
+                });
+        }
+    }
+    sink->flush();
+    const auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    watchdog.request_stop();
+
+    const auto total = static_cast<uint64_t>(producerCount) * roundCount * messagesPerRound;
+    const auto accounted = target->written.load() + sink->droppedCount() + sink->suppressedCount();
+
+    // The flusher's own notices about dropped messages are written too, so there may be a few more than logged
+    spdlog::info("{} messages and {} flushes from {} threads in {:.1f} ms: {} written, {} dropped, {} suppressed",
+                 total,
+                 flushes.load(),
+                 producerCount,
+                 elapsed,
+                 target->written.load(),
+                 sink->droppedCount(),
+                 sink->suppressedCount());
+
+    if (accounted < total)
+    {
+        spdlog::error("FAILED: {} messages unaccounted for after the final flush", total - accounted);
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
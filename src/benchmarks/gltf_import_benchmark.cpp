@@ -0,0 +1,136 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Mark Rapson
+
+// Times glTF imports with arena and heap scratch allocation, and reports the peak RSS of each. Each mode runs in its
+// own child process, since the peak RSS of a process only ever grows.
+
+#include <assets/asset_database.h>
+#include <assets/gltf_loader.h>
+#include <core/file_system.h>
+#include <core/job_system.h>
+
+#include <spdlog/spdlog.h>
+
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <exception>
+#include <filesystem>
+#include <limits>
+#include <utility>
+#include <vector>
+
+constexpr auto repetitions = 5;
+
+// Peak resident set size of this process so far, in KiB
+long peakResidentKiB()
+{
+    auto usage = rusage{};
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+}
+
+std::vector<std::filesystem::path> findModels(int argc, char** argv)
+{
+    auto paths = std::vector<std::filesystem::path>{};
+    for (auto i = 1; i < argc; ++i)
+    {
+        paths.emplace_back(argv[i]);
+    }
+
+    if (paths.empty())
+    {
+        for (const auto& entry : std::filesystem::directory_iterator{core::getPrefabsDir()})
+        {
+            if (entry.is_regular_file() && entry.path().extension() == ".glb")
+            {
+                paths.push_back(entry.path());
+            }
+        }
+        std::ranges::sort(paths);
+    }
+
+    return paths;
+}
+
+// Imports every model into a fresh database several times. Run in a child process so its peak RSS is its own.
+int importAll(const std::vector<std::filesystem::path>& paths, assets::ImportScratch scratch, const char* name)
+{
+    try
+    {
+        auto jobSystem = core::JobSystem{};
+        const auto baseline = peakResidentKiB();
+
+        auto best = std::numeric_limits<double>::max();
+        auto total = 0.0;
+        for (auto i = 0; i < repetitions; ++i)
+        {
+            auto db = assets::AssetDatabase{};
+            db.setJobSystem(&jobSystem);
+
+            const auto start = std::chrono::steady_clock::now();
+            for (const auto& path : paths)
+            {
+                db.addPrefab(path.stem().string(), assets::loadGLTFModel(path, db, scratch));
+            }
+            const auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start);
+            best = std::min(best, elapsed.count());
+            total += elapsed.count();
+        }
+
+        spdlog::info("{:<6} scratch  best {:>9.3f} ms   mean {:>9.3f} ms   peak RSS +{} KiB",
+                     name,
+                     best,
+                     total / repetitions,
+                     peakResidentKiB() - baseline);
+        return EXIT_SUCCESS;
+    }
+    catch (const std::exception& e)
+    {
+        spdlog::error("{} scratch import failed: {}", name, e.what());
+        return EXIT_FAILURE;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    const auto paths = findModels(argc, argv);
+    if (paths.empty())
+    {
+        spdlog::error("No .glb files to import");
+        return EXIT_FAILURE;
+    }
+    spdlog::info("{} models, best of {} imports each", paths.size(), repetitions);
+
+    auto result = EXIT_SUCCESS;
+    for (const auto& [scratch, name] :
+         {std::pair{assets::ImportScratch::Heap, "heap"}, std::pair{assets::ImportScratch::Arena, "arena"}})
+    {
+        const auto pid = fork();
+        if (pid < 0)
+        {
+            spdlog::error("fork failed");
+            return EXIT_FAILURE;
+        }
+        if (pid == 0)
+        {
+            // Skip the exit handlers, which belong to the parent
+            const auto childResult = importAll(paths, scratch, name);
+            spdlog::default_logger()->flush();
+            std::_Exit(childResult);
+        }
+
+        auto status = 0;
+        waitpid(pid, &status, 0);
+        if (!WIFEXITED(status) || WEXITSTATUS(status) != EXIT_SUCCESS)
+        {
+            result = EXIT_FAILURE;
+        }
+    }
+
+    return result;
+}
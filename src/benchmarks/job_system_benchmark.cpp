@@ -0,0 +1,158 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Mark Rapson
+
+// Times core::JobSystem against std::async on fork/join workloads of different granularity and balance
+
+#include <core/job_system.h>
+
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <future>
+#include <limits>
+#include <thread>
+#include <vector>
+
+constexpr auto repetitions = 5;
+constexpr auto elementCount = size_t{1} << 22;
+constexpr auto grainSize = size_t{4096};
+constexpr auto tinyJobCount = size_t{10000};
+
+// Best of several runs, in milliseconds
+double measure(const std::function<void()>& function)
+{
+    auto best = std::numeric_limits<double>::max();
+    for (auto i = 0; i < repetitions; ++i)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        function();
+        const auto elapsed = std::chrono::steady_clock::now() - start;
+        best = std::min(best, std::chrono::duration<double, std::milli>(elapsed).count());
+    }
+    return best;
+}
+
+// Uniform cost per element
+void uniformWork(std::vector<float>& values, size_t begin, size_t end)
+{
+    for (auto i = begin; i < end; ++i)
+    {
+        values[i] = std::sqrt(std::sin(static_cast<float>(i)) + 2.0f);
+    }
+}
+
+// Cost grows across the range, so equal static chunks finish at very different times
+void skewedWork(std::vector<float>& values, size_t begin, size_t end)
+{
+    for (auto i = begin; i < end; ++i)
+    {
+        auto value = static_cast<float>(i);
+        const auto iterations = 1 + i * 8 / elementCount;
+        for (auto j = size_t{0}; j < iterations; ++j)
+        {
+            value = std::sqrt(std::sin(value) + 2.0f);
+        }
+        values[i] = value;
+    }
+}
+
+// One std::async task per hardware thread, each taking an equal slice
+void asyncPerThread(size_t count, const std::function<void(size_t, size_t)>& body)
+{
+    const auto threadCount = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+    auto tasks = std::vector<std::future<void>>{};
+    for (auto thread = size_t{0}; thread < threadCount; ++thread)
+    {
+        const auto begin = count * thread / threadCount;
+        const auto end = count * (thread + 1) / threadCount;
+        tasks.push_back(std::async(std::launch::async, body, begin, end));
+    }
+
+    for (auto& task : tasks)
+    {
+        task.get();
+    }
+}
+
+// One std::async task per grain, the closest match to what the job system schedules
+void asyncPerGrain(size_t count, const std::function<void(size_t, size_t)>& body)
+{
+    auto tasks = std::vector<std::future<void>>{};
+    for (auto begin = size_t{0}; begin < count; begin += grainSize)
+    {
+        tasks.push_back(std::async(std::launch::async, body, begin, std::min(begin + grainSize, count)));
+    }
+
+    for (auto& task : tasks)
+    {
+        task.get();
+    }
+}
+
+void report(const char* workload, double jobSystem, double asyncTime, const char* asyncVariant)
+{
+    spdlog::info("{:<22} job system {:>9.3f} ms   std::async {:<10} {:>9.3f} ms   speedup {:.2f}x",
+                 workload,
+                 jobSystem,
+                 asyncVariant,
+                 asyncTime,
+                 asyncTime / jobSystem);
+}
+
+int main()
+{
+    auto jobSystem = core::JobSystem{};
+    spdlog::info("{} threads, {} elements, grain {}", jobSystem.threadCount(), elementCount, grainSize);
+
+    auto values = std::vector<float>(elementCount);
+    const auto uniform = [&values](size_t begin, size_t end) { uniformWork(values, begin, end); };
+    const auto skewed = [&values](size_t begin, size_t end) { skewedWork(values, begin, end); };
+
+    const auto uniformJobs = measure([&] { jobSystem.parallelFor(elementCount, grainSize, uniform); });
+    report("uniform parallel for",
+           uniformJobs,
+           measure([&] { asyncPerThread(elementCount, uniform); }),
+           "per thread");
+    report("uniform parallel for",
+           uniformJobs,
+           measure([&] { asyncPerGrain(elementCount, uniform); }),
+           "per grain");
+
+    const auto skewedJobs = measure([&] { jobSystem.parallelFor(elementCount, grainSize, skewed); });
+    report("skewed parallel for", skewedJobs, measure([&] { asyncPerThread(elementCount, skewed); }), "per thread");
+
+    // Jobs too small to be worth a thread each, where per-task overhead dominates
+    auto counter = std::atomic<size_t>{0};
+    const auto tinyJob = [&counter] { counter.fetch_add(1, std::memory_order_relaxed); };
+    report("tiny fork/join jobs",
+           measure(
+               [&]
+               {
+                   auto jobs = core::JobCounter{};
+                   for (auto i = size_t{0}; i < tinyJobCount; ++i)
+                   {
+                       jobSystem.run(jobs, tinyJob);
+                   }
+                   jobSystem.wait(jobs);
+               }),
+           measure(
+               [&]
+               {
+                   auto tasks = std::vector<std::future<void>>{};
+                   tasks.reserve(tinyJobCount);
+                   for (auto i = size_t{0}; i < tinyJobCount; ++i)
+                   {
+                       tasks.push_back(std::async(std::launch::async, tinyJob));
+                   }
+                   for (auto& task : tasks)
+                   {
+                       task.get();
+                   }
+               }),
+           "per job");
+
+    return 0;
+}
@@ -0,0 +1,68 @@
+/// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Mark Rapson
+
+#pragma once
+
+#include <stdint.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace core
+{
+// Heap allocations are counted by replacing the global operator new and delete, which is only compiled in when
+// VULKAN_DEMO_TRACK_ALLOCATIONS is defined. Without it every count is zero and zones cost nothing but a branch.
+
+struct AllocationCounts
+{
+    uint64_t allocations{0};
+    uint64_t deallocations{0};
+
+    // Requested bytes; deallocations aren't always told their size, so this only grows
+    uint64_t bytes{0};
+};
+
+bool allocationTrackingEnabled();
+
+// Allocations made by the calling thread since it started
+AllocationCounts threadAllocations();
+
+// Allocations made by every thread since the process started
+AllocationCounts processAllocations();
+
+// What the allocations made inside one zone on one thread added up to since the stats were last taken
+struct AllocationZoneStats
+{
+    std::string name;
+    std::thread::id thread;
+    uint64_t entries{0};
+
+    // Entries during which at least one allocation was made
+    uint64_t allocatingEntries{0};
+
+    AllocationCounts counts;
+};
+
+// Counts the calling thread's allocations from construction to destruction under a name. Zones may nest, in which
+// case an allocation counts towards each zone it is made in. The stats keep their own copy of name.
+class AllocationZone
+{
+  public:
+    explicit AllocationZone(const char* name);
+    ~AllocationZone();
+
+    AllocationZone(const AllocationZone&) = delete;
+    AllocationZone& operator=(const AllocationZone&) = delete;
+
+    AllocationZone(AllocationZone&& other) = delete;
+    AllocationZone& operator=(AllocationZone&& other) = delete;
+
+  private:
+    const char* name_;
+    AllocationCounts start_;
+};
+
+// Replaces stats with those of every zone exited since the last call and starts counting afresh, so calling it once
+// per frame gives per-frame counts. Reuses the storage already in stats, which isn't counted as allocations.
+void takeAllocationZoneStats(std::vector<AllocationZoneStats>& stats);
+} // namespace core
@@ -0,0 +1,64 @@
+/// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Mark Rapson
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <vector>
+
+namespace core
+{
+// Monotonic memory resource for short-lived scratch data. Allocation bumps a pointer through a list of blocks that
+// double in size, deallocation does nothing, and everything is freed together when the arena is reset or destroyed.
+// Not thread safe; give each thread its own arena.
+class Arena final : public std::pmr::memory_resource
+{
+  public:
+    static constexpr auto defaultBlockSize = size_t{64} * 1024;
+
+    explicit Arena(size_t blockSize = defaultBlockSize);
+    ~Arena() override = default;
+
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    Arena(Arena&& other) = delete;
+    Arena& operator=(Arena&& other) = delete;
+
+    // Invalidates every allocation but keeps the blocks, so refilling the arena doesn't touch the heap again
+    void reset();
+
+    // Invalidates every allocation and returns the blocks to the heap
+    void release();
+
+    // Bytes handed out since the last reset, including alignment padding
+    size_t bytesUsed() const;
+
+    // Largest bytesUsed() since construction
+    size_t peakBytesUsed() const;
+
+    // Bytes held in blocks, whether in use or not
+    size_t bytesReserved() const;
+
+  private:
+    void* do_allocate(size_t bytes, size_t alignment) override;
+    void do_deallocate(void* pointer, size_t bytes, size_t alignment) override;
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+
+  private:
+    struct Block
+    {
+        std::unique_ptr<std::byte[]> data;
+        size_t size;
+    };
+
+    size_t blockSize_;
+    std::vector<Block> blocks_;
+    size_t currentBlock_{0};
+    size_t offset_{0};
+    size_t bytesUsed_{0};
+    size_t peakBytesUsed_{0};
+};
+} // namespace core
@@ -0,0 +1,122 @@
+/// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Mark Rapson
+
+#pragma once
+
+#include <spdlog/sinks/sink.h>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <stdint.h>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace core
+{
+// Sink that hands messages to a background thread, which writes them to another sink. Logging only copies the
+// formatted message into a slot of a fixed-size lock-free ring, so it never blocks on I/O, takes a lock or allocates;
+// when the ring is full the message is dropped and counted instead. The background thread collapses runs of the same
+// message into a repeat count and lets through at most maxRepeatsPerSecond copies of any one message per second,
+// which keeps per-frame validation messages from flooding the console.
+class AsyncLogSink final : public spdlog::sinks::sink
+{
+  public:
+    static constexpr auto defaultCapacity = size_t{4096};
+    static constexpr auto maxRepeatsPerSecond = uint32_t{5};
+
+    // Longer messages are truncated
+    static constexpr auto maxMessageSize = size_t{1000};
+
+    // capacity must be a power of two
+    explicit AsyncLogSink(std::shared_ptr<spdlog::sinks::sink> target, size_t capacity = defaultCapacity);
+
+    // Writes out everything queued before returning
+    ~AsyncLogSink() override;
+
+    AsyncLogSink(const AsyncLogSink&) = delete;
+    AsyncLogSink& operator=(const AsyncLogSink&) = delete;
+
+    AsyncLogSink(AsyncLogSink&& other) = delete;
+    AsyncLogSink& operator=(AsyncLogSink&& other) = delete;
+
+    void log(const spdlog::details::log_msg& message) override;
+
+    // Blocks until everything logged before the call has been written and the target flushed
+    void flush() override;
+
+    void set_pattern(const std::string& pattern) override;
+    void set_formatter(std::unique_ptr<spdlog::formatter> formatter) override;
+
+    // Messages lost to a full ring
+    uint64_t droppedCount() const;
+
+    // Messages held back by deduplication or rate limiting
+    uint64_t suppressedCount() const;
+
+  private:
+    struct Entry
+    {
+        spdlog::log_clock::time_point time;
+        size_t threadId;
+        spdlog::level::level_enum level;
+        uint32_t size;
+        std::array<char, maxMessageSize> text;
+    };
+
+    // Sequence numbers tell producers and the consumer whose turn a slot is, as in Vyukov's bounded queue
+    struct Slot
+    {
+        std::atomic<uint64_t> sequence;
+        Entry entry;
+    };
+
+    struct RateWindow
+    {
+        std::chrono::steady_clock::time_point start;
+        uint32_t count;
+        uint64_t suppressed;
+    };
+
+    // Flusher thread only
+    bool writeNext();
+    void flusherLoop(std::stop_token stopToken);
+    void write(const Entry& entry);
+    void writeRepeats();
+    void writeNotice(spdlog::level::level_enum level, std::string_view text);
+    void report(std::chrono::steady_clock::time_point now);
+    bool allowedByRateLimit(size_t hash, std::chrono::steady_clock::time_point now);
+
+  private:
+    std::shared_ptr<spdlog::sinks::sink> target_;
+
+    std::unique_ptr<Slot[]> slots_;
+    size_t mask_;
+    alignas(64) std::atomic<uint64_t> enqueuePosition_{0};
+    alignas(64) std::atomic<uint64_t> dequeuePosition_{0};
+
+    std::atomic<uint64_t> dropped_{0};
+    std::atomic<uint64_t> suppressed_{0};
+
+    // Ring position up to which everything has been written and flushed, for flush() to wait on
+    std::atomic<uint64_t> flushedThrough_{0};
+
+    // Number of flush() calls still waiting; the flusher republishes flushedThrough_ after every pass while non-zero
+    std::atomic<uint32_t> flushWaiters_{0};
+
+    // Only touched by the flusher thread, other than the target which set_pattern also reaches
+    std::mutex targetMutex_;
+    Entry lastEntry_{};
+    size_t lastHash_{0};
+    uint64_t lastRepeats_{0};
+    std::unordered_map<size_t, RateWindow> rateWindows_;
+    uint64_t reportedDropped_{0};
+    std::chrono::steady_clock::time_point lastReport_;
+
+    std::jthread flusher_;
+};
+} // namespace core
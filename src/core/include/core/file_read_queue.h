@@ -0,0 +1,134 @@
+/// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Mark Rapson
+
+#pragma once
+
+#include <condition_variable>
+#include <coroutine>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <filesystem>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <stdint.h>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+namespace core
+{
+struct IoUring;
+
+// Reads whole files in the background, so a batch of small files costs one round of I/O rather than one blocking
+// read after another. On Linux reads are queued on an io_uring; where that isn't available (other platforms, old
+// kernels, sandboxes that block it) a small pool of threads does blocking reads instead. Large files are better
+// viewed through a MappedFile.
+class FileReadQueue
+{
+  public:
+    // depth bounds the number of reads in flight on the io_uring
+    explicit FileReadQueue(uint32_t depth = 64);
+
+    // Waits for every queued read to finish
+    ~FileReadQueue();
+
+    FileReadQueue(const FileReadQueue&) = delete;
+    FileReadQueue& operator=(const FileReadQueue&) = delete;
+
+    FileReadQueue(FileReadQueue&& other) = delete;
+    FileReadQueue& operator=(FileReadQueue&& other) = delete;
+
+    // Called with the file's contents, or with the std::runtime_error raised if it couldn't be read. Runs on the
+    // queue's completion thread, or on the calling thread if the file can't be opened.
+    using ReadCallback = std::function<void(std::vector<std::byte> data, std::exception_ptr error)>;
+
+    // The future throws std::runtime_error if the file can't be read. Blocks while depth reads are already in flight.
+    [[nodiscard]]
+    std::future<std::vector<std::byte>> read(const std::filesystem::path& path);
+
+    void read(const std::filesystem::path& path, ReadCallback onRead);
+
+    // Awaitable form of read(). The awaiting coroutine resumes on the completion thread, so should move anything
+    // slow elsewhere, such as with JobSystem::schedule().
+    [[nodiscard]]
+    auto readAsync(const std::filesystem::path& path)
+    {
+        struct Awaiter
+        {
+            bool await_ready() noexcept
+            {
+                return false;
+            }
+
+            void await_suspend(std::coroutine_handle<> handle)
+            {
+                // The callback may run before read() returns, and the awaiter is gone once it resumes the handle
+                queue.read(path,
+                           [this, handle](std::vector<std::byte> bytes, std::exception_ptr readError)
+                           {
+                               data = std::move(bytes);
+                               error = readError;
+                               handle.resume();
+                           });
+            }
+
+            std::vector<std::byte> await_resume()
+            {
+                if (error)
+                {
+                    std::rethrow_exception(error);
+                }
+                return std::move(data);
+            }
+
+            FileReadQueue& queue;
+            std::filesystem::path path;
+            std::vector<std::byte> data;
+            std::exception_ptr error;
+        };
+        return Awaiter{.queue = *this, .path = path, .data = {}, .error = nullptr};
+    }
+
+    bool usesIoUring() const;
+
+  private:
+    struct Request
+    {
+        std::filesystem::path path;
+        ReadCallback onRead;
+        std::vector<std::byte> data;
+        size_t offset{0};
+        int fileDescriptor{-1};
+    };
+
+    void submitRead(Request& request);
+    void finishRead(Request* request, std::exception_ptr error);
+    void failReads(std::exception_ptr error);
+    void completeReads();
+    void readQueued();
+
+  private:
+    uint32_t depth_;
+
+    // Reads still with the kernel when the completion thread gave up on the ring. The kernel may yet write into them,
+    // so they're declared before ring_ to outlive it.
+    std::vector<std::unique_ptr<Request>> abandoned_;
+    std::unique_ptr<IoUring> ring_;
+
+    std::mutex mutex_;
+    std::condition_variable readFinished_;
+    std::condition_variable readQueued_;
+    std::deque<std::unique_ptr<Request>> queued_;
+    std::unordered_set<Request*> inFlight_;
+
+    // Set once the completion thread has given up on the ring; later reads fail with it straight away
+    std::exception_ptr failure_;
+    bool stopping_{false};
+
+    // Last, so the threads are joined before anything they use is destroyed
+    std::vector<std::jthread> threads_;
+};
+} // namespace core
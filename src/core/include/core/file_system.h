@@ -14,6 +14,7 @@ std::filesystem::path getShaderDir();
 std::filesystem::path getPrefabsDir();
 std::filesystem::path getTexturesDir();
 std::filesystem::path getSkyboxesDir();
+std::filesystem::path getCacheDir();
 
 [[nodiscard]]
 std::vector<char> readBinaryFile(const std::filesystem::path& filepath);
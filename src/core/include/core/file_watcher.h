@@ -0,0 +1,38 @@
+/// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Mark Rapson
+
+#pragma once
+
+#include <filesystem>
+#include <unordered_map>
+#include <vector>
+
+namespace core
+{
+// Reports files in watched directories that were written or replaced since the last poll. Editors often save by
+// writing a temporary file and renaming it over the original, so whole directories are watched rather than files.
+// Uses inotify on Linux; elsewhere nothing is ever reported.
+class FileWatcher
+{
+  public:
+    FileWatcher();
+    ~FileWatcher();
+
+    FileWatcher(const FileWatcher&) = delete;
+    FileWatcher& operator=(const FileWatcher&) = delete;
+
+    FileWatcher(FileWatcher&& other) = delete;
+    FileWatcher& operator=(FileWatcher&& other) = delete;
+
+    // Not recursive. Watching a directory twice has no effect.
+    void watchDirectory(const std::filesystem::path& directory);
+
+    // Never blocks. Each changed file is listed once however many events it produced.
+    [[nodiscard]]
+    std::vector<std::filesystem::path> poll();
+
+  private:
+    int fileDescriptor_{-1};
+    std::unordered_map<int, std::filesystem::path> directories_;
+};
+} // namespace core
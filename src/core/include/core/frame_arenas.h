@@ -0,0 +1,60 @@
+/// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Mark Rapson
+
+#pragma once
+
+#include "core/arena.h"
+
+#include <cstddef>
+#include <memory>
+#include <stdint.h>
+#include <vector>
+
+namespace core
+{
+// Arenas for data that lives no longer than a frame, one per thread for each of frameCount frames. Starting a frame
+// resets only the arenas of the frame frameCount frames back, so anything allocated during the frames still being
+// consumed, by the GPU or by another thread, stays valid. Once the arenas have grown to fit a frame, later frames
+// allocate without touching the heap.
+//
+// Arenas are pmr memory resources; std::pmr containers constructed with one allocate from it.
+class FrameArenas
+{
+  public:
+    // One more than the renderer's frames in flight, so the frame being recorded never shares arenas with either of
+    // the frames still executing
+    static constexpr auto frameCount = uint32_t{3};
+
+    explicit FrameArenas(uint32_t threadCount, size_t blockSize = Arena::defaultBlockSize);
+
+    FrameArenas(const FrameArenas&) = delete;
+    FrameArenas& operator=(const FrameArenas&) = delete;
+
+    FrameArenas(FrameArenas&& other) = delete;
+    FrameArenas& operator=(FrameArenas&& other) = delete;
+
+    // Moves on to the next frame, invalidating everything allocated frameCount frames ago. Not thread safe; call
+    // once per frame while no other thread is allocating.
+    void beginFrame();
+
+    // The current frame's arena for a thread; for job system threads, pass JobSystem::threadIndex()
+    Arena& arena(uint32_t threadIndex = 0);
+
+    // Frames begun so far
+    uint64_t frameNumber() const;
+
+    // Largest bytesUsed() any single thread reached in any frame
+    size_t peakBytesUsed() const;
+
+    // Bytes held in blocks across all frames and threads
+    size_t bytesReserved() const;
+
+  private:
+    uint32_t threadCount_;
+    uint64_t frameNumber_{0};
+
+    // frameCount groups of threadCount arenas. Allocated separately so threads don't share the cache line holding
+    // their arena's bump pointer.
+    std::vector<std::unique_ptr<Arena>> arenas_;
+};
+} // namespace core
@@ -0,0 +1,24 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Mark Rapson
+
+#pragma once
+
+#include <cstddef>
+#include <ranges>
+#include <span>
+#include <stdint.h>
+#include <type_traits>
+
+namespace core
+{
+// 64-bit xxHash (XXH64). Chain hashes by passing a previous result as the seed.
+uint64_t xxHash64(std::span<const std::byte> data, uint64_t seed = 0);
+
+template <std::ranges::contiguous_range Range>
+uint64_t xxHash64(const Range& values, uint64_t seed = 0)
+{
+    static_assert(std::is_trivially_copyable_v<std::ranges::range_value_t<Range>>,
+                  "Only trivially copyable values can be hashed as bytes");
+    return xxHash64(std::as_bytes(std::span{std::ranges::data(values), std::ranges::size(values)}), seed);
+}
+} // namespace core
@@ -0,0 +1,141 @@
+/// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Mark Rapson
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <coroutine>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stdint.h>
+#include <thread>
+#include <vector>
+
+namespace core
+{
+template <typename T>
+class WorkStealingDeque;
+
+struct JobSystemConfig
+{
+    // Threads started besides the one creating the job system, which runs jobs whenever it waits
+    uint32_t workerCount{std::max(std::thread::hardware_concurrency(), 2u) - 1};
+
+    // Pins worker i to logical CPU i + 1, leaving CPU 0 to the creating thread. Only supported on Linux.
+    bool pinWorkers{false};
+};
+
+// Tracks the unfinished jobs of one fork/join batch, along with the first exception any of them threw
+class JobCounter
+{
+  public:
+    bool done() const;
+
+  private:
+    friend class JobSystem;
+
+    void recordError(std::exception_ptr error);
+
+  private:
+    std::atomic<uint32_t> pending_{0};
+    std::mutex errorMutex_;
+    std::exception_ptr error_;
+};
+
+// Fixed pool of threads running short jobs. Each thread queues the jobs it creates on its own work-stealing deque
+// and steals from the others once that runs dry, so nested fork/join work spreads without a shared queue. Jobs
+// created on threads outside the system go on a shared injection queue. A thread waiting on a counter keeps running
+// jobs until the counter reaches zero, so waiting never blocks a worker.
+class JobSystem
+{
+  public:
+    explicit JobSystem(const JobSystemConfig& config = {});
+
+    // Finishes every queued job before returning
+    ~JobSystem();
+
+    JobSystem(const JobSystem&) = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+
+    JobSystem(JobSystem&& other) = delete;
+    JobSystem& operator=(JobSystem&& other) = delete;
+
+    // Queues a job to run on any thread. counter must outlive the job; wait() on it to join.
+    void run(JobCounter& counter, std::function<void()> job);
+
+    // Runs queued jobs on this thread until every job counted by counter has finished, then rethrows the first
+    // exception any of them threw
+    void wait(JobCounter& counter);
+
+    // Calls body(begin, end) over ranges of at most grainSize covering [0, count), then waits for all of them. The
+    // range is split in halves so idle threads steal large pieces first.
+    void parallelFor(size_t count, size_t grainSize, const std::function<void(size_t, size_t)>& body);
+
+    // Awaitable that resumes the awaiting coroutine as a job on this system
+    [[nodiscard]]
+    auto schedule()
+    {
+        struct Awaiter
+        {
+            bool await_ready() noexcept
+            {
+                return false;
+            }
+
+            void await_suspend(std::coroutine_handle<> handle)
+            {
+                jobSystem.run(jobSystem.detachedJobs_, [handle] { handle.resume(); });
+            }
+
+            void await_resume() noexcept
+            {
+            }
+
+            JobSystem& jobSystem;
+        };
+        return Awaiter{*this};
+    }
+
+    // Threads running jobs, counting the creating thread
+    uint32_t threadCount() const;
+
+    // Index in [0, threadCount()) of the calling thread, for indexing per-thread data; the creating thread is 0.
+    // Throws for threads outside the system.
+    uint32_t threadIndex() const;
+
+  private:
+    struct Job
+    {
+        std::function<void()> task;
+        JobCounter* counter;
+    };
+
+    void workerLoop(uint32_t index);
+    bool runJob();
+    Job* findJob();
+    void execute(Job* job);
+
+  private:
+    // One per thread; the creating thread's is first
+    std::vector<std::unique_ptr<WorkStealingDeque<Job*>>> deques_;
+
+    // Counts jobs nobody waits on, such as coroutines resumed by schedule()
+    JobCounter detachedJobs_;
+
+    std::mutex injectedMutex_;
+    std::deque<Job*> injected_;
+    std::atomic<size_t> injectedCount_{0};
+
+    // Bumped whenever work is queued, for idle workers to sleep on
+    std::atomic<uint64_t> workEpoch_{0};
+    std::atomic<uint32_t> sleepingWorkers_{0};
+    std::atomic<bool> stopping_{false};
+
+    std::vector<std::jthread> workers_;
+};
+} // namespace core
@@ -0,0 +1,40 @@
+/// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Mark Rapson
+
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+#include <span>
+#include <vector>
+
+namespace core
+{
+// Read-only view of a whole file. The file is memory mapped, so pages are read on first touch and never copied into
+// a separate buffer; where mapping isn't available it is read into memory instead.
+class MappedFile
+{
+  public:
+    // Throws std::runtime_error if the file can't be opened or mapped
+    explicit MappedFile(const std::filesystem::path& path);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+
+    std::span<const std::byte> bytes() const;
+    size_t size() const;
+
+  private:
+    void unmap();
+
+  private:
+    const std::byte* data_{nullptr};
+    size_t size_{0};
+    bool mapped_{false};
+    std::vector<std::byte> buffer_;
+};
+} // namespace core
@@ -0,0 +1,39 @@
+/// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Mark Rapson
+
+#pragma once
+
+#include <cstddef>
+#include <map>
+
+namespace core
+{
+// Hands out ranges of elements in a linear resource the caller owns, such as a buffer shared by many meshes, and takes
+// them back for reuse. Free ranges are merged with their neighbours and reused first fit, so the lowest free space is
+// filled first. Freeing the ranges at the end moves end() back, which tells the owner how much of the resource is
+// still needed. Not thread safe.
+class RangeAllocator
+{
+  public:
+    // Offset of the first of count elements. Allocating nothing returns end() without taking anything.
+    size_t allocate(size_t count);
+
+    // Takes back a range returned by allocate()
+    void free(size_t offset, size_t count);
+
+    // Forgets every range
+    void reset();
+
+    // One past the last element allocated
+    size_t end() const;
+
+    // Elements in allocated ranges
+    size_t allocated() const;
+
+  private:
+    // Count of free elements by offset, all before end_
+    std::map<size_t, size_t> freeRanges_;
+    size_t end_{0};
+    size_t allocated_{0};
+};
+} // namespace core
@@ -0,0 +1,247 @@
+/// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Mark Rapson
+
+#pragma once
+
+#include <coroutine>
+#include <exception>
+#include <future>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+namespace core
+{
+template <typename T>
+class Task;
+
+// Where a finished task keeps its value or exception until whoever awaited it takes it
+template <typename T>
+class TaskResult
+{
+  public:
+    template <typename U>
+    void return_value(U&& value)
+    {
+        value_.emplace(std::forward<U>(value));
+    }
+
+    void unhandled_exception()
+    {
+        error_ = std::current_exception();
+    }
+
+    T take()
+    {
+        if (error_)
+        {
+            std::rethrow_exception(error_);
+        }
+        return std::move(*value_);
+    }
+
+  private:
+    std::optional<T> value_;
+    std::exception_ptr error_;
+};
+
+template <>
+class TaskResult<void>
+{
+  public:
+    void return_void()
+    {
+    }
+
+    void unhandled_exception()
+    {
+        error_ = std::current_exception();
+    }
+
+    void take()
+    {
+        if (error_)
+        {
+            std::rethrow_exception(error_);
+        }
+    }
+
+  private:
+    std::exception_ptr error_;
+};
+
+// Coroutine producing a T. Tasks are lazy: nothing runs until the task is awaited, at which point the awaiting
+// coroutine is suspended and resumed on whichever thread the task finishes on. Where a task resumes after each of its
+// own co_awaits depends on what it awaits; JobSystem::schedule() moves it onto the job system. Exceptions propagate
+// to the awaiter. Top-level tasks are started with startTask().
+template <typename T = void>
+class [[nodiscard]] Task
+{
+  public:
+    struct promise_type : TaskResult<T>
+    {
+        Task get_return_object()
+        {
+            return Task{std::coroutine_handle<promise_type>::from_promise(*this)};
+        }
+
+        std::suspend_always initial_suspend() noexcept
+        {
+            return {};
+        }
+
+        // Hands the thread straight to the awaiter rather than returning up the stack, so long chains of tasks
+        // finishing synchronously don't overflow it
+        auto final_suspend() noexcept
+        {
+            struct FinalAwaiter
+            {
+                bool await_ready() noexcept
+                {
+                    return false;
+                }
+
+                std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type> handle) noexcept
+                {
+                    return handle.promise().continuation;
+                }
+
+                void await_resume() noexcept
+                {
+                }
+            };
+            return FinalAwaiter{};
+        }
+
+        std::coroutine_handle<> continuation{std::noop_coroutine()};
+    };
+
+    Task(const Task&) = delete;
+    Task& operator=(const Task&) = delete;
+
+    Task(Task&& other) noexcept
+        : handle_{std::exchange(other.handle_, nullptr)}
+    {
+    }
+
+    Task& operator=(Task&& other) noexcept
+    {
+        if (this != &other)
+        {
+            if (handle_)
+            {
+                handle_.destroy();
+            }
+            handle_ = std::exchange(other.handle_, nullptr);
+        }
+        return *this;
+    }
+
+    ~Task()
+    {
+        if (handle_)
+        {
+            handle_.destroy();
+        }
+    }
+
+    auto operator co_await() && noexcept
+    {
+        struct Awaiter
+        {
+            bool await_ready() noexcept
+            {
+                return false;
+            }
+
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept
+            {
+                handle.promise().continuation = awaiting;
+                return handle;
+            }
+
+            T await_resume()
+            {
+                return handle.promise().take();
+            }
+
+            std::coroutine_handle<promise_type> handle;
+        };
+        return Awaiter{handle_};
+    }
+
+  private:
+    explicit Task(std::coroutine_handle<promise_type> handle)
+        : handle_{handle}
+    {
+    }
+
+  private:
+    std::coroutine_handle<promise_type> handle_;
+};
+
+// Coroutine that starts straight away and frees itself when it finishes, for driving a task from code that isn't a
+// coroutine
+struct DetachedTask
+{
+    struct promise_type
+    {
+        DetachedTask get_return_object()
+        {
+            return {};
+        }
+
+        std::suspend_never initial_suspend() noexcept
+        {
+            return {};
+        }
+
+        std::suspend_never final_suspend() noexcept
+        {
+            return {};
+        }
+
+        void return_void()
+        {
+        }
+
+        // Callers catch everything themselves
+        void unhandled_exception()
+        {
+            std::terminate();
+        }
+    };
+};
+
+template <typename T>
+DetachedTask runTask(Task<T> task, std::promise<T> promise)
+{
+    try
+    {
+        if constexpr (std::is_void_v<T>)
+        {
+            co_await std::move(task);
+            promise.set_value();
+        }
+        else
+        {
+            promise.set_value(co_await std::move(task));
+        }
+    }
+    catch (...)
+    {
+        promise.set_exception(std::current_exception());
+    }
+}
+
+// Runs the task on this thread up to its first suspension and returns a future for its result. The future doesn't
+// wait for the task when destroyed, so anything the task uses must outlive it.
+template <typename T>
+std::future<T> startTask(Task<T> task)
+{
+    auto promise = std::promise<T>{};
+    auto future = promise.get_future();
+    runTask(std::move(task), std::move(promise));
+    return future;
+}
+} // namespace core
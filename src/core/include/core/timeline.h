@@ -0,0 +1,65 @@
+/// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Mark Rapson
+
+#pragma once
+
+#include <atomic>
+#include <coroutine>
+#include <mutex>
+#include <stdint.h>
+#include <vector>
+
+namespace core
+{
+// Counter that only goes up, for coroutines to wait on a value, such as the number of frames the GPU has finished.
+// Mirrors a timeline semaphore on the CPU side, owned by whatever learns of progress.
+class Timeline
+{
+  public:
+    uint64_t value() const;
+
+    // Raises the value and resumes every coroutine waiting for it, on this thread. Lower values are ignored.
+    void signal(uint64_t value);
+
+    // Awaitable that resumes the awaiting coroutine once the timeline reaches value, straight away if it already has
+    [[nodiscard]]
+    auto wait(uint64_t value)
+    {
+        struct Awaiter
+        {
+            bool await_ready() const noexcept
+            {
+                return timeline.value() >= target;
+            }
+
+            bool await_suspend(std::coroutine_handle<> handle)
+            {
+                return timeline.addWaiter(target, handle);
+            }
+
+            void await_resume() noexcept
+            {
+            }
+
+            Timeline& timeline;
+            uint64_t target;
+        };
+        return Awaiter{*this, value};
+    }
+
+  private:
+    struct Waiter
+    {
+        uint64_t target;
+        std::coroutine_handle<> handle;
+    };
+
+    // False if the value was reached in the meantime, in which case the caller carries on
+    bool addWaiter(uint64_t target, std::coroutine_handle<> handle);
+
+  private:
+    std::atomic<uint64_t> value_{0};
+    std::mutex mutex_;
+    std::vector<Waiter> waiters_;
+};
+} // namespace core
@@ -0,0 +1,281 @@
+/// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Mark Rapson
+
+#include "core/allocation_tracker.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <atomic>
+#include <cstdlib>
+#include <mutex>
+#include <new>
+
+namespace core
+{
+#ifdef VULKAN_DEMO_TRACK_ALLOCATIONS
+// Plain thread_locals with constant initialisation, so operator new can use them before any constructor has run
+thread_local uint64_t threadAllocationCount = 0;
+thread_local uint64_t threadDeallocationCount = 0;
+thread_local uint64_t threadAllocatedBytes = 0;
+
+// Set while the tracker allocates for its own bookkeeping, which shouldn't show up in any zone
+thread_local bool trackerAllocating = false;
+
+std::atomic<uint64_t> processAllocationCount{0};
+std::atomic<uint64_t> processDeallocationCount{0};
+std::atomic<uint64_t> processAllocatedBytes{0};
+
+std::mutex zoneStatsMutex;
+std::vector<AllocationZoneStats> zoneStats;
+
+void countAllocation(size_t bytes)
+{
+    if (trackerAllocating)
+    {
+        return;
+    }
+
+    ++threadAllocationCount;
+    threadAllocatedBytes += bytes;
+    processAllocationCount.fetch_add(1, std::memory_order_relaxed);
+    processAllocatedBytes.fetch_add(bytes, std::memory_order_relaxed);
+}
+
+void countDeallocation(void* pointer)
+{
+    if (trackerAllocating || !pointer)
+    {
+        return;
+    }
+
+    ++threadDeallocationCount;
+    processDeallocationCount.fetch_add(1, std::memory_order_relaxed);
+}
+
+void* trackedAllocate(size_t bytes, size_t alignment)
+{
+    countAllocation(bytes);
+
+    const auto size = std::max<size_t>(bytes, 1);
+    if (alignment <= alignof(std::max_align_t))
+    {
+        return std::malloc(size);
+    }
+
+#ifdef _WIN32
+    return _aligned_malloc(size, alignment);
+#else
+    // aligned_alloc wants a size that is a multiple of the alignment
+    return std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment);
+#endif
+}
+
+void trackedFree(void* pointer, [[maybe_unused]] size_t alignment)
+{
+    countDeallocation(pointer);
+
+#ifdef _WIN32
+    if (alignment > alignof(std::max_align_t))
+    {
+        _aligned_free(pointer);
+        return;
+    }
+#endif
+    std::free(pointer);
+}
+#endif
+
+bool allocationTrackingEnabled()
+{
+#ifdef VULKAN_DEMO_TRACK_ALLOCATIONS
+    return true;
+#else
+    return false;
+#endif
+}
+
+AllocationCounts threadAllocations()
+{
+#ifdef VULKAN_DEMO_TRACK_ALLOCATIONS
+    return AllocationCounts{.allocations = threadAllocationCount,
+                            .deallocations = threadDeallocationCount,
+                            .bytes = threadAllocatedBytes};
+#else
+    return {};
+#endif
+}
+
+AllocationCounts processAllocations()
+{
+#ifdef VULKAN_DEMO_TRACK_ALLOCATIONS
+    return AllocationCounts{.allocations = processAllocationCount.load(std::memory_order_relaxed),
+                            .deallocations = processDeallocationCount.load(std::memory_order_relaxed),
+                            .bytes = processAllocatedBytes.load(std::memory_order_relaxed)};
+#else
+    return {};
+#endif
+}
+
+AllocationZone::AllocationZone(const char* name)
+    : name_{name}
+    , start_{threadAllocations()}
+{
+}
+
+AllocationZone::~AllocationZone()
+{
+#ifdef VULKAN_DEMO_TRACK_ALLOCATIONS
+    const auto end = threadAllocations();
+    const auto counts = AllocationCounts{.allocations = end.allocations - start_.allocations,
+                                         .deallocations = end.deallocations - start_.deallocations,
+                                         .bytes = end.bytes - start_.bytes};
+
+    trackerAllocating = true;
+    {
+        auto lock = std::lock_guard{zoneStatsMutex};
+        const auto thread = std::this_thread::get_id();
+        auto stats = std::ranges::find_if(zoneStats,
+                                          [&](const AllocationZoneStats& zone)
+                                          { return zone.thread == thread && zone.name == name_; });
+        if (stats == zoneStats.end())
+        {
+            auto& added = zoneStats.emplace_back();
+            added.name = name_;
+            added.thread = thread;
+            stats = zoneStats.end() - 1;
+        }
+
+        stats->entries++;
+        stats->allocatingEntries += counts.allocations > 0 ? 1 : 0;
+        stats->counts.allocations += counts.allocations;
+        stats->counts.deallocations += counts.deallocations;
+        stats->counts.bytes += counts.bytes;
+    }
+    trackerAllocating = false;
+#endif
+}
+
+void takeAllocationZoneStats(std::vector<AllocationZoneStats>& stats)
+{
+#ifdef VULKAN_DEMO_TRACK_ALLOCATIONS
+    // The zones stay registered with their counts cleared, so a zone entered every frame doesn't allocate its entry
+    // again each time
+    trackerAllocating = true;
+    {
+        auto lock = std::lock_guard{zoneStatsMutex};
+        auto taken = size_t{0};
+        for (auto& zone : zoneStats)
+        {
+            if (zone.entries > 0)
+            {
+                if (taken == stats.size())
+                {
+                    stats.emplace_back();
+                }
+                stats[taken++] = zone;
+            }
+            zone.entries = 0;
+            zone.allocatingEntries = 0;
+            zone.counts = {};
+        }
+        stats.resize(taken);
+    }
+    trackerAllocating = false;
+#else
+    stats.clear();
+#endif
+}
+} // namespace core
+
+#ifdef VULKAN_DEMO_TRACK_ALLOCATIONS
+// Replacing these in the same translation unit as the functions above means any program using the tracker links them
+// in. Every other global form of new and delete forwards to one of these.
+
+void* operator new(size_t bytes)
+{
+    if (auto* pointer = core::trackedAllocate(bytes, alignof(std::max_align_t)))
+    {
+        return pointer;
+    }
+    throw std::bad_alloc{};
+}
+
+void* operator new(size_t bytes, std::align_val_t alignment)
+{
+    if (auto* pointer = core::trackedAllocate(bytes, static_cast<size_t>(alignment)))
+    {
+        return pointer;
+    }
+    throw std::bad_alloc{};
+}
+
+void* operator new(size_t bytes, const std::nothrow_t&) noexcept
+{
+    return core::trackedAllocate(bytes, alignof(std::max_align_t));
+}
+
+void* operator new(size_t bytes, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+    return core::trackedAllocate(bytes, static_cast<size_t>(alignment));
+}
+
+void* operator new[](size_t bytes)
+{
+    return operator new(bytes);
+}
+
+void* operator new[](size_t bytes, std::align_val_t alignment)
+{
+    return operator new(bytes, alignment);
+}
+
+void* operator new[](size_t bytes, const std::nothrow_t& tag) noexcept
+{
+    return operator new(bytes, tag);
+}
+
+void* operator new[](size_t bytes, std::align_val_t alignment, const std::nothrow_t& tag) noexcept
+{
+    return operator new(bytes, alignment, tag);
+}
+
+void operator delete(void* pointer) noexcept
+{
+    core::trackedFree(pointer, alignof(std::max_align_t));
+}
+
+void operator delete(void* pointer, size_t) noexcept
+{
+    core::trackedFree(pointer, alignof(std::max_align_t));
+}
+
+void operator delete(void* pointer, std::align_val_t alignment) noexcept
+{
+    core::trackedFree(pointer, static_cast<size_t>(alignment));
+}
+
+void operator delete(void* pointer, size_t, std::align_val_t alignment) noexcept
+{
+    core::trackedFree(pointer, static_cast<size_t>(alignment));
+}
+
+void operator delete[](void* pointer) noexcept
+{
+    core::trackedFree(pointer, alignof(std::max_align_t));
+}
+
+void operator delete[](void* pointer, size_t) noexcept
+{
+    core::trackedFree(pointer, alignof(std::max_align_t));
+}
+
+void operator delete[](void* pointer, std::align_val_t alignment) noexcept
+{
+    core::trackedFree(pointer, static_cast<size_t>(alignment));
+}
+
+void operator delete[](void* pointer, size_t, std::align_val_t alignment) noexcept
+{
+    core::trackedFree(pointer, static_cast<size_t>(alignment));
+}
+#endif
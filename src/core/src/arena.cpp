@@ -0,0 +1,89 @@
+/// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Mark Rapson
+
+#include "core/arena.h"
+
+#include <algorithm>
+#include <bit>
+#include <stdint.h>
+
+namespace core
+{
+Arena::Arena(size_t blockSize)
+    : blockSize_{std::max<size_t>(blockSize, 1)}
+{
+}
+
+void Arena::reset()
+{
+    currentBlock_ = 0;
+    offset_ = 0;
+    bytesUsed_ = 0;
+}
+
+void Arena::release()
+{
+    blocks_.clear();
+    reset();
+}
+
+size_t Arena::bytesUsed() const
+{
+    return bytesUsed_;
+}
+
+size_t Arena::peakBytesUsed() const
+{
+    return peakBytesUsed_;
+}
+
+size_t Arena::bytesReserved() const
+{
+    auto bytes = size_t{0};
+    for (const auto& block : blocks_)
+    {
+        bytes += block.size;
+    }
+    return bytes;
+}
+
+void* Arena::do_allocate(size_t bytes, size_t alignment)
+{
+    // Walks forward through blocks kept by reset() before growing, skipping any too small for this allocation
+    while (currentBlock_ < blocks_.size())
+    {
+        auto& block = blocks_[currentBlock_];
+        const auto address = std::bit_cast<uintptr_t>(block.data.get()) + offset_;
+        const auto padding = (alignment - address % alignment) % alignment;
+        if (offset_ + padding + bytes <= block.size)
+        {
+            auto* pointer = block.data.get() + offset_ + padding;
+            offset_ += padding + bytes;
+            bytesUsed_ += padding + bytes;
+            peakBytesUsed_ = std::max(peakBytesUsed_, bytesUsed_);
+            return pointer;
+        }
+
+        ++currentBlock_;
+        offset_ = 0;
+    }
+
+    // Doubling the block size keeps the number of heap allocations logarithmic in the total size
+    const auto previousSize = blocks_.empty() ? blockSize_ / 2 : blocks_.back().size;
+    const auto size = std::max(previousSize * 2, bytes + alignment);
+    blocks_.push_back(Block{.data = std::make_unique_for_overwrite<std::byte[]>(size), .size = size});
+    currentBlock_ = blocks_.size() - 1;
+    offset_ = 0;
+
+    return do_allocate(bytes, alignment);
+}
+
+void Arena::do_deallocate(void*, size_t, size_t)
+{
+}
+
+bool Arena::do_is_equal(const std::pmr::memory_resource& other) const noexcept
+{
+    return this == &other;
+}
+} // namespace core
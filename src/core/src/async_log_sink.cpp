@@ -0,0 +1,306 @@
+/// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Mark Rapson
+
+#include "core/async_log_sink.h"
+
+#include <spdlog/details/log_msg.h>
+#include <spdlog/details/os.h>
+#include <spdlog/fmt/fmt.h>
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <functional>
+#include <stdexcept>
+
+namespace core
+{
+// How long the flusher sleeps once the ring is empty; also the longest flush() waits for it to wake
+constexpr auto flushInterval = std::chrono::milliseconds{10};
+
+// How often dropped and rate-limited messages are reported
+constexpr auto reportInterval = std::chrono::seconds{1};
+
+constexpr auto rateWindow = std::chrono::seconds{1};
+
+AsyncLogSink::AsyncLogSink(std::shared_ptr<spdlog::sinks::sink> target, size_t capacity)
+    : target_{std::move(target)}
+    , slots_{std::make_unique<Slot[]>(capacity)}
+    , mask_{capacity - 1}
+    , lastReport_{std::chrono::steady_clock::now()}
+{
+    if (!std::has_single_bit(capacity))
+    {
+        throw std::runtime_error("Log ring capacity must be a power of two");
+    }
+
+    for (auto i = size_t{0}; i < capacity; ++i)
+    {
+        slots_[i].sequence.store(i, std::memory_order_relaxed);
+    }
+
+    flusher_ = std::jthread([this](std::stop_token stopToken) { flusherLoop(stopToken); });
+}
+
+AsyncLogSink::~AsyncLogSink()
+{
+    flusher_.request_stop();
+    flusher_.join();
+}
+
+void AsyncLogSink::log(const spdlog::details::log_msg& message)
+{
+    if (!should_log(message.level))
+    {
+        return;
+    }
+
+    // Claim the next slot, unless the flusher hasn't freed it yet
+    auto position = enqueuePosition_.load(std::memory_order_relaxed);
+    auto* slot = static_cast<Slot*>(nullptr);
+    while (true)
+    {
+        slot = &slots_[position & mask_];
+        const auto sequence = slot->sequence.load(std::memory_order_acquire);
+        const auto difference = static_cast<int64_t>(sequence - position);
+        if (difference == 0)
+        {
+            if (enqueuePosition_.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+            {
+                break;
+            }
+        }
+        else if (difference < 0)
+        {
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        else
+        {
+            position = enqueuePosition_.load(std::memory_order_relaxed);
+        }
+    }
+
+    auto& entry = slot->entry;
+    entry.time = message.time;
+    entry.threadId = message.thread_id;
+    entry.level = message.level;
+    entry.size = static_cast<uint32_t>(std::min(message.payload.size(), maxMessageSize));
+    std::memcpy(entry.text.data(), message.payload.data(), entry.size);
+
+    slot->sequence.store(position + 1, std::memory_order_release);
+}
+
+void AsyncLogSink::flush()
+{
+    // The flusher keeps flushing and publishing its progress for as long as anyone is waiting, so a target that
+    // covers slots still being written by other producers is reached on a later pass rather than never
+    const auto target = enqueuePosition_.load();
+    flushWaiters_.fetch_add(1);
+
+    auto flushed = flushedThrough_.load();
+    while (flushed < target)
+    {
+        flushedThrough_.wait(flushed);
+        flushed = flushedThrough_.load();
+    }
+
+    flushWaiters_.fetch_sub(1);
+}
+
+void AsyncLogSink::set_pattern(const std::string& pattern)
+{
+    auto lock = std::lock_guard{targetMutex_};
+    target_->set_pattern(pattern);
+}
+
+void AsyncLogSink::set_formatter(std::unique_ptr<spdlog::formatter> formatter)
+{
+    auto lock = std::lock_guard{targetMutex_};
+    target_->set_formatter(std::move(formatter));
+}
+
+uint64_t AsyncLogSink::droppedCount() const
+{
+    return dropped_.load(std::memory_order_relaxed);
+}
+
+uint64_t AsyncLogSink::suppressedCount() const
+{
+    return suppressed_.load(std::memory_order_relaxed);
+}
+
+bool AsyncLogSink::writeNext()
+{
+    const auto position = dequeuePosition_.load(std::memory_order_relaxed);
+    auto& slot = slots_[position & mask_];
+    if (slot.sequence.load(std::memory_order_acquire) != position + 1)
+    {
+        return false;
+    }
+
+    write(slot.entry);
+
+    // Hand the slot back to producers for the next lap of the ring
+    slot.sequence.store(position + mask_ + 1, std::memory_order_release);
+    dequeuePosition_.store(position + 1, std::memory_order_relaxed);
+    return true;
+}
+
+void AsyncLogSink::flusherLoop(std::stop_token stopToken)
+{
+    while (true)
+    {
+        auto wroteAny = false;
+        while (writeNext())
+        {
+            wroteAny = true;
+        }
+
+        const auto stopping = stopToken.stop_requested();
+        const auto now = std::chrono::steady_clock::now();
+        if (now - lastReport_ >= reportInterval || stopping)
+        {
+            report(now);
+        }
+
+        // Repeat counts are written once the run of repeats ends or the ring goes quiet, whichever is first
+        const auto flushWanted = flushWaiters_.load() > 0;
+        if (!wroteAny || stopping || flushWanted)
+        {
+            writeRepeats();
+        }
+
+        if (flushWanted || stopping)
+        {
+            {
+                auto lock = std::lock_guard{targetMutex_};
+                target_->flush();
+            }
+            flushedThrough_.store(stopping ? UINT64_MAX : dequeuePosition_.load(std::memory_order_relaxed));
+            flushedThrough_.notify_all();
+        }
+
+        if (stopping)
+        {
+            return;
+        }
+
+        if (!wroteAny)
+        {
+            std::this_thread::sleep_for(flushInterval);
+        }
+    }
+}
+
+void AsyncLogSink::write(const Entry& entry)
+{
+    const auto text = std::string_view{entry.text.data(), entry.size};
+    const auto hash = std::hash<std::string_view>{}(text);
+
+    if (hash == lastHash_ && entry.level == lastEntry_.level
+        && text == std::string_view{lastEntry_.text.data(), lastEntry_.size})
+    {
+        ++lastRepeats_;
+        suppressed_.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    writeRepeats();
+
+    if (!allowedByRateLimit(hash, std::chrono::steady_clock::now()))
+    {
+        suppressed_.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    auto message = spdlog::details::log_msg{entry.time, spdlog::source_loc{}, "", entry.level, text};
+    message.thread_id = entry.threadId;
+    {
+        auto lock = std::lock_guard{targetMutex_};
+        target_->log(message);
+    }
+
+    lastEntry_ = entry;
+    lastHash_ = hash;
+}
+
+void AsyncLogSink::writeRepeats()
+{
+    if (lastRepeats_ == 0)
+    {
+        return;
+    }
+
+    writeNotice(lastEntry_.level, fmt::format("Last message repeated {} more times", lastRepeats_));
+    lastRepeats_ = 0;
+}
+
+void AsyncLogSink::writeNotice(spdlog::level::level_enum level, std::string_view text)
+{
+    auto message = spdlog::details::log_msg{spdlog::log_clock::now(), spdlog::source_loc{}, "", level, text};
+    message.thread_id = spdlog::details::os::thread_id();
+
+    auto lock = std::lock_guard{targetMutex_};
+    target_->log(message);
+}
+
+void AsyncLogSink::report(std::chrono::steady_clock::time_point now)
+{
+    lastReport_ = now;
+
+    const auto dropped = dropped_.load(std::memory_order_relaxed);
+    if (dropped > reportedDropped_)
+    {
+        writeNotice(spdlog::level::warn,
+                    fmt::format("Dropped {} log messages while the log queue was full", dropped - reportedDropped_));
+        reportedDropped_ = dropped;
+    }
+
+    // Closes finished windows, so the table only holds messages seen in the last second
+    auto rateLimited = uint64_t{0};
+    std::erase_if(rateWindows_,
+                  [&](const auto& window)
+                  {
+                      if (now - window.second.start < rateWindow)
+                      {
+                          return false;
+                      }
+                      rateLimited += window.second.suppressed;
+                      return true;
+                  });
+
+    if (rateLimited > 0)
+    {
+        writeNotice(spdlog::level::warn,
+                    fmt::format("Suppressed {} log messages repeated more than {} times a second",
+                                rateLimited,
+                                maxRepeatsPerSecond));
+    }
+}
+
+bool AsyncLogSink::allowedByRateLimit(size_t hash, std::chrono::steady_clock::time_point now)
+{
+    auto [window, inserted] = rateWindows_.try_emplace(hash, RateWindow{.start = now, .count = 0, .suppressed = 0});
+    if (!inserted && now - window->second.start >= rateWindow)
+    {
+        if (window->second.suppressed > 0)
+        {
+            writeNotice(spdlog::level::warn,
+                        fmt::format("Suppressed {} log messages repeated more than {} times a second",
+                                    window->second.suppressed,
+                                    maxRepeatsPerSecond));
+        }
+        window->second = RateWindow{.start = now, .count = 0, .suppressed = 0};
+    }
+
+    if (window->second.count < maxRepeatsPerSecond)
+    {
+        ++window->second.count;
+        return true;
+    }
+
+    ++window->second.suppressed;
+    return false;
+}
+} // namespace core
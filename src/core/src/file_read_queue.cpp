@@ -0,0 +1,515 @@
+/// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Mark Rapson
+
+#include "core/file_read_queue.h"
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+#include <string>
+
+namespace core
+{
+// Completion tag of the no-op submitted to wake the completion thread for shutdown
+constexpr auto wakeTag = uint64_t{0};
+
+// Threads doing blocking reads when there's no io_uring; reads are I/O bound, so a few go a long way
+constexpr auto maxReadThreads = 4u;
+
+#ifdef __linux__
+// The submission and completion rings of an io_uring, driven through the raw system calls
+struct IoUring
+{
+    int fileDescriptor{-1};
+
+    void* submissionRing{MAP_FAILED};
+    size_t submissionRingSize{0};
+    void* completionRing{MAP_FAILED};
+    size_t completionRingSize{0};
+    io_uring_sqe* entries{static_cast<io_uring_sqe*>(MAP_FAILED)};
+    size_t entriesSize{0};
+
+    unsigned* submissionTail{nullptr};
+    unsigned* submissionMask{nullptr};
+    unsigned* submissionArray{nullptr};
+    unsigned* completionHead{nullptr};
+    unsigned* completionTail{nullptr};
+    unsigned* completionMask{nullptr};
+    io_uring_cqe* completions{nullptr};
+
+    ~IoUring()
+    {
+        if (entries != MAP_FAILED)
+        {
+            munmap(entries, entriesSize);
+        }
+
+        if (completionRing != MAP_FAILED && completionRing != submissionRing)
+        {
+            munmap(completionRing, completionRingSize);
+        }
+
+        if (submissionRing != MAP_FAILED)
+        {
+            munmap(submissionRing, submissionRingSize);
+        }
+
+        if (fileDescriptor >= 0)
+        {
+            close(fileDescriptor);
+        }
+    }
+};
+
+template <typename T>
+T* ringField(void* ring, uint32_t offset)
+{
+    return reinterpret_cast<T*>(static_cast<std::byte*>(ring) + offset);
+}
+
+int enterIoUring(int fileDescriptor, unsigned submitCount, unsigned waitCount, unsigned flags)
+{
+    return static_cast<int>(syscall(__NR_io_uring_enter, fileDescriptor, submitCount, waitCount, flags, nullptr, 0));
+}
+
+// Null if the kernel doesn't offer io_uring with IORING_OP_READ, or forbids it
+std::unique_ptr<IoUring> createIoUring(uint32_t depth)
+{
+    auto params = io_uring_params{};
+    auto ring = std::make_unique<IoUring>();
+    ring->fileDescriptor = static_cast<int>(syscall(__NR_io_uring_setup, depth, &params));
+    if (ring->fileDescriptor < 0)
+    {
+        return nullptr;
+    }
+
+    // IORING_OP_READ arrived in the same kernel (5.6) as this feature flag
+    if (!(params.features & IORING_FEAT_RW_CUR_POS))
+    {
+        return nullptr;
+    }
+
+    ring->submissionRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    ring->completionRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+
+    // Newer kernels map both rings with one call
+    const auto singleMapping = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+    if (singleMapping)
+    {
+        ring->submissionRingSize = std::max(ring->submissionRingSize, ring->completionRingSize);
+    }
+
+    ring->submissionRing = mmap(nullptr,
+                                ring->submissionRingSize,
+                                PROT_READ | PROT_WRITE,
+                                MAP_SHARED | MAP_POPULATE,
+                                ring->fileDescriptor,
+                                IORING_OFF_SQ_RING);
+    if (ring->submissionRing == MAP_FAILED)
+    {
+        return nullptr;
+    }
+
+    if (singleMapping)
+    {
+        ring->completionRing = ring->submissionRing;
+    }
+    else
+    {
+        ring->completionRing = mmap(nullptr,
+                                    ring->completionRingSize,
+                                    PROT_READ | PROT_WRITE,
+                                    MAP_SHARED | MAP_POPULATE,
+                                    ring->fileDescriptor,
+                                    IORING_OFF_CQ_RING);
+        if (ring->completionRing == MAP_FAILED)
+        {
+            return nullptr;
+        }
+    }
+
+    ring->entriesSize = params.sq_entries * sizeof(io_uring_sqe);
+    ring->entries = static_cast<io_uring_sqe*>(mmap(nullptr,
+                                                    ring->entriesSize,
+                                                    PROT_READ | PROT_WRITE,
+                                                    MAP_SHARED | MAP_POPULATE,
+                                                    ring->fileDescriptor,
+                                                    IORING_OFF_SQES));
+    if (ring->entries == MAP_FAILED)
+    {
+        return nullptr;
+    }
+
+    ring->submissionTail = ringField<unsigned>(ring->submissionRing, params.sq_off.tail);
+    ring->submissionMask = ringField<unsigned>(ring->submissionRing, params.sq_off.ring_mask);
+    ring->submissionArray = ringField<unsigned>(ring->submissionRing, params.sq_off.array);
+    ring->completionHead = ringField<unsigned>(ring->completionRing, params.cq_off.head);
+    ring->completionTail = ringField<unsigned>(ring->completionRing, params.cq_off.tail);
+    ring->completionMask = ringField<unsigned>(ring->completionRing, params.cq_off.ring_mask);
+    ring->completions = ringField<io_uring_cqe>(ring->completionRing, params.cq_off.cqes);
+
+    return ring;
+}
+
+// Queues one entry and submits it. Without SQPOLL the kernel consumes entries during the enter call, so the ring is
+// empty again once this returns.
+void submitEntry(IoUring& ring, const io_uring_sqe& entry)
+{
+    const auto tail = std::atomic_ref{*ring.submissionTail}.load(std::memory_order_relaxed);
+    const auto index = tail & *ring.submissionMask;
+    ring.entries[index] = entry;
+    ring.submissionArray[index] = index;
+    std::atomic_ref{*ring.submissionTail}.store(tail + 1, std::memory_order_release);
+
+    while (enterIoUring(ring.fileDescriptor, 1, 0, 0) < 0)
+    {
+        if (errno != EINTR && errno != EAGAIN)
+        {
+            // Withdraw the entry, so a later submission doesn't hand the kernel a request that's already been failed
+            const auto error = std::string{"Failed to submit to io_uring: "} + std::strerror(errno);
+            std::atomic_ref{*ring.submissionTail}.store(tail, std::memory_order_release);
+            throw std::runtime_error(error);
+        }
+    }
+}
+#else
+struct IoUring
+{
+};
+
+std::unique_ptr<IoUring> createIoUring(uint32_t)
+{
+    return nullptr;
+}
+#endif
+
+std::vector<std::byte> readWholeFile(const std::filesystem::path& path)
+{
+    auto file = std::ifstream(path, std::ios::ate | std::ios::binary);
+    if (!file.is_open())
+    {
+        throw std::runtime_error("Failed to open " + path.string());
+    }
+
+    auto data = std::vector<std::byte>(static_cast<size_t>(file.tellg()));
+    file.seekg(0, std::ios::beg);
+    if (!file.read(reinterpret_cast<char*>(data.data()), static_cast<std::streamsize>(data.size())))
+    {
+        throw std::runtime_error("Failed to read " + path.string());
+    }
+
+    return data;
+}
+
+FileReadQueue::FileReadQueue(uint32_t depth)
+    : depth_{std::max(depth, 1u)}
+    , ring_{createIoUring(depth_)}
+{
+    if (ring_)
+    {
+        threads_.emplace_back([this] { completeReads(); });
+        return;
+    }
+
+    const auto threadCount = std::clamp(std::thread::hardware_concurrency(), 1u, maxReadThreads);
+    for (auto i = 0u; i < threadCount; ++i)
+    {
+        threads_.emplace_back([this] { readQueued(); });
+    }
+}
+
+FileReadQueue::~FileReadQueue()
+{
+    {
+        auto lock = std::lock_guard{mutex_};
+        stopping_ = true;
+
+#ifdef __linux__
+        // A completion thread that gave up has already exited
+        if (ring_ && !failure_)
+        {
+            auto entry = io_uring_sqe{};
+            entry.opcode = IORING_OP_NOP;
+            entry.user_data = wakeTag;
+            submitEntry(*ring_, entry);
+        }
+#endif
+    }
+
+    readQueued_.notify_all();
+    threads_.clear();
+}
+
+std::future<std::vector<std::byte>> FileReadQueue::read(const std::filesystem::path& path)
+{
+    // std::function needs a copyable callback, which a promise isn't
+    auto promise = std::make_shared<std::promise<std::vector<std::byte>>>();
+    auto result = promise->get_future();
+    read(path,
+         [promise](std::vector<std::byte> data, std::exception_ptr error)
+         {
+             if (error)
+             {
+                 promise->set_exception(error);
+             }
+             else
+             {
+                 promise->set_value(std::move(data));
+             }
+         });
+    return result;
+}
+
+void FileReadQueue::read(const std::filesystem::path& path, ReadCallback onRead)
+{
+    auto request = std::make_unique<Request>();
+    request->path = path;
+    request->onRead = std::move(onRead);
+
+    if (!ring_)
+    {
+        {
+            auto lock = std::lock_guard{mutex_};
+            queued_.push_back(std::move(request));
+        }
+        readQueued_.notify_one();
+        return;
+    }
+
+#ifdef __linux__
+    // Opening and sizing the file are quick metadata lookups; only the read itself goes on the ring
+    request->fileDescriptor = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    struct stat status{};
+    if (request->fileDescriptor < 0 || fstat(request->fileDescriptor, &status) != 0)
+    {
+        const auto error = std::runtime_error("Failed to open " + path.string() + ": " + std::strerror(errno));
+        if (request->fileDescriptor >= 0)
+        {
+            close(request->fileDescriptor);
+        }
+        request->onRead({}, std::make_exception_ptr(error));
+        return;
+    }
+
+    request->data.resize(static_cast<size_t>(status.st_size));
+    if (request->data.empty())
+    {
+        close(request->fileDescriptor);
+        request->onRead({}, nullptr);
+        return;
+    }
+
+    auto lock = std::unique_lock{mutex_};
+    readFinished_.wait(lock, [this] { return inFlight_.size() < depth_ || failure_; });
+    if (failure_)
+    {
+        const auto error = failure_;
+        lock.unlock();
+        close(request->fileDescriptor);
+        request->onRead({}, error);
+        return;
+    }
+
+    inFlight_.insert(request.get());
+    try
+    {
+        submitRead(*request);
+    }
+    catch (const std::runtime_error&)
+    {
+        inFlight_.erase(request.get());
+        lock.unlock();
+        readFinished_.notify_all();
+        close(request->fileDescriptor);
+        request->onRead({}, std::current_exception());
+        return;
+    }
+
+    // Owned by the ring until its read finishes
+    request.release();
+#endif
+}
+
+bool FileReadQueue::usesIoUring() const
+{
+    return ring_ != nullptr;
+}
+
+// Call with mutex_ held
+void FileReadQueue::submitRead([[maybe_unused]] Request& request)
+{
+#ifdef __linux__
+    const auto remaining = request.data.size() - request.offset;
+
+    auto entry = io_uring_sqe{};
+    entry.opcode = IORING_OP_READ;
+    entry.fd = request.fileDescriptor;
+    entry.addr = reinterpret_cast<uint64_t>(request.data.data() + request.offset);
+    entry.len = static_cast<uint32_t>(std::min<size_t>(remaining, std::numeric_limits<int32_t>::max()));
+    entry.off = request.offset;
+    entry.user_data = reinterpret_cast<uint64_t>(&request);
+    submitEntry(*ring_, entry);
+#endif
+}
+
+void FileReadQueue::finishRead([[maybe_unused]] Request* request, [[maybe_unused]] std::exception_ptr error)
+{
+#ifdef __linux__
+    close(request->fileDescriptor);
+    auto finished = std::unique_ptr<Request>{request};
+
+    // Frees the slot first, as the callback may queue another read and would wait forever for a full ring
+    {
+        auto lock = std::lock_guard{mutex_};
+        inFlight_.erase(request);
+    }
+    readFinished_.notify_all();
+
+    finished->onRead(error ? std::vector<std::byte>{} : std::move(finished->data), error);
+#endif
+}
+
+// Called on the completion thread when the ring stops working, as throwing there would terminate. Every read still on
+// the ring fails with the error, as does any read queued after.
+void FileReadQueue::failReads([[maybe_unused]] std::exception_ptr error)
+{
+#ifdef __linux__
+    auto failed = std::vector<Request*>{};
+    {
+        auto lock = std::lock_guard{mutex_};
+        failure_ = error;
+        failed.assign(inFlight_.begin(), inFlight_.end());
+        inFlight_.clear();
+    }
+    readFinished_.notify_all();
+
+    for (auto* request : failed)
+    {
+        close(request->fileDescriptor);
+        abandoned_.emplace_back(request)->onRead({}, error);
+    }
+#endif
+}
+
+// Body of the completion thread when reads go through the io_uring
+void FileReadQueue::completeReads()
+{
+#ifdef __linux__
+    auto& ring = *ring_;
+    auto woken = false;
+
+    while (true)
+    {
+        {
+            auto lock = std::lock_guard{mutex_};
+            if (woken && inFlight_.empty())
+            {
+                return;
+            }
+        }
+
+        if (enterIoUring(ring.fileDescriptor, 0, 1, IORING_ENTER_GETEVENTS) < 0 && errno != EINTR)
+        {
+            failReads(std::make_exception_ptr(
+                std::runtime_error(std::string{"Failed to wait on io_uring: "} + std::strerror(errno))));
+            return;
+        }
+
+        auto head = std::atomic_ref{*ring.completionHead}.load(std::memory_order_relaxed);
+        const auto tail = std::atomic_ref{*ring.completionTail}.load(std::memory_order_acquire);
+        for (; head != tail; ++head)
+        {
+            // Hand the slot back straight away, as finishing a read lets the caller queue another
+            const auto completion = ring.completions[head & *ring.completionMask];
+            std::atomic_ref{*ring.completionHead}.store(head + 1, std::memory_order_release);
+
+            if (completion.user_data == wakeTag)
+            {
+                woken = true;
+                continue;
+            }
+
+            auto* request = reinterpret_cast<Request*>(completion.user_data);
+            if (completion.res < 0)
+            {
+                finishRead(request,
+                           std::make_exception_ptr(std::runtime_error("Failed to read " + request->path.string() + ": "
+                                                                      + std::strerror(-completion.res))));
+            }
+            else if (completion.res == 0)
+            {
+                finishRead(request,
+                           std::make_exception_ptr(std::runtime_error("Unexpected end of " + request->path.string())));
+            }
+            else
+            {
+                // Reads can come back short, e.g. for files over 2 GiB; carry on from where this one stopped
+                request->offset += static_cast<size_t>(completion.res);
+                if (request->offset < request->data.size())
+                {
+                    try
+                    {
+                        auto lock = std::lock_guard{mutex_};
+                        submitRead(*request);
+                    }
+                    catch (const std::runtime_error&)
+                    {
+                        failReads(std::current_exception());
+                        return;
+                    }
+                }
+                else
+                {
+                    finishRead(request, nullptr);
+                }
+            }
+        }
+    }
+#endif
+}
+
+// Body of each pool thread when there's no io_uring
+void FileReadQueue::readQueued()
+{
+    while (true)
+    {
+        auto request = std::unique_ptr<Request>{};
+        {
+            auto lock = std::unique_lock{mutex_};
+            readQueued_.wait(lock, [this] { return stopping_ || !queued_.empty(); });
+            if (queued_.empty())
+            {
+                return;
+            }
+
+            request = std::move(queued_.front());
+            queued_.pop_front();
+        }
+
+        auto data = std::vector<std::byte>{};
+        auto error = std::exception_ptr{};
+        try
+        {
+            data = readWholeFile(request->path);
+        }
+        catch (...)
+        {
+            error = std::current_exception();
+        }
+        request->onRead(std::move(data), error);
+    }
+}
+} // namespace core
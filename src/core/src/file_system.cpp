@@ -65,6 +65,11 @@ std::filesystem::path getSkyboxesDir()
     return getTexturesDir() / "skyboxes";
 }
 
+std::filesystem::path getCacheDir()
+{
+    return getRootDir() / "cache";
+}
+
 std::vector<char> readBinaryFile(const std::filesystem::path& filepath)
 {
     auto file = std::ifstream(filepath, std::ios::ate | std::ios::binary);
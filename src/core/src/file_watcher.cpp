@@ -0,0 +1,99 @@
+/// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Mark Rapson
+
+#include "core/file_watcher.h"
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+namespace core
+{
+#ifdef __linux__
+FileWatcher::FileWatcher()
+    : fileDescriptor_{inotify_init1(IN_NONBLOCK | IN_CLOEXEC)}
+{
+    if (fileDescriptor_ < 0)
+    {
+        throw std::runtime_error(std::string{"Failed to initialise inotify: "} + std::strerror(errno));
+    }
+}
+
+FileWatcher::~FileWatcher()
+{
+    if (fileDescriptor_ >= 0)
+    {
+        close(fileDescriptor_);
+    }
+}
+
+void FileWatcher::watchDirectory(const std::filesystem::path& directory)
+{
+    const auto watch = inotify_add_watch(fileDescriptor_, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+    if (watch < 0)
+    {
+        throw std::runtime_error("Failed to watch " + directory.string() + ": " + std::strerror(errno));
+    }
+
+    // inotify returns the existing descriptor for a directory that is already watched
+    directories_[watch] = directory;
+}
+
+std::vector<std::filesystem::path> FileWatcher::poll()
+{
+    auto changes = std::vector<std::filesystem::path>{};
+
+    alignas(inotify_event) auto buffer = std::array<char, 4096>{};
+    while (true)
+    {
+        const auto length = read(fileDescriptor_, buffer.data(), buffer.size());
+        if (length <= 0)
+        {
+            // EAGAIN once the queue is drained
+            break;
+        }
+
+        for (auto offset = ssize_t{0}; offset < length;)
+        {
+            const auto* event = reinterpret_cast<const inotify_event*>(buffer.data() + offset);
+            offset += static_cast<ssize_t>(sizeof(inotify_event) + event->len);
+
+            auto itr = directories_.find(event->wd);
+            if (itr == directories_.end() || event->len == 0)
+            {
+                continue;
+            }
+
+            auto path = itr->second / event->name;
+            if (std::ranges::find(changes, path) == changes.end())
+            {
+                changes.push_back(std::move(path));
+            }
+        }
+    }
+
+    return changes;
+}
+#else
+FileWatcher::FileWatcher() = default;
+
+FileWatcher::~FileWatcher() = default;
+
+void FileWatcher::watchDirectory(const std::filesystem::path&)
+{
+}
+
+std::vector<std::filesystem::path> FileWatcher::poll()
+{
+    return {};
+}
+#endif
+} // namespace core
@@ -0,0 +1,66 @@
+/// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Mark Rapson
+
+#include "core/frame_arenas.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+namespace core
+{
+FrameArenas::FrameArenas(uint32_t threadCount, size_t blockSize)
+    : threadCount_{std::max(threadCount, 1u)}
+{
+    arenas_.reserve(size_t{frameCount} * threadCount_);
+    for (auto i = size_t{0}; i < size_t{frameCount} * threadCount_; ++i)
+    {
+        arenas_.push_back(std::make_unique<Arena>(blockSize));
+    }
+}
+
+void FrameArenas::beginFrame()
+{
+    ++frameNumber_;
+    for (auto threadIndex = uint32_t{0}; threadIndex < threadCount_; ++threadIndex)
+    {
+        arena(threadIndex).reset();
+    }
+}
+
+Arena& FrameArenas::arena(uint32_t threadIndex)
+{
+    if (threadIndex >= threadCount_)
+    {
+        throw std::out_of_range("No frame arena for thread " + std::to_string(threadIndex));
+    }
+
+    const auto slot = static_cast<size_t>(frameNumber_ % frameCount);
+    return *arenas_[slot * threadCount_ + threadIndex];
+}
+
+uint64_t FrameArenas::frameNumber() const
+{
+    return frameNumber_;
+}
+
+size_t FrameArenas::peakBytesUsed() const
+{
+    auto bytes = size_t{0};
+    for (const auto& arena : arenas_)
+    {
+        bytes = std::max(bytes, arena->peakBytesUsed());
+    }
+    return bytes;
+}
+
+size_t FrameArenas::bytesReserved() const
+{
+    auto bytes = size_t{0};
+    for (const auto& arena : arenas_)
+    {
+        bytes += arena->bytesReserved();
+    }
+    return bytes;
+}
+} // namespace core
@@ -0,0 +1,111 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Mark Rapson
+
+#include "core/hash.h"
+
+#include <bit>
+#include <cstring>
+
+namespace core
+{
+constexpr auto xxPrime1 = uint64_t{0x9e3779b185ebca87};
+constexpr auto xxPrime2 = uint64_t{0xc2b2ae3d27d4eb4f};
+constexpr auto xxPrime3 = uint64_t{0x165667b19e3779f9};
+constexpr auto xxPrime4 = uint64_t{0x85ebca77c2b2ae63};
+constexpr auto xxPrime5 = uint64_t{0x27d4eb2f165667c5};
+
+// xxHash is defined over little endian reads
+uint64_t readLane64(const std::byte* data)
+{
+    auto value = uint64_t{0};
+    std::memcpy(&value, data, sizeof(value));
+    return std::endian::native == std::endian::little ? value : std::byteswap(value);
+}
+
+uint32_t readLane32(const std::byte* data)
+{
+    auto value = uint32_t{0};
+    std::memcpy(&value, data, sizeof(value));
+    return std::endian::native == std::endian::little ? value : std::byteswap(value);
+}
+
+uint64_t xxRound(uint64_t accumulator, uint64_t lane)
+{
+    accumulator += lane * xxPrime2;
+    accumulator = std::rotl(accumulator, 31);
+    return accumulator * xxPrime1;
+}
+
+uint64_t xxMergeRound(uint64_t hash, uint64_t accumulator)
+{
+    hash ^= xxRound(0, accumulator);
+    return hash * xxPrime1 + xxPrime4;
+}
+
+uint64_t xxHash64(std::span<const std::byte> data, uint64_t seed)
+{
+    const auto* input = data.data();
+    const auto* end = input + data.size();
+    auto hash = uint64_t{0};
+
+    if (data.size() >= 32)
+    {
+        // Four independent accumulators consume 32-byte stripes
+        auto v1 = seed + xxPrime1 + xxPrime2;
+        auto v2 = seed + xxPrime2;
+        auto v3 = seed;
+        auto v4 = seed - xxPrime1;
+
+        const auto* limit = end - 32;
+        do
+        {
+            v1 = xxRound(v1, readLane64(input));
+            v2 = xxRound(v2, readLane64(input + 8));
+            v3 = xxRound(v3, readLane64(input + 16));
+            v4 = xxRound(v4, readLane64(input + 24));
+            input += 32;
+        } while (input <= limit);
+
+        hash = std::rotl(v1, 1) + std::rotl(v2, 7) + std::rotl(v3, 12) + std::rotl(v4, 18);
+        hash = xxMergeRound(hash, v1);
+        hash = xxMergeRound(hash, v2);
+        hash = xxMergeRound(hash, v3);
+        hash = xxMergeRound(hash, v4);
+    }
+    else
+    {
+        hash = seed + xxPrime5;
+    }
+
+    hash += static_cast<uint64_t>(data.size());
+
+    while (end - input >= 8)
+    {
+        hash ^= xxRound(0, readLane64(input));
+        hash = std::rotl(hash, 27) * xxPrime1 + xxPrime4;
+        input += 8;
+    }
+
+    if (end - input >= 4)
+    {
+        hash ^= static_cast<uint64_t>(readLane32(input)) * xxPrime1;
+        hash = std::rotl(hash, 23) * xxPrime2 + xxPrime3;
+        input += 4;
+    }
+
+    while (input < end)
+    {
+        hash ^= static_cast<uint64_t>(*input) * xxPrime5;
+        hash = std::rotl(hash, 11) * xxPrime1;
+        ++input;
+    }
+
+    hash ^= hash >> 33;
+    hash *= xxPrime2;
+    hash ^= hash >> 29;
+    hash *= xxPrime3;
+    hash ^= hash >> 32;
+
+    return hash;
+}
+} // namespace core
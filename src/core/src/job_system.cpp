@@ -0,0 +1,287 @@
+/// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Mark Rapson
+
+#include "core/job_system.h"
+
+#include "work_stealing_deque.h"
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#include <stdexcept>
+#include <utility>
+
+namespace core
+{
+// Job system the current thread belongs to and its deque index, so jobs created on it go on its own deque
+thread_local const JobSystem* currentJobSystem = nullptr;
+thread_local uint32_t currentDequeIndex = 0;
+
+// Failed steals an idle worker retries before going to sleep; jobs often arrive in quick succession
+constexpr auto idleSpinCount = 64;
+
+bool JobCounter::done() const
+{
+    return pending_.load(std::memory_order_acquire) == 0;
+}
+
+void JobCounter::recordError(std::exception_ptr error)
+{
+    auto lock = std::lock_guard{errorMutex_};
+    if (!error_)
+    {
+        error_ = error;
+    }
+}
+
+void pinThread([[maybe_unused]] std::jthread& thread, [[maybe_unused]] uint32_t cpu)
+{
+#ifdef __linux__
+    auto cpus = cpu_set_t{};
+    CPU_ZERO(&cpus);
+    CPU_SET(cpu, &cpus);
+    pthread_setaffinity_np(thread.native_handle(), sizeof(cpu_set_t), &cpus);
+#endif
+}
+
+JobSystem::JobSystem(const JobSystemConfig& config)
+{
+    for (auto i = uint32_t{0}; i <= config.workerCount; ++i)
+    {
+        deques_.push_back(std::make_unique<WorkStealingDeque<Job*>>());
+    }
+
+    currentJobSystem = this;
+    currentDequeIndex = 0;
+
+    const auto cpuCount = std::max(std::thread::hardware_concurrency(), 1u);
+    for (auto i = uint32_t{1}; i <= config.workerCount; ++i)
+    {
+        workers_.emplace_back([this, i] { workerLoop(i); });
+        if (config.pinWorkers)
+        {
+            pinThread(workers_.back(), i % cpuCount);
+        }
+    }
+}
+
+JobSystem::~JobSystem()
+{
+    stopping_.store(true);
+    workEpoch_.fetch_add(1);
+    workEpoch_.notify_all();
+    workers_.clear();
+
+    // Without workers, anything left was queued by this thread and is finished here
+    while (runJob())
+    {
+    }
+
+    if (currentJobSystem == this)
+    {
+        currentJobSystem = nullptr;
+    }
+}
+
+void JobSystem::run(JobCounter& counter, std::function<void()> job)
+{
+    counter.pending_.fetch_add(1, std::memory_order_relaxed);
+    auto* queued = new Job{.task = std::move(job), .counter = &counter};
+
+    if (currentJobSystem == this)
+    {
+        deques_[currentDequeIndex]->push(queued);
+    }
+    else
+    {
+        auto lock = std::lock_guard{injectedMutex_};
+        injected_.push_back(queued);
+        injectedCount_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // Waking a worker is a system call, so only pay for it when one is asleep. Either the epoch bump is seen by a
+    // worker about to sleep, or the worker's sleeping count is seen here.
+    workEpoch_.fetch_add(1);
+    if (sleepingWorkers_.load() > 0)
+    {
+        workEpoch_.notify_one();
+    }
+}
+
+void JobSystem::wait(JobCounter& counter)
+{
+    while (!counter.done())
+    {
+        // The rest of the batch is running elsewhere; stay out of its way until it finishes
+        if (!runJob())
+        {
+            std::this_thread::yield();
+        }
+    }
+
+    if (counter.error_)
+    {
+        std::rethrow_exception(std::exchange(counter.error_, nullptr));
+    }
+}
+
+void JobSystem::parallelFor(size_t count, size_t grainSize, const std::function<void(size_t, size_t)>& body)
+{
+    const auto grain = std::max<size_t>(grainSize, 1);
+    auto counter = JobCounter{};
+
+    // Queues the upper half of the range and carries on with the lower half, so the largest pieces are the ones
+    // left at the top of the deque for other threads to steal
+    auto split = std::function<void(size_t, size_t)>{};
+    split = [&](size_t begin, size_t end)
+    {
+        while (end - begin > grain)
+        {
+            const auto middle = begin + (end - begin) / 2;
+            run(counter, [&split, middle, end] { split(middle, end); });
+            end = middle;
+        }
+
+        body(begin, end);
+    };
+
+    try
+    {
+        if (count > 0)
+        {
+            split(0, count);
+        }
+    }
+    catch (...)
+    {
+        counter.recordError(std::current_exception());
+    }
+
+    wait(counter);
+}
+
+uint32_t JobSystem::threadCount() const
+{
+    return static_cast<uint32_t>(deques_.size());
+}
+
+uint32_t JobSystem::threadIndex() const
+{
+    if (currentJobSystem != this)
+    {
+        throw std::runtime_error("Thread does not belong to this job system");
+    }
+
+    return currentDequeIndex;
+}
+
+void JobSystem::workerLoop(uint32_t index)
+{
+    currentJobSystem = this;
+    currentDequeIndex = index;
+
+    while (true)
+    {
+        auto found = false;
+        for (auto spin = 0; spin < idleSpinCount && !found; ++spin)
+        {
+            found = runJob();
+        }
+
+        if (found)
+        {
+            continue;
+        }
+
+        const auto epoch = workEpoch_.load();
+        if (runJob())
+        {
+            continue;
+        }
+
+        if (stopping_.load())
+        {
+            return;
+        }
+
+        sleepingWorkers_.fetch_add(1);
+        workEpoch_.wait(epoch);
+        sleepingWorkers_.fetch_sub(1);
+    }
+}
+
+bool JobSystem::runJob()
+{
+    auto* job = findJob();
+    if (!job)
+    {
+        return false;
+    }
+
+    execute(job);
+    return true;
+}
+
+JobSystem::Job* JobSystem::findJob()
+{
+    const auto isMember = currentJobSystem == this;
+    const auto ownIndex = isMember ? currentDequeIndex : 0;
+
+    if (isMember)
+    {
+        if (const auto job = deques_[ownIndex]->pop())
+        {
+            return *job;
+        }
+    }
+
+    if (injectedCount_.load(std::memory_order_relaxed) > 0)
+    {
+        auto lock = std::lock_guard{injectedMutex_};
+        if (!injected_.empty())
+        {
+            auto* job = injected_.front();
+            injected_.pop_front();
+            injectedCount_.fetch_sub(1, std::memory_order_relaxed);
+            return job;
+        }
+    }
+
+    // Start with the next thread along so thieves spread over the victims rather than all hitting the first
+    const auto dequeCount = deques_.size();
+    for (auto offset = size_t{1}; offset <= dequeCount; ++offset)
+    {
+        const auto victim = (ownIndex + offset) % dequeCount;
+        if (isMember && victim == ownIndex)
+        {
+            continue;
+        }
+
+        if (const auto job = deques_[victim]->steal())
+        {
+            return *job;
+        }
+    }
+
+    return nullptr;
+}
+
+void JobSystem::execute(Job* job)
+{
+    auto* counter = job->counter;
+    try
+    {
+        job->task();
+    }
+    catch (...)
+    {
+        counter->recordError(std::current_exception());
+    }
+    delete job;
+
+    // The waiting thread may destroy the counter as soon as this reaches zero
+    counter->pending_.fetch_sub(1, std::memory_order_release);
+}
+} // namespace core
@@ -0,0 +1,124 @@
+/// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Mark Rapson
+
+#include "core/mapped_file.h"
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+namespace core
+{
+MappedFile::MappedFile(const std::filesystem::path& path)
+{
+#ifndef _WIN32
+    const auto fileDescriptor = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fileDescriptor < 0)
+    {
+        throw std::runtime_error("Failed to open " + path.string() + ": " + std::strerror(errno));
+    }
+
+    struct stat status{};
+    if (fstat(fileDescriptor, &status) != 0)
+    {
+        const auto error = errno;
+        close(fileDescriptor);
+        throw std::runtime_error("Failed to stat " + path.string() + ": " + std::strerror(error));
+    }
+
+    size_ = static_cast<size_t>(status.st_size);
+
+    // Zero length mappings are invalid, and an empty file has nothing to view anyway
+    if (size_ > 0)
+    {
+        auto* mapping = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fileDescriptor, 0);
+        if (mapping == MAP_FAILED)
+        {
+            const auto error = errno;
+            close(fileDescriptor);
+            throw std::runtime_error("Failed to map " + path.string() + ": " + std::strerror(error));
+        }
+
+        data_ = static_cast<const std::byte*>(mapping);
+        mapped_ = true;
+    }
+
+    // The mapping keeps the file alive on its own
+    close(fileDescriptor);
+#else
+    auto file = std::ifstream(path, std::ios::ate | std::ios::binary);
+    if (!file.is_open())
+    {
+        throw std::runtime_error("Failed to open " + path.string());
+    }
+
+    buffer_.resize(static_cast<size_t>(file.tellg()));
+    file.seekg(0, std::ios::beg);
+    file.read(reinterpret_cast<char*>(buffer_.data()), static_cast<std::streamsize>(buffer_.size()));
+
+    data_ = buffer_.data();
+    size_ = buffer_.size();
+#endif
+}
+
+MappedFile::~MappedFile()
+{
+    unmap();
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+    : data_{std::exchange(other.data_, nullptr)}
+    , size_{std::exchange(other.size_, 0)}
+    , mapped_{std::exchange(other.mapped_, false)}
+    , buffer_{std::move(other.buffer_)}
+{
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept
+{
+    if (this != &other)
+    {
+        unmap();
+        data_ = std::exchange(other.data_, nullptr);
+        size_ = std::exchange(other.size_, 0);
+        mapped_ = std::exchange(other.mapped_, false);
+        buffer_ = std::move(other.buffer_);
+    }
+
+    return *this;
+}
+
+std::span<const std::byte> MappedFile::bytes() const
+{
+    return {data_, size_};
+}
+
+size_t MappedFile::size() const
+{
+    return size_;
+}
+
+void MappedFile::unmap()
+{
+#ifndef _WIN32
+    if (mapped_)
+    {
+        munmap(const_cast<std::byte*>(data_), size_);
+    }
+#endif
+
+    data_ = nullptr;
+    size_ = 0;
+    mapped_ = false;
+}
+} // namespace core
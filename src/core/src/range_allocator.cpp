@@ -0,0 +1,101 @@
+/// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Mark Rapson
+
+#include "core/range_allocator.h"
+
+#include <iterator>
+#include <stdexcept>
+
+namespace core
+{
+size_t RangeAllocator::allocate(size_t count)
+{
+    if (count == 0)
+    {
+        return end_;
+    }
+
+    allocated_ += count;
+
+    for (auto itr = freeRanges_.begin(); itr != freeRanges_.end(); ++itr)
+    {
+        const auto [offset, size] = *itr;
+        if (size < count)
+        {
+            continue;
+        }
+
+        freeRanges_.erase(itr);
+        if (size > count)
+        {
+            freeRanges_.emplace(offset + count, size - count);
+        }
+        return offset;
+    }
+
+    const auto offset = end_;
+    end_ += count;
+    return offset;
+}
+
+void RangeAllocator::free(size_t offset, size_t count)
+{
+    if (count == 0)
+    {
+        return;
+    }
+
+    if (offset + count > end_ || count > allocated_)
+    {
+        throw std::logic_error("Freed range was never allocated");
+    }
+
+    allocated_ -= count;
+
+    auto [itr, inserted] = freeRanges_.emplace(offset, count);
+    if (!inserted)
+    {
+        throw std::logic_error("Range freed twice");
+    }
+
+    if (auto next = std::next(itr); next != freeRanges_.end() && offset + count == next->first)
+    {
+        itr->second += next->second;
+        freeRanges_.erase(next);
+    }
+
+    if (itr != freeRanges_.begin())
+    {
+        if (auto previous = std::prev(itr); previous->first + previous->second == offset)
+        {
+            previous->second += itr->second;
+            freeRanges_.erase(itr);
+            itr = previous;
+        }
+    }
+
+    // Free space at the end isn't kept as a range, so end() reflects what's still in use
+    if (itr->first + itr->second == end_)
+    {
+        end_ = itr->first;
+        freeRanges_.erase(itr);
+    }
+}
+
+void RangeAllocator::reset()
+{
+    freeRanges_.clear();
+    end_ = 0;
+    allocated_ = 0;
+}
+
+size_t RangeAllocator::end() const
+{
+    return end_;
+}
+
+size_t RangeAllocator::allocated() const
+{
+    return allocated_;
+}
+} // namespace core
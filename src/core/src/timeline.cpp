@@ -0,0 +1,71 @@
+/// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Mark Rapson
+
+#include "core/timeline.h"
+
+#include "core/allocation_tracker.h"
+
+#include <algorithm>
+
+namespace core
+{
+uint64_t Timeline::value() const
+{
+    return value_.load(std::memory_order_acquire);
+}
+
+void Timeline::signal(uint64_t value)
+{
+    // Only allocated when something is ready, so signalling with nothing to resume doesn't touch the heap
+    auto ready = std::vector<Waiter>{};
+    {
+        auto lock = std::lock_guard{mutex_};
+        if (value <= value_.load(std::memory_order_relaxed))
+        {
+            return;
+        }
+
+        value_.store(value, std::memory_order_release);
+        if (waiters_.empty())
+        {
+            return;
+        }
+
+        std::erase_if(waiters_,
+                      [&](const Waiter& waiter)
+                      {
+                          if (waiter.target > value)
+                          {
+                              return false;
+                          }
+                          ready.push_back(waiter);
+                          return true;
+                      });
+    }
+
+    if (ready.empty())
+    {
+        return;
+    }
+
+    // Resumed outside the lock, as a coroutine may wait on the timeline again. Whatever the coroutines allocate is
+    // counted against them rather than the signaller.
+    auto allocationZone = AllocationZone{"Timeline::resume"};
+    for (const auto& waiter : ready)
+    {
+        waiter.handle.resume();
+    }
+}
+
+bool Timeline::addWaiter(uint64_t target, std::coroutine_handle<> handle)
+{
+    auto lock = std::lock_guard{mutex_};
+    if (value_.load(std::memory_order_relaxed) >= target)
+    {
+        return false;
+    }
+
+    waiters_.push_back(Waiter{.target = target, .handle = handle});
+    return true;
+}
+} // namespace core
@@ -0,0 +1,148 @@
+/// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Mark Rapson
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <stdint.h>
+#include <type_traits>
+#include <vector>
+
+namespace core
+{
+// Chase-Lev work-stealing deque, with the memory orderings of Le et al., "Correct and Efficient Work-Stealing for
+// Weak Memory Models". The owning thread pushes and pops at the bottom; any other thread may steal from the top.
+// Grows when full; outgrown buffers are kept until the deque is destroyed, as a thief may still be reading one.
+template <typename T>
+class WorkStealingDeque
+{
+    static_assert(std::is_trivially_copyable_v<T>, "Items are copied in and out of atomics");
+
+  public:
+    // capacity must be a power of two
+    explicit WorkStealingDeque(size_t capacity = 1024)
+    {
+        buffers_.push_back(std::make_unique<Buffer>(capacity));
+        buffer_.store(buffers_.back().get(), std::memory_order_relaxed);
+    }
+
+    WorkStealingDeque(const WorkStealingDeque&) = delete;
+    WorkStealingDeque& operator=(const WorkStealingDeque&) = delete;
+
+    WorkStealingDeque(WorkStealingDeque&& other) = delete;
+    WorkStealingDeque& operator=(WorkStealingDeque&& other) = delete;
+
+    // Owner only
+    void push(T item)
+    {
+        const auto bottom = bottom_.load(std::memory_order_relaxed);
+        const auto top = top_.load(std::memory_order_acquire);
+        auto* buffer = buffer_.load(std::memory_order_relaxed);
+
+        if (bottom - top > static_cast<int64_t>(buffer->capacity) - 1)
+        {
+            buffer = grow(buffer, top, bottom);
+        }
+
+        buffer->put(bottom, item);
+        bottom_.store(bottom + 1, std::memory_order_release);
+    }
+
+    // Owner only. Takes the most recently pushed item.
+    std::optional<T> pop()
+    {
+        const auto bottom = bottom_.load(std::memory_order_relaxed) - 1;
+        auto* buffer = buffer_.load(std::memory_order_relaxed);
+        bottom_.store(bottom, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        auto top = top_.load(std::memory_order_relaxed);
+
+        if (top > bottom)
+        {
+            bottom_.store(bottom + 1, std::memory_order_relaxed);
+            return std::nullopt;
+        }
+
+        auto item = std::optional<T>{buffer->get(bottom)};
+        if (top == bottom)
+        {
+            // Last item, so race any thief for it
+            if (!top_.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+            {
+                item.reset();
+            }
+            bottom_.store(bottom + 1, std::memory_order_relaxed);
+        }
+
+        return item;
+    }
+
+    // Any thread. Takes the least recently pushed item; empty if there was none or another thread won it.
+    std::optional<T> steal()
+    {
+        auto top = top_.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        const auto bottom = bottom_.load(std::memory_order_acquire);
+
+        if (top >= bottom)
+        {
+            return std::nullopt;
+        }
+
+        auto* buffer = buffer_.load(std::memory_order_acquire);
+        const auto item = buffer->get(top);
+        if (!top_.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+        {
+            return std::nullopt;
+        }
+
+        return item;
+    }
+
+  private:
+    struct Buffer
+    {
+        explicit Buffer(size_t size)
+            : capacity{size}
+            , items{std::make_unique<std::atomic<T>[]>(size)}
+        {
+        }
+
+        T get(int64_t index) const
+        {
+            return items[static_cast<size_t>(index) & (capacity - 1)].load(std::memory_order_relaxed);
+        }
+
+        void put(int64_t index, T item)
+        {
+            items[static_cast<size_t>(index) & (capacity - 1)].store(item, std::memory_order_relaxed);
+        }
+
+        size_t capacity;
+        std::unique_ptr<std::atomic<T>[]> items;
+    };
+
+    Buffer* grow(Buffer* buffer, int64_t top, int64_t bottom)
+    {
+        buffers_.push_back(std::make_unique<Buffer>(buffer->capacity * 2));
+        auto* grown = buffers_.back().get();
+        for (auto i = top; i < bottom; ++i)
+        {
+            grown->put(i, buffer->get(i));
+        }
+
+        buffer_.store(grown, std::memory_order_release);
+        return grown;
+    }
+
+  private:
+    // Owner and thieves contend on different ends, so keep them off each other's cache line
+    alignas(64) std::atomic<int64_t> top_{0};
+    alignas(64) std::atomic<int64_t> bottom_{0};
+    std::atomic<Buffer*> buffer_{nullptr};
+    std::vector<std::unique_ptr<Buffer>> buffers_;
+};
+} // namespace core
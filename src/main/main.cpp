@@ -3,16 +3,40 @@
 
 #include "vulkan_application.h"
 
+#include <core/async_log_sink.h>
+
+#include <spdlog/sinks/stdout_color_sinks.h>
 #include <spdlog/spdlog.h>
 
+#include <algorithm>
+#include <cstdlib>
+#include <memory>
+#include <optional>
 #include <stdexcept>
+#include <string_view>
 
 constexpr auto windowWidth = 1440;
 constexpr auto windowHeight = 1080;
 constexpr auto windowTitle = "Vulkan Demo";
 
-int main(int /* argc */, char** /* argv */)
+int main(int argc, char** argv)
 {
+    // --stream-benchmark [laps] streams the scene's cells out and back in instead of taking input
+    auto benchmark = std::optional<StreamingBenchmark>{};
+    if (argc > 1 && std::string_view{argv[1]} == "--stream-benchmark")
+    {
+        benchmark.emplace();
+        if (argc > 2)
+        {
+            benchmark->laps = static_cast<uint32_t>(std::max(std::atoi(argv[2]), 1));
+        }
+    }
+
+    // Frame code and the validation layers log from the render loop, which shouldn't wait on the console
+    auto logSink = std::make_shared<core::AsyncLogSink>(std::make_shared<spdlog::sinks::stdout_color_sink_mt>());
+    spdlog::set_default_logger(std::make_shared<spdlog::logger>("", logSink));
+    spdlog::flush_on(spdlog::level::critical);
+
     spdlog::set_pattern("[%H:%M:%S.%e] [%^%l%$] %v");
     spdlog::set_level(spdlog::level::trace);
 
@@ -23,13 +47,20 @@ int main(int /* argc */, char** /* argv */)
     {
         VulkanApplication app;
         app.init(windowWidth, windowHeight, windowTitle);
-        app.run();
+        app.run(benchmark);
     }
     catch (const std::exception& ex)
     {
         spdlog::critical("{}", ex.what());
+        spdlog::shutdown();
         return 1;
     }
 
+    if (logSink->droppedCount() > 0)
+    {
+        spdlog::warn("{} log messages were dropped while the log queue was full", logSink->droppedCount());
+    }
+
+    spdlog::shutdown();
     return 0;
 }
@@ -4,15 +4,23 @@
 #include "vulkan_application.h"
 
 #include <assets/asset_database.h>
-#include <assets/gltf_loader.h>
+#include <assets/image_cache.h>
 #include <assets/image_loader.h>
+#include <assets/ktx2_loader.h>
+#include <assets/prefab_reloader.h>
+#include <core/allocation_tracker.h>
+#include <core/file_read_queue.h>
 #include <core/file_system.h>
+#include <core/frame_arenas.h>
 #include <core/input_handler.h>
+#include <core/job_system.h>
 #include <renderer/camera.h>
 #include <renderer/gpu_device.h>
 #include <renderer/renderer.h>
+#include <scene/binary_scene.h>
 #include <scene/scene.h>
 #include <scene/scene_loader.h>
+#include <world/scene_reloader.h>
 #include <world/systems/render_system.h>
 #include <world/world.h>
 
@@ -20,11 +28,41 @@
 
 #include <spdlog/spdlog.h>
 
+#include <algorithm>
+#include <array>
 #include <chrono>
+#include <filesystem>
 #include <ranges>
 #include <stdexcept>
+#include <string>
+#include <thread>
 #include <vector>
 
+// Generous enough to keep the demo scene resident; unreferenced prefabs are evicted past these
+constexpr auto cpuMemoryBudget = size_t{1024} * 1024 * 1024;
+constexpr auto gpuMemoryBudget = size_t{2048} * 1024 * 1024;
+
+constexpr auto imageCacheSize = uint64_t{1024} * 1024 * 1024;
+
+// With allocation tracking compiled in, frames after these must not allocate inside allocationFreeZones. Anything
+// reloaded starts the count again, as the frames after it fill caches and grow the frame arenas.
+constexpr auto allocationWarmUpFrames = uint64_t{10};
+constexpr auto allocationReportInterval = uint64_t{600};
+constexpr auto allocationFreeZones = std::array{"World::update", "Renderer::renderFrame"};
+
+// Zones inside the allocation-free ones that do allocate, but only in response to an event rather than every frame
+constexpr auto allocatingEventZones = std::array{"Renderer::recreateSwapchain",
+                                                 "TextureStreamer::stream",
+                                                 "Timeline::resume",
+                                                 "GpuResourceCache::freeMeshRanges"};
+
+// Frames the streaming benchmark spends out of range of the scene and back at the start on each lap, long enough for
+// the frames using evicted prefabs to finish and for texture streaming to settle
+constexpr auto benchmarkLegFrames = uint64_t{120};
+
+// Far enough along the ground plane that every cell of the scene unloads
+constexpr auto benchmarkFarDistance = 100000.0f;
+
 static void framebufferResizeCallback(GLFWwindow* window, int width, int height)
 {
     auto app = static_cast<VulkanApplication*>(glfwGetWindowUserPointer(window));
@@ -105,12 +143,47 @@ static vk::Bool32 debugCallback(vk::DebugUtilsMessageSeverityFlagBitsEXT severit
     }
     else
     {
-        spdlog::info("{}", pCallbackData->pMessage);
+        SPDLOG_DEBUG("{}", pCallbackData->pMessage);
     }
 
     return VK_TRUE;
 }
 
+static std::filesystem::path compiledScenePath(const std::filesystem::path& path)
+{
+    return core::getCacheDir() / "scenes" / path.filename().replace_extension(".vscene");
+}
+
+// Scenes are compiled into the cache the first time they're loaded and again whenever the JSON is edited or the
+// compiled format changes
+static std::unique_ptr<scene::BinaryScene> loadCompiledScene(const std::filesystem::path& path)
+{
+    const auto compiledPath = compiledScenePath(path);
+
+    auto error = std::error_code{};
+    const auto compiledTime = std::filesystem::last_write_time(compiledPath, error);
+    if (!error && compiledTime >= std::filesystem::last_write_time(path))
+    {
+        try
+        {
+            return std::make_unique<scene::BinaryScene>(compiledPath);
+        }
+        catch (const std::runtime_error& ex)
+        {
+            spdlog::warn("Recompiling scene: {}", ex.what());
+        }
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    std::filesystem::create_directories(compiledPath.parent_path());
+    scene::writeBinaryScene(*scene::loadScene(path), compiledPath);
+    spdlog::info("Compiled scene {} in {:.1f} ms",
+                 path.string(),
+                 std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+
+    return std::make_unique<scene::BinaryScene>(compiledPath);
+}
+
 VulkanApplication::VulkanApplication()
     : inputHandler_{std::make_unique<core::InputHandler>()}
 {
@@ -144,63 +217,208 @@ void VulkanApplication::init(int windowWidth, int windowHeight, const std::strin
     initVulkan(windowWidth, windowHeight);
 }
 
-void VulkanApplication::run()
+void VulkanApplication::run(const std::optional<StreamingBenchmark>& benchmark)
 {
     spdlog::info("Running");
 
-    auto scene = scene::loadScene(core::getScenesDir() / "demo.json");
-    camera_->setPosition(glm::vec3{0.0f, 8.0f, 24.0f});
+    const auto scenePath = core::getScenesDir() / "demo.json";
+    auto sceneReloader = world::SceneReloader{scenePath, compiledScenePath(scenePath), loadCompiledScene(scenePath)};
+    const auto startPosition = glm::vec3{0.0f, 8.0f, 24.0f};
+    camera_->setPosition(startPosition);
 
     // Probably show some loading screen here...
     // Move to separate func
+    auto jobSystem = core::JobSystem{};
+    auto frameArenas = core::FrameArenas{jobSystem.threadCount()};
+    auto readQueue = core::FileReadQueue{};
+    auto imageCache = assets::ImageCache{core::getCacheDir() / "images", imageCacheSize};
     auto db = assets::AssetDatabase{};
-    for (auto& prefabDef : scene->prefabs)
-    {
-        db.addPrefab(prefabDef.name, assets::loadGLTFModel(core::getPrefabsDir() / prefabDef.path));
-    }
+    db.setImageCache(&imageCache);
+    db.setJobSystem(&jobSystem);
+    db.setFileReadQueue(&readQueue);
+    db.setMemoryBudget(assets::MemoryBudget{.cpuBytes = cpuMemoryBudget, .gpuBytes = gpuMemoryBudget});
 
-    for (auto& skyboxDef : scene->skyboxes)
+    for (auto& skyboxDef : sceneReloader.scene().skyboxes())
     {
-        auto skybox = std::make_unique<assets::Skybox>();
-        skybox->images[0] = assets::createImageFromPath(core::getSkyboxesDir() / skyboxDef.pxPath);
-        skybox->images[1] = assets::createImageFromPath(core::getSkyboxesDir() / skyboxDef.pyPath);
-        skybox->images[2] = assets::createImageFromPath(core::getSkyboxesDir() / skyboxDef.pzPath);
-        skybox->images[3] = assets::createImageFromPath(core::getSkyboxesDir() / skyboxDef.nxPath);
-        skybox->images[4] = assets::createImageFromPath(core::getSkyboxesDir() / skyboxDef.nyPath);
-        skybox->images[5] = assets::createImageFromPath(core::getSkyboxesDir() / skyboxDef.nzPath);
+        auto cubemap = std::unique_ptr<assets::Image>{};
+        if (!skyboxDef.path.empty())
+        {
+            cubemap = assets::createImageFromPath(core::getSkyboxesDir() / skyboxDef.path, &imageCache);
+        }
+        else
+        {
+            const auto facePaths = std::array{core::getSkyboxesDir() / skyboxDef.pxPath,
+                                              core::getSkyboxesDir() / skyboxDef.nxPath,
+                                              core::getSkyboxesDir() / skyboxDef.pyPath,
+                                              core::getSkyboxesDir() / skyboxDef.nyPath,
+                                              core::getSkyboxesDir() / skyboxDef.pzPath,
+                                              core::getSkyboxesDir() / skyboxDef.nzPath};
+            auto faces = assets::createImagesFromPaths(facePaths, readQueue, &imageCache);
+            cubemap = assets::createCubemapFromFaces({std::move(faces[0]),
+                                                      std::move(faces[1]),
+                                                      std::move(faces[2]),
+                                                      std::move(faces[3]),
+                                                      std::move(faces[4]),
+                                                      std::move(faces[5])});
+        }
+
+        if (cubemap->layers != 6)
+        {
+            throw std::runtime_error("Skybox " + skyboxDef.name + " is not a cubemap");
+        }
 
-        db.addSkybox(skyboxDef.name, std::move(skybox));
+        db.addSkybox(skyboxDef.name, assets::Skybox{.cubemap = db.addImage(std::move(*cubemap))});
     }
 
+    // Prefabs are loaded as the cells using them first stream in, and those of generators while the world is built,
+    // so it must exist before the first upload
+    const auto partitionConfig = world::WorldPartitionConfig{.prefabDirectory = core::getPrefabsDir()};
+    auto world = world::World{sceneReloader.scene(), db, *renderer_, partitionConfig};
+    world.setFrameArenas(&frameArenas);
+    world.stream(camera_->position(), true);
+
+    const auto& report = db.deduplicationReport();
+    spdlog::info("Loaded {} unique images ({} shared), {} unique materials ({} shared), {} unique sub-meshes ({} "
+                 "shared); deduplication saved {} bytes",
+                 report.uniqueImages,
+                 report.duplicateImages,
+                 report.uniqueMaterials,
+                 report.duplicateMaterials,
+                 report.uniqueSubMeshes,
+                 report.duplicateSubMeshes,
+                 report.bytesSaved);
+
     renderer_->setResources(db);
+    db.applyResidencyPolicy();
+    logResidency(db);
 
-    auto world = world::World{*scene, db, *renderer_};
+    renderer_->setFrameArenas(&frameArenas);
+    auto prefabReloader = assets::PrefabReloader{db};
     // ...end loading screen
 
     constexpr auto maxFps = std::chrono::duration<double>(1.0 / 60.0);
     auto lastTime = std::chrono::steady_clock::now();
 
+    auto allocationStats = std::vector<core::AllocationZoneStats>{};
+    auto allocationWarmUpEnd = allocationWarmUpFrames;
+
+    auto benchmarkFrame = uint64_t{0};
+    auto benchmarkLapStartTime = lastTime;
+    auto firstLapGpuBytes = size_t{0};
+    auto firstLapCapacity = renderer::MeshBufferCapacity{};
+
     while (!glfwWindowShouldClose(window_))
     {
         const auto frameStartTime = std::chrono::steady_clock::now();
         const auto deltaTime = std::chrono::duration<double>(frameStartTime - lastTime).count();
         lastTime = frameStartTime;
 
+        frameArenas.beginFrame();
         glfwPollEvents();
 
-        updateCamera(deltaTime);
+        // Benchmark legs alternate between out of range of the scene and back at the start, where the cells are
+        // waited for so every lap measures the same set loaded
+        const auto benchmarkLeg = benchmarkFrame / benchmarkLegFrames;
+        const auto benchmarkLegFrame = benchmarkFrame % benchmarkLegFrames;
+        const auto benchmarkReturned = benchmark && benchmarkLeg % 2 == 1;
+        if (!benchmark)
+        {
+            updateCamera(deltaTime);
+        }
+        else if (benchmarkLegFrame == 0)
+        {
+            camera_->setPosition(benchmarkReturned ? startPosition
+                                                   : startPosition + glm::vec3{benchmarkFarDistance, 0.0f, 0.0f});
+        }
+
+        // Reloads apply before streaming so a cell a reload unloaded is requested again straight away
+        const auto reloaded = sceneReloader.update(world);
+        auto streamed = world.stream(camera_->position(), benchmarkReturned && benchmarkLegFrame == 0);
+        if (reloaded)
+        {
+            streamed.prefabsLoaded += reloaded->prefabsLoaded;
+            streamed.evicted.append(reloaded->evicted);
+        }
+        if (streamed.prefabsLoaded > 0 || !streamed.evicted.empty())
+        {
+            renderer_->updateResources(db, streamed.evicted);
+            db.applyResidencyPolicy();
+        }
+        if (reloaded || streamed.cellsLoaded > 0 || streamed.prefabsLoaded > 0)
+        {
+            allocationWarmUpEnd = frameArenas.frameNumber() + allocationWarmUpFrames;
+        }
 
         world.update(*camera_);
 
+        if (auto removed = prefabReloader.update(db))
+        {
+            renderer_->updateResources(db, *removed);
+            db.applyResidencyPolicy();
+            allocationWarmUpEnd = frameArenas.frameNumber() + allocationWarmUpFrames;
+        }
+
+        enforceMemoryBudget(db);
+        const auto frame = frameArenas.frameNumber();
+        checkFrameAllocations(frame, frame > allocationWarmUpEnd, allocationStats);
+
+        if (benchmark)
+        {
+            // Halfway out every cell has unloaded, and the rest of the leg lets the frames still using the evicted
+            // prefabs finish so their buffer ranges are free before the way back
+            if (!benchmarkReturned && benchmarkLegFrame == benchmarkLegFrames / 2)
+            {
+                evictUnusedPrefabs(db);
+            }
+            else if (benchmarkReturned && benchmarkLegFrame == benchmarkLegFrames - 1)
+            {
+                const auto lap = static_cast<uint32_t>(benchmarkLeg / 2);
+                const auto gpuBytes = renderer_->gpuMemoryUsage();
+                const auto capacity = renderer_->meshBufferCapacity();
+                const auto now = std::chrono::steady_clock::now();
+                spdlog::info("Streaming lap {} took {:.1f} ms: {} GPU bytes, mesh buffers hold {} vertices, {} "
+                             "indices, {} meshlets",
+                             lap + 1,
+                             std::chrono::duration<double, std::milli>(now - benchmarkLapStartTime).count(),
+                             gpuBytes,
+                             capacity.vertices,
+                             capacity.indices,
+                             capacity.meshlets);
+                benchmarkLapStartTime = now;
+
+                if (lap == 0)
+                {
+                    firstLapGpuBytes = gpuBytes;
+                    firstLapCapacity = capacity;
+                }
+                else if (gpuBytes > firstLapGpuBytes || capacity.vertices > firstLapCapacity.vertices
+                         || capacity.indices > firstLapCapacity.indices
+                         || capacity.meshlets > firstLapCapacity.meshlets)
+                {
+                    throw std::runtime_error("GPU memory grew streaming the same cells in and out on lap "
+                                             + std::to_string(lap + 1));
+                }
+
+                if (lap + 1 >= benchmark->laps)
+                {
+                    break;
+                }
+            }
+
+            benchmarkFrame++;
+        }
+
+        // The benchmark runs flat out
         const auto frameFinishTime = std::chrono::steady_clock::now();
         const auto frameDuration = frameFinishTime - frameStartTime;
-        if (frameDuration < maxFps)
+        if (!benchmark && frameDuration < maxFps)
         {
             std::this_thread::sleep_for(maxFps - frameDuration);
         }
     }
 
     gpuDevice_->device().waitIdle();
+    renderer_->setFrameArenas(nullptr);
 }
 
 void VulkanApplication::windowResized(int width, int height)
@@ -278,6 +496,12 @@ void VulkanApplication::initVulkan(int windowWidth, int windowHeight)
     spdlog::info("Creating GPU device");
     gpuDevice_ = std::make_unique<renderer::GpuDevice>(instance_, surface_);
 
+    // Basis Universal textures are transcoded at load time to a block format the device can sample
+    assets::setTranscodeTargets(
+        assets::TranscodeTargets{.bc7 = gpuDevice_->supportsSampledImageFormat(vk::Format::eBc7SrgbBlock),
+                                 .astc4x4 = gpuDevice_->supportsSampledImageFormat(vk::Format::eAstc4x4SrgbBlock),
+                                 .etc2 = gpuDevice_->supportsSampledImageFormat(vk::Format::eEtc2R8G8B8A8SrgbBlock)});
+
     spdlog::info("Creating renderer");
     renderer_ = std::make_unique<renderer::Renderer>(instance_, surface_, *gpuDevice_, windowWidth, windowHeight);
 
@@ -329,9 +553,16 @@ void VulkanApplication::createInstance()
 
 void VulkanApplication::createDebugMessenger()
 {
-    const auto severityFlags = (vk::DebugUtilsMessageSeverityFlagBitsEXT::eVerbose
-                                | vk::DebugUtilsMessageSeverityFlagBitsEXT::eWarning
-                                | vk::DebugUtilsMessageSeverityFlagBitsEXT::eError);
+    auto severityFlags = (vk::DebugUtilsMessageSeverityFlagBitsEXT::eWarning
+                          | vk::DebugUtilsMessageSeverityFlagBitsEXT::eError);
+
+    // Verbose messages are logged at debug level, so there's no point in the layers producing them when that's
+    // compiled out
+    if constexpr (SPDLOG_ACTIVE_LEVEL <= SPDLOG_LEVEL_DEBUG)
+    {
+        severityFlags |= vk::DebugUtilsMessageSeverityFlagBitsEXT::eVerbose;
+    }
+
     const auto messageTypeFlags = (vk::DebugUtilsMessageTypeFlagBitsEXT::eGeneral
                                    | vk::DebugUtilsMessageTypeFlagBitsEXT::ePerformance
                                    | vk::DebugUtilsMessageTypeFlagBitsEXT::eValidation);
@@ -403,3 +634,118 @@ void VulkanApplication::updateCamera(float deltaTime)
         camera_->setPosition(camera_->position() + movement);
     }
 }
+
+void VulkanApplication::logResidency(const assets::AssetDatabase& db) const
+{
+    auto totalCpuBytes = size_t{0};
+    auto totalGpuBytes = size_t{0};
+
+    db.pool<assets::Image>().forEach(
+        [&](assets::Handle<assets::Image> handle, const assets::Image& image)
+        {
+            const auto cpuBytes = assets::cpuMemoryUsage(image);
+            const auto gpuBytes = renderer_->gpuMemoryUsage(handle);
+            spdlog::debug("Image {}: {} CPU bytes, {} GPU bytes", handle.index, cpuBytes, gpuBytes);
+            totalCpuBytes += cpuBytes;
+            totalGpuBytes += gpuBytes;
+        });
+
+    db.pool<assets::SubMesh>().forEach(
+        [&](assets::Handle<assets::SubMesh> handle, const assets::SubMesh& subMesh)
+        {
+            const auto cpuBytes = assets::cpuMemoryUsage(subMesh);
+            const auto gpuBytes = renderer_->gpuMemoryUsage(handle);
+            spdlog::debug("Sub-mesh {}: {} CPU bytes, {} GPU bytes", handle.index, cpuBytes, gpuBytes);
+            totalCpuBytes += cpuBytes;
+            totalGpuBytes += gpuBytes;
+        });
+
+    spdlog::info("Assets use {} CPU bytes and {} GPU bytes", totalCpuBytes, totalGpuBytes);
+}
+
+void VulkanApplication::checkFrameAllocations(uint64_t frame,
+                                              bool warmedUp,
+                                              std::vector<core::AllocationZoneStats>& stats) const
+{
+    if (!core::allocationTrackingEnabled())
+    {
+        return;
+    }
+
+    core::takeAllocationZoneStats(stats);
+
+    const auto eventAllocations = [&](std::thread::id thread)
+    {
+        auto allocations = uint64_t{0};
+        for (const auto& zone : stats)
+        {
+            const auto isEventZone = std::ranges::find(allocatingEventZones, zone.name) != allocatingEventZones.end();
+            if (zone.thread == thread && isEventZone)
+            {
+                allocations += zone.counts.allocations;
+            }
+        }
+        return allocations;
+    };
+
+    for (const auto& zone : stats)
+    {
+        if (!warmedUp || std::ranges::find(allocationFreeZones, zone.name) == allocationFreeZones.end())
+        {
+            continue;
+        }
+
+        // Event zones are nested inside the allocation-free ones, so their allocations are counted by both
+        const auto allocations = zone.counts.allocations - std::min(zone.counts.allocations,
+                                                                    eventAllocations(zone.thread));
+        if (allocations > 0)
+        {
+            throw std::runtime_error("Frame " + std::to_string(frame) + " made " + std::to_string(allocations)
+                                     + " heap allocations in " + zone.name);
+        }
+    }
+
+    if (frame % allocationReportInterval == 0)
+    {
+        for (const auto& zone : stats)
+        {
+            spdlog::debug("Frame {}: {} entered {} times, {} allocations, {} deallocations, {} bytes",
+                          frame,
+                          zone.name,
+                          zone.entries,
+                          zone.counts.allocations,
+                          zone.counts.deallocations,
+                          zone.counts.bytes);
+        }
+
+        const auto process = core::processAllocations();
+        spdlog::debug("Process has made {} allocations and {} deallocations, {} bytes allocated in total",
+                      process.allocations,
+                      process.deallocations,
+                      process.bytes);
+    }
+}
+
+void VulkanApplication::enforceMemoryBudget(assets::AssetDatabase& db)
+{
+    const auto& budget = db.memoryBudget();
+    while (db.cpuMemoryUsage() > budget.cpuBytes || renderer_->gpuMemoryUsage() > budget.gpuBytes)
+    {
+        auto evicted = db.evictLeastRecentlyUsed();
+        if (!evicted)
+        {
+            // Everything still loaded is in use
+            break;
+        }
+
+        renderer_->releaseResources(*evicted);
+    }
+}
+
+void VulkanApplication::evictUnusedPrefabs(assets::AssetDatabase& db)
+{
+    while (auto evicted = db.evictLeastRecentlyUsed())
+    {
+        renderer_->releaseResources(*evicted);
+    }
+}
@@ -6,7 +6,10 @@
 #include <vulkan/vulkan_raii.hpp>
 
 #include <memory>
+#include <optional>
+#include <stdint.h>
 #include <string>
+#include <vector>
 
 namespace assets
 {
@@ -16,7 +19,8 @@ class AssetDatabase;
 namespace core
 {
 class InputHandler;
-}
+struct AllocationZoneStats;
+} // namespace core
 
 namespace renderer
 {
@@ -27,6 +31,14 @@ class Renderer;
 
 struct GLFWwindow;
 
+// Moves the camera out of range of every cell and back instead of taking input, evicting every prefab once the cells
+// have unloaded, so they're loaded and uploaded again on the way back. Each lap must end with no more GPU memory or
+// mesh buffer capacity than the first.
+struct StreamingBenchmark
+{
+    uint32_t laps{8};
+};
+
 class VulkanApplication
 {
   public:
@@ -34,7 +46,8 @@ class VulkanApplication
     ~VulkanApplication();
 
     void init(int windowWidth, int windowHeight, const std::string& windowTitle);
-    void run();
+    // Runs until the window is closed, or the benchmark finishes if there is one
+    void run(const std::optional<StreamingBenchmark>& benchmark = std::nullopt);
 
     void windowResized(int width, int height);
     void keyPressed(int key, int scancode, int action, int mods);
@@ -50,6 +63,14 @@ class VulkanApplication
 
     void updateCamera(float deltaTime);
 
+    void logResidency(const assets::AssetDatabase& db) const;
+    void enforceMemoryBudget(assets::AssetDatabase& db);
+    void evictUnusedPrefabs(assets::AssetDatabase& db);
+
+    // Takes this frame's allocation zone stats, logging them periodically. Once warmed up, throws if a zone that
+    // should be allocation-free allocated.
+    void checkFrameAllocations(uint64_t frame, bool warmedUp, std::vector<core::AllocationZoneStats>& stats) const;
+
   private:
     bool glfwInitialised_{false};
     GLFWwindow* window_{nullptr};
@@ -3,10 +3,16 @@
 
 #pragma once
 
+#include <assets/handle.h>
+
 #include <glm/glm.hpp>
 
+#include <cstdint>
+
 namespace assets
 {
+struct Material;
+struct Prefab;
 struct SubMesh;
 } // namespace assets
 
@@ -14,7 +20,13 @@ namespace renderer
 {
 struct DrawCommand
 {
-    assets::SubMesh* subMesh;
+    assets::Handle<assets::SubMesh> subMesh;
+    assets::Handle<assets::Material> material;
     glm::mat4 transform;
+
+    // Instanced draws read instanceCount transforms from the prefab's instance array, starting at instanceOffset
+    assets::Handle<assets::Prefab> prefab;
+    uint32_t instanceOffset{0};
+    uint32_t instanceCount{0};
 };
 } // namespace renderer
@@ -21,13 +21,22 @@ class GpuDevice
     GpuDevice& operator=(GpuDevice&& other) = delete;
 
     vk::raii::CommandBuffers createCommandBuffers(uint32_t count) const;
+    // Submits and waits for the command buffer to finish
     void submitCommandBuffer(const vk::CommandBuffer& cmd) const;
+
+    // Submits without waiting, signalling the timeline semaphore with signalValue when the command buffer finishes
+    void submitCommandBuffer(const vk::CommandBuffer& cmd,
+                             const vk::Semaphore& timelineSemaphore,
+                             uint64_t signalValue) const;
     void submitCommandBuffer(const vk::CommandBuffer& cmd,
                              std::span<vk::Semaphore> waitSemaphores,
                              const vk::PipelineStageFlags& waitStageMask,
                              std::span<vk::Semaphore> signalSemaphores,
                              const vk::Fence& fence) const;
 
+    vk::raii::Semaphore createTimelineSemaphore(uint64_t initialValue = 0) const;
+    void waitForTimeline(const vk::Semaphore& timelineSemaphore, uint64_t value) const;
+
     vk::raii::Buffer createBuffer(const vk::DeviceSize& size,
                                   const vk::BufferUsageFlags& usage,
                                   const vk::SharingMode& sharingMode) const;
@@ -41,14 +50,30 @@ class GpuDevice
                            uint32_t width,
                            uint32_t height,
                            uint32_t layers = 1) const;
-
-    vk::raii::Image createImage(uint32_t width, uint32_t height) const;
-    vk::raii::Image createCubemapImage(uint32_t width, uint32_t height) const;
+    void copyBufferToImage(const vk::CommandBuffer& cmd,
+                           const vk::Buffer& source,
+                           const vk::Image& destination,
+                           std::span<const vk::BufferImageCopy> regions) const;
+
+    vk::raii::Image createImage(uint32_t width,
+                                uint32_t height,
+                                vk::Format format = vk::Format::eR8G8B8A8Srgb,
+                                uint32_t mipLevels = 1) const;
+    vk::raii::Image createCubemapImage(uint32_t width,
+                                       uint32_t height,
+                                       vk::Format format = vk::Format::eR8G8B8A8Srgb,
+                                       uint32_t mipLevels = 1) const;
     vk::raii::Image createDepthImage(uint32_t width, uint32_t height) const;
 
-    vk::raii::ImageView createImageView(const vk::raii::Image& image) const;
+    vk::raii::ImageView createImageView(const vk::raii::Image& image,
+                                        vk::Format format = vk::Format::eR8G8B8A8Srgb,
+                                        uint32_t mipLevels = 1) const;
     vk::raii::ImageView createDepthImageView(const vk::raii::Image& image) const;
-    vk::raii::ImageView createCubemapImageView(const vk::raii::Image& image) const;
+    vk::raii::ImageView createCubemapImageView(const vk::raii::Image& image,
+                                               vk::Format format = vk::Format::eR8G8B8A8Srgb,
+                                               uint32_t mipLevels = 1) const;
+
+    bool supportsSampledImageFormat(vk::Format format) const;
 
     vk::raii::Sampler createSampler() const;
 
@@ -61,7 +86,21 @@ class GpuDevice
                                vk::PipelineStageFlags2 srcStageMask,
                                vk::PipelineStageFlags2 dstStageMask,
                                const vk::ImageAspectFlags& aspectFlags,
-                               uint32_t layerCount = 1) const;
+                               uint32_t layerCount = 1,
+                               uint32_t levelCount = 1) const;
+
+    void bufferMemoryBarrier(const vk::Buffer& buffer,
+                             const vk::CommandBuffer& commandBuffer,
+                             vk::AccessFlags2 srcAccessMask,
+                             vk::AccessFlags2 dstAccessMask,
+                             vk::PipelineStageFlags2 srcStageMask,
+                             vk::PipelineStageFlags2 dstStageMask) const;
+
+    void memoryBarrier(const vk::CommandBuffer& commandBuffer,
+                       vk::AccessFlags2 srcAccessMask,
+                       vk::AccessFlags2 dstAccessMask,
+                       vk::PipelineStageFlags2 srcStageMask,
+                       vk::PipelineStageFlags2 dstStageMask) const;
 
     vk::raii::DeviceMemory allocateBufferMemory(const vk::raii::Buffer& buffer,
                                                 vk::MemoryPropertyFlags properties) const;
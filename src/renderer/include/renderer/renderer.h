@@ -5,26 +5,48 @@
 
 #include "renderer/draw_command.h"
 
+#include <assets/handle.h>
+
 #include <assets/material.h>
 
 #include <vulkan/vulkan_raii.hpp>
 
 #include <memory>
+#include <span>
 #include <vector>
 
 namespace assets
 {
 class AssetDatabase;
+struct EvictedAssets;
+struct Image;
+struct SubMesh;
 struct Skybox;
 } // namespace assets
 
+namespace core
+{
+class FrameArenas;
+class Timeline;
+} // namespace core
+
 namespace renderer
 {
 class Camera;
+class ClusterCullPass;
 class GeometryPass;
 class GpuDevice;
 class GpuResourceCache;
 class SkyboxPass;
+class TextureStreamer;
+
+// Elements the buffers shared by every mesh's geometry have room for, including ranges not in use
+struct MeshBufferCapacity
+{
+    size_t vertices{0};
+    size_t indices{0};
+    size_t meshlets{0};
+};
 
 class Renderer
 {
@@ -44,13 +66,39 @@ class Renderer
     Renderer& operator=(Renderer&& other) = delete;
 
     void renderFrame(const renderer::Camera& camera,
-                     assets::Skybox* skybox,
-                     const std::vector<DrawCommand>& drawCommands);
+                     assets::Handle<assets::Skybox> skybox,
+                     std::span<const DrawCommand> drawCommands);
 
     void windowResized(int width, int height);
 
     void setResources(const assets::AssetDatabase& db);
 
+    // Uploads assets added since setResources() and retires the removed ones, without waiting for the device
+    void updateResources(const assets::AssetDatabase& db, const assets::EvictedAssets& removed);
+
+    size_t gpuMemoryUsage(assets::Handle<assets::Image> image) const;
+    size_t gpuMemoryUsage(assets::Handle<assets::SubMesh> mesh) const;
+    size_t gpuMemoryUsage() const;
+    MeshBufferCapacity meshBufferCapacity() const;
+
+    // VRAM for the finer mips of streamed textures
+    void setTextureStreamingBudget(size_t bytes);
+
+    // Frees the GPU copies of evicted assets once every frame that might still be using them has completed
+    void releaseResources(const assets::EvictedAssets& evicted);
+
+    // Per-frame scratch data comes from the calling thread's arena when set, the heap otherwise. Not owned; the
+    // caller begins each frame on the arenas before rendering it.
+    void setFrameArenas(core::FrameArenas* frameArenas);
+
+    // Number of frames the GPU has finished, for coroutines to wait on. Rises as renderFrame() waits for each frame
+    // slot and resumes waiters on the rendering thread.
+    core::Timeline& completedFrames();
+
+    // Number of the next frame to be rendered. Uploads made before rendering it are complete once completedFrames()
+    // passes this value.
+    uint64_t frameNumber() const;
+
   private:
     void createSwapchain();
     void createSwapchainImageViews();
@@ -67,8 +115,8 @@ class Renderer
     void recordCommands(uint32_t imageIndex,
                         const vk::raii::CommandBuffer& commandBuffer,
                         const renderer::Camera& camera,
-                        assets::Skybox* skybox,
-                        const std::vector<DrawCommand>& drawCommands);
+                        assets::Handle<assets::Skybox> skybox,
+                        std::span<const DrawCommand> drawCommands);
 
     void createDepthBufferImage();
     void createRenderPasses();
@@ -97,6 +145,7 @@ class Renderer
     std::vector<vk::raii::Semaphore> renderFinishedSemaphores_;
     std::vector<vk::raii::Fence> drawFences_;
     uint32_t currentFrameIndex_{0};
+    uint64_t frameNumber_{0};
 
     vk::raii::Image depthImage_{nullptr};
     vk::raii::DeviceMemory depthImageMemory_{nullptr};
@@ -108,7 +157,11 @@ class Renderer
     std::vector<vk::raii::DescriptorSet> cameraDescriptorSets_;
 
     std::unique_ptr<GpuResourceCache> gpuResources_{nullptr};
+    std::unique_ptr<TextureStreamer> textureStreamer_{nullptr};
+    core::FrameArenas* frameArenas_{nullptr};
+    std::unique_ptr<core::Timeline> completedFrames_;
 
+    std::unique_ptr<ClusterCullPass> clusterCullPass_{nullptr};
     std::unique_ptr<SkyboxPass> skyboxPass_{nullptr};
     std::unique_ptr<GeometryPass> geometryPass_{nullptr};
 };
@@ -49,5 +49,30 @@ struct VertexLayout
                                                                   normalAttribute,
                                                                   textureUVAttribute};
     }
+
+    // Per-instance transform, stepped once per instance and passed as four column attributes
+    static vk::VertexInputBindingDescription instanceBindingDescription()
+    {
+        auto bindingDescription = vk::VertexInputBindingDescription{};
+        bindingDescription.binding = 1;
+        bindingDescription.stride = sizeof(glm::mat4);
+        bindingDescription.inputRate = vk::VertexInputRate::eInstance;
+
+        return bindingDescription;
+    }
+
+    static std::array<vk::VertexInputAttributeDescription, 4> instanceAttributeDescriptions()
+    {
+        auto attributes = std::array<vk::VertexInputAttributeDescription, 4>{};
+        for (auto column = uint32_t{0}; column < attributes.size(); ++column)
+        {
+            attributes[column].location = 3 + column;
+            attributes[column].binding = 1;
+            attributes[column].format = vk::Format::eR32G32B32A32Sfloat;
+            attributes[column].offset = column * sizeof(glm::vec4);
+        }
+
+        return attributes;
+    }
 };
 } // namespace renderer
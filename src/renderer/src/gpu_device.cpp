@@ -118,8 +118,31 @@ void GpuDevice::submitCommandBuffer(const vk::CommandBuffer& cmd) const
     submitInfo.commandBufferCount = 1;
     submitInfo.pCommandBuffers = &cmd;
 
+    // Waits for this submission only, not for the frames in flight ahead of it
+    auto fence = vk::raii::Fence{device_, vk::FenceCreateInfo{}};
+    graphicsQueue_.submit(submitInfo, *fence);
+    if (device_.waitForFences(*fence, vk::True, UINT64_MAX) != vk::Result::eSuccess)
+    {
+        throw std::runtime_error("Device unable to wait for fence to signal");
+    }
+}
+
+void GpuDevice::submitCommandBuffer(const vk::CommandBuffer& cmd,
+                                    const vk::Semaphore& timelineSemaphore,
+                                    uint64_t signalValue) const
+{
+    auto timelineInfo = vk::TimelineSemaphoreSubmitInfo{};
+    timelineInfo.signalSemaphoreValueCount = 1;
+    timelineInfo.pSignalSemaphoreValues = &signalValue;
+
+    auto submitInfo = vk::SubmitInfo{};
+    submitInfo.pNext = &timelineInfo;
+    submitInfo.commandBufferCount = 1;
+    submitInfo.pCommandBuffers = &cmd;
+    submitInfo.signalSemaphoreCount = 1;
+    submitInfo.pSignalSemaphores = &timelineSemaphore;
+
     graphicsQueue_.submit(submitInfo);
-    graphicsQueue_.waitIdle();
 }
 
 void GpuDevice::submitCommandBuffer(const vk::CommandBuffer& cmd,
@@ -140,6 +163,31 @@ void GpuDevice::submitCommandBuffer(const vk::CommandBuffer& cmd,
     graphicsQueue_.submit(submitInfo, fence);
 }
 
+vk::raii::Semaphore GpuDevice::createTimelineSemaphore(uint64_t initialValue) const
+{
+    auto typeInfo = vk::SemaphoreTypeCreateInfo{};
+    typeInfo.semaphoreType = vk::SemaphoreType::eTimeline;
+    typeInfo.initialValue = initialValue;
+
+    auto semaphoreInfo = vk::SemaphoreCreateInfo{};
+    semaphoreInfo.pNext = &typeInfo;
+
+    return vk::raii::Semaphore{device_, semaphoreInfo};
+}
+
+void GpuDevice::waitForTimeline(const vk::Semaphore& timelineSemaphore, uint64_t value) const
+{
+    auto waitInfo = vk::SemaphoreWaitInfo{};
+    waitInfo.semaphoreCount = 1;
+    waitInfo.pSemaphores = &timelineSemaphore;
+    waitInfo.pValues = &value;
+
+    if (device_.waitSemaphores(waitInfo, UINT64_MAX) != vk::Result::eSuccess)
+    {
+        throw std::runtime_error("Device unable to wait for timeline semaphore");
+    }
+}
+
 vk::raii::Buffer GpuDevice::createBuffer(const vk::DeviceSize& size,
                                          const vk::BufferUsageFlags& usage,
                                          const vk::SharingMode& sharingMode) const
@@ -185,13 +233,21 @@ void GpuDevice::copyBufferToImage(const vk::CommandBuffer& cmd,
     cmd.copyBufferToImage(source, destination, vk::ImageLayout::eTransferDstOptimal, region);
 }
 
-vk::raii::Image GpuDevice::createImage(uint32_t width, uint32_t height) const
+void GpuDevice::copyBufferToImage(const vk::CommandBuffer& cmd,
+                                  const vk::Buffer& source,
+                                  const vk::Image& destination,
+                                  std::span<const vk::BufferImageCopy> regions) const
+{
+    cmd.copyBufferToImage(source, destination, vk::ImageLayout::eTransferDstOptimal, regions);
+}
+
+vk::raii::Image GpuDevice::createImage(uint32_t width, uint32_t height, vk::Format format, uint32_t mipLevels) const
 {
     auto imageInfo = vk::ImageCreateInfo{};
     imageInfo.imageType = vk::ImageType::e2D;
-    imageInfo.format = vk::Format::eR8G8B8A8Srgb;
+    imageInfo.format = format;
     imageInfo.extent = vk::Extent3D{width, height, 1};
-    imageInfo.mipLevels = 1;
+    imageInfo.mipLevels = mipLevels;
     imageInfo.arrayLayers = 1;
     imageInfo.samples = vk::SampleCountFlagBits::e1;
     imageInfo.tiling = vk::ImageTiling::eOptimal;
@@ -202,13 +258,16 @@ vk::raii::Image GpuDevice::createImage(uint32_t width, uint32_t height) const
     return vk::raii::Image{device_, imageInfo};
 }
 
-vk::raii::Image GpuDevice::createCubemapImage(uint32_t width, uint32_t height) const
+vk::raii::Image GpuDevice::createCubemapImage(uint32_t width,
+                                              uint32_t height,
+                                              vk::Format format,
+                                              uint32_t mipLevels) const
 {
     auto imageInfo = vk::ImageCreateInfo{};
     imageInfo.imageType = vk::ImageType::e2D;
-    imageInfo.format = vk::Format::eR8G8B8A8Srgb;
+    imageInfo.format = format;
     imageInfo.extent = vk::Extent3D{width, height, 1};
-    imageInfo.mipLevels = 1;
+    imageInfo.mipLevels = mipLevels;
     imageInfo.arrayLayers = 6;
     imageInfo.samples = vk::SampleCountFlagBits::e1;
     imageInfo.tiling = vk::ImageTiling::eOptimal;
@@ -237,19 +296,21 @@ vk::raii::Image GpuDevice::createDepthImage(uint32_t width, uint32_t height) con
     return vk::raii::Image{device_, imageInfo};
 }
 
-vk::raii::ImageView GpuDevice::createImageView(const vk::raii::Image& image) const
+vk::raii::ImageView GpuDevice::createImageView(const vk::raii::Image& image,
+                                               vk::Format format,
+                                               uint32_t mipLevels) const
 {
     auto subresourceRange = vk::ImageSubresourceRange{};
     subresourceRange.aspectMask = vk::ImageAspectFlagBits::eColor;
     subresourceRange.baseMipLevel = 0;
-    subresourceRange.levelCount = 1;
+    subresourceRange.levelCount = mipLevels;
     subresourceRange.baseArrayLayer = 0;
     subresourceRange.layerCount = 1;
 
     auto imageViewCreateInfo = vk::ImageViewCreateInfo{};
     imageViewCreateInfo.image = *image;
     imageViewCreateInfo.viewType = vk::ImageViewType::e2D;
-    imageViewCreateInfo.format = vk::Format::eR8G8B8A8Srgb;
+    imageViewCreateInfo.format = format;
     imageViewCreateInfo.subresourceRange = subresourceRange;
 
     return vk::raii::ImageView{device_, imageViewCreateInfo};
@@ -273,19 +334,21 @@ vk::raii::ImageView GpuDevice::createDepthImageView(const vk::raii::Image& image
     return vk::raii::ImageView{device_, imageViewCreateInfo};
 }
 
-vk::raii::ImageView GpuDevice::createCubemapImageView(const vk::raii::Image& image) const
+vk::raii::ImageView GpuDevice::createCubemapImageView(const vk::raii::Image& image,
+                                                      vk::Format format,
+                                                      uint32_t mipLevels) const
 {
     auto subresourceRange = vk::ImageSubresourceRange{};
     subresourceRange.aspectMask = vk::ImageAspectFlagBits::eColor;
     subresourceRange.baseMipLevel = 0;
-    subresourceRange.levelCount = 1;
+    subresourceRange.levelCount = mipLevels;
     subresourceRange.baseArrayLayer = 0;
     subresourceRange.layerCount = 6;
 
     auto imageViewCreateInfo = vk::ImageViewCreateInfo{};
     imageViewCreateInfo.image = *image;
     imageViewCreateInfo.viewType = vk::ImageViewType::eCube;
-    imageViewCreateInfo.format = vk::Format::eR8G8B8A8Srgb;
+    imageViewCreateInfo.format = format;
     imageViewCreateInfo.subresourceRange = subresourceRange;
 
     return vk::raii::ImageView{device_, imageViewCreateInfo};
@@ -305,10 +368,17 @@ vk::raii::Sampler GpuDevice::createSampler() const
     samplerInfo.unnormalizedCoordinates = VK_FALSE;
     samplerInfo.compareEnable = VK_FALSE;
     samplerInfo.mipmapMode = vk::SamplerMipmapMode::eLinear;
+    samplerInfo.maxLod = vk::LodClampNone;
 
     return vk::raii::Sampler(device_, samplerInfo);
 }
 
+bool GpuDevice::supportsSampledImageFormat(vk::Format format) const
+{
+    const auto properties = physicalDevice_.getFormatProperties(format);
+    return static_cast<bool>(properties.optimalTilingFeatures & vk::FormatFeatureFlagBits::eSampledImage);
+}
+
 void GpuDevice::transitionImageLayout(const vk::Image& image,
                                       const vk::CommandBuffer& commandBuffer,
                                       vk::ImageLayout oldLayout,
@@ -318,7 +388,8 @@ void GpuDevice::transitionImageLayout(const vk::Image& image,
                                       vk::PipelineStageFlags2 srcStageMask,
                                       vk::PipelineStageFlags2 dstStageMask,
                                       const vk::ImageAspectFlags& aspectFlags,
-                                      uint32_t layerCount) const
+                                      uint32_t layerCount,
+                                      uint32_t levelCount) const
 {
     auto barrier = vk::ImageMemoryBarrier2{};
     barrier.srcStageMask = srcStageMask;
@@ -332,7 +403,7 @@ void GpuDevice::transitionImageLayout(const vk::Image& image,
     barrier.image = image;
     barrier.subresourceRange.aspectMask = aspectFlags;
     barrier.subresourceRange.baseMipLevel = 0;
-    barrier.subresourceRange.levelCount = 1;
+    barrier.subresourceRange.levelCount = levelCount;
     barrier.subresourceRange.baseArrayLayer = 0;
     barrier.subresourceRange.layerCount = layerCount;
 
@@ -343,6 +414,50 @@ void GpuDevice::transitionImageLayout(const vk::Image& image,
     commandBuffer.pipelineBarrier2(dependencyInfo);
 }
 
+void GpuDevice::bufferMemoryBarrier(const vk::Buffer& buffer,
+                                    const vk::CommandBuffer& commandBuffer,
+                                    vk::AccessFlags2 srcAccessMask,
+                                    vk::AccessFlags2 dstAccessMask,
+                                    vk::PipelineStageFlags2 srcStageMask,
+                                    vk::PipelineStageFlags2 dstStageMask) const
+{
+    auto barrier = vk::BufferMemoryBarrier2{};
+    barrier.srcStageMask = srcStageMask;
+    barrier.srcAccessMask = srcAccessMask;
+    barrier.dstStageMask = dstStageMask;
+    barrier.dstAccessMask = dstAccessMask;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.buffer = buffer;
+    barrier.offset = 0;
+    barrier.size = VK_WHOLE_SIZE;
+
+    auto dependencyInfo = vk::DependencyInfo{};
+    dependencyInfo.bufferMemoryBarrierCount = 1;
+    dependencyInfo.pBufferMemoryBarriers = &barrier;
+
+    commandBuffer.pipelineBarrier2(dependencyInfo);
+}
+
+void GpuDevice::memoryBarrier(const vk::CommandBuffer& commandBuffer,
+                              vk::AccessFlags2 srcAccessMask,
+                              vk::AccessFlags2 dstAccessMask,
+                              vk::PipelineStageFlags2 srcStageMask,
+                              vk::PipelineStageFlags2 dstStageMask) const
+{
+    auto barrier = vk::MemoryBarrier2{};
+    barrier.srcStageMask = srcStageMask;
+    barrier.srcAccessMask = srcAccessMask;
+    barrier.dstStageMask = dstStageMask;
+    barrier.dstAccessMask = dstAccessMask;
+
+    auto dependencyInfo = vk::DependencyInfo{};
+    dependencyInfo.memoryBarrierCount = 1;
+    dependencyInfo.pMemoryBarriers = &barrier;
+
+    commandBuffer.pipelineBarrier2(dependencyInfo);
+}
+
 vk::raii::DeviceMemory GpuDevice::allocateBufferMemory(const vk::raii::Buffer& buffer,
                                                        vk::MemoryPropertyFlags properties) const
 {
@@ -426,10 +541,22 @@ void GpuDevice::createLogicalDevice(const vk::raii::SurfaceKHR& surface)
     deviceQueueCreateInfo.pQueuePriorities = &queuePriority;
 
     auto deviceFeatures = vk::PhysicalDeviceFeatures2{};
+    deviceFeatures.features.multiDrawIndirect = true;
+    deviceFeatures.features.drawIndirectFirstInstance = true;
+
+    // Block compressed textures (e.g. from KTX2 files) can use whichever families the device supports
+    const auto supportedFeatures = physicalDevice_.getFeatures();
+    deviceFeatures.features.textureCompressionBC = supportedFeatures.textureCompressionBC;
+    deviceFeatures.features.textureCompressionETC2 = supportedFeatures.textureCompressionETC2;
+    deviceFeatures.features.textureCompressionASTC_LDR = supportedFeatures.textureCompressionASTC_LDR;
 
     auto vulkan11Features = vk::PhysicalDeviceVulkan11Features{};
     vulkan11Features.shaderDrawParameters = true;
 
+    auto vulkan12Features = vk::PhysicalDeviceVulkan12Features{};
+    vulkan12Features.drawIndirectCount = true;
+    vulkan12Features.timelineSemaphore = true;
+
     auto vulkan13Features = vk::PhysicalDeviceVulkan13Features{};
     vulkan13Features.synchronization2 = true;
     vulkan13Features.dynamicRendering = true;
@@ -439,10 +566,12 @@ void GpuDevice::createLogicalDevice(const vk::raii::SurfaceKHR& surface)
 
     auto featureChain = vk::StructureChain<vk::PhysicalDeviceFeatures2,
                                            vk::PhysicalDeviceVulkan11Features,
+                                           vk::PhysicalDeviceVulkan12Features,
                                            vk::PhysicalDeviceVulkan13Features,
                                            vk::PhysicalDeviceExtendedDynamicStateFeaturesEXT>{
         deviceFeatures,
         vulkan11Features,
+        vulkan12Features,
         vulkan13Features,
         extendedDynamicStateFeatures};
 
@@ -484,6 +613,16 @@ bool GpuDevice::isDeviceSuitable(vk::raii::PhysicalDevice device) const
         return false;
     }
 
+    // Cluster culling writes a variable number of indirect draws per sub-mesh
+    const auto features = device.getFeatures2<vk::PhysicalDeviceFeatures2, vk::PhysicalDeviceVulkan12Features>();
+    if (!features.get<vk::PhysicalDeviceFeatures2>().features.multiDrawIndirect
+        || !features.get<vk::PhysicalDeviceFeatures2>().features.drawIndirectFirstInstance
+        || !features.get<vk::PhysicalDeviceVulkan12Features>().drawIndirectCount)
+    {
+        spdlog::info("Skipping {} - Does not support indirect count draws", deviceName);
+        return false;
+    }
+
     const auto extensionProperties = device.enumerateDeviceExtensionProperties();
     bool hasAllRequiredExtensions = true;
     for (const auto& requiredExtension : deviceExtensions)
@@ -13,5 +13,9 @@ struct GpuImage
     vk::raii::DeviceMemory memory{nullptr};
     vk::raii::ImageView view{nullptr};
     vk::raii::Sampler sampler{nullptr};
+    vk::DeviceSize memorySize{0};
+
+    // Finest mip of the source image held by the GPU image, which is its level 0. Non-zero while streaming.
+    uint32_t baseMip{0};
 };
 } // namespace renderer
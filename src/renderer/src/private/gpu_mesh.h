@@ -3,6 +3,8 @@
 
 #pragma once
 
+#include <glm/glm.hpp>
+
 #include <stdint.h>
 
 namespace renderer
@@ -13,5 +15,10 @@ struct GpuMesh
     uint32_t vertexCount;
     uint32_t indexOffset;
     uint32_t indexCount;
+    uint32_t meshletOffset;
+    uint32_t meshletCount;
+
+    // Object space centre and radius, used to estimate how large the mesh appears on screen
+    glm::vec4 boundingSphere;
 };
 } // namespace renderer
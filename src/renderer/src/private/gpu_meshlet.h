@@ -0,0 +1,22 @@
+/// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Mark Rapson
+
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <stdint.h>
+
+namespace renderer
+{
+// Matches the Meshlet struct in cluster_cull.slang (std430)
+struct GpuMeshlet
+{
+    glm::vec4 boundingSphere; // xyz centre, w radius
+    glm::vec4 cone;           // xyz axis, w cutoff
+    uint32_t firstIndex;
+    uint32_t indexCount;
+    int32_t vertexOffset;
+    uint32_t _padding;
+};
+} // namespace renderer
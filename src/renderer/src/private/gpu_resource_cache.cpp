@@ -2,15 +2,36 @@
 // Copyright (c) 2025 Mark Rapson
 
 #include "gpu_resource_cache.h"
+#include "texture_streamer.h"
 
 #include "renderer/gpu_device.h"
 
 #include <assets/asset_database.h>
+#include <assets/prefab.h>
+#include <core/allocation_tracker.h>
 
+#include <algorithm>
 #include <stdexcept>
 
 namespace renderer
 {
+// Sized to hold a few 4K textures between flushes; larger images grow the ring
+constexpr auto stagingRingCapacity = vk::DeviceSize{64} * 1024 * 1024;
+
+// Satisfies the copy offset alignment of every supported format, including 16-byte compressed blocks
+constexpr auto stagingAlignment = vk::DeviceSize{16};
+
+// Spare material slots reserved for materials added by reloads, 256 bytes each per frame in flight at most
+constexpr auto materialHeadroom = uint32_t{1024};
+
+// Mesh buffers are also copy sources so they can grow when reloads add geometry
+constexpr auto vertexBufferUsage = vk::BufferUsageFlagBits::eVertexBuffer | vk::BufferUsageFlagBits::eTransferDst
+                                   | vk::BufferUsageFlagBits::eTransferSrc;
+constexpr auto indexBufferUsage = vk::BufferUsageFlagBits::eIndexBuffer | vk::BufferUsageFlagBits::eTransferDst
+                                  | vk::BufferUsageFlagBits::eTransferSrc;
+constexpr auto meshletBufferUsage = vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eTransferDst
+                                    | vk::BufferUsageFlagBits::eTransferSrc;
+
 vk::DeviceSize alignMemory(vk::DeviceSize data, vk::DeviceSize alignment)
 {
     if (data < alignment || data == alignment)
@@ -29,7 +50,9 @@ GpuResourceCache::GpuResourceCache(const assets::AssetDatabase& db,
     : gpuDevice_{gpuDevice},
       maxFramesInFlight_{maxFramesInFlight},
       materialDescriptorSetLayout_{materialDescriptorSetLayout},
-      skyboxDescriptorSetLayout_{skyboxDescriptorSetLayout}
+      skyboxDescriptorSetLayout_{skyboxDescriptorSetLayout},
+      assetDatabase_{&db},
+      stagingRing_{gpuDevice, stagingRingCapacity}
 {
     createDefaultData();
 
@@ -46,54 +69,322 @@ const vk::raii::Buffer& GpuResourceCache::meshIndexBuffer() const
     return meshIndexBuffer_;
 }
 
-GpuImage& GpuResourceCache::gpuImage(assets::Image* image)
+const vk::raii::Buffer& GpuResourceCache::meshletBuffer() const
+{
+    return meshletBuffer_;
+}
+
+const vk::raii::Buffer& GpuResourceCache::meshInstanceBuffer() const
+{
+    return meshInstanceBuffer_;
+}
+
+// Per-asset GPU data is stored in arrays indexed by the asset's handle
+template <typename Resource, typename AssetType>
+Resource& slot(std::vector<Resource>& resources, assets::Handle<AssetType> handle, const char* error)
+{
+    if (handle.index >= resources.size())
+    {
+        throw std::runtime_error(error);
+    }
+
+    return resources[handle.index];
+}
+
+GpuImage& GpuResourceCache::gpuImage(assets::Handle<assets::Image> image)
+{
+    auto& gpuImage = slot(gpuImages_, image, "Image handle not uploaded to GPU");
+    if (!*gpuImage.image)
+    {
+        throw std::runtime_error("Image handle not uploaded to GPU");
+    }
+
+    return gpuImage;
+}
+
+GpuMaterial& GpuResourceCache::gpuMaterial(assets::Handle<assets::Material> material)
+{
+    return slot(gpuMaterials_, material, "Material handle not uploaded to GPU");
+}
+
+GpuMesh& GpuResourceCache::gpuMesh(assets::Handle<assets::SubMesh> mesh)
+{
+    return slot(gpuMeshes_, mesh, "Mesh handle not uploaded to GPU");
+}
+
+uint32_t GpuResourceCache::instanceOffset(assets::Handle<assets::Prefab> prefab)
+{
+    return slot(prefabInstanceOffsets_, prefab, "Prefab instances not uploaded to GPU");
+}
+
+vk::DeviceSize GpuResourceCache::gpuMemoryUsage(assets::Handle<assets::Image> image) const
+{
+    return image.index < gpuImages_.size() ? gpuImages_[image.index].memorySize : 0;
+}
+
+vk::DeviceSize GpuResourceCache::gpuMemoryUsage(assets::Handle<assets::SubMesh> mesh) const
+{
+    if (mesh.index >= gpuMeshes_.size())
+    {
+        return 0;
+    }
+
+    const auto& gpuMesh = gpuMeshes_[mesh.index];
+    return gpuMesh.vertexCount * sizeof(core::Vertex) + gpuMesh.indexCount * sizeof(uint32_t)
+           + gpuMesh.meshletCount * sizeof(GpuMeshlet);
+}
+
+const assets::AssetDatabase& GpuResourceCache::assetDatabase() const
+{
+    return *assetDatabase_;
+}
+
+assets::Handle<assets::Image> GpuResourceCache::materialTexture(assets::Handle<assets::Material> material) const
+{
+    if (material.index >= materialTextures_.size())
+    {
+        return {};
+    }
+
+    return materialTextures_[material.index];
+}
+
+void GpuResourceCache::streamImage(assets::Handle<assets::Image> handle, uint32_t baseMip)
 {
-    if (auto itr = gpuImages_.find(image); itr != gpuImages_.end())
+    if (pendingImage(handle))
     {
-        return itr->second;
+        throw std::logic_error("Image is already being streamed");
     }
 
-    throw std::runtime_error("Image handle not uploaded to GPU");
+    pendingImages_.push_back(
+        PendingImage{.handle = handle, .image = createGpuImage(assetDatabase_->get(handle), baseMip)});
 }
 
-GpuMaterial& GpuResourceCache::gpuMaterial(assets::Material* material)
+void GpuResourceCache::flushUploads()
 {
-    if (auto itr = gpuMaterials_.find(material); itr != gpuMaterials_.end())
+    // Copies recorded before an earlier flush are covered by this value too
+    const auto uploadValue = stagingRing_.flush();
+    for (auto& pending : pendingImages_)
     {
-        return itr->second;
+        if (pending.uploadValue == 0)
+        {
+            pending.uploadValue = uploadValue;
+        }
     }
+}
+
+void GpuResourceCache::commitStreamedImages(uint64_t retireFrame)
+{
+    for (auto itr = pendingImages_.begin(); itr != pendingImages_.end();)
+    {
+        if (itr->uploadValue == 0 || !stagingRing_.completed(itr->uploadValue))
+        {
+            ++itr;
+            continue;
+        }
+
+        const auto handle = itr->handle;
+        auto retired = RetiredResources{.retireFrame = retireFrame};
+        retired.images.push_back(std::exchange(gpuImage(handle), std::move(itr->image)));
+        itr = pendingImages_.erase(itr);
+
+        // Materials sampling the image switch to it in the next frame recorded
+        for (auto index = uint32_t{0}; index < materialTextures_.size(); ++index)
+        {
+            if (materialTextures_[index] == handle && !materialDescriptorSets_[index].empty())
+            {
+                retired.descriptorSets.push_back(std::move(materialDescriptorSets_[index]));
+                materialDescriptorSets_[index].clear();
+                allocateMaterialDescriptorSets(assets::Handle<assets::Material>{index, 0});
+            }
+        }
+
+        retiredResources_.push_back(std::move(retired));
+    }
+}
+
+const GpuImage* GpuResourceCache::pendingImage(assets::Handle<assets::Image> handle) const
+{
+    const auto itr = std::ranges::find(pendingImages_, handle, &PendingImage::handle);
+    return itr != pendingImages_.end() ? &itr->image : nullptr;
+}
+
+vk::DeviceSize GpuResourceCache::gpuMemoryUsage() const
+{
+    auto bytes = vk::DeviceSize{0};
+    for (const auto& gpuImage : gpuImages_)
+    {
+        bytes += gpuImage.memorySize;
+    }
+
+    for (const auto& pending : pendingImages_)
+    {
+        bytes += pending.image.memorySize;
+    }
+
+    // Evicted geometry leaves free ranges for later geometry rather than shrinking the buffers straight away, so the
+    // buffers' full size is what's in use
+    bytes += vertexCapacity_ * sizeof(core::Vertex) + indexCapacity_ * sizeof(uint32_t)
+             + meshletCapacity_ * sizeof(GpuMeshlet) + instanceBufferSize_;
+
+    return bytes;
+}
+
+size_t GpuResourceCache::vertexCapacity() const
+{
+    return vertexCapacity_;
+}
+
+size_t GpuResourceCache::indexCapacity() const
+{
+    return indexCapacity_;
+}
 
-    throw std::runtime_error("Material handle not uploaded to GPU");
+size_t GpuResourceCache::meshletCapacity() const
+{
+    return meshletCapacity_;
 }
 
-GpuMesh& GpuResourceCache::gpuMesh(assets::SubMesh* mesh)
+void GpuResourceCache::retire(const assets::EvictedAssets& evicted, uint64_t retireFrame)
 {
-    if (auto itr = gpuMeshes_.find(mesh); itr != gpuMeshes_.end())
+    auto retired = RetiredResources{.retireFrame = retireFrame};
+
+    for (const auto& image : evicted.images)
+    {
+        if (image.index < gpuImages_.size() && *gpuImages_[image.index].image)
+        {
+            retired.images.push_back(std::move(gpuImages_[image.index]));
+            gpuImages_[image.index] = GpuImage{};
+        }
+    }
+
+    // Copies still being uploaded into are destroyed once their upload has finished as well
+    const auto streamed = std::ranges::partition(
+        pendingImages_,
+        [&evicted](const PendingImage& pending)
+        { return std::ranges::find(evicted.images, pending.handle) == evicted.images.end(); });
+    if (!streamed.empty())
     {
-        return itr->second;
+        for (auto& pending : streamed)
+        {
+            retired.images.push_back(std::move(pending.image));
+        }
+        retired.uploadValue = stagingRing_.flush();
+        pendingImages_.erase(streamed.begin(), streamed.end());
     }
 
-    throw std::runtime_error("Mesh handle not uploaded to GPU");
+    for (const auto& material : evicted.materials)
+    {
+        if (material.index < materialDescriptorSets_.size() && !materialDescriptorSets_[material.index].empty())
+        {
+            retired.descriptorSets.push_back(std::move(materialDescriptorSets_[material.index]));
+            materialDescriptorSets_[material.index].clear();
+            retired.materialSlots.push_back(gpuMaterials_[material.index].uboOffset);
+        }
+    }
+
+    for (const auto& subMesh : evicted.subMeshes)
+    {
+        if (subMesh.index < gpuMeshes_.size())
+        {
+            retired.meshes.push_back(std::exchange(gpuMeshes_[subMesh.index], GpuMesh{}));
+        }
+    }
+
+    if (!retired.images.empty() || !retired.descriptorSets.empty() || !retired.meshes.empty())
+    {
+        retiredResources_.push_back(std::move(retired));
+    }
 }
 
-GpuImage& GpuResourceCache::gpuSkyboxImage(assets::Skybox* skybox)
+void GpuResourceCache::destroyRetiredResources(uint64_t frame)
 {
-    if (auto itr = gpuSkyboxImages_.find(skybox); itr != gpuSkyboxImages_.end())
+    // Retired in frame and submission order, so everything due is at the front
+    while (!retiredResources_.empty() && retiredResources_.front().retireFrame <= frame
+           && stagingRing_.completed(retiredResources_.front().uploadValue))
     {
-        return itr->second;
+        const auto& retired = retiredResources_.front();
+        freeMaterialSlots_.insert(freeMaterialSlots_.end(), retired.materialSlots.begin(), retired.materialSlots.end());
+
+        if (!retired.meshes.empty())
+        {
+            // Free lists may allocate as ranges split and merge, which only happens after an eviction
+            auto allocationZone = core::AllocationZone{"GpuResourceCache::freeMeshRanges"};
+            for (const auto& gpuMesh : retired.meshes)
+            {
+                vertexRanges_.free(gpuMesh.vertexOffset, gpuMesh.vertexCount);
+                indexRanges_.free(gpuMesh.indexOffset, gpuMesh.indexCount);
+                meshletRanges_.free(gpuMesh.meshletOffset, gpuMesh.meshletCount);
+            }
+        }
+
+        retiredResources_.pop_front();
     }
+}
+
+void GpuResourceCache::update(const assets::AssetDatabase& db, uint64_t retireFrame)
+{
+    assetDatabase_ = &db;
+
+    auto retired = RetiredResources{.retireFrame = retireFrame};
+
+    // Slots without a GPU copy hold assets added since the last upload. Images whose CPU data was already released
+    // can't be uploaded and are skipped.
+    const auto& images = db.pool<assets::Image>();
+    gpuImages_.resize(std::max<size_t>(gpuImages_.size(), images.slotCount()));
+    images.forEach(
+        [this](assets::Handle<assets::Image> handle, const assets::Image& image)
+        {
+            if (!*gpuImages_[handle.index].image && !image.data.empty())
+            {
+                gpuImages_[handle.index] = createGpuImage(image, initialMip(image));
+            }
+        });
+
+    db.pool<assets::Material>().forEach(
+        [this](assets::Handle<assets::Material> handle, const assets::Material& material)
+        {
+            if (handle.index >= materialDescriptorSets_.size() || materialDescriptorSets_[handle.index].empty())
+            {
+                createGpuMaterial(handle, material);
+            }
+        });
+
+    auto subMeshes = std::vector<std::pair<assets::Handle<assets::SubMesh>, const assets::SubMesh*>>{};
+    db.pool<assets::SubMesh>().forEach(
+        [this, &subMeshes](assets::Handle<assets::SubMesh> handle, const assets::SubMesh& subMesh)
+        {
+            const auto resident = handle.index < gpuMeshes_.size()
+                                  && (gpuMeshes_[handle.index].vertexCount > 0
+                                      || gpuMeshes_[handle.index].indexCount > 0);
+            if (!resident && !subMesh.vertices.empty())
+            {
+                subMeshes.emplace_back(handle, &subMesh);
+            }
+        });
+
+    appendMeshData(subMeshes, retired);
+
+    // Instance offsets are per prefab and the buffer is small, so it's simply rebuilt
+    retired.buffers.push_back(std::move(meshInstanceBuffer_));
+    retired.memory.push_back(std::move(meshInstanceBufferMemory_));
+    uploadInstanceData(db);
 
-    throw std::runtime_error("Skybox handle not uploaded to GPU");
+    retired.uploadValue = stagingRing_.flush();
+
+    retiredResources_.push_back(std::move(retired));
 }
 
-const std::vector<vk::raii::DescriptorSet>& GpuResourceCache::materialDescriptorSet(assets::Material* material) const
+const std::vector<vk::raii::DescriptorSet>& GpuResourceCache::materialDescriptorSet(
+    assets::Handle<assets::Material> material) const
 {
-    return materialDescriptorSets_.at(material);
+    return materialDescriptorSets_.at(material.index);
 }
 
-const std::vector<vk::raii::DescriptorSet>& GpuResourceCache::skyboxDescriptorSet(assets::Skybox* skybox) const
+const std::vector<vk::raii::DescriptorSet>& GpuResourceCache::skyboxDescriptorSet(
+    assets::Handle<assets::Skybox> skybox) const
 {
-    return skyboxDescriptorSets_.at(skybox);
+    return skyboxDescriptorSets_.at(skybox.index);
 }
 
 void GpuResourceCache::createDefaultData()
@@ -150,107 +441,224 @@ void GpuResourceCache::createDefaultData()
 
 void GpuResourceCache::uploadData(const assets::AssetDatabase& db)
 {
-    auto images = std::vector<assets::Image*>{};
-    for (const auto& prefab : db.prefabs())
+    // Skybox cubemaps live in the image pool too, so they're uploaded here with every other image
+    uploadImageData(db);
+
+    uploadMaterialData(db);
+
+    uploadMeshData(db);
+
+    uploadInstanceData(db);
+
+    uploadSkyboxData(db);
+
+    stagingRing_.flush();
+}
+
+void GpuResourceCache::uploadImageData(const assets::AssetDatabase& db)
+{
+    const auto& images = db.pool<assets::Image>();
+    gpuImages_.resize(images.slotCount());
+    images.forEach([this](assets::Handle<assets::Image> handle, const assets::Image& image)
+                   { gpuImages_[handle.index] = createGpuImage(image, initialMip(image)); });
+}
+
+// Widens count RGB texels to RGBA with opaque alpha. Kept as a plain fixed-stride loop so the compiler vectorises it.
+void expandRgbToRgba(const std::byte* source, std::byte* destination, size_t count)
+{
+    for (auto i = size_t{0}; i < count; ++i)
     {
-        for (const auto& image : prefab.second->images())
-        {
-            images.push_back(image.second.get());
-        }
+        destination[i * 4 + 0] = source[i * 3 + 0];
+        destination[i * 4 + 1] = source[i * 3 + 1];
+        destination[i * 4 + 2] = source[i * 3 + 2];
+        destination[i * 4 + 3] = std::byte{0xff};
     }
-    uploadImageData(images);
+}
 
-    auto materials = std::vector<assets::Material*>{};
-    for (const auto& prefab : db.prefabs())
+// Start of each level from baseMip in staging memory, plus the total size. Levels are packed in order and each one
+// aligned for copying, so streaming can upload just the levels it needs.
+std::vector<size_t> stagedLevelOffsets(const assets::Image& image, uint32_t baseMip)
+{
+    if (image.levels.empty())
+    {
+        const auto size = image.channels == 3 ? image.data.size() / 3 * 4 : image.data.size();
+        return {0, size};
+    }
+
+    auto offsets = std::vector<size_t>{};
+    auto offset = size_t{0};
+    for (auto level = baseMip; level < image.mipLevels; ++level)
+    {
+        offsets.push_back(offset);
+        offset = (offset + image.levels.at(level).size + stagingAlignment - 1) / stagingAlignment * stagingAlignment;
+    }
+
+    offsets.push_back(offset);
+    return offsets;
+}
+
+// One copy per mip level from baseMip, covering every layer of the level
+std::vector<vk::BufferImageCopy> imageCopyRegions(const assets::Image& image,
+                                                  uint32_t baseMip,
+                                                  const std::vector<size_t>& levelOffsets,
+                                                  vk::DeviceSize stagingOffset)
+{
+    auto regions = std::vector<vk::BufferImageCopy>{};
+    for (auto level = baseMip; level < image.mipLevels; ++level)
     {
-        for (const auto& material : prefab.second->materials())
+        auto region = vk::BufferImageCopy{};
+        region.bufferOffset = stagingOffset + levelOffsets.at(level - baseMip);
+        region.imageSubresource.aspectMask = vk::ImageAspectFlagBits::eColor;
+        region.imageSubresource.mipLevel = level - baseMip;
+        region.imageSubresource.baseArrayLayer = 0;
+        region.imageSubresource.layerCount = image.layers;
+        region.imageExtent = vk::Extent3D{std::max(image.width >> level, 1u), std::max(image.height >> level, 1u), 1};
+        regions.push_back(region);
+    }
+
+    return regions;
+}
+
+// Writes an image as the GPU expects it, expanding RGB to RGBA and flipping rows in the same pass
+void writeImagePixels(const assets::Image& image,
+                      uint32_t baseMip,
+                      const std::vector<size_t>& levelOffsets,
+                      std::byte* destination)
+{
+    if (!image.levels.empty())
+    {
+        for (auto level = baseMip; level < image.mipLevels; ++level)
         {
-            materials.push_back(material.second.get());
+            const auto& source = image.levels.at(level);
+            std::memcpy(destination + levelOffsets.at(level - baseMip), image.data.data() + source.offset, source.size);
         }
+
+        return;
     }
-    uploadMaterialData(materials);
 
-    uploadMeshData(db);
+    if (image.channels == 4 && !image.flipVertically)
+    {
+        std::memcpy(destination, image.data.data(), image.data.size());
+        return;
+    }
+
+    if ((image.channels != 3 && image.channels != 4) || image.mipLevels != 1)
+    {
+        throw std::runtime_error("Only single level 8-bit RGB and RGBA images can be converted during upload");
+    }
 
-    uploadSkyboxImageData(db);
+    const auto sourceRowSize = static_cast<size_t>(image.width) * image.channels;
+    const auto destinationRowSize = static_cast<size_t>(image.width) * 4;
+
+    for (auto layer = uint32_t{0}; layer < image.layers; ++layer)
+    {
+        for (auto row = uint32_t{0}; row < image.height; ++row)
+        {
+            const auto layerRow = static_cast<size_t>(layer) * image.height;
+            const auto sourceRow = image.flipVertically ? image.height - 1 - row : row;
+            const auto* source = image.data.data() + (layerRow + sourceRow) * sourceRowSize;
+            auto* target = destination + (layerRow + row) * destinationRowSize;
+
+            if (image.channels == 3)
+            {
+                expandRgbToRgba(source, target, image.width);
+            }
+            else
+            {
+                std::memcpy(target, source, sourceRowSize);
+            }
+        }
+    }
 }
 
-void GpuResourceCache::uploadImageData(const std::vector<assets::Image*>& images)
+GpuImage GpuResourceCache::createGpuImage(const assets::Image& image, uint32_t baseMip)
 {
-    for (const auto& image : images)
+    const auto format = static_cast<vk::Format>(image.format);
+    if (!gpuDevice_.supportsSampledImageFormat(format))
     {
-        const auto imageSize = image->width * image->height * 4; //  RGBA8
+        throw std::runtime_error("Image format " + vk::to_string(format) + " is not supported by the GPU");
+    }
 
-        auto gpuImage = GpuImage{};
-        gpuImage.image = gpuDevice_.createImage(image->width, image->height);
-        gpuImage.memory = gpuDevice_.allocateImageMemory(gpuImage.image, vk::MemoryPropertyFlagBits::eDeviceLocal);
+    if (baseMip > 0 && !assets::isStreamable(image))
+    {
+        throw std::runtime_error("Only streamable images can be uploaded from a coarser mip");
+    }
 
-        auto stagingBuffer = gpuDevice_.createBuffer(imageSize,
-                                                     vk::BufferUsageFlagBits::eTransferSrc,
-                                                     vk::SharingMode::eExclusive);
+    const auto isCubemap = image.layers == 6;
+    const auto width = std::max(image.width >> baseMip, 1u);
+    const auto height = std::max(image.height >> baseMip, 1u);
+    const auto mipLevels = image.mipLevels - baseMip;
 
-        auto stagingMemory = gpuDevice_.allocateBufferMemory(stagingBuffer,
-                                                             vk::MemoryPropertyFlagBits::eHostVisible
-                                                                 | vk::MemoryPropertyFlagBits::eHostCoherent);
+    auto gpuImage = GpuImage{};
+    gpuImage.image = isCubemap ? gpuDevice_.createCubemapImage(width, height, format, mipLevels)
+                               : gpuDevice_.createImage(width, height, format, mipLevels);
+    gpuImage.memory = gpuDevice_.allocateImageMemory(gpuImage.image, vk::MemoryPropertyFlagBits::eDeviceLocal);
+    gpuImage.memorySize = gpuImage.image.getMemoryRequirements().size;
+    gpuImage.baseMip = baseMip;
 
-        void* data = stagingMemory.mapMemory(0, imageSize);
-        std::memcpy(data, image->data.data(), imageSize);
-        stagingMemory.unmapMemory();
+    // Pixels go straight from the decoder's buffer into the mapped ring
+    const auto levelOffsets = stagedLevelOffsets(image, baseMip);
+    auto staging = stagingRing_.allocate(levelOffsets.back(), stagingAlignment);
+    writeImagePixels(image, baseMip, levelOffsets, staging.data);
 
-        auto commandBuffers = gpuDevice_.createCommandBuffers(1);
-        auto& cmd = commandBuffers[0];
-        cmd.begin({vk::CommandBufferUsageFlagBits::eOneTimeSubmit});
+    const auto regions = imageCopyRegions(image, baseMip, levelOffsets, staging.offset);
 
-        gpuDevice_.transitionImageLayout(*gpuImage.image,
-                                         *cmd,
-                                         vk::ImageLayout::eUndefined,
-                                         vk::ImageLayout::eTransferDstOptimal,
-                                         {}, // srcAccess
-                                         vk::AccessFlagBits2::eTransferWrite,
-                                         vk::PipelineStageFlagBits2::eTopOfPipe,
-                                         vk::PipelineStageFlagBits2::eTransfer,
-                                         vk::ImageAspectFlagBits::eColor);
+    const auto& cmd = stagingRing_.commandBuffer();
 
-        gpuDevice_.copyBufferToImage(*cmd, *stagingBuffer, *gpuImage.image, image->width, image->height);
+    gpuDevice_.transitionImageLayout(*gpuImage.image,
+                                     *cmd,
+                                     vk::ImageLayout::eUndefined,
+                                     vk::ImageLayout::eTransferDstOptimal,
+                                     {}, // srcAccess
+                                     vk::AccessFlagBits2::eTransferWrite,
+                                     vk::PipelineStageFlagBits2::eTopOfPipe,
+                                     vk::PipelineStageFlagBits2::eTransfer,
+                                     vk::ImageAspectFlagBits::eColor,
+                                     image.layers,
+                                     mipLevels);
 
-        gpuDevice_.transitionImageLayout(*gpuImage.image,
-                                         *cmd,
-                                         vk::ImageLayout::eTransferDstOptimal,
-                                         vk::ImageLayout::eShaderReadOnlyOptimal,
-                                         vk::AccessFlagBits2::eTransferWrite,
-                                         vk::AccessFlagBits2::eShaderRead,
-                                         vk::PipelineStageFlagBits2::eTransfer,
-                                         vk::PipelineStageFlagBits2::eFragmentShader,
-                                         vk::ImageAspectFlagBits::eColor);
+    gpuDevice_.copyBufferToImage(*cmd, *stagingRing_.buffer(), *gpuImage.image, regions);
 
-        cmd.end();
-        gpuDevice_.submitCommandBuffer(*cmd);
+    gpuDevice_.transitionImageLayout(*gpuImage.image,
+                                     *cmd,
+                                     vk::ImageLayout::eTransferDstOptimal,
+                                     vk::ImageLayout::eShaderReadOnlyOptimal,
+                                     vk::AccessFlagBits2::eTransferWrite,
+                                     vk::AccessFlagBits2::eShaderRead,
+                                     vk::PipelineStageFlagBits2::eTransfer,
+                                     vk::PipelineStageFlagBits2::eFragmentShader,
+                                     vk::ImageAspectFlagBits::eColor,
+                                     image.layers,
+                                     mipLevels);
 
-        gpuImage.view = gpuDevice_.createImageView(gpuImage.image);
-        gpuImage.sampler = gpuDevice_.createSampler();
+    gpuImage.view = isCubemap ? gpuDevice_.createCubemapImageView(gpuImage.image, format, mipLevels)
+                              : gpuDevice_.createImageView(gpuImage.image, format, mipLevels);
+    gpuImage.sampler = gpuDevice_.createSampler();
 
-        gpuImages_.emplace(image, std::move(gpuImage));
-    }
+    return gpuImage;
 }
 
-void GpuResourceCache::uploadMaterialData(const std::vector<assets::Material*>& materials)
+void GpuResourceCache::uploadMaterialData(const assets::AssetDatabase& db)
 {
-    if (materials.empty())
-    {
-        return;
-    }
+    const auto& materials = db.pool<assets::Material>();
 
-    createMaterialDescriptorPools(static_cast<uint32_t>(materials.size()));
+    auto materialCount = uint32_t{0};
+    materials.forEach([&materialCount](assets::Handle<assets::Material>, const assets::Material&) { materialCount++; });
 
-    auto layouts = std::vector<vk::DescriptorSetLayout>{static_cast<size_t>(maxFramesInFlight_),
-                                                        materialDescriptorSetLayout_};
+    gpuMaterials_.resize(materials.slotCount());
+    materialDescriptorSets_.resize(materials.slotCount());
+    materialTextures_.resize(materials.slotCount());
 
-    auto stride = alignMemory(sizeof(GpuMaterialBufferData),
-                              gpuDevice_.physicalDevice().getProperties().limits.minUniformBufferOffsetAlignment);
+    // Spare slots let materials added by a reload be uploaded without rebuilding the cache
+    const auto capacity = materialCount + materialHeadroom;
+    createMaterialDescriptorPools(capacity);
+
+    materialStride_ = alignMemory(sizeof(GpuMaterialBufferData),
+                                  gpuDevice_.physicalDevice().getProperties().limits.minUniformBufferOffsetAlignment);
 
     for (auto frameIndex = 0; frameIndex < maxFramesInFlight_; ++frameIndex)
     {
-        auto buffer = gpuDevice_.createBuffer(stride * materials.size(),
+        auto buffer = gpuDevice_.createBuffer(materialStride_ * capacity,
                                               vk::BufferUsageFlagBits::eUniformBuffer,
                                               vk::SharingMode::eExclusive);
 
@@ -265,95 +673,143 @@ void GpuResourceCache::uploadMaterialData(const std::vector<assets::Material*>&
         materialUboMappedMemory_.emplace_back(std::move(mappedMemory));
     }
 
-    auto currentOffset = uint32_t{0};
-    for (const auto& material : materials)
+    // Handed out from the back, so materials loaded together get consecutive slots from the start of the buffer
+    for (auto slot = capacity; slot > 0; --slot)
     {
-        auto gpuMaterial = GpuMaterial{};
-        gpuMaterial.uboOffset = currentOffset;
-        gpuMaterials_.emplace(material, std::move(gpuMaterial));
+        freeMaterialSlots_.push_back(static_cast<uint32_t>((slot - 1) * materialStride_));
+    }
 
-        auto uboData = GpuMaterialBufferData{};
-        uboData.diffuseColor = glm::vec4{material->diffuse, 1.0f};
-        uboData.hasDiffuseTexture = material->diffuseTexture ? 1 : 0;
+    materials.forEach([this](assets::Handle<assets::Material> handle, const assets::Material& material)
+                      { createGpuMaterial(handle, material); });
+}
 
-        for (auto frameIndex = 0; frameIndex < maxFramesInFlight_; ++frameIndex)
-        {
+void GpuResourceCache::createGpuMaterial(assets::Handle<assets::Material> handle, const assets::Material& material)
+{
+    if (freeMaterialSlots_.empty())
+    {
+        throw std::runtime_error("Out of material slots, set resources again to grow the material buffer");
+    }
 
-            auto data = materialUboMappedMemory_.at(frameIndex);
-            std::memcpy(static_cast<std::byte*>(data) + currentOffset, &uboData, sizeof(GpuMaterialBufferData));
-        }
+    if (handle.index >= gpuMaterials_.size())
+    {
+        gpuMaterials_.resize(handle.index + 1);
+        materialDescriptorSets_.resize(handle.index + 1);
+        materialTextures_.resize(handle.index + 1);
+    }
 
-        currentOffset += static_cast<uint32_t>(stride);
+    auto gpuMaterial = GpuMaterial{};
+    gpuMaterial.uboOffset = freeMaterialSlots_.back();
+    freeMaterialSlots_.pop_back();
 
-        auto allocInfo = vk::DescriptorSetAllocateInfo{};
-        allocInfo.descriptorPool = *materialDescriptorPool_;
-        allocInfo.descriptorSetCount = maxFramesInFlight_;
-        allocInfo.pSetLayouts = layouts.data();
+    auto uboData = GpuMaterialBufferData{};
+    uboData.diffuseColor = glm::vec4{material.diffuse, 1.0f};
+    uboData.hasDiffuseTexture = material.diffuseTexture.valid() ? 1 : 0;
 
-        materialDescriptorSets_[material] = std::move(vk::raii::DescriptorSets{gpuDevice_.device(), allocInfo});
+    for (auto frameIndex = 0; frameIndex < maxFramesInFlight_; ++frameIndex)
+    {
+        auto data = materialUboMappedMemory_.at(frameIndex);
+        std::memcpy(static_cast<std::byte*>(data) + gpuMaterial.uboOffset, &uboData, sizeof(GpuMaterialBufferData));
+    }
 
-        for (auto frameIndex = uint32_t{0}; frameIndex < static_cast<uint32_t>(maxFramesInFlight_); ++frameIndex)
-        {
-            auto bufferInfo = vk::DescriptorBufferInfo{};
-            bufferInfo.buffer = *materialUboBuffers_.at(frameIndex);
-            bufferInfo.offset = 0;
-            bufferInfo.range = stride;
-
-            auto uboWrite = vk::WriteDescriptorSet{};
-            uboWrite.dstSet = *materialDescriptorSets_.at(material).at(frameIndex);
-            uboWrite.dstBinding = 0;
-            uboWrite.descriptorType = vk::DescriptorType::eUniformBufferDynamic;
-            uboWrite.descriptorCount = 1;
-            uboWrite.pBufferInfo = &bufferInfo;
-
-            auto imageInfo = vk::DescriptorImageInfo{};
-            if (material->diffuseTexture)
-            {
-                imageInfo.imageView = *gpuImage(material->diffuseTexture).view;
-                imageInfo.sampler = *gpuImage(material->diffuseTexture).sampler;
-            }
-            else
-            {
-                imageInfo.imageView = *emptyImage_.view;
-                imageInfo.sampler = *emptyImage_.sampler;
-            }
-            imageInfo.imageLayout = vk::ImageLayout::eShaderReadOnlyOptimal;
+    gpuMaterials_[handle.index] = std::move(gpuMaterial);
+    materialTextures_[handle.index] = material.diffuseTexture;
 
-            auto textureWrite = vk::WriteDescriptorSet{};
-            textureWrite.dstSet = *materialDescriptorSets_.at(material).at(frameIndex);
-            textureWrite.dstBinding = 1;
-            textureWrite.descriptorType = vk::DescriptorType::eCombinedImageSampler;
-            textureWrite.descriptorCount = 1;
-            textureWrite.pImageInfo = &imageInfo;
+    allocateMaterialDescriptorSets(handle);
+}
 
-            std::array writes{uboWrite, textureWrite};
-            gpuDevice_.device().updateDescriptorSets(writes, {});
+// New sets rather than updates to the existing ones, which frames in flight may still be using
+void GpuResourceCache::allocateMaterialDescriptorSets(assets::Handle<assets::Material> handle)
+{
+    const auto texture = materialTextures_[handle.index];
+
+    auto layouts = std::vector<vk::DescriptorSetLayout>{static_cast<size_t>(maxFramesInFlight_),
+                                                        materialDescriptorSetLayout_};
+
+    auto allocInfo = vk::DescriptorSetAllocateInfo{};
+    allocInfo.descriptorPool = *materialDescriptorPool_;
+    allocInfo.descriptorSetCount = maxFramesInFlight_;
+    allocInfo.pSetLayouts = layouts.data();
+
+    materialDescriptorSets_[handle.index] = std::move(vk::raii::DescriptorSets{gpuDevice_.device(), allocInfo});
+
+    for (auto frameIndex = uint32_t{0}; frameIndex < static_cast<uint32_t>(maxFramesInFlight_); ++frameIndex)
+    {
+        auto bufferInfo = vk::DescriptorBufferInfo{};
+        bufferInfo.buffer = *materialUboBuffers_.at(frameIndex);
+        bufferInfo.offset = 0;
+        bufferInfo.range = materialStride_;
+
+        auto uboWrite = vk::WriteDescriptorSet{};
+        uboWrite.dstSet = *materialDescriptorSets_[handle.index].at(frameIndex);
+        uboWrite.dstBinding = 0;
+        uboWrite.descriptorType = vk::DescriptorType::eUniformBufferDynamic;
+        uboWrite.descriptorCount = 1;
+        uboWrite.pBufferInfo = &bufferInfo;
+
+        auto imageInfo = vk::DescriptorImageInfo{};
+        if (texture.valid())
+        {
+            imageInfo.imageView = *gpuImage(texture).view;
+            imageInfo.sampler = *gpuImage(texture).sampler;
         }
+        else
+        {
+            imageInfo.imageView = *emptyImage_.view;
+            imageInfo.sampler = *emptyImage_.sampler;
+        }
+        imageInfo.imageLayout = vk::ImageLayout::eShaderReadOnlyOptimal;
+
+        auto textureWrite = vk::WriteDescriptorSet{};
+        textureWrite.dstSet = *materialDescriptorSets_[handle.index].at(frameIndex);
+        textureWrite.dstBinding = 1;
+        textureWrite.descriptorType = vk::DescriptorType::eCombinedImageSampler;
+        textureWrite.descriptorCount = 1;
+        textureWrite.pImageInfo = &imageInfo;
+
+        std::array writes{uboWrite, textureWrite};
+        gpuDevice_.device().updateDescriptorSets(writes, {});
+    }
+}
+
+// Sphere around the vertices' bounding box, which is close enough for screen size estimates
+glm::vec4 boundingSphere(const std::vector<core::Vertex>& vertices)
+{
+    if (vertices.empty())
+    {
+        return glm::vec4{0.0f};
+    }
+
+    auto minimum = vertices.front().position;
+    auto maximum = vertices.front().position;
+    for (const auto& vertex : vertices)
+    {
+        minimum = glm::min(minimum, vertex.position);
+        maximum = glm::max(maximum, vertex.position);
     }
+
+    return glm::vec4{(minimum + maximum) * 0.5f, glm::length(maximum - minimum) * 0.5f};
 }
 
 void GpuResourceCache::uploadMeshData(const assets::AssetDatabase& db)
 {
+    auto subMeshes = std::vector<std::pair<assets::Handle<assets::SubMesh>, const assets::SubMesh*>>{};
+    db.pool<assets::SubMesh>().forEach([&subMeshes](assets::Handle<assets::SubMesh> handle,
+                                                    const assets::SubMesh& subMesh)
+                                       { subMeshes.emplace_back(handle, &subMesh); });
+
     auto totalVertices = size_t{0};
     auto totalIndices = size_t{0};
+    auto totalMeshlets = size_t{0};
 
-    for (const auto& [_, prefab] : db.prefabs())
+    for (const auto& [_, subMesh] : subMeshes)
     {
-        for (const auto& mesh : prefab->meshes())
-        {
-            for (const auto& subMesh : mesh->subMeshes)
-            {
-                totalVertices += subMesh->vertices.size();
-                totalIndices += subMesh->indices.size();
-            }
-        }
+        totalVertices += subMesh->vertices.size();
+        totalIndices += subMesh->indices.size();
+        totalMeshlets += subMesh->meshlets.size();
     }
 
     const auto vertexBufferSize = sizeof(core::Vertex) * totalVertices;
-    meshVertexBuffer_ = gpuDevice_.createBuffer(vertexBufferSize,
-                                                vk::BufferUsageFlagBits::eVertexBuffer
-                                                    | vk::BufferUsageFlagBits::eTransferDst,
-                                                vk::SharingMode::eExclusive);
+    meshVertexBuffer_ = gpuDevice_.createBuffer(vertexBufferSize, vertexBufferUsage, vk::SharingMode::eExclusive);
 
     meshVertexBufferMemory_ = gpuDevice_.allocateBufferMemory(meshVertexBuffer_,
                                                               vk::MemoryPropertyFlagBits::eDeviceLocal);
@@ -367,10 +823,7 @@ void GpuResourceCache::uploadMeshData(const assets::AssetDatabase& db)
                                                                          | vk::MemoryPropertyFlagBits::eHostCoherent);
 
     const auto indexBufferSize = sizeof(uint32_t) * totalIndices;
-    meshIndexBuffer_ = gpuDevice_.createBuffer(indexBufferSize,
-                                               vk::BufferUsageFlagBits::eIndexBuffer
-                                                   | vk::BufferUsageFlagBits::eTransferDst,
-                                               vk::SharingMode::eExclusive);
+    meshIndexBuffer_ = gpuDevice_.createBuffer(indexBufferSize, indexBufferUsage, vk::SharingMode::eExclusive);
 
     meshIndexBufferMemory_ = gpuDevice_.allocateBufferMemory(meshIndexBuffer_,
                                                              vk::MemoryPropertyFlagBits::eDeviceLocal);
@@ -383,152 +836,315 @@ void GpuResourceCache::uploadMeshData(const assets::AssetDatabase& db)
                                                                     vk::MemoryPropertyFlagBits::eHostVisible
                                                                         | vk::MemoryPropertyFlagBits::eHostCoherent);
 
-    void* vertexStagingMemory = vertexStagingBufferMemory.mapMemory(0, vertexBufferSize);
-    void* indexStagingMemory = indexStagingBufferMemory.mapMemory(0, indexBufferSize);
+    // Keep the buffer valid when no meshlets are loaded so the culling pass can always bind it
+    const auto meshletBufferSize = sizeof(GpuMeshlet) * std::max(totalMeshlets, size_t{1});
+    meshletBuffer_ = gpuDevice_.createBuffer(meshletBufferSize, meshletBufferUsage, vk::SharingMode::eExclusive);
 
-    auto currentVertexOffset = size_t{0};
-    auto currentIndexOffset = size_t{0};
-    for (const auto& [_, prefab] : db.prefabs())
-    {
-        for (const auto& mesh : prefab->meshes())
-        {
-            for (const auto& subMesh : mesh->subMeshes)
-            {
-                auto gpuMesh = GpuMesh{};
-                gpuMesh.vertexCount = static_cast<uint32_t>(subMesh->vertices.size());
-                gpuMesh.indexCount = static_cast<uint32_t>(subMesh->indices.size());
-                gpuMesh.vertexOffset = static_cast<uint32_t>(currentVertexOffset);
-                gpuMesh.indexOffset = static_cast<uint32_t>(currentIndexOffset);
-
-                const auto vertexSize = subMesh->vertices.size() * sizeof(core::Vertex);
-                const auto indexSize = subMesh->indices.size() * sizeof(uint32_t);
-
-                std::memcpy(static_cast<std::byte*>(vertexStagingMemory) + currentVertexOffset * sizeof(core::Vertex),
-                            subMesh->vertices.data(),
-                            vertexSize);
+    meshletBufferMemory_ = gpuDevice_.allocateBufferMemory(meshletBuffer_, vk::MemoryPropertyFlagBits::eDeviceLocal);
 
-                std::memcpy(static_cast<std::byte*>(indexStagingMemory) + currentIndexOffset * sizeof(uint32_t),
-                            subMesh->indices.data(),
-                            indexSize);
+    auto meshletStagingBuffer = gpuDevice_.createBuffer(meshletBufferSize,
+                                                        vk::BufferUsageFlagBits::eTransferSrc,
+                                                        vk::SharingMode::eExclusive);
 
-                currentVertexOffset += subMesh->vertices.size();
-                currentIndexOffset += subMesh->indices.size();
+    auto meshletStagingBufferMemory = gpuDevice_.allocateBufferMemory(meshletStagingBuffer,
+                                                                      vk::MemoryPropertyFlagBits::eHostVisible
+                                                                          | vk::MemoryPropertyFlagBits::eHostCoherent);
 
-                gpuMeshes_.emplace(subMesh.get(), std::move(gpuMesh));
-            }
+    void* vertexStagingMemory = vertexStagingBufferMemory.mapMemory(0, vertexBufferSize);
+    void* indexStagingMemory = indexStagingBufferMemory.mapMemory(0, indexBufferSize);
+    auto* meshletStagingMemory = static_cast<GpuMeshlet*>(meshletStagingBufferMemory.mapMemory(0, meshletBufferSize));
+
+    // Nothing has been freed yet, so every range is allocated straight after the previous one
+    vertexRanges_.reset();
+    indexRanges_.reset();
+    meshletRanges_.reset();
+    gpuMeshes_.resize(db.pool<assets::SubMesh>().slotCount());
+    for (const auto& [handle, subMesh] : subMeshes)
+    {
+        auto gpuMesh = GpuMesh{};
+        gpuMesh.vertexCount = static_cast<uint32_t>(subMesh->vertices.size());
+        gpuMesh.indexCount = static_cast<uint32_t>(subMesh->indices.size());
+        gpuMesh.vertexOffset = static_cast<uint32_t>(vertexRanges_.allocate(subMesh->vertices.size()));
+        gpuMesh.indexOffset = static_cast<uint32_t>(indexRanges_.allocate(subMesh->indices.size()));
+        gpuMesh.meshletOffset = static_cast<uint32_t>(meshletRanges_.allocate(subMesh->meshlets.size()));
+        gpuMesh.meshletCount = static_cast<uint32_t>(subMesh->meshlets.size());
+        gpuMesh.boundingSphere = boundingSphere(subMesh->vertices);
+
+        const auto vertexSize = subMesh->vertices.size() * sizeof(core::Vertex);
+        const auto indexSize = subMesh->indices.size() * sizeof(uint32_t);
+
+        std::memcpy(static_cast<std::byte*>(vertexStagingMemory) + gpuMesh.vertexOffset * sizeof(core::Vertex),
+                    subMesh->vertices.data(),
+                    vertexSize);
+
+        std::memcpy(static_cast<std::byte*>(indexStagingMemory) + gpuMesh.indexOffset * sizeof(uint32_t),
+                    subMesh->indices.data(),
+                    indexSize);
+
+        auto* gpuMeshlets = meshletStagingMemory + gpuMesh.meshletOffset;
+        for (const auto& meshlet : subMesh->meshlets)
+        {
+            auto& gpuMeshlet = *gpuMeshlets++;
+            gpuMeshlet.boundingSphere = glm::vec4{meshlet.center, meshlet.radius};
+            gpuMeshlet.cone = glm::vec4{meshlet.coneAxis, meshlet.coneCutoff};
+            gpuMeshlet.firstIndex = gpuMesh.indexOffset + meshlet.indexOffset;
+            gpuMeshlet.indexCount = meshlet.indexCount;
+            gpuMeshlet.vertexOffset = static_cast<int32_t>(gpuMesh.vertexOffset);
+            gpuMeshlet._padding = 0;
         }
+
+        gpuMeshes_[handle.index] = std::move(gpuMesh);
     }
 
     vertexStagingBufferMemory.unmapMemory();
     indexStagingBufferMemory.unmapMemory();
+    meshletStagingBufferMemory.unmapMemory();
 
     gpuDevice_.copyBuffer(vertexStagingBuffer, meshVertexBuffer_, vertexBufferSize);
     gpuDevice_.copyBuffer(indexStagingBuffer, meshIndexBuffer_, indexBufferSize);
+    gpuDevice_.copyBuffer(meshletStagingBuffer, meshletBuffer_, meshletBufferSize);
+
+    vertexCapacity_ = totalVertices;
+    indexCapacity_ = totalIndices;
+    meshletCapacity_ = std::max(totalMeshlets, size_t{1});
 }
 
-void GpuResourceCache::uploadSkyboxImageData(const assets::AssetDatabase& db)
+void GpuResourceCache::appendMeshData(
+    const std::vector<std::pair<assets::Handle<assets::SubMesh>, const assets::SubMesh*>>& subMeshes,
+    RetiredResources& retired)
 {
-    createSkyboxDescriptorPools(static_cast<uint32_t>(db.skyboxes().size()));
-
-    auto layouts = std::vector<vk::DescriptorSetLayout>{static_cast<size_t>(maxFramesInFlight_),
-                                                        skyboxDescriptorSetLayout_};
+    // Ranges freed by evicted geometry are reused first, so the buffers only grow past what's actually in use
+    const auto usedVertices = vertexRanges_.end();
+    const auto usedIndices = indexRanges_.end();
+    const auto usedMeshlets = meshletRanges_.end();
+
+    auto gpuMeshes = std::vector<GpuMesh>{};
+    gpuMeshes.reserve(subMeshes.size());
+    for (const auto& [_, subMesh] : subMeshes)
+    {
+        auto& gpuMesh = gpuMeshes.emplace_back();
+        gpuMesh.vertexCount = static_cast<uint32_t>(subMesh->vertices.size());
+        gpuMesh.indexCount = static_cast<uint32_t>(subMesh->indices.size());
+        gpuMesh.vertexOffset = static_cast<uint32_t>(vertexRanges_.allocate(subMesh->vertices.size()));
+        gpuMesh.indexOffset = static_cast<uint32_t>(indexRanges_.allocate(subMesh->indices.size()));
+        gpuMesh.meshletOffset = static_cast<uint32_t>(meshletRanges_.allocate(subMesh->meshlets.size()));
+        gpuMesh.meshletCount = static_cast<uint32_t>(subMesh->meshlets.size());
+        gpuMesh.boundingSphere = boundingSphere(subMesh->vertices);
+    }
 
-    for (const auto& skybox : db.skyboxes())
-    {
-        // Assume all faces equal dimensions
-        const auto width = skybox.second->images[0]->width;
-        const auto height = skybox.second->images[0]->height;
-        const auto imageSize = width * height * 4; // RGBA8
-
-        auto gpuImage = GpuImage{};
-        gpuImage.image = gpuDevice_.createCubemapImage(width, height);
-        gpuImage.memory = gpuDevice_.allocateImageMemory(gpuImage.image, vk::MemoryPropertyFlagBits::eDeviceLocal);
-
-        auto stagingBuffer = gpuDevice_.createBuffer(imageSize * 6,
-                                                     vk::BufferUsageFlagBits::eTransferSrc,
-                                                     vk::SharingMode::eExclusive);
-
-        auto stagingMemory = gpuDevice_.allocateBufferMemory(stagingBuffer,
-                                                             vk::MemoryPropertyFlagBits::eHostVisible
-                                                                 | vk::MemoryPropertyFlagBits::eHostCoherent);
-
-        auto commandBuffers = gpuDevice_.createCommandBuffers(1);
-        auto& cmd = commandBuffers[0];
-        cmd.begin({vk::CommandBufferUsageFlagBits::eOneTimeSubmit});
-
-        gpuDevice_.transitionImageLayout(*gpuImage.image,
-                                         *cmd,
-                                         vk::ImageLayout::eUndefined,
-                                         vk::ImageLayout::eTransferDstOptimal,
-                                         {}, // srcAccess
-                                         vk::AccessFlagBits2::eTransferWrite,
-                                         vk::PipelineStageFlagBits2::eTopOfPipe,
-                                         vk::PipelineStageFlagBits2::eTransfer,
-                                         vk::ImageAspectFlagBits::eColor,
-                                         6);
-        void* data = stagingMemory.mapMemory(0, imageSize * 6);
-        for (auto face = uint32_t{0}; face < 6; ++face)
+    resizeBuffer(meshVertexBuffer_,
+                 meshVertexBufferMemory_,
+                 vertexCapacity_,
+                 usedVertices,
+                 vertexRanges_.end(),
+                 sizeof(core::Vertex),
+                 vertexBufferUsage,
+                 retired);
+
+    resizeBuffer(meshIndexBuffer_,
+                 meshIndexBufferMemory_,
+                 indexCapacity_,
+                 usedIndices,
+                 indexRanges_.end(),
+                 sizeof(uint32_t),
+                 indexBufferUsage,
+                 retired);
+
+    resizeBuffer(meshletBuffer_,
+                 meshletBufferMemory_,
+                 meshletCapacity_,
+                 usedMeshlets,
+                 meshletRanges_.end(),
+                 sizeof(GpuMeshlet),
+                 meshletBufferUsage,
+                 retired);
+
+    // Each range is written into the ring then copied to its place in the buffer
+    auto writeRange = [this](const vk::raii::Buffer& buffer, vk::DeviceSize offset, vk::DeviceSize size, auto write)
+    {
+        if (size == 0)
         {
-            std::memcpy(data + (face * imageSize), skybox.second->images[face]->data.data(), imageSize);
+            return;
         }
-        stagingMemory.unmapMemory();
-        gpuDevice_.copyBufferToImage(*cmd, *stagingBuffer, *gpuImage.image, width, height, 6);
-        gpuDevice_.transitionImageLayout(*gpuImage.image,
-                                         *cmd,
-                                         vk::ImageLayout::eTransferDstOptimal,
-                                         vk::ImageLayout::eShaderReadOnlyOptimal,
-                                         vk::AccessFlagBits2::eTransferWrite,
-                                         vk::AccessFlagBits2::eShaderRead,
-                                         vk::PipelineStageFlagBits2::eTransfer,
-                                         vk::PipelineStageFlagBits2::eFragmentShader,
-                                         vk::ImageAspectFlagBits::eColor,
-                                         6);
-
-        cmd.end();
-        gpuDevice_.submitCommandBuffer(*cmd);
-
-        gpuImage.view = gpuDevice_.createCubemapImageView(gpuImage.image);
-        gpuImage.sampler = gpuDevice_.createSampler();
-
-        auto allocInfo = vk::DescriptorSetAllocateInfo{};
-        allocInfo.descriptorPool = *skyboxDescriptorPool_;
-        allocInfo.descriptorSetCount = maxFramesInFlight_;
-        allocInfo.pSetLayouts = layouts.data();
-
-        skyboxDescriptorSets_[skybox.second.get()] = std::move(
-            vk::raii::DescriptorSets{gpuDevice_.device(), allocInfo});
-
-        for (auto frameIndex = uint32_t{0}; frameIndex < static_cast<uint32_t>(maxFramesInFlight_); ++frameIndex)
+
+        auto staging = stagingRing_.allocate(size, stagingAlignment);
+        write(staging.data);
+        stagingRing_.commandBuffer().copyBuffer(*stagingRing_.buffer(),
+                                                *buffer,
+                                                vk::BufferCopy{staging.offset, offset, size});
+    };
+
+    for (size_t i = 0; i < subMeshes.size(); ++i)
+    {
+        const auto& [handle, subMesh] = subMeshes[i];
+        const auto& gpuMesh = gpuMeshes[i];
+
+        writeRange(meshVertexBuffer_,
+                   gpuMesh.vertexOffset * sizeof(core::Vertex),
+                   subMesh->vertices.size() * sizeof(core::Vertex),
+                   [subMesh](std::byte* data)
+                   { std::memcpy(data, subMesh->vertices.data(), subMesh->vertices.size() * sizeof(core::Vertex)); });
+
+        writeRange(meshIndexBuffer_,
+                   gpuMesh.indexOffset * sizeof(uint32_t),
+                   subMesh->indices.size() * sizeof(uint32_t),
+                   [subMesh](std::byte* data)
+                   { std::memcpy(data, subMesh->indices.data(), subMesh->indices.size() * sizeof(uint32_t)); });
+
+        writeRange(meshletBuffer_,
+                   gpuMesh.meshletOffset * sizeof(GpuMeshlet),
+                   subMesh->meshlets.size() * sizeof(GpuMeshlet),
+                   [subMesh, &gpuMesh](std::byte* data)
+                   {
+                       auto* gpuMeshlets = reinterpret_cast<GpuMeshlet*>(data);
+                       for (const auto& meshlet : subMesh->meshlets)
+                       {
+                           auto& gpuMeshlet = *gpuMeshlets++;
+                           gpuMeshlet.boundingSphere = glm::vec4{meshlet.center, meshlet.radius};
+                           gpuMeshlet.cone = glm::vec4{meshlet.coneAxis, meshlet.coneCutoff};
+                           gpuMeshlet.firstIndex = gpuMesh.indexOffset + meshlet.indexOffset;
+                           gpuMeshlet.indexCount = meshlet.indexCount;
+                           gpuMeshlet.vertexOffset = static_cast<int32_t>(gpuMesh.vertexOffset);
+                           gpuMeshlet._padding = 0;
+                       }
+                   });
+
+        if (handle.index >= gpuMeshes_.size())
         {
-            auto imageInfo = vk::DescriptorImageInfo{};
-            imageInfo.imageView = gpuImage.view;
-            imageInfo.sampler = gpuImage.sampler;
-            imageInfo.imageLayout = vk::ImageLayout::eShaderReadOnlyOptimal;
-
-            auto textureWrite = vk::WriteDescriptorSet{};
-            textureWrite.dstSet = *skyboxDescriptorSets_.at(skybox.second.get()).at(frameIndex);
-            textureWrite.dstBinding = 0;
-            textureWrite.descriptorType = vk::DescriptorType::eCombinedImageSampler;
-            textureWrite.descriptorCount = 1;
-            textureWrite.pImageInfo = &imageInfo;
-
-            std::array writes{textureWrite};
-            gpuDevice_.device().updateDescriptorSets(writes, {});
+            gpuMeshes_.resize(handle.index + 1);
         }
 
-        gpuSkyboxImages_.emplace(skybox.second.get(), std::move(gpuImage));
+        gpuMeshes_[handle.index] = gpuMesh;
+    }
+}
+
+// Replaces a device local buffer when the required elements no longer fit, or when they fill under a quarter of it
+// because the geometry at its end was evicted. The used elements are copied across on the GPU and the old buffer is
+// retired, since frames in flight may still be reading it.
+void GpuResourceCache::resizeBuffer(vk::raii::Buffer& buffer,
+                                    vk::raii::DeviceMemory& memory,
+                                    size_t& capacity,
+                                    size_t used,
+                                    size_t required,
+                                    size_t elementSize,
+                                    vk::BufferUsageFlags usage,
+                                    RetiredResources& retired)
+{
+    auto newCapacity = capacity;
+    if (required > capacity)
+    {
+        newCapacity = std::max(required, capacity + capacity / 2);
     }
+    else if (required < capacity / 4)
+    {
+        // Leaves room to grow again before the next resize
+        newCapacity = std::max(required + required / 2, size_t{1});
+    }
+
+    if (newCapacity == capacity)
+    {
+        return;
+    }
+
+    auto newBuffer = gpuDevice_.createBuffer(newCapacity * elementSize, usage, vk::SharingMode::eExclusive);
+    auto newMemory = gpuDevice_.allocateBufferMemory(newBuffer, vk::MemoryPropertyFlagBits::eDeviceLocal);
+
+    if (used > 0)
+    {
+        stagingRing_.commandBuffer().copyBuffer(*buffer, *newBuffer, vk::BufferCopy{0, 0, used * elementSize});
+    }
+
+    retired.buffers.push_back(std::move(buffer));
+    retired.memory.push_back(std::move(memory));
+
+    buffer = std::move(newBuffer);
+    memory = std::move(newMemory);
+    capacity = newCapacity;
+}
+
+void GpuResourceCache::uploadInstanceData(const assets::AssetDatabase& db)
+{
+    auto instanceTransforms = std::vector<glm::mat4>{glm::mat4{1.0f}};
+    prefabInstanceOffsets_.resize(db.pool<assets::Prefab>().slotCount());
+    db.pool<assets::Prefab>().forEach(
+        [this, &instanceTransforms](assets::Handle<assets::Prefab> handle, const assets::Prefab& prefab)
+        {
+            prefabInstanceOffsets_[handle.index] = static_cast<uint32_t>(instanceTransforms.size());
+            instanceTransforms.insert(instanceTransforms.end(),
+                                      prefab.instanceTransforms.begin(),
+                                      prefab.instanceTransforms.end());
+        });
+
+    const auto instanceBufferSize = sizeof(glm::mat4) * instanceTransforms.size();
+    instanceBufferSize_ = instanceBufferSize;
+    meshInstanceBuffer_ = gpuDevice_.createBuffer(instanceBufferSize,
+                                                  vk::BufferUsageFlagBits::eVertexBuffer
+                                                      | vk::BufferUsageFlagBits::eTransferDst,
+                                                  vk::SharingMode::eExclusive);
+
+    meshInstanceBufferMemory_ = gpuDevice_.allocateBufferMemory(meshInstanceBuffer_,
+                                                                vk::MemoryPropertyFlagBits::eDeviceLocal);
+
+    auto staging = stagingRing_.allocate(instanceBufferSize, stagingAlignment);
+    std::memcpy(staging.data, instanceTransforms.data(), instanceBufferSize);
+    stagingRing_.commandBuffer().copyBuffer(*stagingRing_.buffer(),
+                                            *meshInstanceBuffer_,
+                                            vk::BufferCopy{staging.offset, 0, instanceBufferSize});
+}
+
+void GpuResourceCache::uploadSkyboxData(const assets::AssetDatabase& db)
+{
+    const auto& skyboxes = db.pool<assets::Skybox>();
+
+    auto skyboxCount = uint32_t{0};
+    skyboxes.forEach([&skyboxCount](assets::Handle<assets::Skybox>, const assets::Skybox&) { skyboxCount++; });
+    createSkyboxDescriptorPools(skyboxCount);
+
+    auto layouts = std::vector<vk::DescriptorSetLayout>{static_cast<size_t>(maxFramesInFlight_),
+                                                        skyboxDescriptorSetLayout_};
+
+    skyboxDescriptorSets_.resize(skyboxes.slotCount());
+    skyboxes.forEach(
+        [&](assets::Handle<assets::Skybox> handle, const assets::Skybox& skybox)
+        {
+            const auto& gpuCubemap = gpuImage(skybox.cubemap);
+
+            auto allocInfo = vk::DescriptorSetAllocateInfo{};
+            allocInfo.descriptorPool = *skyboxDescriptorPool_;
+            allocInfo.descriptorSetCount = maxFramesInFlight_;
+            allocInfo.pSetLayouts = layouts.data();
+
+            skyboxDescriptorSets_[handle.index] = std::move(vk::raii::DescriptorSets{gpuDevice_.device(), allocInfo});
+
+            for (auto frameIndex = uint32_t{0}; frameIndex < static_cast<uint32_t>(maxFramesInFlight_); ++frameIndex)
+            {
+                auto imageInfo = vk::DescriptorImageInfo{};
+                imageInfo.imageView = gpuCubemap.view;
+                imageInfo.sampler = gpuCubemap.sampler;
+                imageInfo.imageLayout = vk::ImageLayout::eShaderReadOnlyOptimal;
+
+                auto textureWrite = vk::WriteDescriptorSet{};
+                textureWrite.dstSet = *skyboxDescriptorSets_[handle.index].at(frameIndex);
+                textureWrite.dstBinding = 0;
+                textureWrite.descriptorType = vk::DescriptorType::eCombinedImageSampler;
+                textureWrite.descriptorCount = 1;
+                textureWrite.pImageInfo = &imageInfo;
+
+                std::array writes{textureWrite};
+                gpuDevice_.device().updateDescriptorSets(writes, {});
+            }
+        });
 }
 
 void GpuResourceCache::createMaterialDescriptorPools(uint32_t materialCount)
 {
     auto materialUboPoolSize = vk::DescriptorPoolSize{};
     materialUboPoolSize.type = vk::DescriptorType::eUniformBufferDynamic;
-    materialUboPoolSize.descriptorCount = maxFramesInFlight_;
+    materialUboPoolSize.descriptorCount = maxFramesInFlight_ * materialCount;
 
     auto texturePoolSize = vk::DescriptorPoolSize{};
     texturePoolSize.type = vk::DescriptorType::eCombinedImageSampler;
-    texturePoolSize.descriptorCount = maxFramesInFlight_;
+    texturePoolSize.descriptorCount = maxFramesInFlight_ * materialCount;
 
     auto materialPoolSizes = std::array{materialUboPoolSize, texturePoolSize};
 
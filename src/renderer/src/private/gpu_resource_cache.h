@@ -6,19 +6,28 @@
 #include "gpu_image.h"
 #include "gpu_material.h"
 #include "gpu_mesh.h"
+#include "gpu_meshlet.h"
+#include "staging_ring.h"
 
+#include <assets/handle.h>
 #include <assets/image.h>
 #include <assets/material.h>
 #include <assets/mesh.h>
 #include <assets/skybox.h>
-#include <unordered_map>
+#include <core/range_allocator.h>
+
+#include <deque>
+#include <utility>
+#include <vector>
 
 #include <vulkan/vulkan_raii.hpp>
 
 namespace assets
 {
 class AssetDatabase;
-}
+struct EvictedAssets;
+struct Prefab;
+} // namespace assets
 
 namespace renderer
 {
@@ -43,23 +52,113 @@ class GpuResourceCache
 
     const vk::raii::Buffer& meshVertexBuffer() const;
     const vk::raii::Buffer& meshIndexBuffer() const;
+    const vk::raii::Buffer& meshletBuffer() const;
+    const vk::raii::Buffer& meshInstanceBuffer() const;
     const vk::raii::Buffer& materialUniformBuffer(int frameIndex) const;
 
-    GpuImage& gpuImage(assets::Image* image);
-    GpuMaterial& gpuMaterial(assets::Material* material);
-    GpuMesh& gpuMesh(assets::SubMesh* mesh);
-    GpuImage& gpuSkyboxImage(assets::Skybox* skybox);
+    GpuImage& gpuImage(assets::Handle<assets::Image> image);
+    GpuMaterial& gpuMaterial(assets::Handle<assets::Material> material);
+    GpuMesh& gpuMesh(assets::Handle<assets::SubMesh> mesh);
+
+    // Index of a prefab's first instance transform in the instance buffer. Index 0 holds the identity transform
+    // used by non-instanced draws.
+    uint32_t instanceOffset(assets::Handle<assets::Prefab> prefab);
+
+    // Device memory used by an asset, or zero if it isn't resident
+    vk::DeviceSize gpuMemoryUsage(assets::Handle<assets::Image> image) const;
+    vk::DeviceSize gpuMemoryUsage(assets::Handle<assets::SubMesh> mesh) const;
+
+    // Device memory allocated for resident images and the shared mesh and instance buffers, including ranges of the
+    // buffers not in use
+    vk::DeviceSize gpuMemoryUsage() const;
+
+    // Elements the shared mesh buffers have room for
+    size_t vertexCapacity() const;
+    size_t indexCapacity() const;
+    size_t meshletCapacity() const;
+
+    // Takes the GPU copies of evicted assets out of the cache. Frames already in flight may still use them, so they're
+    // only destroyed by the first destroyRetiredResources() call for retireFrame or later.
+    void retire(const assets::EvictedAssets& evicted, uint64_t retireFrame);
+    void destroyRetiredResources(uint64_t frame);
+
+    // Uploads assets added to the database since the cache was built, such as a reloaded prefab's new content. The
+    // copies are submitted without waiting and ordered before the next frame recorded. Buffers that have to grow are
+    // replaced and the old ones retired like evicted assets, once the copies out of them have finished too.
+    void update(const assets::AssetDatabase& db, uint64_t retireFrame);
+
+    // Database the cached assets were uploaded from
+    const assets::AssetDatabase& assetDatabase() const;
+
+    assets::Handle<assets::Image> materialTexture(assets::Handle<assets::Material> material) const;
+
+    // Starts replacing an image's GPU copy with one holding the levels from baseMip down. The upload is recorded into
+    // the staging ring and submitted by flushUploads(); frames keep sampling the current copy until
+    // commitStreamedImages() finds the upload finished.
+    void streamImage(assets::Handle<assets::Image> handle, uint32_t baseMip);
+    void flushUploads();
+
+    // Swaps in streamed copies whose uploads have finished, pointing the materials using them at the new copy and
+    // retiring the old one
+    void commitStreamedImages(uint64_t retireFrame);
 
-    const std::vector<vk::raii::DescriptorSet>& materialDescriptorSet(assets::Material* material) const;
-    const std::vector<vk::raii::DescriptorSet>& skyboxDescriptorSet(assets::Skybox* skybox) const;
+    // Copy of the image still being uploaded, or null if it isn't being streamed
+    const GpuImage* pendingImage(assets::Handle<assets::Image> handle) const;
+
+    const std::vector<vk::raii::DescriptorSet>& materialDescriptorSet(assets::Handle<assets::Material> material) const;
+    const std::vector<vk::raii::DescriptorSet>& skyboxDescriptorSet(assets::Handle<assets::Skybox> skybox) const;
+
+  private:
+    struct RetiredResources
+    {
+        uint64_t retireFrame;
+
+        // Upload submission that copies out of the retired buffers, if any
+        uint64_t uploadValue{0};
+
+        std::vector<GpuImage> images;
+        std::vector<std::vector<vk::raii::DescriptorSet>> descriptorSets;
+        std::vector<uint32_t> materialSlots;
+
+        // Ranges of the shared mesh buffers, handed back for reuse
+        std::vector<GpuMesh> meshes;
+
+        // Buffers are destroyed before the memory bound to them
+        std::vector<vk::raii::DeviceMemory> memory;
+        std::vector<vk::raii::Buffer> buffers;
+    };
+
+    struct PendingImage
+    {
+        assets::Handle<assets::Image> handle;
+        GpuImage image;
+
+        // Zero until the upload is submitted
+        uint64_t uploadValue{0};
+    };
 
   private:
     void createDefaultData();
     void uploadData(const assets::AssetDatabase& db);
-    void uploadImageData(const std::vector<assets::Image*>& images);
-    void uploadMaterialData(const std::vector<assets::Material*>& materials);
+    void uploadImageData(const assets::AssetDatabase& db);
+    GpuImage createGpuImage(const assets::Image& image, uint32_t baseMip);
+    void uploadMaterialData(const assets::AssetDatabase& db);
+    void createGpuMaterial(assets::Handle<assets::Material> handle, const assets::Material& material);
+    void allocateMaterialDescriptorSets(assets::Handle<assets::Material> handle);
     void uploadMeshData(const assets::AssetDatabase& db);
-    void uploadSkyboxImageData(const assets::AssetDatabase& db);
+    void appendMeshData(
+        const std::vector<std::pair<assets::Handle<assets::SubMesh>, const assets::SubMesh*>>& subMeshes,
+        RetiredResources& retired);
+    void resizeBuffer(vk::raii::Buffer& buffer,
+                      vk::raii::DeviceMemory& memory,
+                      size_t& capacity,
+                      size_t used,
+                      size_t required,
+                      size_t elementSize,
+                      vk::BufferUsageFlags usage,
+                      RetiredResources& retired);
+    void uploadInstanceData(const assets::AssetDatabase& db);
+    void uploadSkyboxData(const assets::AssetDatabase& db);
 
     void createMaterialDescriptorPools(uint32_t materialCount);
     void createSkyboxDescriptorPools(uint32_t skyboxCount);
@@ -69,24 +168,48 @@ class GpuResourceCache
     const int maxFramesInFlight_;
     const vk::DescriptorSetLayout& materialDescriptorSetLayout_;
     const vk::DescriptorSetLayout& skyboxDescriptorSetLayout_;
+    const assets::AssetDatabase* assetDatabase_;
     GpuImage emptyImage_;
 
     vk::raii::Buffer meshVertexBuffer_{nullptr};
     vk::raii::Buffer meshIndexBuffer_{nullptr};
     vk::raii::DeviceMemory meshVertexBufferMemory_{nullptr};
     vk::raii::DeviceMemory meshIndexBufferMemory_{nullptr};
+    vk::raii::Buffer meshletBuffer_{nullptr};
+    vk::raii::DeviceMemory meshletBufferMemory_{nullptr};
+    vk::raii::Buffer meshInstanceBuffer_{nullptr};
+    vk::raii::DeviceMemory meshInstanceBufferMemory_{nullptr};
 
     vk::raii::DescriptorPool materialDescriptorPool_{nullptr};
     vk::raii::DescriptorPool skyboxDescriptorPool_{nullptr};
-    std::unordered_map<assets::Material*, std::vector<vk::raii::DescriptorSet>> materialDescriptorSets_;
-    std::unordered_map<assets::Skybox*, std::vector<vk::raii::DescriptorSet>> skyboxDescriptorSets_;
+    std::vector<std::vector<vk::raii::DescriptorSet>> materialDescriptorSets_;
+    std::vector<std::vector<vk::raii::DescriptorSet>> skyboxDescriptorSets_;
     std::vector<vk::raii::Buffer> materialUboBuffers_;
     std::vector<vk::raii::DeviceMemory> materialUboBuffersMemory_;
     std::vector<void*> materialUboMappedMemory_;
-
-    std::unordered_map<assets::Image*, GpuImage> gpuImages_;
-    std::unordered_map<assets::Material*, GpuMaterial> gpuMaterials_;
-    std::unordered_map<assets::SubMesh*, GpuMesh> gpuMeshes_;
-    std::unordered_map<assets::Skybox*, GpuImage> gpuSkyboxImages_;
+    vk::DeviceSize materialStride_{0};
+    std::vector<uint32_t> freeMaterialSlots_;
+
+    // Ranges of elements in use in the shared mesh buffers, and the elements allocated for each buffer
+    core::RangeAllocator vertexRanges_;
+    core::RangeAllocator indexRanges_;
+    core::RangeAllocator meshletRanges_;
+    size_t vertexCapacity_{0};
+    size_t indexCapacity_{0};
+    size_t meshletCapacity_{0};
+    vk::DeviceSize instanceBufferSize_{0};
+
+    // Indexed by asset handle
+    std::vector<GpuImage> gpuImages_;
+    std::vector<GpuMaterial> gpuMaterials_;
+    std::vector<GpuMesh> gpuMeshes_;
+    std::vector<uint32_t> prefabInstanceOffsets_;
+    std::vector<assets::Handle<assets::Image>> materialTextures_;
+
+    std::deque<RetiredResources> retiredResources_;
+    std::vector<PendingImage> pendingImages_;
+
+    // Destroyed first, which waits for submitted copies still reading or writing the resources above
+    StagingRing stagingRing_;
 };
 } // namespace renderer
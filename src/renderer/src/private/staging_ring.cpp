@@ -0,0 +1,167 @@
+/// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Mark Rapson
+
+#include "staging_ring.h"
+
+#include "renderer/gpu_device.h"
+
+#include <spdlog/spdlog.h>
+
+namespace renderer
+{
+// Capacities are kept a multiple of this so aligning a ring position also aligns its offset in the buffer
+constexpr auto capacityGranularity = vk::DeviceSize{256};
+
+StagingRing::StagingRing(const GpuDevice& gpuDevice, vk::DeviceSize capacity)
+    : gpuDevice_{&gpuDevice}
+{
+    createBuffer(capacity);
+    timelineSemaphore_ = gpuDevice_->createTimelineSemaphore();
+}
+
+StagingRing::~StagingRing()
+{
+    if (!submissions_.empty())
+    {
+        gpuDevice_->waitForTimeline(*timelineSemaphore_, submissions_.back().value);
+    }
+}
+
+StagingRing::Allocation StagingRing::allocate(vk::DeviceSize size, vk::DeviceSize alignment)
+{
+    if (size > capacity_)
+    {
+        // The buffer can only be replaced once nothing reads from it
+        const auto value = flush();
+        if (value > 0)
+        {
+            gpuDevice_->waitForTimeline(*timelineSemaphore_, value);
+        }
+        reclaim();
+
+        spdlog::debug("Growing staging ring to {} bytes", size);
+        createBuffer(size);
+    }
+
+    while (true)
+    {
+        reclaim();
+
+        auto position = (head_ + alignment - 1) / alignment * alignment;
+        if (position % capacity_ + size > capacity_)
+        {
+            // Allocations don't wrap, so skip the end of the buffer
+            position = (position / capacity_ + 1) * capacity_;
+        }
+
+        if (position + size - tail_ <= capacity_)
+        {
+            head_ = position + size;
+            return Allocation{mappedMemory_ + position % capacity_, position % capacity_};
+        }
+
+        // Full: submit what's recorded so it can finish, then wait for the oldest copies to free their space
+        flush();
+        gpuDevice_->waitForTimeline(*timelineSemaphore_, submissions_.front().value);
+    }
+}
+
+const vk::raii::Buffer& StagingRing::buffer() const
+{
+    return buffer_;
+}
+
+const vk::raii::CommandBuffer& StagingRing::commandBuffer()
+{
+    if (!recording_)
+    {
+        if (freeCommandBuffers_.empty())
+        {
+            auto commandBuffers = gpuDevice_->createCommandBuffers(1);
+            commandBuffer_ = std::move(commandBuffers[0]);
+        }
+        else
+        {
+            commandBuffer_ = std::move(freeCommandBuffers_.back());
+            freeCommandBuffers_.pop_back();
+        }
+
+        commandBuffer_.begin({vk::CommandBufferUsageFlagBits::eOneTimeSubmit});
+        recording_ = true;
+    }
+
+    return commandBuffer_;
+}
+
+uint64_t StagingRing::flush()
+{
+    if (!recording_)
+    {
+        return submittedValue_;
+    }
+
+    // Barriers also order commands submitted later to the queue, so every frame recorded after this sees the copies
+    gpuDevice_->memoryBarrier(*commandBuffer_,
+                              vk::AccessFlagBits2::eTransferWrite,
+                              vk::AccessFlagBits2::eMemoryRead,
+                              vk::PipelineStageFlagBits2::eTransfer,
+                              vk::PipelineStageFlagBits2::eAllCommands);
+    commandBuffer_.end();
+
+    gpuDevice_->submitCommandBuffer(*commandBuffer_, *timelineSemaphore_, ++submittedValue_);
+    submissions_.push_back(
+        Submission{.value = submittedValue_, .end = head_, .commandBuffer = std::move(commandBuffer_)});
+    recording_ = false;
+
+    return submittedValue_;
+}
+
+bool StagingRing::completed(uint64_t value) const
+{
+    return value == 0 || timelineSemaphore_.getCounterValue() >= value;
+}
+
+// Returns the space and command buffers of finished submissions
+void StagingRing::reclaim()
+{
+    if (submissions_.empty())
+    {
+        return;
+    }
+
+    const auto completedValue = timelineSemaphore_.getCounterValue();
+    while (!submissions_.empty() && submissions_.front().value <= completedValue)
+    {
+        auto& submission = submissions_.front();
+        tail_ = submission.end;
+        submission.commandBuffer.reset();
+        freeCommandBuffers_.push_back(std::move(submission.commandBuffer));
+        submissions_.pop_front();
+    }
+
+    // Nothing in flight or being recorded, so start again from the beginning of the buffer
+    if (submissions_.empty() && !recording_)
+    {
+        head_ = 0;
+        tail_ = 0;
+    }
+}
+
+void StagingRing::createBuffer(vk::DeviceSize capacity)
+{
+    if (mappedMemory_)
+    {
+        memory_.unmapMemory();
+    }
+
+    capacity = (capacity + capacityGranularity - 1) / capacityGranularity * capacityGranularity;
+    buffer_ = gpuDevice_->createBuffer(capacity, vk::BufferUsageFlagBits::eTransferSrc, vk::SharingMode::eExclusive);
+    memory_ = gpuDevice_->allocateBufferMemory(buffer_,
+                                               vk::MemoryPropertyFlagBits::eHostVisible
+                                                   | vk::MemoryPropertyFlagBits::eHostCoherent);
+    mappedMemory_ = static_cast<std::byte*>(memory_.mapMemory(0, VK_WHOLE_SIZE));
+    capacity_ = capacity;
+    head_ = 0;
+    tail_ = 0;
+}
+} // namespace renderer
@@ -0,0 +1,91 @@
+/// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Mark Rapson
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+#include <vulkan/vulkan_raii.hpp>
+
+namespace renderer
+{
+class GpuDevice;
+
+// Persistently mapped host visible buffer that uploads are written into directly. Copies out of the ring are
+// recorded into one shared command buffer and submitted together on flush(), or whenever the ring runs out of space.
+// Submissions signal increasing values on a timeline semaphore, and the space a submission's copies read from is
+// reused once its value has been reached, so nothing waits on the GPU unless the ring is full.
+class StagingRing
+{
+  public:
+    struct Allocation
+    {
+        std::byte* data;
+        vk::DeviceSize offset;
+    };
+
+    StagingRing(const GpuDevice& gpuDevice, vk::DeviceSize capacity);
+
+    // Waits for submitted copies, which still read from the buffer
+    ~StagingRing();
+
+    StagingRing(const StagingRing&) = delete;
+    StagingRing& operator=(const StagingRing&) = delete;
+
+    StagingRing(StagingRing&& other) = default;
+    StagingRing& operator=(StagingRing&& other) = default;
+
+    // May flush pending copies, and wait for the oldest submitted ones if the ring is full, so record the copy for
+    // an allocation only after allocating it
+    Allocation allocate(vk::DeviceSize size, vk::DeviceSize alignment);
+
+    const vk::raii::Buffer& buffer() const;
+
+    // Command buffer for copies out of the ring, begun on first use after a flush
+    const vk::raii::CommandBuffer& commandBuffer();
+
+    // Submits all recorded copies without waiting for them. Returns the value signalled when they're done, or the
+    // last submission's value if nothing was recorded.
+    uint64_t flush();
+
+    // Whether the copies submitted with value have finished
+    bool completed(uint64_t value) const;
+
+  private:
+    struct Submission
+    {
+        uint64_t value;
+
+        // Ring position just past the submission's last allocation
+        vk::DeviceSize end;
+
+        vk::raii::CommandBuffer commandBuffer;
+    };
+
+  private:
+    void createBuffer(vk::DeviceSize capacity);
+    void reclaim();
+
+  private:
+    const GpuDevice* gpuDevice_;
+    vk::DeviceSize capacity_{0};
+
+    // Positions count up through the ring without wrapping, so the bytes in use are head_ - tail_ and the offset in
+    // the buffer is a position modulo the capacity
+    vk::DeviceSize head_{0};
+    vk::DeviceSize tail_{0};
+
+    vk::raii::Buffer buffer_{nullptr};
+    vk::raii::DeviceMemory memory_{nullptr};
+    std::byte* mappedMemory_{nullptr};
+    vk::raii::Semaphore timelineSemaphore_{nullptr};
+    uint64_t submittedValue_{0};
+    std::deque<Submission> submissions_;
+    std::vector<vk::raii::CommandBuffer> freeCommandBuffers_;
+    vk::raii::CommandBuffer commandBuffer_{nullptr};
+    bool recording_{false};
+};
+} // namespace renderer
@@ -0,0 +1,244 @@
+/// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Mark Rapson
+
+#include "texture_streamer.h"
+#include "gpu_resource_cache.h"
+
+#include "renderer/camera.h"
+
+#include <assets/asset_database.h>
+#include <assets/residency.h>
+#include <core/allocation_tracker.h>
+
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace renderer
+{
+constexpr auto initialStreamedSize = 64u;
+
+// Textures usually cover a mesh more than once, so ask for one level finer than the mesh's screen size suggests
+constexpr auto mipBias = 1.0f;
+
+constexpr auto noRequest = std::numeric_limits<uint32_t>::max();
+
+uint32_t initialMip(const assets::Image& image)
+{
+    if (!assets::isStreamable(image))
+    {
+        return 0;
+    }
+
+    auto mip = uint32_t{0};
+    while (mip + 1 < image.mipLevels && std::max(image.width >> mip, image.height >> mip) > initialStreamedSize)
+    {
+        mip++;
+    }
+
+    return mip;
+}
+
+// GPU memory for the levels from baseMip down, close enough to the allocation size to budget with
+vk::DeviceSize streamedSize(const assets::Image& image, uint32_t baseMip)
+{
+    auto size = vk::DeviceSize{0};
+    for (auto level = baseMip; level < image.mipLevels; ++level)
+    {
+        size += image.levels.at(level).size;
+    }
+
+    return size;
+}
+
+// Level whose texel density matches the pixels covered by the mesh's bounding sphere
+uint32_t requiredMip(const assets::Image& image,
+                     const glm::vec4& boundingSphere,
+                     const glm::mat4& transform,
+                     const glm::vec3& cameraPosition,
+                     float pixelsPerUnit)
+{
+    const auto center = glm::vec3{transform * glm::vec4{glm::vec3{boundingSphere}, 1.0f}};
+    const auto scale = std::max({glm::length(glm::vec3{transform[0]}),
+                                 glm::length(glm::vec3{transform[1]}),
+                                 glm::length(glm::vec3{transform[2]})});
+    const auto radius = boundingSphere.w * scale;
+
+    const auto distance = glm::length(center - cameraPosition) - radius;
+    if (distance <= 0.0f)
+    {
+        return 0;
+    }
+
+    const auto screenSize = std::max(2.0f * radius * pixelsPerUnit / distance, 1.0f);
+    const auto texels = static_cast<float>(std::max(image.width, image.height));
+    const auto mip = std::floor(std::log2(texels / screenSize) - mipBias);
+
+    return static_cast<uint32_t>(std::clamp(mip, 0.0f, static_cast<float>(image.mipLevels - 1)));
+}
+
+TextureStreamer::TextureStreamer(vk::DeviceSize budget, vk::DeviceSize uploadBytesPerFrame)
+    : budget_{budget},
+      uploadBytesPerFrame_{uploadBytesPerFrame}
+{
+}
+
+void TextureStreamer::setBudget(vk::DeviceSize budget)
+{
+    budget_ = budget;
+}
+
+void TextureStreamer::requestMips(GpuResourceCache& gpuResources,
+                                  const Camera& camera,
+                                  vk::Extent2D extent,
+                                  std::span<const DrawCommand> drawCommands)
+{
+    const auto& images = gpuResources.assetDatabase().pool<assets::Image>();
+    requestedMips_.assign(images.slotCount(), noRequest);
+
+    // Screen pixels covered by one world unit at distance one
+    const auto pixelsPerUnit = std::abs(camera.projection()[1][1]) * 0.5f * static_cast<float>(extent.height);
+
+    for (const auto& drawCommand : drawCommands)
+    {
+        const auto texture = gpuResources.materialTexture(drawCommand.material);
+        if (!images.contains(texture) || !assets::isStreamable(images.get(texture)))
+        {
+            continue;
+        }
+
+        // Instances can be spread anywhere, so their textures are kept at full resolution
+        auto mip = uint32_t{0};
+        if (drawCommand.instanceCount == 0)
+        {
+            mip = requiredMip(images.get(texture),
+                              gpuResources.gpuMesh(drawCommand.subMesh).boundingSphere,
+                              drawCommand.transform,
+                              camera.position(),
+                              pixelsPerUnit);
+        }
+
+        requestedMips_[texture.index] = std::min(requestedMips_[texture.index], mip);
+    }
+}
+
+void TextureStreamer::update(GpuResourceCache& gpuResources,
+                             const Camera& camera,
+                             vk::Extent2D extent,
+                             std::span<const DrawCommand> drawCommands,
+                             uint64_t retireFrame,
+                             std::pmr::memory_resource* scratch)
+{
+    {
+        auto allocationZone = core::AllocationZone{"TextureStreamer::stream"};
+        gpuResources.commitStreamedImages(retireFrame);
+    }
+
+    requestMips(gpuResources, camera, extent, drawCommands);
+
+    struct Change
+    {
+        assets::Handle<assets::Image> handle;
+        uint32_t baseMip;
+        uint32_t targetMip;
+    };
+
+    // Textures never go coarser than their initial levels, which stay resident for as long as the image is loaded
+    auto residentBytes = vk::DeviceSize{0};
+    auto streamIn = std::pmr::vector<Change>{scratch};
+    auto streamOut = std::pmr::vector<Change>{scratch};
+
+    const auto& images = gpuResources.assetDatabase().pool<assets::Image>();
+    images.forEach(
+        [&](assets::Handle<assets::Image> handle, const assets::Image& image)
+        {
+            if (!assets::isStreamable(image) || image.data.empty() || gpuResources.gpuMemoryUsage(handle) == 0)
+            {
+                return;
+            }
+
+            const auto baseMip = gpuResources.gpuImage(handle).baseMip;
+            residentBytes += streamedSize(image, baseMip);
+
+            // Both copies hold memory until the one being uploaded is swapped in, and it isn't changed meanwhile
+            if (const auto* pending = gpuResources.pendingImage(handle))
+            {
+                residentBytes += streamedSize(image, pending->baseMip);
+                return;
+            }
+
+            const auto targetMip = std::min(requestedMips_[handle.index], initialMip(image));
+
+            if (targetMip < baseMip)
+            {
+                streamIn.push_back({handle, baseMip, targetMip});
+            }
+            else if (targetMip > baseMip)
+            {
+                streamOut.push_back({handle, baseMip, targetMip});
+            }
+        });
+
+    // Biggest shortfall first in, biggest surplus last out so it's the first popped
+    std::ranges::sort(streamIn, std::greater{}, [](const Change& change) { return change.baseMip - change.targetMip; });
+    std::ranges::sort(streamOut, std::less{}, [](const Change& change) { return change.targetMip - change.baseMip; });
+
+    auto uploadedBytes = vk::DeviceSize{0};
+    auto stream = [&](const Change& change)
+    {
+        auto allocationZone = core::AllocationZone{"TextureStreamer::stream"};
+
+        const auto& image = images.get(change.handle);
+        residentBytes -= streamedSize(image, change.baseMip);
+        residentBytes += streamedSize(image, change.targetMip);
+        uploadedBytes += streamedSize(image, change.targetMip);
+
+        gpuResources.streamImage(change.handle, change.targetMip);
+    };
+
+    for (const auto& change : streamIn)
+    {
+        const auto& image = images.get(change.handle);
+        const auto growth = streamedSize(image, change.targetMip) - streamedSize(image, change.baseMip);
+
+        // Spread large uploads over several frames rather than stalling one
+        if (uploadedBytes > 0 && uploadedBytes + streamedSize(image, change.targetMip) > uploadBytesPerFrame_)
+        {
+            break;
+        }
+
+        while (residentBytes + growth > budget_ && !streamOut.empty())
+        {
+            stream(streamOut.back());
+            streamOut.pop_back();
+        }
+
+        if (residentBytes + growth > budget_)
+        {
+            SPDLOG_DEBUG("Texture budget of {} bytes reached, image {} stays at mip {}",
+                         budget_,
+                         change.handle.index,
+                         change.baseMip);
+            break;
+        }
+
+        stream(change);
+    }
+
+    // A lowered budget is met by trimming textures that need less than they hold
+    while (residentBytes > budget_ && !streamOut.empty())
+    {
+        stream(streamOut.back());
+        streamOut.pop_back();
+    }
+
+    // Submitted without waiting; the new copies are swapped in by a later update once their uploads have finished
+    if (uploadedBytes > 0)
+    {
+        auto allocationZone = core::AllocationZone{"TextureStreamer::stream"};
+        gpuResources.flushUploads();
+    }
+}
+} // namespace renderer
@@ -0,0 +1,62 @@
+/// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Mark Rapson
+
+#pragma once
+
+#include "renderer/draw_command.h"
+
+#include <vulkan/vulkan_raii.hpp>
+
+#include <cstdint>
+#include <memory_resource>
+#include <span>
+#include <vector>
+
+namespace assets
+{
+struct Image;
+}
+
+namespace renderer
+{
+class Camera;
+class GpuResourceCache;
+
+// Mip a streamable image is first uploaded from: the largest level no bigger than 64 texels a side. Images that
+// can't be streamed are always uploaded whole.
+uint32_t initialMip(const assets::Image& image);
+
+// Streams the finer mips of mipmapped textures in and out as they're needed. Each frame the mip every texture needs
+// is estimated from how large the meshes using it appear on screen, and textures are re-uploaded from their CPU copy
+// at that level while the total stays within a VRAM budget. Textures nobody needs give their memory back first.
+class TextureStreamer
+{
+  public:
+    TextureStreamer(vk::DeviceSize budget, vk::DeviceSize uploadBytesPerFrame);
+
+    void setBudget(vk::DeviceSize budget);
+
+    // Call between frames. Uploads started by earlier updates that have finished are swapped into the material
+    // descriptors for the next frame recorded and the old copies retired once frames in flight are done with them;
+    // new uploads are submitted without waiting for them. Working lists are allocated from scratch.
+    void update(GpuResourceCache& gpuResources,
+                const Camera& camera,
+                vk::Extent2D extent,
+                std::span<const DrawCommand> drawCommands,
+                uint64_t retireFrame,
+                std::pmr::memory_resource* scratch = std::pmr::get_default_resource());
+
+  private:
+    void requestMips(GpuResourceCache& gpuResources,
+                     const Camera& camera,
+                     vk::Extent2D extent,
+                     std::span<const DrawCommand> drawCommands);
+
+  private:
+    vk::DeviceSize budget_;
+    vk::DeviceSize uploadBytesPerFrame_;
+
+    // Finest mip needed this frame, indexed by image handle
+    std::vector<uint32_t> requestedMips_;
+};
+} // namespace renderer
@@ -0,0 +1,351 @@
+/// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Mark Rapson
+
+#include "cluster_cull_pass.h"
+
+#include "private/gpu_resource_cache.h"
+#include "private/shader.h"
+#include "renderer/camera.h"
+#include "renderer/draw_command.h"
+#include "renderer/gpu_device.h"
+
+#include <core/file_system.h>
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace renderer
+{
+// Matches the ClusterDraw struct in cluster_cull.slang (std430)
+struct GpuClusterDraw
+{
+    glm::mat4 modelTransform;
+    uint32_t meshletOffset;
+    uint32_t meshletCount;
+    uint32_t commandOffset;
+    uint32_t firstInstance;
+    uint32_t instanceCount;
+    uint32_t _padding[3];
+};
+
+struct ClusterCullPushConstants
+{
+    std::array<glm::vec4, 6> frustumPlanes;
+    glm::vec4 cameraPosition;
+    uint32_t drawCount;
+    uint32_t groupsPerRow;
+};
+
+constexpr auto minimumDrawCapacity = uint32_t{64};
+constexpr auto minimumCommandCapacity = uint32_t{1024};
+
+// World-space frustum planes (Gribb/Hartmann), normalised so plane distances can be compared with sphere radii
+std::array<glm::vec4, 6> extractFrustumPlanes(const glm::mat4& viewProjection)
+{
+    const auto row = [&viewProjection](int index)
+    {
+        return glm::vec4{viewProjection[0][index],
+                         viewProjection[1][index],
+                         viewProjection[2][index],
+                         viewProjection[3][index]};
+    };
+
+    auto planes = std::array{row(3) + row(0),
+                             row(3) - row(0),
+                             row(3) + row(1),
+                             row(3) - row(1),
+                             row(3) + row(2),
+                             row(3) - row(2)};
+
+    for (auto& plane : planes)
+    {
+        plane = plane / glm::length(glm::vec3{plane});
+    }
+
+    return planes;
+}
+
+ClusterCullPass::ClusterCullPass(const GpuDevice& gpuDevice, int maxFramesInFlight)
+    : gpuDevice_{gpuDevice},
+      maxFramesInFlight_{maxFramesInFlight}
+{
+    createDescriptorSetLayout();
+    createDescriptorSets();
+    createPipeline();
+
+    const auto limits = gpuDevice_.physicalDevice().getProperties().limits;
+    maxWorkGroupCount_ = {limits.maxComputeWorkGroupCount[0],
+                          limits.maxComputeWorkGroupCount[1],
+                          limits.maxComputeWorkGroupCount[2]};
+}
+
+void ClusterCullPass::recordCommands(const RenderPassCommandInfo& passInfo)
+{
+    auto& frame = frames_.at(passInfo.frameIndex);
+    const auto drawCount = static_cast<uint32_t>(passInfo.drawCommands.size());
+
+    drawRanges_.clear();
+
+    if (drawCount == 0)
+    {
+        return;
+    }
+
+    // One workgroup per draw command, laid out in rows no wider than the device allows along x
+    const auto groupsPerRow = std::min(drawCount, maxWorkGroupCount_[0]);
+    const auto rowCount = (drawCount + groupsPerRow - 1) / groupsPerRow;
+    if (rowCount > maxWorkGroupCount_[1])
+    {
+        throw std::runtime_error{"Too many draw commands for a single cluster culling dispatch"};
+    }
+
+    reserveDraws(frame, drawCount);
+
+    auto* draws = static_cast<GpuClusterDraw*>(frame.drawMappedMemory);
+    auto commandCount = uint32_t{0};
+    for (auto drawIndex = uint32_t{0}; drawIndex < drawCount; ++drawIndex)
+    {
+        const auto& drawCommand = passInfo.drawCommands[drawIndex];
+        const auto& gpuMesh = passInfo.gpuResourceCache.gpuMesh(drawCommand.subMesh);
+
+        auto& draw = draws[drawIndex];
+        draw.modelTransform = drawCommand.transform;
+        draw.meshletOffset = gpuMesh.meshletOffset;
+        draw.meshletCount = gpuMesh.meshletCount;
+        draw.commandOffset = commandCount;
+        draw.firstInstance = 0;
+        draw.instanceCount = 1;
+        if (drawCommand.instanceCount > 0)
+        {
+            draw.firstInstance = passInfo.gpuResourceCache.instanceOffset(drawCommand.prefab)
+                                 + drawCommand.instanceOffset;
+            draw.instanceCount = drawCommand.instanceCount;
+        }
+
+        drawRanges_.push_back({.commandOffset = commandCount, .maxCommandCount = gpuMesh.meshletCount});
+        commandCount += gpuMesh.meshletCount;
+    }
+
+    reserveCommands(frame, commandCount);
+    updateDescriptorSet(frame, passInfo.gpuResourceCache.meshletBuffer());
+
+    const auto& commandBuffer = passInfo.commandBuffer;
+
+    commandBuffer.fillBuffer(*frame.countBuffer, 0, drawCount * sizeof(uint32_t), 0);
+
+    gpuDevice_.bufferMemoryBarrier(*frame.countBuffer,
+                                   commandBuffer,
+                                   vk::AccessFlagBits2::eTransferWrite,
+                                   vk::AccessFlagBits2::eShaderStorageRead | vk::AccessFlagBits2::eShaderStorageWrite,
+                                   vk::PipelineStageFlagBits2::eTransfer,
+                                   vk::PipelineStageFlagBits2::eComputeShader);
+
+    auto pushConstants = ClusterCullPushConstants{};
+    pushConstants.frustumPlanes = extractFrustumPlanes(passInfo.camera.projection() * passInfo.camera.view());
+    pushConstants.cameraPosition = glm::vec4{passInfo.camera.position(), 1.0f};
+    pushConstants.drawCount = drawCount;
+    pushConstants.groupsPerRow = groupsPerRow;
+
+    commandBuffer.bindPipeline(vk::PipelineBindPoint::eCompute, *pipeline_);
+    commandBuffer.bindDescriptorSets(vk::PipelineBindPoint::eCompute,
+                                     pipelineLayout_,
+                                     0,
+                                     *frame.descriptorSet,
+                                     nullptr);
+    commandBuffer.pushConstants(pipelineLayout_,
+                                vk::ShaderStageFlagBits::eCompute,
+                                0,
+                                vk::ArrayProxy<const ClusterCullPushConstants>{pushConstants});
+
+    // Each invocation strides over its draw's meshlets; groups past drawCount in the last row exit early
+    commandBuffer.dispatch(groupsPerRow, rowCount, 1);
+
+    gpuDevice_.bufferMemoryBarrier(*frame.commandBuffer,
+                                   commandBuffer,
+                                   vk::AccessFlagBits2::eShaderStorageWrite,
+                                   vk::AccessFlagBits2::eIndirectCommandRead,
+                                   vk::PipelineStageFlagBits2::eComputeShader,
+                                   vk::PipelineStageFlagBits2::eDrawIndirect);
+
+    gpuDevice_.bufferMemoryBarrier(*frame.countBuffer,
+                                   commandBuffer,
+                                   vk::AccessFlagBits2::eShaderStorageWrite,
+                                   vk::AccessFlagBits2::eIndirectCommandRead,
+                                   vk::PipelineStageFlagBits2::eComputeShader,
+                                   vk::PipelineStageFlagBits2::eDrawIndirect);
+}
+
+const vk::raii::Buffer& ClusterCullPass::indirectCommandBuffer(uint32_t frameIndex) const
+{
+    return frames_.at(frameIndex).commandBuffer;
+}
+
+const vk::raii::Buffer& ClusterCullPass::indirectCountBuffer(uint32_t frameIndex) const
+{
+    return frames_.at(frameIndex).countBuffer;
+}
+
+const ClusterDrawRange& ClusterCullPass::drawRange(size_t drawIndex) const
+{
+    return drawRanges_.at(drawIndex);
+}
+
+void ClusterCullPass::createDescriptorSetLayout()
+{
+    // 0: meshlets, 1: draws, 2: indirect commands, 3: indirect command counts
+    auto bindings = std::array<vk::DescriptorSetLayoutBinding, 4>{};
+    for (auto binding = uint32_t{0}; binding < bindings.size(); ++binding)
+    {
+        bindings[binding].binding = binding;
+        bindings[binding].descriptorType = vk::DescriptorType::eStorageBuffer;
+        bindings[binding].descriptorCount = 1;
+        bindings[binding].stageFlags = vk::ShaderStageFlagBits::eCompute;
+    }
+
+    auto layoutInfo = vk::DescriptorSetLayoutCreateInfo{};
+    layoutInfo.bindingCount = static_cast<uint32_t>(bindings.size());
+    layoutInfo.pBindings = bindings.data();
+
+    descriptorSetLayout_ = vk::raii::DescriptorSetLayout(gpuDevice_.device(), layoutInfo);
+}
+
+void ClusterCullPass::createDescriptorSets()
+{
+    auto storagePoolSize = vk::DescriptorPoolSize{};
+    storagePoolSize.type = vk::DescriptorType::eStorageBuffer;
+    storagePoolSize.descriptorCount = 4 * maxFramesInFlight_;
+
+    auto poolInfo = vk::DescriptorPoolCreateInfo{};
+    poolInfo.flags = vk::DescriptorPoolCreateFlagBits::eFreeDescriptorSet;
+    poolInfo.maxSets = maxFramesInFlight_;
+    poolInfo.poolSizeCount = 1;
+    poolInfo.pPoolSizes = &storagePoolSize;
+
+    descriptorPool_ = vk::raii::DescriptorPool{gpuDevice_.device(), poolInfo};
+
+    auto layouts = std::vector<vk::DescriptorSetLayout>{static_cast<size_t>(maxFramesInFlight_),
+                                                        *descriptorSetLayout_};
+
+    auto allocInfo = vk::DescriptorSetAllocateInfo{};
+    allocInfo.descriptorPool = *descriptorPool_;
+    allocInfo.descriptorSetCount = maxFramesInFlight_;
+    allocInfo.pSetLayouts = layouts.data();
+
+    auto descriptorSets = vk::raii::DescriptorSets{gpuDevice_.device(), allocInfo};
+
+    frames_.resize(maxFramesInFlight_);
+    for (auto frameIndex = 0; frameIndex < maxFramesInFlight_; ++frameIndex)
+    {
+        frames_.at(frameIndex).descriptorSet = std::move(descriptorSets.at(frameIndex));
+    }
+}
+
+void ClusterCullPass::createPipeline()
+{
+    auto computeShaderModule = createShaderModule(gpuDevice_.device(),
+                                                  core::readBinaryFile(core::getShaderDir() / "cluster_cull.comp.spv"));
+
+    auto computeShaderStageInfo = vk::PipelineShaderStageCreateInfo{};
+    computeShaderStageInfo.stage = vk::ShaderStageFlagBits::eCompute;
+    computeShaderStageInfo.module = *computeShaderModule;
+    computeShaderStageInfo.pName = "compMain";
+
+    if (gpuDevice_.physicalDevice().getProperties().limits.maxPushConstantsSize < sizeof(ClusterCullPushConstants))
+    {
+        throw std::runtime_error{"Requested push constant size exceeds device limits"};
+    }
+
+    auto pushConstantRange = vk::PushConstantRange{};
+    pushConstantRange.offset = 0;
+    pushConstantRange.size = sizeof(ClusterCullPushConstants);
+    pushConstantRange.stageFlags = vk::ShaderStageFlagBits::eCompute;
+
+    auto pipelineLayoutInfo = vk::PipelineLayoutCreateInfo{};
+    pipelineLayoutInfo.setLayoutCount = 1;
+    pipelineLayoutInfo.pSetLayouts = &*descriptorSetLayout_;
+    pipelineLayoutInfo.pushConstantRangeCount = 1;
+    pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
+
+    pipelineLayout_ = vk::raii::PipelineLayout(gpuDevice_.device(), pipelineLayoutInfo);
+
+    auto pipelineInfo = vk::ComputePipelineCreateInfo{};
+    pipelineInfo.stage = computeShaderStageInfo;
+    pipelineInfo.layout = *pipelineLayout_;
+
+    pipeline_ = vk::raii::Pipeline(gpuDevice_.device(), nullptr, pipelineInfo);
+}
+
+void ClusterCullPass::reserveDraws(FrameResources& frame, uint32_t drawCount)
+{
+    if (drawCount <= frame.drawCapacity)
+    {
+        return;
+    }
+
+    const auto capacity = std::max({drawCount, frame.drawCapacity * 2, minimumDrawCapacity});
+
+    frame.drawBuffer = gpuDevice_.createBuffer(sizeof(GpuClusterDraw) * capacity,
+                                               vk::BufferUsageFlagBits::eStorageBuffer,
+                                               vk::SharingMode::eExclusive);
+
+    frame.drawBufferMemory = gpuDevice_.allocateBufferMemory(frame.drawBuffer,
+                                                             vk::MemoryPropertyFlagBits::eHostVisible
+                                                                 | vk::MemoryPropertyFlagBits::eHostCoherent);
+
+    frame.drawMappedMemory = frame.drawBufferMemory.mapMemory(0, VK_WHOLE_SIZE);
+
+    frame.countBuffer = gpuDevice_.createBuffer(sizeof(uint32_t) * capacity,
+                                                vk::BufferUsageFlagBits::eStorageBuffer
+                                                    | vk::BufferUsageFlagBits::eIndirectBuffer
+                                                    | vk::BufferUsageFlagBits::eTransferDst,
+                                                vk::SharingMode::eExclusive);
+
+    frame.countBufferMemory = gpuDevice_.allocateBufferMemory(frame.countBuffer,
+                                                              vk::MemoryPropertyFlagBits::eDeviceLocal);
+
+    frame.drawCapacity = capacity;
+}
+
+void ClusterCullPass::reserveCommands(FrameResources& frame, uint32_t commandCount)
+{
+    if (commandCount <= frame.commandCapacity)
+    {
+        return;
+    }
+
+    const auto capacity = std::max({commandCount, frame.commandCapacity * 2, minimumCommandCapacity});
+
+    frame.commandBuffer = gpuDevice_.createBuffer(sizeof(vk::DrawIndexedIndirectCommand) * capacity,
+                                                  vk::BufferUsageFlagBits::eStorageBuffer
+                                                      | vk::BufferUsageFlagBits::eIndirectBuffer,
+                                                  vk::SharingMode::eExclusive);
+
+    frame.commandBufferMemory = gpuDevice_.allocateBufferMemory(frame.commandBuffer,
+                                                                vk::MemoryPropertyFlagBits::eDeviceLocal);
+
+    frame.commandCapacity = capacity;
+}
+
+void ClusterCullPass::updateDescriptorSet(const FrameResources& frame, const vk::raii::Buffer& meshletBuffer)
+{
+    // The frame's previous submission has completed by the time it is re-recorded, so its set can be rewritten
+    const auto bufferInfos = std::array{vk::DescriptorBufferInfo{*meshletBuffer, 0, VK_WHOLE_SIZE},
+                                        vk::DescriptorBufferInfo{*frame.drawBuffer, 0, VK_WHOLE_SIZE},
+                                        vk::DescriptorBufferInfo{*frame.commandBuffer, 0, VK_WHOLE_SIZE},
+                                        vk::DescriptorBufferInfo{*frame.countBuffer, 0, VK_WHOLE_SIZE}};
+
+    auto writes = std::array<vk::WriteDescriptorSet, 4>{};
+    for (auto binding = uint32_t{0}; binding < writes.size(); ++binding)
+    {
+        writes[binding].dstSet = *frame.descriptorSet;
+        writes[binding].dstBinding = binding;
+        writes[binding].descriptorType = vk::DescriptorType::eStorageBuffer;
+        writes[binding].descriptorCount = 1;
+        writes[binding].pBufferInfo = &bufferInfos[binding];
+    }
+
+    gpuDevice_.device().updateDescriptorSets(writes, {});
+}
+} // namespace renderer
@@ -0,0 +1,74 @@
+/// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Mark Rapson
+
+#pragma once
+
+#include "render_pass_command_info.h"
+
+#include <vulkan/vulkan_raii.hpp>
+
+#include <array>
+#include <vector>
+
+namespace renderer
+{
+class GpuDevice;
+
+// Range of indirect draw commands written by the culling pass for a single draw command
+struct ClusterDrawRange
+{
+    uint32_t commandOffset;
+    uint32_t maxCommandCount;
+};
+
+// Compute pass that tests every meshlet of every draw command against the camera frustum and its normal cone, and
+// writes the surviving meshlets as compacted indexed indirect draws for the geometry pass to consume.
+class ClusterCullPass
+{
+  public:
+    ClusterCullPass(const GpuDevice& gpuDevice, int maxFramesInFlight);
+
+    void recordCommands(const RenderPassCommandInfo& passInfo);
+
+    const vk::raii::Buffer& indirectCommandBuffer(uint32_t frameIndex) const;
+    const vk::raii::Buffer& indirectCountBuffer(uint32_t frameIndex) const;
+    const ClusterDrawRange& drawRange(size_t drawIndex) const;
+
+  private:
+    struct FrameResources
+    {
+        vk::raii::Buffer drawBuffer{nullptr};
+        vk::raii::DeviceMemory drawBufferMemory{nullptr};
+        void* drawMappedMemory{nullptr};
+        uint32_t drawCapacity{0};
+
+        vk::raii::Buffer commandBuffer{nullptr};
+        vk::raii::DeviceMemory commandBufferMemory{nullptr};
+        vk::raii::Buffer countBuffer{nullptr};
+        vk::raii::DeviceMemory countBufferMemory{nullptr};
+        uint32_t commandCapacity{0};
+
+        vk::raii::DescriptorSet descriptorSet{nullptr};
+    };
+
+    void createDescriptorSetLayout();
+    void createDescriptorSets();
+    void createPipeline();
+
+    void reserveDraws(FrameResources& frame, uint32_t drawCount);
+    void reserveCommands(FrameResources& frame, uint32_t commandCount);
+    void updateDescriptorSet(const FrameResources& frame, const vk::raii::Buffer& meshletBuffer);
+
+  private:
+    const GpuDevice& gpuDevice_;
+    const int maxFramesInFlight_;
+    vk::raii::DescriptorSetLayout descriptorSetLayout_{nullptr};
+    vk::raii::DescriptorPool descriptorPool_{nullptr};
+    vk::raii::PipelineLayout pipelineLayout_{nullptr};
+    vk::raii::Pipeline pipeline_{nullptr};
+    std::array<uint32_t, 3> maxWorkGroupCount_{};
+
+    std::vector<FrameResources> frames_;
+    std::vector<ClusterDrawRange> drawRanges_;
+};
+} // namespace renderer
@@ -3,6 +3,7 @@
 
 #include "geometry_pass.h"
 
+#include "cluster_cull_pass.h"
 #include "private/gpu_resource_cache.h"
 #include "private/shader.h"
 #include "renderer/draw_command.h"
@@ -11,6 +12,9 @@
 
 #include <core/file_system.h>
 
+#include <algorithm>
+#include <iterator>
+
 namespace renderer
 {
 struct PushConstants
@@ -22,8 +26,10 @@ struct PushConstants
 GeometryPass::GeometryPass(const GpuDevice& gpuDevice,
                            const vk::Format& surfaceFormat,
                            const vk::raii::DescriptorSetLayout& cameraDescriptorSetLayout,
-                           const vk::raii::DescriptorSetLayout& materialDescriptorSetLayout)
-    : gpuDevice_{gpuDevice}
+                           const vk::raii::DescriptorSetLayout& materialDescriptorSetLayout,
+                           const ClusterCullPass& clusterCullPass)
+    : gpuDevice_{gpuDevice},
+      clusterCullPass_{clusterCullPass}
 {
     createPipeline(surfaceFormat, cameraDescriptorSetLayout, materialDescriptorSetLayout);
 }
@@ -67,7 +73,10 @@ void GeometryPass::recordCommands(const RenderPassCommandInfo& passInfo)
 
     passInfo.commandBuffer.beginRendering(renderingInfo);
     passInfo.commandBuffer.bindPipeline(vk::PipelineBindPoint::eGraphics, *pipeline_);
-    passInfo.commandBuffer.bindVertexBuffers(0, *passInfo.gpuResourceCache.meshVertexBuffer(), {0});
+    passInfo.commandBuffer.bindVertexBuffers(0,
+                                             {*passInfo.gpuResourceCache.meshVertexBuffer(),
+                                              *passInfo.gpuResourceCache.meshInstanceBuffer()},
+                                             {0, 0});
     passInfo.commandBuffer.bindIndexBuffer(*passInfo.gpuResourceCache.meshIndexBuffer(), 0, vk::IndexType::eUint32);
 
     passInfo.commandBuffer.bindDescriptorSets(vk::PipelineBindPoint::eGraphics,
@@ -85,8 +94,10 @@ void GeometryPass::recordCommands(const RenderPassCommandInfo& passInfo)
                                                     1.0f));
     passInfo.commandBuffer.setScissor(0, vk::Rect2D(vk::Offset2D(0, 0), passInfo.extent));
 
-    for (const auto& drawCommand : passInfo.drawCommands)
+    for (auto drawIndex = size_t{0}; drawIndex < passInfo.drawCommands.size(); ++drawIndex)
     {
+        const auto& drawCommand = passInfo.drawCommands[drawIndex];
+
         auto pushConstants = PushConstants{};
         pushConstants.modelTransform = drawCommand.transform;
         pushConstants.normalMatrix = glm::transpose(glm::inverse(glm::mat3(drawCommand.transform)));
@@ -96,19 +107,26 @@ void GeometryPass::recordCommands(const RenderPassCommandInfo& passInfo)
                                              0,
                                              vk::ArrayProxy<const PushConstants>{pushConstants});
 
-        if (drawCommand.subMesh->material)
+        if (drawCommand.material.valid())
         {
-            const auto& gpuMaterial = passInfo.gpuResourceCache.gpuMaterial(drawCommand.subMesh->material);
+            const auto& gpuMaterial = passInfo.gpuResourceCache.gpuMaterial(drawCommand.material);
             passInfo.commandBuffer.bindDescriptorSets(
                 vk::PipelineBindPoint::eGraphics,
                 pipelineLayout_,
                 1,
-                *passInfo.gpuResourceCache.materialDescriptorSet(drawCommand.subMesh->material).at(passInfo.frameIndex),
+                *passInfo.gpuResourceCache.materialDescriptorSet(drawCommand.material).at(passInfo.frameIndex),
                 gpuMaterial.uboOffset);
         }
 
-        auto& gpuMesh = passInfo.gpuResourceCache.gpuMesh(drawCommand.subMesh);
-        passInfo.commandBuffer.drawIndexed(gpuMesh.indexCount, 1, gpuMesh.indexOffset, gpuMesh.vertexOffset, 0);
+        // One indirect draw per meshlet that survived culling
+        const auto& drawRange = clusterCullPass_.drawRange(drawIndex);
+        passInfo.commandBuffer.drawIndexedIndirectCount(
+            *clusterCullPass_.indirectCommandBuffer(passInfo.frameIndex),
+            drawRange.commandOffset * sizeof(vk::DrawIndexedIndirectCommand),
+            *clusterCullPass_.indirectCountBuffer(passInfo.frameIndex),
+            drawIndex * sizeof(uint32_t),
+            drawRange.maxCommandCount,
+            sizeof(vk::DrawIndexedIndirectCommand));
     }
 
     passInfo.commandBuffer.endRendering();
@@ -138,12 +156,17 @@ void GeometryPass::createPipeline(const vk::Format& surfaceFormat,
     vk::PipelineShaderStageCreateInfo shaderStages[] = {vertShaderStageInfo, fragShaderStageInfo};
 
     // Fixed function stages
-    const auto bindingDescriptions = VertexLayout::bindingDescription();
-    const auto attributeDescriptions = VertexLayout::attributeDescriptions();
+    const auto bindingDescriptions = std::array{VertexLayout::bindingDescription(),
+                                                VertexLayout::instanceBindingDescription()};
+
+    auto attributeDescriptions = std::vector<vk::VertexInputAttributeDescription>{};
+    std::ranges::copy(VertexLayout::attributeDescriptions(), std::back_inserter(attributeDescriptions));
+    std::ranges::copy(VertexLayout::instanceAttributeDescriptions(), std::back_inserter(attributeDescriptions));
+
     auto vertexInputInfo = vk::PipelineVertexInputStateCreateInfo{};
-    vertexInputInfo.vertexBindingDescriptionCount = 1;
-    vertexInputInfo.pVertexBindingDescriptions = &bindingDescriptions;
-    vertexInputInfo.vertexAttributeDescriptionCount = attributeDescriptions.size();
+    vertexInputInfo.vertexBindingDescriptionCount = static_cast<uint32_t>(bindingDescriptions.size());
+    vertexInputInfo.pVertexBindingDescriptions = bindingDescriptions.data();
+    vertexInputInfo.vertexAttributeDescriptionCount = static_cast<uint32_t>(attributeDescriptions.size());
     vertexInputInfo.pVertexAttributeDescriptions = attributeDescriptions.data();
 
     auto inputAssembly = vk::PipelineInputAssemblyStateCreateInfo{};
@@ -9,6 +9,7 @@
 
 namespace renderer
 {
+class ClusterCullPass;
 class GpuDevice;
 
 class GeometryPass
@@ -17,7 +18,8 @@ class GeometryPass
     GeometryPass(const GpuDevice& gpuDevice,
                  const vk::Format& surfaceFormat,
                  const vk::raii::DescriptorSetLayout& cameraDescriptorSetLayout,
-                 const vk::raii::DescriptorSetLayout& materialDescriptorSetLayout);
+                 const vk::raii::DescriptorSetLayout& materialDescriptorSetLayout,
+                 const ClusterCullPass& clusterCullPass);
 
     void recordCommands(const RenderPassCommandInfo& passInfo);
 
@@ -28,6 +30,7 @@ class GeometryPass
 
   private:
     const GpuDevice& gpuDevice_;
+    const ClusterCullPass& clusterCullPass_;
     vk::raii::PipelineLayout pipelineLayout_{nullptr};
     vk::raii::Pipeline pipeline_{nullptr};
 };
@@ -3,6 +3,8 @@
 
 #pragma once
 
+#include <assets/handle.h>
+
 #include <vulkan/vulkan_raii.hpp>
 
 #include <optional>
@@ -15,6 +17,7 @@ struct Skybox;
 
 namespace renderer
 {
+class Camera;
 struct DrawCommand;
 class GpuResourceCache;
 
@@ -28,7 +31,8 @@ struct RenderPassCommandInfo
     const vk::Extent2D& extent;
     const vk::raii::CommandBuffer& commandBuffer;
     const vk::raii::DescriptorSet& cameraDescriptorSet;
-    assets::Skybox* skybox{nullptr};
+    const Camera& camera;
+    assets::Handle<assets::Skybox> skybox;
     GpuResourceCache& gpuResourceCache;
     std::span<const DrawCommand> drawCommands;
 };
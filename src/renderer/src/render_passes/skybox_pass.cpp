@@ -45,7 +45,7 @@ void SkyboxPass::recordCommands(const RenderPassCommandInfo& passInfo)
                                               *passInfo.cameraDescriptorSet,
                                               nullptr);
 
-    if (passInfo.skybox)
+    if (passInfo.skybox.valid())
     {
         passInfo.commandBuffer.bindDescriptorSets(
             vk::PipelineBindPoint::eGraphics,
@@ -2,6 +2,8 @@
 
 #include "private/gpu_material.h"
 #include "private/gpu_resource_cache.h"
+#include "private/texture_streamer.h"
+#include "render_passes/cluster_cull_pass.h"
 #include "render_passes/geometry_pass.h"
 #include "render_passes/skybox_pass.h"
 #include "renderer/camera.h"
@@ -9,6 +11,9 @@
 #include "renderer/vertex_layout.h"
 
 #include <assets/asset_database.h>
+#include <core/allocation_tracker.h>
+#include <core/frame_arenas.h>
+#include <core/timeline.h>
 
 #include <spdlog/spdlog.h>
 
@@ -27,6 +32,9 @@ struct CameraBufferObject
 
 constexpr auto maxFramesInFlight = 2;
 
+constexpr auto defaultTextureStreamingBudget = vk::DeviceSize{512} * 1024 * 1024;
+constexpr auto textureUploadBytesPerFrame = vk::DeviceSize{32} * 1024 * 1024;
+
 vk::Extent2D getSwapchainExtent(const vk::SurfaceCapabilitiesKHR& capabilities, int windowWidth, int windowHeight)
 {
     if (capabilities.currentExtent.width != 0xFFFFFFFF)
@@ -102,20 +110,42 @@ Renderer::Renderer(const vk::raii::Instance& instance,
 
     spdlog::info("Creating render passes");
     createRenderPasses();
+
+    textureStreamer_ = std::make_unique<TextureStreamer>(defaultTextureStreamingBudget, textureUploadBytesPerFrame);
+    completedFrames_ = std::make_unique<core::Timeline>();
 }
 
 Renderer::~Renderer() = default;
 
 void Renderer::renderFrame(const renderer::Camera& camera,
-                           assets::Skybox* skybox,
-                           const std::vector<DrawCommand>& drawCommands)
+                           assets::Handle<assets::Skybox> skybox,
+                           std::span<const DrawCommand> drawCommands)
 {
+    auto allocationZone = core::AllocationZone{"Renderer::renderFrame"};
+
     if (gpuDevice_.device().waitForFences(*drawFences_.at(currentFrameIndex_), vk::True, UINT64_MAX)
         != vk::Result::eSuccess)
     {
         throw std::runtime_error("Device unable to wait for fence to signal");
     }
 
+    // The slot's fence was last signalled by the frame maxFramesInFlight ago, and frames finish in order
+    if (frameNumber_ + 1 >= maxFramesInFlight)
+    {
+        completedFrames_->signal(frameNumber_ + 1 - maxFramesInFlight);
+    }
+
+    if (gpuResources_)
+    {
+        gpuResources_->destroyRetiredResources(frameNumber_);
+        textureStreamer_->update(*gpuResources_,
+                                 camera,
+                                 swapchainExtent_,
+                                 drawCommands,
+                                 frameNumber_ + maxFramesInFlight,
+                                 frameArenas_ ? &frameArenas_->arena() : std::pmr::get_default_resource());
+    }
+
     auto result = vk::Result{};
     auto imageIndex = uint32_t{};
 
@@ -169,7 +199,8 @@ void Renderer::renderFrame(const renderer::Camera& camera,
         recreateSwapchain();
     }
 
-    currentFrameIndex_ = (currentFrameIndex_ + 1) & maxFramesInFlight;
+    currentFrameIndex_ = (currentFrameIndex_ + 1) % maxFramesInFlight;
+    frameNumber_++;
 }
 
 void Renderer::windowResized(int width, int height)
@@ -198,6 +229,77 @@ void Renderer::setResources(const assets::AssetDatabase& db)
                                                        skyboxDescriptorSetLayout_);
 }
 
+void Renderer::updateResources(const assets::AssetDatabase& db, const assets::EvictedAssets& removed)
+{
+    if (!gpuResources_)
+    {
+        setResources(db);
+        return;
+    }
+
+    releaseResources(removed);
+    gpuResources_->update(db, frameNumber_ + maxFramesInFlight);
+}
+
+size_t Renderer::gpuMemoryUsage(assets::Handle<assets::Image> image) const
+{
+    return gpuResources_ ? static_cast<size_t>(gpuResources_->gpuMemoryUsage(image)) : 0;
+}
+
+size_t Renderer::gpuMemoryUsage(assets::Handle<assets::SubMesh> mesh) const
+{
+    return gpuResources_ ? static_cast<size_t>(gpuResources_->gpuMemoryUsage(mesh)) : 0;
+}
+
+size_t Renderer::gpuMemoryUsage() const
+{
+    return gpuResources_ ? static_cast<size_t>(gpuResources_->gpuMemoryUsage()) : 0;
+}
+
+MeshBufferCapacity Renderer::meshBufferCapacity() const
+{
+    if (!gpuResources_)
+    {
+        return {};
+    }
+
+    return MeshBufferCapacity{.vertices = gpuResources_->vertexCapacity(),
+                              .indices = gpuResources_->indexCapacity(),
+                              .meshlets = gpuResources_->meshletCapacity()};
+}
+
+void Renderer::setTextureStreamingBudget(size_t bytes)
+{
+    textureStreamer_->setBudget(bytes);
+}
+
+void Renderer::releaseResources(const assets::EvictedAssets& evicted)
+{
+    if (!gpuResources_)
+    {
+        return;
+    }
+
+    // The last frame that can reference these has number frameNumber_ - 1. Its fence is waited on before a frame
+    // reuses its slot, which has happened by the time frame frameNumber_ + maxFramesInFlight starts.
+    gpuResources_->retire(evicted, frameNumber_ + maxFramesInFlight);
+}
+
+void Renderer::setFrameArenas(core::FrameArenas* frameArenas)
+{
+    frameArenas_ = frameArenas;
+}
+
+core::Timeline& Renderer::completedFrames()
+{
+    return *completedFrames_;
+}
+
+uint64_t Renderer::frameNumber() const
+{
+    return frameNumber_;
+}
+
 void Renderer::createSwapchain()
 {
     const auto surfaceCapabilities = gpuDevice_.physicalDevice().getSurfaceCapabilitiesKHR(*surface_);
@@ -380,6 +482,8 @@ void Renderer::createCameraBuffers()
 
 void Renderer::recreateSwapchain()
 {
+    auto allocationZone = core::AllocationZone{"Renderer::recreateSwapchain"};
+
     if (windowMinimized_)
     {
         return;
@@ -398,8 +502,8 @@ void Renderer::recreateSwapchain()
 void Renderer::recordCommands(uint32_t imageIndex,
                               const vk::raii::CommandBuffer& commandBuffer,
                               const renderer::Camera& camera,
-                              assets::Skybox* skybox,
-                              const std::vector<DrawCommand>& drawCommands)
+                              assets::Handle<assets::Skybox> skybox,
+                              std::span<const DrawCommand> drawCommands)
 {
     commandBuffer.begin({});
 
@@ -418,11 +522,14 @@ void Renderer::recordCommands(uint32_t imageIndex,
         .extent = swapchainExtent_,
         .commandBuffer = commandBuffer,
         .cameraDescriptorSet = cameraDescriptorSets_.at(currentFrameIndex_),
+        .camera = camera,
         .skybox = skybox,
         .gpuResourceCache = *gpuResources_,
         .drawCommands = drawCommands,
     };
 
+    clusterCullPass_->recordCommands(passInfo);
+
     gpuDevice_.transitionImageLayout(swapchainImages_[imageIndex],
                                      commandBuffer,
                                      vk::ImageLayout::eUndefined,
@@ -458,6 +565,8 @@ void Renderer::createDepthBufferImage()
 
 void Renderer::createRenderPasses()
 {
+    clusterCullPass_ = std::make_unique<ClusterCullPass>(gpuDevice_, maxFramesInFlight);
+
     skyboxPass_ = std::make_unique<SkyboxPass>(gpuDevice_,
                                                surfaceFormat_.format,
                                                cameraDescriptorSetLayout_,
@@ -466,6 +575,7 @@ void Renderer::createRenderPasses()
     geometryPass_ = std::make_unique<GeometryPass>(gpuDevice_,
                                                    surfaceFormat_.format,
                                                    cameraDescriptorSetLayout_,
-                                                   materialDescriptorSetLayout_);
+                                                   materialDescriptorSetLayout_,
+                                                   *clusterCullPass_);
 }
 } // namespace renderer
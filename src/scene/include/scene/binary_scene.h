@@ -0,0 +1,66 @@
+/// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Mark Rapson
+
+#pragma once
+
+#include "scene.h"
+
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <span>
+#include <string_view>
+#include <vector>
+
+namespace core
+{
+class MappedFile;
+}
+
+namespace scene
+{
+// A scene compiled by writeBinaryScene. Entities are numbered from zero in scene order and each component is stored
+// as a pair of columns, the entities that have it and their components, laid out as the world stores them. Render
+// components refer to prefabs by index into prefabs(). The columns are views of the mapped file.
+class BinaryScene
+{
+  public:
+    // Throws std::runtime_error if the file can't be read or isn't a valid compiled scene of this version
+    explicit BinaryScene(const std::filesystem::path& path);
+    ~BinaryScene();
+
+    BinaryScene(const BinaryScene&) = delete;
+    BinaryScene& operator=(const BinaryScene&) = delete;
+
+    const std::vector<Prefab>& prefabs() const;
+    const std::vector<Skybox>& skyboxes() const;
+    const std::vector<Generator>& generators() const;
+    const Camera& camera() const;
+
+    uint32_t entityCount() const;
+    std::string_view entityName(uint32_t entity) const;
+
+    // Entity columns are strictly increasing
+    std::span<const uint32_t> transformEntities() const;
+    std::span<const TransformComponent> transforms() const;
+    std::span<const uint32_t> renderEntities() const;
+    std::span<const uint32_t> renderPrefabs() const;
+
+  private:
+    std::unique_ptr<core::MappedFile> file_;
+    std::vector<Prefab> prefabs_;
+    std::vector<Skybox> skyboxes_;
+    std::vector<Generator> generators_;
+    Camera camera_;
+    uint32_t entityCount_{0};
+    std::string_view strings_;
+    std::span<const uint32_t> nameOffsets_;
+    std::span<const uint32_t> transformEntities_;
+    std::span<const TransformComponent> transforms_;
+    std::span<const uint32_t> renderEntities_;
+    std::span<const uint32_t> renderPrefabs_;
+};
+
+// Throws std::runtime_error if an entity refers to a prefab the scene doesn't define or the file can't be written
+void writeBinaryScene(const Scene& scene, const std::filesystem::path& path);
+} // namespace scene
@@ -3,8 +3,12 @@
 
 #pragma once
 
+#include "string_pool.h"
+
+#include <cstdint>
 #include <optional>
 #include <string>
+#include <string_view>
 #include <vector>
 
 #include <glm/glm.hpp>
@@ -22,23 +26,70 @@ struct TransformComponent
     glm::vec3 position{0.0f};
     glm::vec3 rotation{0.0f};
     glm::vec3 scale{1.0f};
+
+    bool operator==(const TransformComponent&) const = default;
 };
 
 struct RenderComponent
 {
-    std::string prefabId;
+    std::string_view prefabId;
 };
 
+// Entity strings live in the owning Scene's string pool; prefab ids are interned
 struct Entity
 {
-    std::string name;
+    std::string_view name;
     std::optional<TransformComponent> transformComponent;
     std::optional<RenderComponent> renderComponent;
 };
 
+enum class GeneratorType
+{
+    Grid,
+    Volume,
+    Surface
+};
+
+// Places copies of a prefab when the world is built rather than listing each one as an entity. Each instance is a
+// pure function of the seed and its index, so a scene always expands to the same population.
+struct Generator
+{
+    std::string name;
+    GeneratorType type{GeneratorType::Grid};
+    std::string prefab;
+    uint32_t seed{0};
+
+    // Grid: count instances along each axis, spacing apart from the origin
+    glm::uvec3 count{1};
+    glm::vec3 spacing{1.0f};
+
+    // Volume: density instances per unit volume between min and max.
+    // Surface: density instances per unit area of the surface prefab's triangles.
+    glm::vec3 min{0.0f};
+    glm::vec3 max{0.0f};
+    float density{0.0f};
+    std::string surface;
+
+    // Each instance is scaled uniformly between minScale and maxScale, and randomYaw turns it about the up axis
+    float minScale{1.0f};
+    float maxScale{1.0f};
+    bool randomYaw{false};
+
+    // Instanced populations are one entity drawn through the prefab instance path rather than an entity each
+    bool instanced{false};
+
+    // Placement of the whole population
+    TransformComponent transform;
+
+    bool operator==(const Generator&) const = default;
+};
+
 struct Skybox
 {
     std::string name;
+
+    // Either a single cubemap texture (KTX2) or one texture per face
+    std::string path;
     std::string pxPath;
     std::string pyPath;
     std::string pzPath;
@@ -54,8 +105,10 @@ struct Camera
 
 struct Scene
 {
+    StringPool strings;
     std::vector<Prefab> prefabs;
     std::vector<Entity> entities;
+    std::vector<Generator> generators;
     std::vector<Skybox> skyboxes;
     Camera camera;
 };
@@ -0,0 +1,56 @@
+/// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Mark Rapson
+
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace scene
+{
+class BinaryScene;
+
+// What changed between two compilations of a scene. Entities are matched by name, the n-th entity with a name in one
+// scene to the n-th with that name in the other, so an entity keeps its identity when others around it are added,
+// removed or reordered.
+struct SceneDiff
+{
+    static constexpr auto noEntity = std::numeric_limits<uint32_t>::max();
+
+    // For each entity of the new scene, the entity of the old scene it matches, or noEntity if it's new
+    std::vector<uint32_t> previous;
+
+    // Entities of the new scene with no match in the old one, in scene order
+    std::vector<uint32_t> added;
+
+    // Entities of the new scene whose components differ from those of their match, in scene order
+    std::vector<uint32_t> modified;
+
+    // Entities of the old scene with no match in the new one, in scene order
+    std::vector<uint32_t> removed;
+
+    // Generators are matched by name. For each generator of the new scene, the generator of the old scene it matches,
+    // or noEntity if it's new.
+    std::vector<uint32_t> previousGenerators;
+
+    // Generators of the new scene with no match in the old one
+    std::vector<uint32_t> addedGenerators;
+
+    // Generators of the new scene whose parameters differ from those of their match, or whose prefab or surface
+    // moved, so their population has to be rebuilt
+    std::vector<uint32_t> modifiedGenerators;
+
+    // Generators of the old scene with no match in the new one
+    std::vector<uint32_t> removedGenerators;
+
+    // Prefabs of the new scene whose old version with the same name was loaded from a different path
+    std::vector<uint32_t> movedPrefabs;
+
+    bool cameraChanged{false};
+
+    bool empty() const;
+};
+
+SceneDiff diffScenes(const BinaryScene& before, const BinaryScene& after);
+} // namespace scene
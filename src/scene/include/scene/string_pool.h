@@ -0,0 +1,35 @@
+/// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Mark Rapson
+
+#pragma once
+
+#include <cstddef>
+#include <memory_resource>
+#include <string_view>
+#include <unordered_set>
+
+namespace scene
+{
+// Append-only string storage. Views stay valid for the lifetime of the pool. Interned strings are deduplicated, so
+// equal interned strings share the same characters and can be compared or hashed by pointer; stored strings skip the
+// lookup for text that is expected to be unique
+class StringPool
+{
+  public:
+    StringPool() = default;
+
+    StringPool(const StringPool&) = delete;
+    StringPool& operator=(const StringPool&) = delete;
+
+    std::string_view intern(std::string_view text);
+    std::string_view store(std::string_view text);
+
+    std::size_t size() const;
+    std::size_t bytesUsed() const;
+
+  private:
+    std::pmr::monotonic_buffer_resource storage_;
+    std::unordered_set<std::string_view> strings_;
+    std::size_t bytesUsed_{0};
+};
+} // namespace scene
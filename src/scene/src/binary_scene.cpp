@@ -0,0 +1,448 @@
+/// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Mark Rapson
+
+#include "scene/binary_scene.h"
+
+#include <core/mapped_file.h>
+
+#include <array>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+
+namespace scene
+{
+constexpr auto sceneMagic = uint32_t{0x4E43'5356}; // "VSCN"
+
+// Bump whenever the file layout or the layout of a component column changes
+constexpr auto sceneFormatVersion = uint32_t{2};
+
+constexpr auto temporaryExtension = ".tmp";
+
+// Every section starts on this boundary so columns can be read in place from the mapping
+constexpr auto sectionAlignment = uint64_t{16};
+
+static_assert(std::is_trivially_copyable_v<TransformComponent>, "Transform columns are copied as bytes");
+
+// A range of the string section
+struct StringRef
+{
+    uint32_t offset;
+    uint32_t size;
+};
+
+struct PrefabRecord
+{
+    StringRef name;
+    StringRef path;
+};
+
+struct SkyboxRecord
+{
+    StringRef name;
+    StringRef path;
+    std::array<StringRef, 6> faces;
+};
+
+constexpr auto randomYawFlag = uint32_t{1};
+constexpr auto instancedFlag = uint32_t{2};
+
+struct GeneratorRecord
+{
+    StringRef name;
+    StringRef prefab;
+    StringRef surface;
+    uint32_t type;
+    uint32_t seed;
+    uint32_t flags;
+    glm::uvec3 count;
+    glm::vec3 spacing;
+    glm::vec3 min;
+    glm::vec3 max;
+    float density;
+    float minScale;
+    float maxScale;
+    TransformComponent transform;
+};
+
+// Files are written as this header followed by the sections it points to, in the order listed. Entity names are the
+// first entityCount strings in the string section, delimited by entityCount + 1 offsets.
+struct SceneHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t entityCount;
+    uint32_t prefabCount;
+    uint32_t skyboxCount;
+    uint32_t transformCount;
+    uint32_t renderCount;
+    uint32_t generatorCount;
+    StringRef cameraSkybox;
+    uint64_t prefabsOffset;
+    uint64_t skyboxesOffset;
+    uint64_t generatorsOffset;
+    uint64_t nameOffsetsOffset;
+    uint64_t transformEntitiesOffset;
+    uint64_t transformsOffset;
+    uint64_t renderEntitiesOffset;
+    uint64_t renderPrefabsOffset;
+    uint64_t stringsOffset;
+    uint64_t stringsSize;
+};
+
+uint64_t alignUp(uint64_t value, uint64_t alignment)
+{
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+void writeSection(std::ofstream& file, uint64_t& position, uint64_t offset, std::span<const std::byte> bytes)
+{
+    constexpr auto padding = std::array<char, sectionAlignment>{};
+    file.write(padding.data(), static_cast<std::streamsize>(offset - position));
+    file.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+    position = offset + bytes.size();
+}
+
+[[noreturn]] void invalidScene(const std::filesystem::path& path, const std::string& reason)
+{
+    throw std::runtime_error("Invalid compiled scene " + path.string() + ": " + reason);
+}
+
+template <typename Element>
+std::span<const Element>
+section(std::span<const std::byte> bytes, uint64_t offset, uint64_t count, const std::filesystem::path& path)
+{
+    if (offset % alignof(Element) != 0 || offset > bytes.size() || count > (bytes.size() - offset) / sizeof(Element))
+    {
+        invalidScene(path, "section out of bounds");
+    }
+
+    return {reinterpret_cast<const Element*>(bytes.data() + offset), static_cast<size_t>(count)};
+}
+
+void validateEntityColumn(std::span<const uint32_t> entities, uint32_t entityCount, const std::filesystem::path& path)
+{
+    for (size_t i = 0; i < entities.size(); ++i)
+    {
+        if (entities[i] >= entityCount || (i > 0 && entities[i] <= entities[i - 1]))
+        {
+            invalidScene(path, "entity column out of order");
+        }
+    }
+}
+
+BinaryScene::BinaryScene(const std::filesystem::path& path)
+    : file_{std::make_unique<core::MappedFile>(path)}
+{
+    const auto bytes = file_->bytes();
+
+    auto header = SceneHeader{};
+    if (bytes.size() < sizeof(SceneHeader))
+    {
+        invalidScene(path, "truncated header");
+    }
+    std::memcpy(&header, bytes.data(), sizeof(SceneHeader));
+
+    if (header.magic != sceneMagic || header.version != sceneFormatVersion)
+    {
+        invalidScene(path, "unsupported format");
+    }
+
+    const auto characters = section<char>(bytes, header.stringsOffset, header.stringsSize, path);
+    strings_ = std::string_view{characters.data(), characters.size()};
+
+    const auto string = [&](StringRef ref)
+    {
+        if (ref.offset > strings_.size() || ref.size > strings_.size() - ref.offset)
+        {
+            invalidScene(path, "string out of bounds");
+        }
+        return std::string{strings_.substr(ref.offset, ref.size)};
+    };
+
+    for (const auto& record : section<PrefabRecord>(bytes, header.prefabsOffset, header.prefabCount, path))
+    {
+        prefabs_.push_back(Prefab{.name = string(record.name), .path = string(record.path)});
+    }
+
+    for (const auto& record : section<SkyboxRecord>(bytes, header.skyboxesOffset, header.skyboxCount, path))
+    {
+        skyboxes_.push_back(Skybox{.name = string(record.name),
+                                   .path = string(record.path),
+                                   .pxPath = string(record.faces[0]),
+                                   .pyPath = string(record.faces[1]),
+                                   .pzPath = string(record.faces[2]),
+                                   .nxPath = string(record.faces[3]),
+                                   .nyPath = string(record.faces[4]),
+                                   .nzPath = string(record.faces[5])});
+    }
+
+    for (const auto& record : section<GeneratorRecord>(bytes, header.generatorsOffset, header.generatorCount, path))
+    {
+        if (record.type > static_cast<uint32_t>(GeneratorType::Surface))
+        {
+            invalidScene(path, "unknown generator type");
+        }
+
+        generators_.push_back(Generator{.name = string(record.name),
+                                        .type = static_cast<GeneratorType>(record.type),
+                                        .prefab = string(record.prefab),
+                                        .seed = record.seed,
+                                        .count = record.count,
+                                        .spacing = record.spacing,
+                                        .min = record.min,
+                                        .max = record.max,
+                                        .density = record.density,
+                                        .surface = string(record.surface),
+                                        .minScale = record.minScale,
+                                        .maxScale = record.maxScale,
+                                        .randomYaw = (record.flags & randomYawFlag) != 0,
+                                        .instanced = (record.flags & instancedFlag) != 0,
+                                        .transform = record.transform});
+    }
+
+    camera_.skybox = string(header.cameraSkybox);
+
+    entityCount_ = header.entityCount;
+    nameOffsets_ = section<uint32_t>(bytes, header.nameOffsetsOffset, uint64_t{header.entityCount} + 1, path);
+    for (size_t i = 0; i < nameOffsets_.size(); ++i)
+    {
+        if (nameOffsets_[i] > strings_.size() || (i > 0 && nameOffsets_[i] < nameOffsets_[i - 1]))
+        {
+            invalidScene(path, "entity name out of bounds");
+        }
+    }
+
+    transformEntities_ = section<uint32_t>(bytes, header.transformEntitiesOffset, header.transformCount, path);
+    transforms_ = section<TransformComponent>(bytes, header.transformsOffset, header.transformCount, path);
+    renderEntities_ = section<uint32_t>(bytes, header.renderEntitiesOffset, header.renderCount, path);
+    renderPrefabs_ = section<uint32_t>(bytes, header.renderPrefabsOffset, header.renderCount, path);
+
+    validateEntityColumn(transformEntities_, entityCount_, path);
+    validateEntityColumn(renderEntities_, entityCount_, path);
+    for (const auto prefab : renderPrefabs_)
+    {
+        if (prefab >= prefabs_.size())
+        {
+            invalidScene(path, "prefab index out of range");
+        }
+    }
+}
+
+BinaryScene::~BinaryScene() = default;
+
+const std::vector<Prefab>& BinaryScene::prefabs() const
+{
+    return prefabs_;
+}
+
+const std::vector<Skybox>& BinaryScene::skyboxes() const
+{
+    return skyboxes_;
+}
+
+const std::vector<Generator>& BinaryScene::generators() const
+{
+    return generators_;
+}
+
+const Camera& BinaryScene::camera() const
+{
+    return camera_;
+}
+
+uint32_t BinaryScene::entityCount() const
+{
+    return entityCount_;
+}
+
+std::string_view BinaryScene::entityName(uint32_t entity) const
+{
+    return strings_.substr(nameOffsets_[entity], nameOffsets_[entity + 1] - nameOffsets_[entity]);
+}
+
+std::span<const uint32_t> BinaryScene::transformEntities() const
+{
+    return transformEntities_;
+}
+
+std::span<const TransformComponent> BinaryScene::transforms() const
+{
+    return transforms_;
+}
+
+std::span<const uint32_t> BinaryScene::renderEntities() const
+{
+    return renderEntities_;
+}
+
+std::span<const uint32_t> BinaryScene::renderPrefabs() const
+{
+    return renderPrefabs_;
+}
+
+void writeBinaryScene(const Scene& scene, const std::filesystem::path& path)
+{
+    if (scene.entities.size() >= std::numeric_limits<uint32_t>::max())
+    {
+        throw std::runtime_error("Too many entities to compile scene " + path.string());
+    }
+
+    auto strings = std::string{};
+    auto nameOffsets = std::vector<uint32_t>{};
+    nameOffsets.reserve(scene.entities.size() + 1);
+
+    const auto addString = [&strings](std::string_view text)
+    {
+        const auto ref = StringRef{.offset = static_cast<uint32_t>(strings.size()),
+                                   .size = static_cast<uint32_t>(text.size())};
+        strings += text;
+        return ref;
+    };
+
+    for (const auto& entity : scene.entities)
+    {
+        nameOffsets.push_back(addString(entity.name).offset);
+    }
+    nameOffsets.push_back(static_cast<uint32_t>(strings.size()));
+
+    auto prefabs = std::vector<PrefabRecord>{};
+    auto prefabIndices = std::unordered_map<std::string_view, uint32_t>{};
+    for (const auto& prefab : scene.prefabs)
+    {
+        prefabIndices.try_emplace(prefab.name, static_cast<uint32_t>(prefabs.size()));
+        prefabs.push_back(PrefabRecord{.name = addString(prefab.name), .path = addString(prefab.path)});
+    }
+
+    auto skyboxes = std::vector<SkyboxRecord>{};
+    for (const auto& skybox : scene.skyboxes)
+    {
+        skyboxes.push_back(SkyboxRecord{.name = addString(skybox.name),
+                                        .path = addString(skybox.path),
+                                        .faces = {addString(skybox.pxPath),
+                                                  addString(skybox.pyPath),
+                                                  addString(skybox.pzPath),
+                                                  addString(skybox.nxPath),
+                                                  addString(skybox.nyPath),
+                                                  addString(skybox.nzPath)}});
+    }
+
+    auto generators = std::vector<GeneratorRecord>{};
+    for (const auto& generator : scene.generators)
+    {
+        generators.push_back(GeneratorRecord{.name = addString(generator.name),
+                                             .prefab = addString(generator.prefab),
+                                             .surface = addString(generator.surface),
+                                             .type = static_cast<uint32_t>(generator.type),
+                                             .seed = generator.seed,
+                                             .flags = (generator.randomYaw ? randomYawFlag : 0)
+                                                      | (generator.instanced ? instancedFlag : 0),
+                                             .count = generator.count,
+                                             .spacing = generator.spacing,
+                                             .min = generator.min,
+                                             .max = generator.max,
+                                             .density = generator.density,
+                                             .minScale = generator.minScale,
+                                             .maxScale = generator.maxScale,
+                                             .transform = generator.transform});
+    }
+
+    const auto cameraSkybox = addString(scene.camera.skybox);
+
+    if (strings.size() > std::numeric_limits<uint32_t>::max())
+    {
+        throw std::runtime_error("Too much text to compile scene " + path.string());
+    }
+
+    auto transformEntities = std::vector<uint32_t>{};
+    auto transforms = std::vector<TransformComponent>{};
+    auto renderEntities = std::vector<uint32_t>{};
+    auto renderPrefabs = std::vector<uint32_t>{};
+
+    for (uint32_t entity = 0; entity < scene.entities.size(); ++entity)
+    {
+        const auto& sceneEntity = scene.entities[entity];
+
+        if (sceneEntity.transformComponent.has_value())
+        {
+            transformEntities.push_back(entity);
+            transforms.push_back(*sceneEntity.transformComponent);
+        }
+        if (sceneEntity.renderComponent.has_value())
+        {
+            const auto prefab = prefabIndices.find(sceneEntity.renderComponent->prefabId);
+            if (prefab == prefabIndices.end())
+            {
+                throw std::runtime_error("Unknown prefab " + std::string{sceneEntity.renderComponent->prefabId}
+                                         + " on entity " + std::string{sceneEntity.name});
+            }
+
+            renderEntities.push_back(entity);
+            renderPrefabs.push_back(prefab->second);
+        }
+    }
+
+    auto header = SceneHeader{};
+    header.magic = sceneMagic;
+    header.version = sceneFormatVersion;
+    header.entityCount = static_cast<uint32_t>(scene.entities.size());
+    header.prefabCount = static_cast<uint32_t>(prefabs.size());
+    header.skyboxCount = static_cast<uint32_t>(skyboxes.size());
+    header.transformCount = static_cast<uint32_t>(transforms.size());
+    header.renderCount = static_cast<uint32_t>(renderEntities.size());
+    header.generatorCount = static_cast<uint32_t>(generators.size());
+    header.cameraSkybox = cameraSkybox;
+
+    auto end = uint64_t{sizeof(SceneHeader)};
+    const auto place = [&end](uint64_t& offset, uint64_t size)
+    {
+        offset = alignUp(end, sectionAlignment);
+        end = offset + size;
+    };
+
+    const auto sections = std::array{
+        std::pair{&header.prefabsOffset, std::as_bytes(std::span{prefabs})},
+        std::pair{&header.skyboxesOffset, std::as_bytes(std::span{skyboxes})},
+        std::pair{&header.generatorsOffset, std::as_bytes(std::span{generators})},
+        std::pair{&header.nameOffsetsOffset, std::as_bytes(std::span{nameOffsets})},
+        std::pair{&header.transformEntitiesOffset, std::as_bytes(std::span{transformEntities})},
+        std::pair{&header.transformsOffset, std::as_bytes(std::span{transforms})},
+        std::pair{&header.renderEntitiesOffset, std::as_bytes(std::span{renderEntities})},
+        std::pair{&header.renderPrefabsOffset, std::as_bytes(std::span{renderPrefabs})},
+        std::pair{&header.stringsOffset, std::as_bytes(std::span{strings})},
+    };
+    for (const auto& [offset, bytes] : sections)
+    {
+        place(*offset, bytes.size());
+    }
+    header.stringsSize = strings.size();
+
+    // Written beside the destination and renamed over it, so a reader never maps a partly written file
+    auto temporary = path;
+    temporary += temporaryExtension;
+    {
+        auto file = std::ofstream(temporary, std::ios::binary | std::ios::trunc);
+        file.write(reinterpret_cast<const char*>(&header), sizeof(SceneHeader));
+
+        auto position = uint64_t{sizeof(SceneHeader)};
+        for (const auto& [offset, bytes] : sections)
+        {
+            writeSection(file, position, *offset, bytes);
+        }
+
+        if (!file.good())
+        {
+            file.close();
+            auto error = std::error_code{};
+            std::filesystem::remove(temporary, error);
+            throw std::runtime_error("Failed to write compiled scene " + temporary.string());
+        }
+    }
+
+    std::filesystem::rename(temporary, path);
+}
+} // namespace scene
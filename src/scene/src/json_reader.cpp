@@ -0,0 +1,224 @@
+/// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Mark Rapson
+
+#include "json_reader.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cstdint>
+#include <stdexcept>
+
+namespace scene
+{
+bool isNumberCharacter(char c)
+{
+    return (c >= '0' && c <= '9') || c == '-' || c == '+' || c == '.' || c == 'e' || c == 'E';
+}
+
+int hexDigit(char c)
+{
+    if (c >= '0' && c <= '9')
+    {
+        return c - '0';
+    }
+    if (c >= 'a' && c <= 'f')
+    {
+        return c - 'a' + 10;
+    }
+    if (c >= 'A' && c <= 'F')
+    {
+        return c - 'A' + 10;
+    }
+    return -1;
+}
+
+void appendUtf8(std::string& output, uint32_t codePoint)
+{
+    if (codePoint < 0x80)
+    {
+        output += static_cast<char>(codePoint);
+    }
+    else if (codePoint < 0x800)
+    {
+        output += static_cast<char>(0xc0 | (codePoint >> 6));
+        output += static_cast<char>(0x80 | (codePoint & 0x3f));
+    }
+    else if (codePoint < 0x10000)
+    {
+        output += static_cast<char>(0xe0 | (codePoint >> 12));
+        output += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3f));
+        output += static_cast<char>(0x80 | (codePoint & 0x3f));
+    }
+    else
+    {
+        output += static_cast<char>(0xf0 | (codePoint >> 18));
+        output += static_cast<char>(0x80 | ((codePoint >> 12) & 0x3f));
+        output += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3f));
+        output += static_cast<char>(0x80 | (codePoint & 0x3f));
+    }
+}
+
+JsonReader::JsonReader(std::string_view text)
+    : text_{text}
+{
+    scopes_.reserve(16);
+}
+
+void JsonReader::expect(char expected)
+{
+    if (peek() != expected)
+    {
+        fail(std::string{"expected '"} + expected + "'");
+    }
+    ++offset_;
+}
+
+std::string_view JsonReader::readString()
+{
+    const auto start = ++offset_;
+
+    // Most strings have no escapes and can be returned as a view of the source
+    for (auto end = start; end < text_.size(); ++end)
+    {
+        if (text_[end] == '"')
+        {
+            offset_ = end + 1;
+            return text_.substr(start, end - start);
+        }
+        if (text_[end] == '\\')
+        {
+            return readEscapedString(start);
+        }
+    }
+
+    offset_ = text_.size();
+    fail("unterminated string");
+}
+
+std::string_view JsonReader::readEscapedString(std::size_t start)
+{
+    unescaped_.clear();
+    offset_ = start;
+
+    const auto readHex = [this]()
+    {
+        auto value = uint32_t{0};
+        for (auto i = 0; i < 4; ++i)
+        {
+            const auto digit = hexDigit(take());
+            if (digit < 0)
+            {
+                --offset_;
+                fail("invalid unicode escape");
+            }
+            value = (value << 4) | static_cast<uint32_t>(digit);
+        }
+        return value;
+    };
+
+    while (true)
+    {
+        const auto c = take();
+        if (c == '"')
+        {
+            return unescaped_;
+        }
+        if (c != '\\')
+        {
+            unescaped_ += c;
+            continue;
+        }
+
+        switch (take())
+        {
+            case '"':
+                unescaped_ += '"';
+                break;
+            case '\\':
+                unescaped_ += '\\';
+                break;
+            case '/':
+                unescaped_ += '/';
+                break;
+            case 'b':
+                unescaped_ += '\b';
+                break;
+            case 'f':
+                unescaped_ += '\f';
+                break;
+            case 'n':
+                unescaped_ += '\n';
+                break;
+            case 'r':
+                unescaped_ += '\r';
+                break;
+            case 't':
+                unescaped_ += '\t';
+                break;
+            case 'u':
+            {
+                auto codePoint = readHex();
+                if (codePoint >= 0xd800 && codePoint < 0xdc00)
+                {
+                    expect('\\');
+                    expect('u');
+                    const auto low = readHex();
+                    if (low < 0xdc00 || low >= 0xe000)
+                    {
+                        fail("invalid unicode surrogate pair");
+                    }
+                    codePoint = 0x10000 + ((codePoint - 0xd800) << 10) + (low - 0xdc00);
+                }
+                appendUtf8(unescaped_, codePoint);
+                break;
+            }
+            default:
+                --offset_;
+                fail("invalid escape sequence");
+        }
+    }
+}
+
+double JsonReader::readNumber()
+{
+    const auto start = offset_;
+    while (offset_ < text_.size() && isNumberCharacter(text_[offset_]))
+    {
+        ++offset_;
+    }
+
+    auto value = 0.0;
+    const auto* first = text_.data() + start;
+    const auto* last = text_.data() + offset_;
+    const auto [end, error] = std::from_chars(first, last, value);
+
+    if (start == offset_ || error == std::errc::invalid_argument || end != last)
+    {
+        offset_ = start;
+        fail("invalid value");
+    }
+
+    return value;
+}
+
+void JsonReader::readKeyword(std::string_view keyword)
+{
+    if (text_.substr(offset_, keyword.size()) != keyword)
+    {
+        fail("invalid value");
+    }
+
+    offset_ += keyword.size();
+}
+
+void JsonReader::fail(std::string_view reason) const
+{
+    const auto consumed = text_.substr(0, std::min(offset_, text_.size()));
+    const auto line = std::ranges::count(consumed, '\n') + 1;
+    const auto lineStart = consumed.rfind('\n');
+    const auto column = lineStart == std::string_view::npos ? consumed.size() + 1 : consumed.size() - lineStart;
+
+    throw std::runtime_error(std::string{reason} + " at line " + std::to_string(line) + ", column "
+                             + std::to_string(column));
+}
+} // namespace scene
@@ -0,0 +1,207 @@
+/// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Mark Rapson
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace scene
+{
+// Minimal in-place JSON reader. Values are reported to the handler as they are scanned rather than built into a
+// document: strings are views into the source text (or into a reused buffer when they contain escapes) and are only
+// valid for the duration of the callback. The handler provides startObject, key, endObject, startArray, endArray,
+// string, number, boolean and null
+class JsonReader
+{
+  public:
+    explicit JsonReader(std::string_view text);
+
+    template <typename Handler>
+    void read(Handler& handler);
+
+  private:
+    enum class Opened
+    {
+        Nothing,
+        Object,
+        Array
+    };
+
+    template <typename Handler>
+    Opened readValue(Handler& handler);
+
+    template <typename Handler>
+    void readKey(Handler& handler);
+
+    void skipWhitespace();
+    char peek() const;
+    char take();
+    void expect(char expected);
+
+    std::string_view readString();
+    std::string_view readEscapedString(std::size_t start);
+    double readNumber();
+    void readKeyword(std::string_view keyword);
+
+    [[noreturn]] void fail(std::string_view reason) const;
+
+    std::string_view text_;
+    std::size_t offset_{0};
+    std::string unescaped_;
+    std::vector<Opened> scopes_;
+};
+
+inline void JsonReader::skipWhitespace()
+{
+    while (offset_ < text_.size())
+    {
+        const auto c = text_[offset_];
+        if (c != ' ' && c != '\n' && c != '\r' && c != '\t')
+        {
+            return;
+        }
+        ++offset_;
+    }
+}
+
+inline char JsonReader::peek() const
+{
+    if (offset_ >= text_.size())
+    {
+        fail("unexpected end of file");
+    }
+    return text_[offset_];
+}
+
+inline char JsonReader::take()
+{
+    const auto c = peek();
+    ++offset_;
+    return c;
+}
+
+template <typename Handler>
+void JsonReader::read(Handler& handler)
+{
+    while (true)
+    {
+        if (auto opened = readValue(handler); opened != Opened::Nothing)
+        {
+            scopes_.push_back(opened);
+            if (opened == Opened::Object)
+            {
+                readKey(handler);
+            }
+            continue;
+        }
+
+        // A value is complete, close every container that ends after it
+        while (true)
+        {
+            skipWhitespace();
+
+            if (scopes_.empty())
+            {
+                if (offset_ != text_.size())
+                {
+                    fail("unexpected trailing characters");
+                }
+                return;
+            }
+
+            const auto c = take();
+            if (c == ',')
+            {
+                if (scopes_.back() == Opened::Object)
+                {
+                    readKey(handler);
+                }
+                break;
+            }
+            if (c == '}' && scopes_.back() == Opened::Object)
+            {
+                scopes_.pop_back();
+                handler.endObject();
+            }
+            else if (c == ']' && scopes_.back() == Opened::Array)
+            {
+                scopes_.pop_back();
+                handler.endArray();
+            }
+            else
+            {
+                --offset_;
+                fail("expected ',' or a closing bracket");
+            }
+        }
+    }
+}
+
+template <typename Handler>
+JsonReader::Opened JsonReader::readValue(Handler& handler)
+{
+    skipWhitespace();
+
+    switch (peek())
+    {
+        case '{':
+            ++offset_;
+            handler.startObject();
+            skipWhitespace();
+            if (peek() == '}')
+            {
+                ++offset_;
+                handler.endObject();
+                return Opened::Nothing;
+            }
+            return Opened::Object;
+        case '[':
+            ++offset_;
+            handler.startArray();
+            skipWhitespace();
+            if (peek() == ']')
+            {
+                ++offset_;
+                handler.endArray();
+                return Opened::Nothing;
+            }
+            return Opened::Array;
+        case '"':
+            handler.string(readString());
+            return Opened::Nothing;
+        case 't':
+            readKeyword("true");
+            handler.boolean(true);
+            return Opened::Nothing;
+        case 'f':
+            readKeyword("false");
+            handler.boolean(false);
+            return Opened::Nothing;
+        case 'n':
+            readKeyword("null");
+            handler.null();
+            return Opened::Nothing;
+        default:
+            handler.number(readNumber());
+            return Opened::Nothing;
+    }
+}
+
+template <typename Handler>
+void JsonReader::readKey(Handler& handler)
+{
+    skipWhitespace();
+    if (peek() != '"')
+    {
+        fail("expected an object key");
+    }
+
+    handler.key(readString());
+
+    skipWhitespace();
+    expect(':');
+}
+} // namespace scene
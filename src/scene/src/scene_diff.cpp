@@ -0,0 +1,204 @@
+/// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Mark Rapson
+
+#include "scene/scene_diff.h"
+#include "scene/binary_scene.h"
+
+#include <algorithm>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+
+namespace scene
+{
+// Position of each entity's component in a column, or noEntity for entities without one
+std::vector<uint32_t> componentIndices(std::span<const uint32_t> entities, uint32_t entityCount)
+{
+    auto indices = std::vector<uint32_t>(entityCount, SceneDiff::noEntity);
+    for (size_t i = 0; i < entities.size(); ++i)
+    {
+        indices[entities[i]] = static_cast<uint32_t>(i);
+    }
+
+    return indices;
+}
+
+// Generators are few, so they're matched by name directly
+void diffGenerators(const BinaryScene& before, const BinaryScene& after, SceneDiff& diff)
+{
+    const auto moved = [&](const std::string& prefab)
+    {
+        return std::ranges::any_of(diff.movedPrefabs,
+                                   [&](uint32_t movedPrefab) { return after.prefabs()[movedPrefab].name == prefab; });
+    };
+
+    const auto& beforeGenerators = before.generators();
+    const auto& afterGenerators = after.generators();
+    diff.previousGenerators.resize(afterGenerators.size(), SceneDiff::noEntity);
+    auto matched = std::vector<bool>(beforeGenerators.size());
+
+    for (auto generator = uint32_t{0}; generator < afterGenerators.size(); ++generator)
+    {
+        const auto& afterGenerator = afterGenerators[generator];
+        auto previous = uint32_t{0};
+        while (previous < beforeGenerators.size()
+               && (matched[previous] || beforeGenerators[previous].name != afterGenerator.name))
+        {
+            ++previous;
+        }
+
+        if (previous == beforeGenerators.size())
+        {
+            diff.addedGenerators.push_back(generator);
+            continue;
+        }
+
+        diff.previousGenerators[generator] = previous;
+        matched[previous] = true;
+
+        if (beforeGenerators[previous] != afterGenerator || moved(afterGenerator.prefab)
+            || (afterGenerator.type == GeneratorType::Surface && moved(afterGenerator.surface)))
+        {
+            diff.modifiedGenerators.push_back(generator);
+        }
+    }
+
+    for (auto generator = uint32_t{0}; generator < beforeGenerators.size(); ++generator)
+    {
+        if (!matched[generator])
+        {
+            diff.removedGenerators.push_back(generator);
+        }
+    }
+}
+
+bool SceneDiff::empty() const
+{
+    return added.empty() && modified.empty() && removed.empty() && addedGenerators.empty()
+           && modifiedGenerators.empty() && removedGenerators.empty() && movedPrefabs.empty() && !cameraChanged;
+}
+
+SceneDiff diffScenes(const BinaryScene& before, const BinaryScene& after)
+{
+    const auto beforeCount = before.entityCount();
+    const auto afterCount = after.entityCount();
+
+    // Edits usually leave most of the file in place, so entities before and after the edited range are matched by
+    // position and only those in between are looked up by name
+    const auto commonCount = std::min(beforeCount, afterCount);
+    auto prefix = uint32_t{0};
+    while (prefix < commonCount && before.entityName(prefix) == after.entityName(prefix))
+    {
+        ++prefix;
+    }
+
+    auto suffix = uint32_t{0};
+    while (suffix < commonCount - prefix
+           && before.entityName(beforeCount - 1 - suffix) == after.entityName(afterCount - 1 - suffix))
+    {
+        ++suffix;
+    }
+
+    // Old entities by name. Entities sharing a name are chained in scene order and taken from the front as they're
+    // matched.
+    auto unmatched = std::unordered_map<std::string_view, uint32_t>{};
+    unmatched.reserve(beforeCount - prefix - suffix);
+    auto nextWithName = std::vector<uint32_t>(beforeCount, SceneDiff::noEntity);
+    for (auto entity = beforeCount - suffix; entity-- > prefix;)
+    {
+        auto [itr, inserted] = unmatched.try_emplace(before.entityName(entity), entity);
+        if (!inserted)
+        {
+            nextWithName[entity] = std::exchange(itr->second, entity);
+        }
+    }
+
+    auto diff = SceneDiff{};
+
+    // Prefab indices differ between compilations, so render components are compared by the new scene's index. A prefab
+    // keeps its identity when its path changes, and is loaded again from the new one.
+    auto prefabs = std::vector<uint32_t>(before.prefabs().size(), SceneDiff::noEntity);
+    for (size_t i = 0; i < prefabs.size(); ++i)
+    {
+        const auto itr = std::ranges::find(after.prefabs(), before.prefabs()[i].name, &Prefab::name);
+        if (itr != after.prefabs().end())
+        {
+            prefabs[i] = static_cast<uint32_t>(itr - after.prefabs().begin());
+            if (itr->path != before.prefabs()[i].path)
+            {
+                diff.movedPrefabs.push_back(prefabs[i]);
+            }
+        }
+    }
+    std::ranges::sort(diff.movedPrefabs);
+
+    const auto beforeTransforms = componentIndices(before.transformEntities(), beforeCount);
+    const auto beforeRenders = componentIndices(before.renderEntities(), beforeCount);
+    const auto afterTransforms = componentIndices(after.transformEntities(), afterCount);
+    const auto afterRenders = componentIndices(after.renderEntities(), afterCount);
+
+    diff.previous.resize(afterCount, SceneDiff::noEntity);
+    auto matched = std::vector<bool>(beforeCount);
+
+    for (auto entity = uint32_t{0}; entity < afterCount; ++entity)
+    {
+        auto previous = SceneDiff::noEntity;
+        if (entity < prefix)
+        {
+            previous = entity;
+        }
+        else if (entity >= afterCount - suffix)
+        {
+            previous = entity - afterCount + beforeCount;
+        }
+        else
+        {
+            const auto itr = unmatched.find(after.entityName(entity));
+            if (itr == unmatched.end() || itr->second == SceneDiff::noEntity)
+            {
+                diff.added.push_back(entity);
+                continue;
+            }
+
+            previous = std::exchange(itr->second, nextWithName[itr->second]);
+        }
+
+        diff.previous[entity] = previous;
+        matched[previous] = true;
+
+        const auto beforeTransform = beforeTransforms[previous];
+        const auto afterTransform = afterTransforms[entity];
+        const auto transformChanged =
+            (beforeTransform == SceneDiff::noEntity) != (afterTransform == SceneDiff::noEntity)
+            || (afterTransform != SceneDiff::noEntity
+                && before.transforms()[beforeTransform] != after.transforms()[afterTransform]);
+
+        const auto beforeRender = beforeRenders[previous];
+        const auto afterRender = afterRenders[entity];
+        const auto renderChanged =
+            (beforeRender == SceneDiff::noEntity) != (afterRender == SceneDiff::noEntity)
+            || (afterRender != SceneDiff::noEntity
+                && prefabs[before.renderPrefabs()[beforeRender]] != after.renderPrefabs()[afterRender]);
+
+        if (transformChanged || renderChanged)
+        {
+            diff.modified.push_back(entity);
+        }
+    }
+
+    for (auto entity = uint32_t{0}; entity < beforeCount; ++entity)
+    {
+        if (!matched[entity])
+        {
+            diff.removed.push_back(entity);
+        }
+    }
+
+    diffGenerators(before, after, diff);
+    diff.cameraChanged = before.camera().skybox != after.camera().skybox;
+
+    return diff;
+}
+} // namespace scene
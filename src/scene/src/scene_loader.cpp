@@ -3,168 +3,575 @@
 
 #include "scene/scene_loader.h"
 
+#include "json_reader.h"
 #include "scene/scene.h"
 
 #include <core/file_system.h>
+#include <core/mapped_file.h>
 
 #include <glm/glm.hpp>
-#include <nlohmann/json.hpp>
 
-#include <fstream>
-#include <iostream>
+#include <array>
+#include <stdexcept>
+#include <string>
+#include <string_view>
 
 namespace scene
 {
-constexpr auto positionKey = "position";
-constexpr auto rotationKey = "rotation";
-constexpr auto scaleKey = "scale";
-constexpr auto transformComponentKey = "transformComponent";
-constexpr auto renderComponentKey = "renderComponent";
-constexpr auto prefabKey = "prefab";
-constexpr auto nameKey = "name";
-constexpr auto pathKey = "path";
-constexpr auto cameraKey = "camera";
-constexpr auto skyboxKey = "skybox";
-constexpr auto texturesKey = "textures";
-constexpr auto prefabsKey = "prefabs";
-constexpr auto entitiesKey = "entities";
-constexpr auto skyboxesKey = "skyboxes";
-
-glm::vec3
-loadVec3(const nlohmann::json& json, const std::string& param1, const std::string& param2, const std::string& param3)
+enum class Field
 {
-    return glm::vec3{json[param1], json[param2], json[param3]};
-}
-
-glm::vec3 loadXYZ(const nlohmann::json& json)
+    Unknown,
+    Name,
+    Path,
+    Position,
+    Rotation,
+    Scale,
+    X,
+    Y,
+    Z,
+    TransformComponent,
+    RenderComponent,
+    Prefab,
+    Camera,
+    Skybox,
+    Textures,
+    Px,
+    Py,
+    Pz,
+    Nx,
+    Ny,
+    Nz,
+    Type,
+    Seed,
+    Count,
+    Spacing,
+    Min,
+    Max,
+    Density,
+    Surface,
+    MinScale,
+    MaxScale,
+    RandomYaw,
+    Instanced,
+    Prefabs,
+    Entities,
+    Generators,
+    Skyboxes
+};
+
+constexpr auto fieldKeys = std::array<std::pair<std::string_view, Field>, 36>{{
+    {"name", Field::Name},
+    {"path", Field::Path},
+    {"position", Field::Position},
+    {"rotation", Field::Rotation},
+    {"scale", Field::Scale},
+    {"x", Field::X},
+    {"y", Field::Y},
+    {"z", Field::Z},
+    {"transformComponent", Field::TransformComponent},
+    {"renderComponent", Field::RenderComponent},
+    {"prefab", Field::Prefab},
+    {"camera", Field::Camera},
+    {"skybox", Field::Skybox},
+    {"textures", Field::Textures},
+    {"px", Field::Px},
+    {"py", Field::Py},
+    {"pz", Field::Pz},
+    {"nx", Field::Nx},
+    {"ny", Field::Ny},
+    {"nz", Field::Nz},
+    {"type", Field::Type},
+    {"seed", Field::Seed},
+    {"count", Field::Count},
+    {"spacing", Field::Spacing},
+    {"min", Field::Min},
+    {"max", Field::Max},
+    {"density", Field::Density},
+    {"surface", Field::Surface},
+    {"minScale", Field::MinScale},
+    {"maxScale", Field::MaxScale},
+    {"randomYaw", Field::RandomYaw},
+    {"instanced", Field::Instanced},
+    {"prefabs", Field::Prefabs},
+    {"entities", Field::Entities},
+    {"generators", Field::Generators},
+    {"skyboxes", Field::Skyboxes},
+}};
+
+constexpr auto generatorTypes = std::array<std::pair<std::string_view, GeneratorType>, 3>{{
+    {"grid", GeneratorType::Grid},
+    {"volume", GeneratorType::Volume},
+    {"surface", GeneratorType::Surface},
+}};
+
+// Every entity carries a name, so counting the key gives an upper bound on the entity count for the price of a memchr
+// pass over the file, which also faults the pages in ahead of the parse
+std::size_t countNameKeys(std::string_view text)
 {
-    return loadVec3(json, "x", "y", "z");
-}
+    constexpr auto nameKey = std::string_view{"\"name\""};
 
-glm::vec3 loadRGB(const nlohmann::json& json)
-{
-    return loadVec3(json, "r", "g", "b");
+    auto count = std::size_t{0};
+    for (auto offset = text.find(nameKey); offset != std::string_view::npos;
+         offset = text.find(nameKey, offset + nameKey.size()))
+    {
+        ++count;
+    }
+
+    return count;
 }
 
-TransformComponent loadTransformComponent(const nlohmann::json& json)
+// Builds the scene straight from reader events instead of materialising a JSON document first. Only the current
+// nesting is tracked; unknown keys and their values are skipped. Entity strings go into the scene's string pool as
+// they arrive, so the only transient memory is the context stack. Names are usually unique so they are stored
+// without a lookup, while prefab ids repeat across entities and are interned.
+class SceneBuilder
 {
-    auto transform = TransformComponent{};
-
-    if (auto itr = json.find(positionKey); itr != json.end())
+  public:
+    explicit SceneBuilder(Scene& scene)
+        : scene_{scene}
     {
-        transform.position = loadXYZ(*itr);
+        contexts_.reserve(16);
     }
-    if (auto itr = json.find(rotationKey); itr != json.end())
+
+    void null()
     {
-        transform.rotation = loadXYZ(*itr);
     }
-    if (auto itr = json.find(scaleKey); itr != json.end())
+
+    void boolean(bool value)
     {
-        transform.scale = loadXYZ(*itr);
+        if (context() != Context::Generator)
+        {
+            return;
+        }
+
+        if (field_ == Field::RandomYaw)
+        {
+            scene_.generators.back().randomYaw = value;
+        }
+        else if (field_ == Field::Instanced)
+        {
+            scene_.generators.back().instanced = value;
+        }
     }
 
-    return transform;
-}
-
-std::optional<RenderComponent> loadRenderComponent(const nlohmann::json& json)
-{
-    if (!json.contains(prefabKey))
+    void number(double value)
     {
-        return std::nullopt;
+        if (context() == Context::Generator)
+        {
+            auto& generator = scene_.generators.back();
+            switch (field_)
+            {
+                case Field::Seed:
+                    generator.seed = static_cast<uint32_t>(value);
+                    break;
+                case Field::Density:
+                    generator.density = static_cast<float>(value);
+                    break;
+                case Field::MinScale:
+                    generator.minScale = static_cast<float>(value);
+                    break;
+                case Field::MaxScale:
+                    generator.maxScale = static_cast<float>(value);
+                    break;
+                default:
+                    break;
+            }
+            return;
+        }
+
+        if (context() != Context::Vector)
+        {
+            return;
+        }
+
+        switch (field_)
+        {
+            case Field::X:
+                vector_->x = static_cast<float>(value);
+                break;
+            case Field::Y:
+                vector_->y = static_cast<float>(value);
+                break;
+            case Field::Z:
+                vector_->z = static_cast<float>(value);
+                break;
+            default:
+                break;
+        }
     }
 
-    return RenderComponent{.prefabId = json[prefabKey]};
-}
-
-void loadEntity(const nlohmann::json& json, Scene& scene)
-{
-    if (!json.contains(nameKey))
+    void string(std::string_view value)
     {
-        return;
+        switch (context())
+        {
+            case Context::Prefab:
+                if (field_ == Field::Name)
+                {
+                    scene_.prefabs.back().name = value;
+                    hasName_ = true;
+                }
+                else if (field_ == Field::Path)
+                {
+                    scene_.prefabs.back().path = value;
+                    hasPath_ = true;
+                }
+                break;
+            case Context::Skybox:
+                if (field_ == Field::Name)
+                {
+                    scene_.skyboxes.back().name = value;
+                    hasName_ = true;
+                }
+                else if (field_ == Field::Path)
+                {
+                    scene_.skyboxes.back().path = value;
+                    hasPath_ = true;
+                }
+                break;
+            case Context::SkyboxTextures:
+                if (auto* facePath = skyboxFacePath(scene_.skyboxes.back()))
+                {
+                    *facePath = value;
+                }
+                break;
+            case Context::Entity:
+                if (field_ == Field::Name)
+                {
+                    scene_.entities.back().name = scene_.strings.store(value);
+                    hasName_ = true;
+                }
+                break;
+            case Context::RenderComponent:
+                if (field_ == Field::Prefab)
+                {
+                    scene_.entities.back().renderComponent = RenderComponent{.prefabId = scene_.strings.intern(value)};
+                }
+                break;
+            case Context::Generator:
+                generatorString(scene_.generators.back(), value);
+                break;
+            case Context::Camera:
+                if (field_ == Field::Skybox)
+                {
+                    scene_.camera.skybox = value;
+                }
+                break;
+            default:
+                break;
+        }
     }
 
-    auto entity = Entity{};
-    entity.name = json[nameKey];
-
-    if (auto itr = json.find(transformComponentKey); itr != json.end())
+    void startObject()
     {
-        entity.transformComponent = loadTransformComponent(*itr);
+        if (contexts_.empty())
+        {
+            contexts_.push_back(Context::Root);
+            return;
+        }
+
+        auto next = Context::Ignored;
+
+        switch (context())
+        {
+            case Context::Root:
+                if (field_ == Field::Camera)
+                {
+                    next = Context::Camera;
+                }
+                break;
+            case Context::Prefabs:
+                scene_.prefabs.emplace_back();
+                next = Context::Prefab;
+                break;
+            case Context::Skyboxes:
+                scene_.skyboxes.emplace_back();
+                next = Context::Skybox;
+                break;
+            case Context::Skybox:
+                if (field_ == Field::Textures)
+                {
+                    hasTextures_ = true;
+                    next = Context::SkyboxTextures;
+                }
+                break;
+            case Context::Entities:
+                scene_.entities.emplace_back();
+                next = Context::Entity;
+                break;
+            case Context::Entity:
+                if (field_ == Field::TransformComponent)
+                {
+                    transform_ = &scene_.entities.back().transformComponent.emplace();
+                    next = Context::TransformComponent;
+                }
+                else if (field_ == Field::RenderComponent)
+                {
+                    next = Context::RenderComponent;
+                }
+                break;
+            case Context::TransformComponent:
+                if (auto* vector = transformVector(*transform_))
+                {
+                    vector_ = vector;
+                    next = Context::Vector;
+                }
+                break;
+            case Context::Generators:
+                scene_.generators.emplace_back();
+                next = Context::Generator;
+                break;
+            case Context::Generator:
+                next = generatorObject(scene_.generators.back());
+                break;
+            default:
+                break;
+        }
+
+        if (next == Context::Prefab || next == Context::Skybox || next == Context::Entity
+            || next == Context::Generator)
+        {
+            hasName_ = false;
+            hasPath_ = false;
+            hasTextures_ = false;
+            hasPrefab_ = false;
+            hasSurface_ = false;
+            count_ = glm::vec3{1.0f};
+        }
+
+        contexts_.push_back(next);
     }
-    if (auto itr = json.find(renderComponentKey); itr != json.end())
+
+    void key(std::string_view value)
     {
-        entity.renderComponent = loadRenderComponent(*itr);
+        field_ = Field::Unknown;
+        for (const auto& [key, field] : fieldKeys)
+        {
+            if (key == value)
+            {
+                field_ = field;
+                break;
+            }
+        }
     }
 
-    scene.entities.push_back(std::move(entity));
-}
+    void endObject()
+    {
+        switch (context())
+        {
+            case Context::Prefab:
+                if (!hasName_ || !hasPath_)
+                {
+                    scene_.prefabs.pop_back();
+                }
+                break;
+            case Context::Skybox:
+                if (!hasName_ || (!hasPath_ && !hasTextures_))
+                {
+                    scene_.skyboxes.pop_back();
+                }
+                break;
+            case Context::Entity:
+                if (!hasName_)
+                {
+                    scene_.entities.pop_back();
+                }
+                break;
+            case Context::Generator:
+            {
+                auto& generator = scene_.generators.back();
+                generator.count = glm::uvec3{glm::max(count_, glm::vec3{0.0f})};
+                if (!hasName_ || !hasPrefab_ || (generator.type == GeneratorType::Surface && !hasSurface_))
+                {
+                    scene_.generators.pop_back();
+                }
+                break;
+            }
+            default:
+                break;
+        }
+
+        contexts_.pop_back();
+    }
 
-void loadPrefab(const nlohmann::json& json, Scene& scene)
-{
-    if (!json.contains(nameKey) || !json.contains(pathKey))
+    void startArray()
     {
-        return;
+        auto next = Context::Ignored;
+
+        if (context() == Context::Root)
+        {
+            switch (field_)
+            {
+                case Field::Prefabs:
+                    next = Context::Prefabs;
+                    break;
+                case Field::Skyboxes:
+                    next = Context::Skyboxes;
+                    break;
+                case Field::Entities:
+                    next = Context::Entities;
+                    break;
+                case Field::Generators:
+                    next = Context::Generators;
+                    break;
+                default:
+                    break;
+            }
+        }
+
+        contexts_.push_back(next);
     }
 
-    auto prefab = Prefab{};
-    prefab.name = json[nameKey];
-    prefab.path = json[pathKey];
+    void endArray()
+    {
+        contexts_.pop_back();
+    }
 
-    scene.prefabs.push_back(std::move(prefab));
-}
+  private:
+    enum class Context
+    {
+        Root,
+        Prefabs,
+        Prefab,
+        Skyboxes,
+        Skybox,
+        SkyboxTextures,
+        Entities,
+        Entity,
+        Generators,
+        Generator,
+        TransformComponent,
+        Vector,
+        RenderComponent,
+        Camera,
+        Ignored
+    };
+
+    Context context() const
+    {
+        return contexts_.empty() ? Context::Ignored : contexts_.back();
+    }
 
-void loadSkybox(const nlohmann::json& json, Scene& scene)
-{
-    if (!json.contains(nameKey) || !json.contains(texturesKey))
+    void generatorString(Generator& generator, std::string_view value)
     {
-        return;
+        switch (field_)
+        {
+            case Field::Name:
+                generator.name = value;
+                hasName_ = true;
+                break;
+            case Field::Prefab:
+                generator.prefab = value;
+                hasPrefab_ = true;
+                break;
+            case Field::Surface:
+                generator.surface = value;
+                hasSurface_ = true;
+                break;
+            case Field::Type:
+                for (const auto& [name, type] : generatorTypes)
+                {
+                    if (name == value)
+                    {
+                        generator.type = type;
+                        return;
+                    }
+                }
+                throw std::runtime_error("Unknown generator type " + std::string{value});
+            default:
+                break;
+        }
     }
 
-    auto skybox = Skybox{};
-    skybox.name = json[nameKey];
-    skybox.pxPath = json[texturesKey]["px"];
-    skybox.pyPath = json[texturesKey]["py"];
-    skybox.pzPath = json[texturesKey]["pz"];
-    skybox.nxPath = json[texturesKey]["nx"];
-    skybox.nyPath = json[texturesKey]["ny"];
-    skybox.nzPath = json[texturesKey]["nz"];
+    Context generatorObject(Generator& generator)
+    {
+        switch (field_)
+        {
+            case Field::TransformComponent:
+                transform_ = &generator.transform;
+                return Context::TransformComponent;
+            case Field::Count:
+                vector_ = &count_;
+                return Context::Vector;
+            case Field::Spacing:
+                vector_ = &generator.spacing;
+                return Context::Vector;
+            case Field::Min:
+                vector_ = &generator.min;
+                return Context::Vector;
+            case Field::Max:
+                vector_ = &generator.max;
+                return Context::Vector;
+            default:
+                return Context::Ignored;
+        }
+    }
 
-    scene.skyboxes.push_back(std::move(skybox));
-}
+    glm::vec3* transformVector(TransformComponent& transform) const
+    {
+        switch (field_)
+        {
+            case Field::Position:
+                return &transform.position;
+            case Field::Rotation:
+                return &transform.rotation;
+            case Field::Scale:
+                return &transform.scale;
+            default:
+                return nullptr;
+        }
+    }
 
-void loadCamera(const nlohmann::json& json, Scene& scene)
-{
-    if (json.contains(skyboxKey))
+    std::string* skyboxFacePath(Skybox& skybox) const
     {
-        scene.camera.skybox = json[skyboxKey];
+        switch (field_)
+        {
+            case Field::Px:
+                return &skybox.pxPath;
+            case Field::Py:
+                return &skybox.pyPath;
+            case Field::Pz:
+                return &skybox.pzPath;
+            case Field::Nx:
+                return &skybox.nxPath;
+            case Field::Ny:
+                return &skybox.nyPath;
+            case Field::Nz:
+                return &skybox.nzPath;
+            default:
+                return nullptr;
+        }
     }
-}
+
+    Scene& scene_;
+    std::vector<Context> contexts_;
+    Field field_{Field::Unknown};
+    TransformComponent* transform_{nullptr};
+    glm::vec3* vector_{nullptr};
+    // Grid counts are read as a vector of floats and converted when the generator ends
+    glm::vec3 count_{1.0f};
+    bool hasName_{false};
+    bool hasPath_{false};
+    bool hasTextures_{false};
+    bool hasPrefab_{false};
+    bool hasSurface_{false};
+};
 
 std::unique_ptr<Scene> loadScene(const std::filesystem::path& path)
 {
-    auto filestream = std::ifstream{path};
-
-    auto sceneJson = nlohmann::json::parse(filestream);
+    const auto file = core::MappedFile{path};
+    const auto text = std::string_view{reinterpret_cast<const char*>(file.bytes().data()), file.size()};
 
     auto scene = std::make_unique<Scene>();
+    scene->entities.reserve(countNameKeys(text));
 
-    for (const auto& prefabJson : sceneJson[prefabsKey])
+    auto builder = SceneBuilder{*scene};
+    try
     {
-        loadPrefab(prefabJson, *scene);
+        JsonReader{text}.read(builder);
     }
-
-    for (const auto& skyboxJson : sceneJson[skyboxesKey])
-    {
-        loadSkybox(skyboxJson, *scene);
-    }
-
-    for (const auto& entityJson : sceneJson[entitiesKey])
-    {
-        loadEntity(entityJson, *scene);
-    }
-
-    if(sceneJson.contains(cameraKey))
+    catch (const std::runtime_error& error)
     {
-        loadCamera(sceneJson[cameraKey], *scene);
+        throw std::runtime_error("Failed to parse scene " + path.string() + ": " + error.what());
     }
 
     return scene;
@@ -0,0 +1,39 @@
+/// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Mark Rapson
+
+#include "scene/string_pool.h"
+
+#include <cstring>
+
+namespace scene
+{
+std::string_view StringPool::intern(std::string_view text)
+{
+    if (auto itr = strings_.find(text); itr != strings_.end())
+    {
+        return *itr;
+    }
+
+    return *strings_.insert(store(text)).first;
+}
+
+std::string_view StringPool::store(std::string_view text)
+{
+    auto* characters = static_cast<char*>(storage_.allocate(text.size() + 1, alignof(char)));
+    std::memcpy(characters, text.data(), text.size());
+    characters[text.size()] = '\0';
+    bytesUsed_ += text.size() + 1;
+
+    return {characters, text.size()};
+}
+
+std::size_t StringPool::size() const
+{
+    return strings_.size();
+}
+
+std::size_t StringPool::bytesUsed() const
+{
+    return bytesUsed_;
+}
+} // namespace scene
@@ -0,0 +1,51 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Mark Rapson
+
+// Compiles a JSON scene into the binary format the world instantiates with bulk copies
+
+#include <scene/binary_scene.h>
+#include <scene/scene.h>
+#include <scene/scene_loader.h>
+
+#include <spdlog/spdlog.h>
+
+#include <chrono>
+#include <exception>
+#include <filesystem>
+
+constexpr auto binarySceneExtension = ".vscene";
+
+int main(int argc, char** argv)
+{
+    if (argc < 2 || argc > 3)
+    {
+        spdlog::error("Usage: {} <scene.json> [output{}]", argv[0], binarySceneExtension);
+        return 1;
+    }
+
+    const auto input = std::filesystem::path{argv[1]};
+    const auto output = argc == 3 ? std::filesystem::path{argv[2]}
+                                  : std::filesystem::path{input}.replace_extension(binarySceneExtension);
+
+    try
+    {
+        const auto start = std::chrono::steady_clock::now();
+
+        const auto scene = scene::loadScene(input);
+        scene::writeBinaryScene(*scene, output);
+
+        const auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start);
+        spdlog::info("Compiled {} entities from {} into {} in {:.1f} ms",
+                     scene->entities.size(),
+                     input.string(),
+                     output.string(),
+                     elapsed.count());
+    }
+    catch (const std::exception& ex)
+    {
+        spdlog::error("{}", ex.what());
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,186 @@
+/// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Mark Rapson
+
+#pragma once
+
+#include "entity.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+namespace world
+{
+// Components of one type packed into a dense column, with the owning entity of each in a parallel column. A sparse
+// index from entity to position makes lookups constant time; removal swaps the last component into the gap, so
+// iteration order is not stable.
+template <typename Component>
+class ComponentStorage
+{
+  public:
+    bool contains(Entity entity) const
+    {
+        return entity < sparse_.size() && sparse_[entity] != absent;
+    }
+
+    Component* find(Entity entity)
+    {
+        return contains(entity) ? &components_[sparse_[entity]] : nullptr;
+    }
+
+    const Component* find(Entity entity) const
+    {
+        return contains(entity) ? &components_[sparse_[entity]] : nullptr;
+    }
+
+    // Throws std::logic_error if the entity already has a component of this type
+    Component& insert(Entity entity, Component component)
+    {
+        if (contains(entity))
+        {
+            throw std::logic_error("Component already exists on this entity");
+        }
+
+        growSparse(entity);
+        sparse_[entity] = static_cast<uint32_t>(components_.size());
+        entities_.push_back(entity);
+        return components_.emplace_back(std::move(component));
+    }
+
+    // Appends default components for a batch of distinct entities, each offset by entityOffset, and returns them
+    // for the caller to fill in bulk. Throws std::logic_error, leaving the storage unchanged, if any entity already
+    // has a component of this type.
+    std::span<Component> extend(std::span<const Entity> entities, Entity entityOffset = 0)
+    {
+        if (entities.empty())
+        {
+            return {};
+        }
+
+        growSparse(std::ranges::max(entities) + entityOffset);
+        for (const auto entity : entities)
+        {
+            if (sparse_[entity + entityOffset] != absent)
+            {
+                throw std::logic_error("Component already exists on this entity");
+            }
+        }
+
+        const auto first = components_.size();
+        entities_.reserve(first + entities.size());
+        components_.resize(first + entities.size());
+
+        auto index = static_cast<uint32_t>(first);
+        for (const auto entity : entities)
+        {
+            sparse_[entity + entityOffset] = index++;
+            entities_.push_back(entity + entityOffset);
+        }
+
+        return std::span{components_}.subspan(first);
+    }
+
+    // Appends default components for the consecutive entities [firstEntity, firstEntity + count), which must not
+    // have one yet, and returns them for the caller to fill in bulk
+    std::span<Component> extend(Entity firstEntity, uint32_t count)
+    {
+        if (count == 0)
+        {
+            return {};
+        }
+
+        growSparse(firstEntity + count - 1);
+        for (auto entity = firstEntity; entity < firstEntity + count; ++entity)
+        {
+            if (sparse_[entity] != absent)
+            {
+                throw std::logic_error("Component already exists on this entity");
+            }
+        }
+
+        const auto first = components_.size();
+        entities_.reserve(first + count);
+        components_.resize(first + count);
+
+        auto index = static_cast<uint32_t>(first);
+        for (auto entity = firstEntity; entity < firstEntity + count; ++entity)
+        {
+            sparse_[entity] = index++;
+            entities_.push_back(entity);
+        }
+
+        return std::span{components_}.subspan(first);
+    }
+
+    bool erase(Entity entity)
+    {
+        if (!contains(entity))
+        {
+            return false;
+        }
+
+        const auto index = sparse_[entity];
+        const auto last = entities_.back();
+
+        components_[index] = std::move(components_.back());
+        entities_[index] = last;
+        sparse_[last] = index;
+
+        components_.pop_back();
+        entities_.pop_back();
+        sparse_[entity] = absent;
+        return true;
+    }
+
+    void reserve(size_t count)
+    {
+        entities_.reserve(count);
+        components_.reserve(count);
+    }
+
+    size_t size() const
+    {
+        return components_.size();
+    }
+
+    bool empty() const
+    {
+        return components_.empty();
+    }
+
+    // Parallel columns: components()[i] belongs to entities()[i]
+    std::span<const Entity> entities() const
+    {
+        return entities_;
+    }
+
+    std::span<Component> components()
+    {
+        return components_;
+    }
+
+    std::span<const Component> components() const
+    {
+        return components_;
+    }
+
+  private:
+    static constexpr auto absent = std::numeric_limits<uint32_t>::max();
+
+    void growSparse(Entity entity)
+    {
+        if (entity >= sparse_.size())
+        {
+            sparse_.resize(static_cast<size_t>(entity) + 1, absent);
+        }
+    }
+
+  private:
+    std::vector<Entity> entities_;
+    std::vector<Component> components_;
+    std::vector<uint32_t> sparse_;
+};
+} // namespace world
@@ -3,12 +3,13 @@
 
 #pragma once
 
+#include <assets/handle.h>
 #include <assets/prefab.h>
 
 namespace world
 {
 struct RenderComponent
 {
-    assets::Prefab* prefab;
+    assets::Handle<assets::Prefab> prefab;
 };
 } // namespace world
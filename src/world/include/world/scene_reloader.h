@@ -0,0 +1,75 @@
+/// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Mark Rapson
+
+#pragma once
+
+#include "world_partition.h"
+
+#include <scene/scene_diff.h>
+
+#include <filesystem>
+#include <future>
+#include <memory>
+#include <optional>
+
+namespace core
+{
+class FileWatcher;
+}
+
+namespace scene
+{
+class BinaryScene;
+}
+
+namespace world
+{
+class World;
+
+// Watches the source file of a compiled scene and, when it's saved, parses, recompiles and diffs it against the
+// current version on a background thread. Only the difference is applied to the world, so an edit costs the frame
+// it lands in the entities it touched rather than a rebuild of the world.
+class SceneReloader
+{
+  public:
+    // The scene is the compiled version of sourcePath the world was built from. Recompiled versions are written to
+    // compiledPath.
+    SceneReloader(std::filesystem::path sourcePath,
+                  std::filesystem::path compiledPath,
+                  std::unique_ptr<scene::BinaryScene> scene);
+
+    // Waits for a recompile still running, which reads the current scene
+    ~SceneReloader();
+
+    SceneReloader(const SceneReloader&) = delete;
+    SceneReloader& operator=(const SceneReloader&) = delete;
+
+    SceneReloader(SceneReloader&& other) = delete;
+    SceneReloader& operator=(SceneReloader&& other) = delete;
+
+    // The version the world is using, which is replaced when a reload is applied
+    const scene::BinaryScene& scene() const;
+
+    // Starts a recompile if the source changed and applies one that has finished to the world, which must be
+    // partitioned. Returns what applying it changed, or nothing if no reload was applied this frame. A source that
+    // fails to parse is reported and the current version kept.
+    std::optional<StreamingUpdate> update(World& world);
+
+  private:
+    struct Recompiled
+    {
+        std::unique_ptr<scene::BinaryScene> scene;
+        scene::SceneDiff diff;
+    };
+
+    void startRecompile();
+
+  private:
+    std::unique_ptr<core::FileWatcher> watcher_;
+    std::filesystem::path sourcePath_;
+    std::filesystem::path compiledPath_;
+    std::unique_ptr<scene::BinaryScene> scene_;
+    std::future<Recompiled> pending_;
+    bool changedAgain_{false};
+};
+} // namespace world
@@ -3,6 +3,9 @@
 
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
+
 namespace renderer
 {
 class Camera;
@@ -23,5 +26,7 @@ class RenderSystem
   private:
     renderer::Renderer& renderer_;
     World& world_;
+    uint64_t frame_{0};
+    size_t lastCommandCount_{0};
 };
 } // namespace world
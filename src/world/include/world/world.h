@@ -3,19 +3,28 @@
 
 #pragma once
 
+#include "component_storage.h"
 #include "entity.h"
 #include "world/components/render_component.h"
 #include "world/components/transform_component.h"
 #include "world/systems/render_system.h"
+#include "world_partition.h"
+
+#include <assets/handle.h>
 
 #include <memory>
-#include <stdexcept>
-#include <unordered_map>
+#include <span>
+#include <string>
+#include <utility>
+#include <vector>
 
 namespace scene
 {
+class BinaryScene;
+struct Generator;
 struct Scene;
-}
+struct SceneDiff;
+} // namespace scene
 
 namespace assets
 {
@@ -23,6 +32,11 @@ class AssetDatabase;
 struct Skybox;
 } // namespace assets
 
+namespace core
+{
+class FrameArenas;
+}
+
 namespace renderer
 {
 class Camera;
@@ -35,7 +49,18 @@ class World
 {
   public:
     World(renderer::Renderer& renderer);
-    World(const scene::Scene& scene, const assets::AssetDatabase& assetDatabase, renderer::Renderer& renderer);
+    // Render components created from the scene hold a reference to their prefab until their entity is destroyed
+    World(const scene::Scene& scene, assets::AssetDatabase& assetDatabase, renderer::Renderer& renderer);
+    // Entities are numbered in scene order and each component column is copied in one go
+    World(const scene::BinaryScene& scene, assets::AssetDatabase& assetDatabase, renderer::Renderer& renderer);
+    // Only the scene's entities near the position given to stream() are in the world, see WorldPartition. The scene
+    // must outlive the world.
+    World(const scene::BinaryScene& scene,
+          assets::AssetDatabase& assetDatabase,
+          renderer::Renderer& renderer,
+          const WorldPartitionConfig& partitionConfig);
+
+    ~World();
 
     World(const World&) = delete;
     World& operator=(const World&) = delete;
@@ -44,42 +69,61 @@ class World
     World& operator=(World&& other) = delete;
 
     Entity createEntity();
+    // Creates count consecutive entities and returns the first
+    Entity createEntities(uint32_t count);
     void destroyEntity(Entity entity);
+    void destroyEntities(std::span<const Entity> entities);
+
+    void setActiveSkybox(assets::Handle<assets::Skybox> skybox);
+    assets::Handle<assets::Skybox> activeSkybox() const;
 
-    void setActiveSkybox(assets::Skybox* skybox);
-    assets::Skybox* activeSkybox() const;
+    // Database the world's asset handles refer to, null for a world created without a scene
+    const assets::AssetDatabase* assetDatabase() const;
+    assets::AssetDatabase* assetDatabase();
+
+    // Arenas systems allocate their per-frame data from, null to use the heap. Not owned.
+    void setFrameArenas(core::FrameArenas* frameArenas);
+    core::FrameArenas* frameArenas() const;
+
+    // Streams the cells of a partitioned world in and out around the position. Does nothing for a world without a
+    // partition.
+    StreamingUpdate stream(const glm::vec3& position, bool wait = false);
+
+    // Applies a recompiled version of the scene the world was built from, see WorldPartition::reload. The populations
+    // of added and modified generators are rebuilt and those of removed ones destroyed; the rest are left alone. Only
+    // a partitioned world knows which of its entities came from which scene entity, so throws std::logic_error for
+    // any other.
+    StreamingUpdate reload(const scene::BinaryScene& scene, const scene::SceneDiff& diff);
+
+    // Null for a world without a partition
+    const WorldPartition* partition() const;
 
     void update(const renderer::Camera& camera);
 
     template <typename Component, typename... Args>
     Component& addComponent(Entity entity, Args&&... args)
     {
-        auto& storage = getStorage<Component>();
-        auto [itr, inserted] = storage.emplace(entity, Component(std::forward<Args>(args)...));
-        if (!inserted)
-        {
-            throw std::logic_error("Component already exists on this entity");
-        }
+        return getStorage<Component>().insert(entity, Component(std::forward<Args>(args)...));
+    }
 
-        return itr->second;
+    // Adds default components to a batch of entities in one go and returns them to be filled in, see
+    // ComponentStorage::extend. Render components added this way don't take a prefab reference; the caller does.
+    template <typename Component>
+    std::span<Component> addComponents(std::span<const Entity> entities)
+    {
+        return getStorage<Component>().extend(entities);
     }
 
     template <typename Component>
     bool hasComponent(Entity entity) const
     {
-        const auto& storage = getStorage<Component>();
-        return storage.find(entity) != storage.end();
+        return getStorage<Component>().contains(entity);
     }
 
     template <typename Component>
     Component* getComponent(Entity entity)
     {
-        auto& storage = getStorage<Component>();
-        if (auto itr = storage.find(entity); itr != storage.end())
-        {
-            return &itr->second;
-        }
-        return nullptr;
+        return getStorage<Component>().find(entity);
     }
 
     template <typename Component>
@@ -95,8 +139,33 @@ class World
     }
 
   private:
+    // What a generator added to the world: consecutive entities, and for an instanced population the prefab
+    // generated for it
+    struct Population
+    {
+        Entity firstEntity{0};
+        uint32_t entityCount{0};
+        assets::Handle<assets::Prefab> prefab;
+    };
+
+    // Non-instanced populations become an entity per instance, written straight into the component columns;
+    // instanced ones become a single entity drawing a prefab built from the source prefab and the population
+    Population generate(const scene::Generator& generator,
+                        assets::AssetDatabase& assetDatabase,
+                        StreamingUpdate& update);
+    void destroyPopulation(const Population& population, StreamingUpdate& update);
+    assets::Handle<assets::Prefab> findGeneratorPrefab(const std::string& name,
+                                                       assets::AssetDatabase& assetDatabase,
+                                                       StreamingUpdate& update);
+
     template <typename Component>
     auto& getStorage()
+    {
+        return const_cast<ComponentStorage<Component>&>(std::as_const(*this).getStorage<Component>());
+    }
+
+    template <typename Component>
+    const auto& getStorage() const
     {
         static_assert(std::is_same_v<Component, RenderComponent> || std::is_same_v<Component, TransformComponent>,
                       "Component type unknown");
@@ -112,9 +181,15 @@ class World
     }
 
   private:
-    std::unordered_map<Entity, RenderComponent> renderComponents_;
-    std::unordered_map<Entity, TransformComponent> transformComponents_;
-    assets::Skybox* activeSkybox_{nullptr};
+    ComponentStorage<RenderComponent> renderComponents_;
+    ComponentStorage<TransformComponent> transformComponents_;
+    assets::AssetDatabase* assetDatabase_{nullptr};
+    assets::Handle<assets::Skybox> activeSkybox_;
+    core::FrameArenas* frameArenas_{nullptr};
+    std::unique_ptr<WorldPartition> partition_;
+
+    // Indexed by the scene's generators
+    std::vector<Population> populations_;
 
   private:
     Entity nextEntity{0};
@@ -0,0 +1,247 @@
+/// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Mark Rapson
+
+#pragma once
+
+#include "entity.h"
+#include "world/components/transform_component.h"
+
+#include <assets/asset_database.h>
+#include <assets/handle.h>
+#include <assets/prefab.h>
+
+#include <glm/glm.hpp>
+
+#include <cstddef>
+#include <filesystem>
+#include <future>
+#include <limits>
+#include <memory>
+#include <span>
+#include <stdint.h>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace scene
+{
+class BinaryScene;
+struct SceneDiff;
+} // namespace scene
+
+namespace core
+{
+class JobSystem;
+
+template <typename T>
+class Task;
+} // namespace core
+
+namespace world
+{
+class World;
+
+struct WorldPartitionConfig
+{
+    // Edge length of the square cells the ground plane is split into
+    float cellSize{64.0f};
+
+    // Cells are loaded once any part of them is this close to the camera, measured across the ground plane
+    float loadRadius{256.0f};
+
+    // How much further the camera has to move before a loaded cell is unloaded, so moving back and forth across a
+    // border doesn't load and unload the same cells every frame
+    float hysteresis{32.0f};
+
+    // Entities added to or removed from the world per update. Cells over the budget wait for the next update, so
+    // crossing into a dense area is spread over several frames. At least one cell is always processed.
+    uint32_t entityBudget{65536};
+
+    // Directory the scene's prefab paths are relative to, for loading prefabs that were evicted or never loaded
+    std::filesystem::path prefabDirectory;
+};
+
+// What an update changed
+struct StreamingUpdate
+{
+    uint32_t cellsLoaded{0};
+    uint32_t cellsUnloaded{0};
+
+    // Prefabs added to the asset database for cells coming into range, or replaced by a reload, which the renderer
+    // has to upload before the next frame
+    uint32_t prefabsLoaded{0};
+
+    // Content a reload removed from the asset database, such as a replaced prefab's, which the renderer has to retire
+    assets::EvictedAssets evicted;
+};
+
+// Splits the entities of a compiled scene into a grid of cells by position and keeps only the cells around the
+// camera in the world. Every scene entity has a fixed world entity, so one that leaves and comes back keeps its
+// number. Entities without a transform aren't in any cell and stay loaded.
+//
+// Cells are copied out of the scene on the asset database's job system and added to the world in bulk once ready.
+// A cell holds a reference to each prefab it uses for every entity using it, from the time it starts loading until
+// it's unloaded, so prefabs only become evictable once no cell in range needs them. Prefabs that aren't loaded are
+// loaded in the background before the cell is added.
+class WorldPartition
+{
+  public:
+    // The scene must outlive the partition. Throws std::runtime_error if an entity without a transform uses a prefab
+    // that can't be loaded.
+    WorldPartition(const scene::BinaryScene& scene,
+                   World& world,
+                   assets::AssetDatabase& assetDatabase,
+                   const WorldPartitionConfig& config);
+
+    // Waits for loads still running, which write to the partition
+    ~WorldPartition();
+
+    WorldPartition(const WorldPartition&) = delete;
+    WorldPartition& operator=(const WorldPartition&) = delete;
+
+    WorldPartition(WorldPartition&& other) = delete;
+    WorldPartition& operator=(WorldPartition&& other) = delete;
+
+    // Starts loading the cells coming into range of the position, adds those that have finished to the world and
+    // removes those that went out of range. With wait, blocks until every cell in range is in the world, e.g. behind
+    // a loading screen. Throws std::runtime_error if a prefab a cell needs fails to load.
+    StreamingUpdate update(const glm::vec3& position, bool wait = false);
+
+    // Switches to a recompiled version of the scene, which must outlive the partition, given its diff against the
+    // current one. Entities the diff matched keep their world entity and stay in the world; removed and changed ones
+    // are destroyed and changed or added ones in loaded cells are added straight away. A loaded cell whose new
+    // entities use a prefab that isn't loaded is unloaded instead, and streams back in once the prefab has loaded.
+    // Loaded prefabs whose path changed are loaded again from the new path and replace the old version once ready.
+    StreamingUpdate reload(const scene::BinaryScene& scene, const scene::SceneDiff& diff);
+
+    // Handle of the scene prefab with the name, loading it first if it isn't loaded or waiting for it to be replaced
+    // if its path changed, for users outside of any cell such as generators. Returns an invalid handle if the scene
+    // has no prefab with the name. Throws std::runtime_error if it fails to load.
+    assets::Handle<assets::Prefab> loadPrefab(std::string_view name, StreamingUpdate& update);
+
+    const WorldPartitionConfig& config() const;
+
+    size_t cellCount() const;
+    size_t loadedCellCount() const;
+    size_t loadedEntityCount() const;
+
+  private:
+    enum class CellState
+    {
+        Unloaded,
+        Loading,
+        Loaded
+    };
+
+    struct Cell
+    {
+        int32_t x{0};
+        int32_t z{0};
+
+        // Ranges of cellEntities_ and cellPrefabs_
+        uint32_t firstEntity{0};
+        uint32_t entityCount{0};
+        uint32_t firstPrefab{0};
+        uint32_t prefabCount{0};
+
+        CellState state{CellState::Unloaded};
+    };
+
+    // Number of a cell's render components using one of the scene's prefabs
+    struct CellPrefab
+    {
+        uint32_t prefab{0};
+        uint32_t count{0};
+    };
+
+    // Components copied out of the scene for world entities
+    struct StagedCell
+    {
+        std::vector<Entity> transformEntities;
+        std::vector<TransformComponent> transforms;
+        std::vector<Entity> renderEntities;
+        std::vector<uint32_t> renderPrefabs;
+    };
+
+    struct PendingCell
+    {
+        uint32_t cell{0};
+        std::future<StagedCell> staged;
+
+        // Whether the cell holds its prefab references yet, which it takes once all of them are loaded
+        bool referenced{false};
+
+        // Went out of range while loading; dropped once its copy finishes
+        bool cancelled{false};
+    };
+
+    struct PrefabLoad
+    {
+        uint32_t prefab{0};
+        std::unique_ptr<assets::AssetDatabase> source;
+        std::future<assets::Prefab> result;
+
+        // Replaces the loaded version of the prefab rather than adding it
+        bool replace{false};
+    };
+
+    void buildCells();
+    void requestCells(const glm::vec3& position);
+    void startLoad(uint32_t cell);
+    void unloadDistantCells(const glm::vec3& position, uint32_t& budget, StreamingUpdate& update);
+    void finishPrefabLoads(StreamingUpdate& update);
+    bool reference(PendingCell& pending);
+    void releaseReferences(const Cell& cell);
+    void commitStagedCells(uint32_t& budget, StreamingUpdate& update);
+    void addToWorld(const StagedCell& staged);
+    void unloadCell(const Cell& cell);
+    bool addChangedEntities(const Cell& cell, const std::vector<bool>& changed);
+    void waitForLoads();
+
+    // Handle of a scene prefab if it's loaded, otherwise starts loading it and returns an invalid handle
+    assets::Handle<assets::Prefab> resolvePrefab(uint32_t prefab);
+    void startPrefabLoad(uint32_t prefab, bool replace);
+
+    static StagedCell stage(const scene::BinaryScene& scene,
+                            std::span<const Entity> worldEntities,
+                            std::span<const uint32_t> entities);
+    static core::Task<StagedCell> stageAsync(const scene::BinaryScene& scene,
+                                             std::span<const Entity> worldEntities,
+                                             std::span<const uint32_t> entities,
+                                             core::JobSystem& jobSystem);
+
+    std::span<const uint32_t> entitiesOf(const Cell& cell) const;
+    std::span<const CellPrefab> prefabsOf(const Cell& cell) const;
+    float distanceTo(const Cell& cell, const glm::vec3& position) const;
+
+  private:
+    static constexpr auto unplacedCell = std::numeric_limits<uint32_t>::max();
+
+    const scene::BinaryScene* scene_{nullptr};
+    World& world_;
+    assets::AssetDatabase& assetDatabase_;
+    WorldPartitionConfig config_;
+
+    // Indexed by scene entity
+    std::vector<Entity> worldEntities_;
+
+    std::vector<Cell> cells_;
+    std::unordered_map<uint64_t, uint32_t> cellIndices_;
+    std::vector<uint32_t> cellEntities_;
+    std::vector<CellPrefab> cellPrefabs_;
+
+    // Entities without a transform, loaded with the partition
+    uint32_t unplaced_{unplacedCell};
+
+    // Indexed by scene prefab
+    std::vector<assets::Handle<assets::Prefab>> prefabs_;
+
+    std::vector<uint32_t> activeCells_;
+    std::vector<PendingCell> pendingCells_;
+    std::vector<PrefabLoad> prefabLoads_;
+    std::vector<uint32_t> requests_;
+    std::vector<uint32_t> scratchIndices_;
+    std::vector<Entity> scratchEntities_;
+    size_t loadedEntityCount_{0};
+};
+} // namespace world
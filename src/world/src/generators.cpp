@@ -0,0 +1,194 @@
+/// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Mark Rapson
+
+#include "generators.h"
+
+#include <assets/asset_database.h>
+#include <scene/scene.h>
+
+#define GLM_ENABLE_EXPERIMENTAL
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtx/quaternion.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <span>
+#include <stdexcept>
+
+namespace world
+{
+// Independent random streams per instance, so the population doesn't depend on how it was split across threads
+constexpr auto xStream = uint64_t{0};
+constexpr auto yStream = uint64_t{1};
+constexpr auto zStream = uint64_t{2};
+constexpr auto yawStream = uint64_t{3};
+constexpr auto scaleStream = uint64_t{4};
+constexpr auto streamCount = uint64_t{5};
+
+// splitmix64 finaliser
+uint64_t mix(uint64_t value)
+{
+    value = (value ^ (value >> 30)) * 0xbf58'476d'1ce4'e5b9;
+    value = (value ^ (value >> 27)) * 0x94d0'49bb'1331'11eb;
+    return value ^ (value >> 31);
+}
+
+// Uniform in [0, 1)
+float random(uint32_t seed, size_t index, uint64_t stream)
+{
+    const auto bits = mix(mix(seed) ^ (static_cast<uint64_t>(index) * streamCount + stream));
+    return static_cast<float>(bits >> 40) * 0x1p-24f;
+}
+
+SurfaceSampler::SurfaceSampler(const assets::Prefab& prefab, const assets::AssetDatabase& db)
+{
+    if (!meshDataResident(prefab, db))
+    {
+        throw std::runtime_error("Surface prefab mesh data isn't loaded");
+    }
+
+    const auto identity = glm::mat4{1.0f};
+    auto total = 0.0;
+
+    for (const auto& instance : prefab.meshInstances)
+    {
+        if (!instance.mesh.valid())
+        {
+            continue;
+        }
+
+        const auto placements = instance.instanceCount > 0
+                                    ? std::span{prefab.instanceTransforms}.subspan(instance.instanceOffset,
+                                                                                   instance.instanceCount)
+                                    : std::span{&identity, 1};
+
+        for (const auto& placement : placements)
+        {
+            const auto transform = instance.transform * placement;
+
+            for (const auto& subMeshHandle : db.get(instance.mesh).subMeshes)
+            {
+                const auto& subMesh = db.get(subMeshHandle);
+                for (size_t i = 0; i + 2 < subMesh.indices.size(); i += 3)
+                {
+                    const auto a =
+                        glm::vec3{transform * glm::vec4{subMesh.vertices[subMesh.indices[i]].position, 1.0f}};
+                    const auto b =
+                        glm::vec3{transform * glm::vec4{subMesh.vertices[subMesh.indices[i + 1]].position, 1.0f}};
+                    const auto c =
+                        glm::vec3{transform * glm::vec4{subMesh.vertices[subMesh.indices[i + 2]].position, 1.0f}};
+
+                    total += 0.5 * static_cast<double>(glm::length(glm::cross(b - a, c - a)));
+                    corners_.push_back(a);
+                    corners_.push_back(b);
+                    corners_.push_back(c);
+                    cumulativeAreas_.push_back(total);
+                }
+            }
+        }
+    }
+}
+
+double SurfaceSampler::area() const
+{
+    return cumulativeAreas_.empty() ? 0.0 : cumulativeAreas_.back();
+}
+
+glm::vec3 SurfaceSampler::sample(float u, float v, float w) const
+{
+    const auto target = static_cast<double>(u) * area();
+    const auto triangle = static_cast<size_t>(std::ranges::upper_bound(cumulativeAreas_, target)
+                                              - cumulativeAreas_.begin());
+    const auto index = std::min(triangle, cumulativeAreas_.size() - 1) * 3;
+
+    // Square rooting one coordinate makes the barycentric weights uniform over the triangle
+    const auto root = std::sqrt(v);
+    return (1.0f - root) * corners_[index] + root * (1.0f - w) * corners_[index + 1] + root * w * corners_[index + 2];
+}
+
+bool meshDataResident(const assets::Prefab& prefab, const assets::AssetDatabase& db)
+{
+    for (const auto& mesh : prefab.meshes)
+    {
+        for (const auto& subMesh : db.get(mesh).subMeshes)
+        {
+            if (db.get(subMesh).vertices.empty() || db.get(subMesh).indices.empty())
+            {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+size_t generatedInstanceCount(const scene::Generator& generator, const SurfaceSampler* surface)
+{
+    auto count = 0.0;
+
+    switch (generator.type)
+    {
+        case scene::GeneratorType::Grid:
+            count = static_cast<double>(generator.count.x) * generator.count.y * generator.count.z;
+            break;
+        case scene::GeneratorType::Volume:
+        {
+            const auto extent = glm::max(generator.max - generator.min, glm::vec3{0.0f});
+            count = std::round(static_cast<double>(generator.density) * extent.x * extent.y * extent.z);
+            break;
+        }
+        case scene::GeneratorType::Surface:
+            count = std::round(static_cast<double>(generator.density) * surface->area());
+            break;
+    }
+
+    if (!(count >= 0.0) || count >= static_cast<double>(std::numeric_limits<uint32_t>::max()))
+    {
+        throw std::runtime_error("Generator " + generator.name + " places too many instances");
+    }
+
+    return static_cast<size_t>(count);
+}
+
+GeneratedInstance generateInstance(const scene::Generator& generator, const SurfaceSampler* surface, size_t index)
+{
+    auto instance = GeneratedInstance{};
+
+    switch (generator.type)
+    {
+        case scene::GeneratorType::Grid:
+        {
+            const auto x = index % generator.count.x;
+            const auto y = index / generator.count.x % generator.count.y;
+            const auto z = index / generator.count.x / generator.count.y;
+            instance.position = glm::vec3{x, y, z} * generator.spacing;
+            break;
+        }
+        case scene::GeneratorType::Volume:
+            instance.position = generator.min
+                                + (generator.max - generator.min)
+                                      * glm::vec3{random(generator.seed, index, xStream),
+                                                  random(generator.seed, index, yStream),
+                                                  random(generator.seed, index, zStream)};
+            break;
+        case scene::GeneratorType::Surface:
+            instance.position = surface->sample(random(generator.seed, index, xStream),
+                                                random(generator.seed, index, yStream),
+                                                random(generator.seed, index, zStream));
+            break;
+    }
+
+    instance.yaw = generator.randomYaw ? 360.0f * random(generator.seed, index, yawStream) : 0.0f;
+    instance.scale = generator.minScale
+                     + (generator.maxScale - generator.minScale) * random(generator.seed, index, scaleStream);
+    return instance;
+}
+
+glm::mat4 transformMatrix(const scene::TransformComponent& transform)
+{
+    return glm::translate(glm::mat4(1.0f), transform.position)
+           * glm::toMat4(glm::quat(glm::radians(transform.rotation)))
+           * glm::scale(glm::mat4(1.0f), transform.scale);
+}
+} // namespace world
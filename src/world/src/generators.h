@@ -0,0 +1,61 @@
+/// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Mark Rapson
+
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <cstddef>
+#include <vector>
+
+namespace assets
+{
+class AssetDatabase;
+struct Prefab;
+} // namespace assets
+
+namespace scene
+{
+struct Generator;
+struct TransformComponent;
+} // namespace scene
+
+namespace world
+{
+// One generated instance in the generator's space, before the generator's own transform is applied
+struct GeneratedInstance
+{
+    glm::vec3 position;
+    float yaw;
+    float scale;
+};
+
+// Triangles of a prefab's meshes in prefab space, with a running total of their areas so points can be sampled
+// uniformly over the surface
+class SurfaceSampler
+{
+  public:
+    // Throws std::runtime_error if the prefab's mesh data isn't on the CPU
+    SurfaceSampler(const assets::Prefab& prefab, const assets::AssetDatabase& db);
+
+    double area() const;
+
+    // u picks a triangle by area and v, w a point on it; all are in [0, 1)
+    glm::vec3 sample(float u, float v, float w) const;
+
+  private:
+    std::vector<glm::vec3> corners_;
+    std::vector<double> cumulativeAreas_;
+};
+
+// Whether every sub-mesh of the prefab still has its vertices and indices on the CPU
+bool meshDataResident(const assets::Prefab& prefab, const assets::AssetDatabase& db);
+
+// Throws std::runtime_error if the population doesn't fit in the world's entity ids
+size_t generatedInstanceCount(const scene::Generator& generator, const SurfaceSampler* surface);
+
+// Depends only on the generator and index, so instances can be generated in any order on any thread
+GeneratedInstance generateInstance(const scene::Generator& generator, const SurfaceSampler* surface, size_t index);
+
+glm::mat4 transformMatrix(const scene::TransformComponent& transform);
+} // namespace world
@@ -0,0 +1,124 @@
+/// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Mark Rapson
+
+#include "world/scene_reloader.h"
+#include "world/world.h"
+
+#include <core/file_watcher.h>
+#include <scene/binary_scene.h>
+#include <scene/scene.h>
+#include <scene/scene_loader.h>
+
+#include <spdlog/spdlog.h>
+
+#include <chrono>
+
+namespace world
+{
+SceneReloader::SceneReloader(std::filesystem::path sourcePath,
+                             std::filesystem::path compiledPath,
+                             std::unique_ptr<scene::BinaryScene> scene)
+    : watcher_{std::make_unique<core::FileWatcher>()}
+    , sourcePath_{sourcePath.lexically_normal()}
+    , compiledPath_{std::move(compiledPath)}
+    , scene_{std::move(scene)}
+{
+    spdlog::info("Watching {} for scene changes", sourcePath_.string());
+    watcher_->watchDirectory(sourcePath_.parent_path());
+}
+
+SceneReloader::~SceneReloader()
+{
+    if (pending_.valid())
+    {
+        pending_.wait();
+    }
+}
+
+const scene::BinaryScene& SceneReloader::scene() const
+{
+    return *scene_;
+}
+
+std::optional<StreamingUpdate> SceneReloader::update(World& world)
+{
+    for (const auto& changed : watcher_->poll())
+    {
+        if (changed.lexically_normal() != sourcePath_)
+        {
+            continue;
+        }
+
+        if (pending_.valid())
+        {
+            // The recompile in progress may have read the old file, so go again once it's done
+            changedAgain_ = true;
+        }
+        else
+        {
+            startRecompile();
+        }
+    }
+
+    if (!pending_.valid() || pending_.wait_for(std::chrono::seconds{0}) != std::future_status::ready)
+    {
+        return std::nullopt;
+    }
+
+    auto result = std::optional<StreamingUpdate>{};
+    try
+    {
+        auto recompiled = pending_.get();
+
+        const auto startTime = std::chrono::steady_clock::now();
+        result = world.reload(*recompiled.scene, recompiled.diff);
+        scene_ = std::move(recompiled.scene);
+
+        spdlog::info("Reloaded {}: {} entities added, {} changed and {} removed, {} generators rebuilt and {} "
+                     "removed, {} prefabs moved in {:.2f} ms",
+                     sourcePath_.string(),
+                     recompiled.diff.added.size(),
+                     recompiled.diff.modified.size(),
+                     recompiled.diff.removed.size(),
+                     recompiled.diff.addedGenerators.size() + recompiled.diff.modifiedGenerators.size(),
+                     recompiled.diff.removedGenerators.size(),
+                     recompiled.diff.movedPrefabs.size(),
+                     std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count());
+    }
+    catch (const std::runtime_error& ex)
+    {
+        // Keep the version already loaded; the next save will try again
+        spdlog::error("Failed to reload scene: {}", ex.what());
+    }
+
+    if (changedAgain_)
+    {
+        changedAgain_ = false;
+        startRecompile();
+    }
+
+    return result;
+}
+
+// The compiled file is replaced by renaming, so the current version's mapping of it stays valid
+void SceneReloader::startRecompile()
+{
+    pending_ = std::async(std::launch::async,
+                          [this]
+                          {
+                              const auto startTime = std::chrono::steady_clock::now();
+
+                              auto recompiled = Recompiled{};
+                              scene::writeBinaryScene(*scene::loadScene(sourcePath_), compiledPath_);
+                              recompiled.scene = std::make_unique<scene::BinaryScene>(compiledPath_);
+                              recompiled.diff = scene::diffScenes(*scene_, *recompiled.scene);
+
+                              spdlog::debug("Recompiled and diffed {} in {:.1f} ms",
+                                            sourcePath_.string(),
+                                            std::chrono::duration<double, std::milli>(
+                                                std::chrono::steady_clock::now() - startTime)
+                                                .count());
+                              return recompiled;
+                          });
+}
+} // namespace world
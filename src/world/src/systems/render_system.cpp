@@ -4,6 +4,7 @@
 #include "world/systems/render_system.h"
 
 #include <assets/asset_database.h>
+#include <core/frame_arenas.h>
 #include <renderer/renderer.h>
 
 #include "world/world.h"
@@ -13,6 +14,9 @@
 #include <glm/gtx/quaternion.hpp>
 #include <glm/gtx/transform.hpp>
 
+#include <memory_resource>
+#include <vector>
+
 namespace world
 {
 RenderSystem::RenderSystem(renderer::Renderer& renderer, World& world)
@@ -23,16 +27,29 @@ RenderSystem::RenderSystem(renderer::Renderer& renderer, World& world)
 
 void RenderSystem::update(const renderer::Camera& camera)
 {
-    auto commands = std::vector<renderer::DrawCommand>{};
-    for (auto& [entity, renderComponent] : world_.getAllComponents<RenderComponent>())
+    // Commands only need to outlive this frame's submission, so they come from the frame arena. Reserving last
+    // frame's count avoids growing through a run of discarded buffers on every frame.
+    auto* frameArenas = world_.frameArenas();
+    auto commands = std::pmr::vector<renderer::DrawCommand>{frameArenas ? &frameArenas->arena()
+                                                                        : std::pmr::get_default_resource()};
+    commands.reserve(lastCommandCount_);
+
+    auto* db = world_.assetDatabase();
+    const auto& renderComponents = world_.getAllComponents<RenderComponent>();
+    for (size_t i = 0; i < renderComponents.size(); ++i)
     {
-        auto prefab = renderComponent.prefab;
-        if (!prefab)
+        const auto entity = renderComponents.entities()[i];
+        const auto& renderComponent = renderComponents.components()[i];
+
+        if (!db || !renderComponent.prefab.valid())
         {
             continue;
         }
 
-        if (prefab->meshes().empty())
+        db->markUsed(renderComponent.prefab, frame_);
+
+        const auto& prefab = db->get(renderComponent.prefab);
+        if (prefab.meshes.empty())
         {
             continue;
         }
@@ -47,23 +64,29 @@ void RenderSystem::update(const renderer::Camera& camera)
                                * glm::toMat4(glm::quat(glm::radians(transformComponent->rotation)))
                                * glm::scale(glm::mat4(1.0f), transformComponent->scale);
 
-        for (const auto& instance : prefab->meshInstances())
+        for (const auto& instance : prefab.meshInstances)
         {
-            if (!instance.mesh)
+            if (!instance.mesh.valid())
             {
                 continue;
             }
 
-            for (const auto& subMesh : instance.mesh->subMeshes)
+            for (const auto& subMesh : db->get(instance.mesh).subMeshes)
             {
                 auto drawCommand = renderer::DrawCommand{};
-                drawCommand.subMesh = subMesh.get();
+                drawCommand.subMesh = subMesh;
+                drawCommand.material = db->get(subMesh).material;
                 drawCommand.transform = transformMatrix * instance.transform;
+                drawCommand.prefab = renderComponent.prefab;
+                drawCommand.instanceOffset = instance.instanceOffset;
+                drawCommand.instanceCount = instance.instanceCount;
                 commands.push_back(drawCommand);
             }
         }
     }
 
+    lastCommandCount_ = commands.size();
     renderer_.renderFrame(camera, world_.activeSkybox(), commands);
+    frame_++;
 }
 } // namespace world
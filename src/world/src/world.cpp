@@ -3,27 +3,82 @@
 
 #include "world/world.h"
 
+#include "generators.h"
+
 #include <assets/asset_database.h>
+#include <core/allocation_tracker.h>
+#include <core/job_system.h>
+#include <scene/binary_scene.h>
 #include <scene/scene.h>
+#include <scene/scene_diff.h>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
 
 namespace world
 {
+// Instances per job when expanding generators
+constexpr auto generatorGrainSize = size_t{4096};
+
+void forEachInstance(core::JobSystem* jobSystem, size_t count, const std::function<void(size_t, size_t)>& body)
+{
+    if (jobSystem)
+    {
+        jobSystem->parallelFor(count, generatorGrainSize, body);
+    }
+    else
+    {
+        body(0, count);
+    }
+}
+
 World::World(renderer::Renderer& renderer)
     : renderSystem_{renderer, *this}
 {
 }
 
-World::World(const scene::Scene& scene, const assets::AssetDatabase& assetDatabase, renderer::Renderer& renderer)
+World::World(const scene::Scene& scene, assets::AssetDatabase& assetDatabase, renderer::Renderer& renderer)
     : World(renderer)
 {
+    assetDatabase_ = &assetDatabase;
+
+    // Prefab ids are interned by the scene loader, so each distinct id only needs looking up once
+    auto prefabs = std::unordered_map<const char*, assets::Handle<assets::Prefab>>{};
+
     for (const auto& sceneEntity : scene.entities)
     {
         auto entity = createEntity();
 
         if (sceneEntity.renderComponent.has_value())
         {
+            const auto prefabId = sceneEntity.renderComponent->prefabId;
+
             auto& renderComponent = addComponent<RenderComponent>(entity);
-            renderComponent.prefab = assetDatabase.prefabs().at(sceneEntity.renderComponent->prefabId).get();
+            auto [itr, inserted] = prefabs.try_emplace(prefabId.data());
+            if (inserted)
+            {
+                itr->second = assetDatabase.findPrefab(std::string{prefabId});
+            }
+
+            renderComponent.prefab = itr->second;
+            if (!renderComponent.prefab.valid())
+            {
+                throw std::runtime_error("Unknown prefab " + std::string{prefabId});
+            }
+
+            assetDatabase.acquire(renderComponent.prefab);
         }
         if (sceneEntity.transformComponent.has_value())
         {
@@ -32,8 +87,123 @@ World::World(const scene::Scene& scene, const assets::AssetDatabase& assetDataba
             transformComponent.rotation = sceneEntity.transformComponent->rotation;
             transformComponent.scale = sceneEntity.transformComponent->scale;
         }
+    }
 
-        activeSkybox_ = assetDatabase.skyboxes().at(scene.camera.skybox).get();
+    auto generated = StreamingUpdate{};
+    for (const auto& generator : scene.generators)
+    {
+        populations_.push_back(generate(generator, assetDatabase, generated));
+    }
+
+    activeSkybox_ = assetDatabase.findSkybox(scene.camera.skybox);
+    if (!activeSkybox_.valid())
+    {
+        throw std::runtime_error("Unknown skybox " + scene.camera.skybox);
+    }
+}
+
+World::World(const scene::BinaryScene& scene, assets::AssetDatabase& assetDatabase, renderer::Renderer& renderer)
+    : World(renderer)
+{
+    static_assert(sizeof(scene::TransformComponent) == sizeof(TransformComponent)
+                      && offsetof(scene::TransformComponent, position) == offsetof(TransformComponent, position)
+                      && offsetof(scene::TransformComponent, rotation) == offsetof(TransformComponent, rotation)
+                      && offsetof(scene::TransformComponent, scale) == offsetof(TransformComponent, scale)
+                      && std::is_trivially_copyable_v<TransformComponent>,
+                  "Compiled scene transforms must match the world's layout");
+
+    assetDatabase_ = &assetDatabase;
+
+    // Resolve and count every referenced prefab before touching storage, so an unknown prefab leaves nothing to undo
+    const auto renderPrefabs = scene.renderPrefabs();
+    auto prefabs = std::vector<assets::Handle<assets::Prefab>>(scene.prefabs().size());
+    auto references = std::vector<uint32_t>(scene.prefabs().size());
+    for (const auto prefab : renderPrefabs)
+    {
+        references[prefab]++;
+    }
+    for (size_t i = 0; i < prefabs.size(); ++i)
+    {
+        if (references[i] == 0)
+        {
+            continue;
+        }
+
+        prefabs[i] = assetDatabase.findPrefab(scene.prefabs()[i].name);
+        if (!prefabs[i].valid())
+        {
+            throw std::runtime_error("Unknown prefab " + scene.prefabs()[i].name);
+        }
+    }
+
+    activeSkybox_ = assetDatabase.findSkybox(scene.camera().skybox);
+    if (!activeSkybox_.valid())
+    {
+        throw std::runtime_error("Unknown skybox " + scene.camera().skybox);
+    }
+
+    const auto firstEntity = createEntities(scene.entityCount());
+
+    const auto sceneTransforms = scene.transforms();
+    auto transforms = transformComponents_.extend(scene.transformEntities(), firstEntity);
+    std::memcpy(static_cast<void*>(transforms.data()), sceneTransforms.data(), sceneTransforms.size_bytes());
+
+    auto renderComponents = renderComponents_.extend(scene.renderEntities(), firstEntity);
+    for (size_t i = 0; i < renderComponents.size(); ++i)
+    {
+        renderComponents[i].prefab = prefabs[renderPrefabs[i]];
+    }
+
+    for (size_t i = 0; i < prefabs.size(); ++i)
+    {
+        if (references[i] > 0)
+        {
+            assetDatabase.acquire(prefabs[i], references[i]);
+        }
+    }
+
+    auto generated = StreamingUpdate{};
+    for (const auto& generator : scene.generators())
+    {
+        populations_.push_back(generate(generator, assetDatabase, generated));
+    }
+}
+
+World::World(const scene::BinaryScene& scene,
+             assets::AssetDatabase& assetDatabase,
+             renderer::Renderer& renderer,
+             const WorldPartitionConfig& partitionConfig)
+    : World(renderer)
+{
+    assetDatabase_ = &assetDatabase;
+
+    activeSkybox_ = assetDatabase.findSkybox(scene.camera().skybox);
+    if (!activeSkybox_.valid())
+    {
+        throw std::runtime_error("Unknown skybox " + scene.camera().skybox);
+    }
+
+    partition_ = std::make_unique<WorldPartition>(scene, *this, assetDatabase, partitionConfig);
+
+    // Generated populations are small in the scene file and aren't split into cells
+    auto generated = StreamingUpdate{};
+    for (const auto& generator : scene.generators())
+    {
+        populations_.push_back(generate(generator, assetDatabase, generated));
+    }
+}
+
+World::~World()
+{
+    // Its loads still running write to the world
+    partition_.reset();
+
+    if (assetDatabase_)
+    {
+        for (const auto& renderComponent : renderComponents_.components())
+        {
+            assetDatabase_->release(renderComponent.prefab);
+        }
     }
 }
 
@@ -42,24 +212,307 @@ Entity World::createEntity()
     return nextEntity++;
 }
 
+Entity World::createEntities(uint32_t count)
+{
+    const auto first = nextEntity;
+    nextEntity += count;
+    return first;
+}
+
 void World::destroyEntity(Entity entity)
 {
+    if (auto* renderComponent = renderComponents_.find(entity); renderComponent && assetDatabase_)
+    {
+        assetDatabase_->release(renderComponent->prefab);
+    }
+
     renderComponents_.erase(entity);
     transformComponents_.erase(entity);
 }
 
-void World::setActiveSkybox(assets::Skybox* skybox)
+void World::destroyEntities(std::span<const Entity> entities)
+{
+    for (const auto entity : entities)
+    {
+        destroyEntity(entity);
+    }
+}
+
+// A partitioned world loads the prefabs of its generators like those of its cells, on first use
+assets::Handle<assets::Prefab> World::findGeneratorPrefab(const std::string& name,
+                                                          assets::AssetDatabase& assetDatabase,
+                                                          StreamingUpdate& update)
+{
+    if (partition_)
+    {
+        if (const auto handle = partition_->loadPrefab(name, update); handle.valid())
+        {
+            return handle;
+        }
+    }
+
+    return assetDatabase.findPrefab(name);
+}
+
+World::Population World::generate(const scene::Generator& generator,
+                                   assets::AssetDatabase& assetDatabase,
+                                   StreamingUpdate& update)
+{
+    const auto sourceHandle = findGeneratorPrefab(generator.prefab, assetDatabase, update);
+    if (!sourceHandle.valid())
+    {
+        throw std::runtime_error("Unknown prefab " + generator.prefab + " in generator " + generator.name);
+    }
+
+    auto surface = std::optional<SurfaceSampler>{};
+    if (generator.type == scene::GeneratorType::Surface)
+    {
+        const auto surfaceHandle = findGeneratorPrefab(generator.surface, assetDatabase, update);
+        if (!surfaceHandle.valid())
+        {
+            throw std::runtime_error("Unknown surface " + generator.surface + " in generator " + generator.name);
+        }
+
+        if (!meshDataResident(assetDatabase.get(surfaceHandle), assetDatabase))
+        {
+            assetDatabase.restoreCpuData(surfaceHandle);
+        }
+        surface.emplace(assetDatabase.get(surfaceHandle), assetDatabase);
+    }
+
+    const auto* sampler = surface ? &*surface : nullptr;
+    const auto count = generatedInstanceCount(generator, sampler);
+    if (count == 0)
+    {
+        return {};
+    }
+
+    auto* jobSystem = assetDatabase.jobSystem();
+    const auto generatorTransform = transformMatrix(generator.transform);
+
+    if (!generator.instanced)
+    {
+        const auto firstEntity = createEntities(static_cast<uint32_t>(count));
+
+        auto transforms = transformComponents_.extend(firstEntity, static_cast<uint32_t>(count));
+        forEachInstance(jobSystem,
+                        count,
+                        [&](size_t begin, size_t end)
+                        {
+                            for (auto i = begin; i < end; ++i)
+                            {
+                                const auto instance = generateInstance(generator, sampler, i);
+                                auto& transform = transforms[i];
+                                transform.position = glm::vec3{generatorTransform
+                                                               * glm::vec4{instance.position, 1.0f}};
+                                transform.rotation = generator.transform.rotation + glm::vec3{0.0f, instance.yaw, 0.0f};
+                                transform.scale = generator.transform.scale * instance.scale;
+                            }
+                        });
+
+        auto renderComponents = renderComponents_.extend(firstEntity, static_cast<uint32_t>(count));
+        std::ranges::fill(renderComponents, RenderComponent{.prefab = sourceHandle});
+        assetDatabase.acquire(sourceHandle, static_cast<uint32_t>(count));
+        return Population{.firstEntity = firstEntity, .entityCount = static_cast<uint32_t>(count), .prefab = {}};
+    }
+
+    // The generated prefab is registered under the generator's name, which mustn't replace a loaded prefab
+    if (assetDatabase.findPrefab(generator.name).valid())
+    {
+        throw std::runtime_error("Generator " + generator.name + " has the same name as a prefab");
+    }
+
+    const auto& source = assetDatabase.get(sourceHandle);
+
+    auto prefab = assets::Prefab{};
+    prefab.images = source.images;
+    prefab.materials = source.materials;
+    prefab.meshes = source.meshes;
+    prefab.sourcePath = source.sourcePath;
+
+    // Every mesh instance of the source is drawn once per generated instance. The population transform has to apply
+    // after the mesh instance's own, so that's folded into the instance array and the mesh instance left at identity.
+    const auto identity = glm::mat4{1.0f};
+    const auto maxInstances = size_t{std::numeric_limits<uint32_t>::max()};
+    for (const auto& sourceInstance : source.meshInstances)
+    {
+        const auto placements = sourceInstance.instanceCount > 0
+                                    ? std::span{source.instanceTransforms}.subspan(sourceInstance.instanceOffset,
+                                                                                   sourceInstance.instanceCount)
+                                    : std::span{&identity, 1};
+
+        // Instance offsets and counts are 32-bit, and the instances of every mesh instance share one array
+        const auto offset = prefab.instanceTransforms.size();
+        if (placements.size() > (maxInstances - offset) / count)
+        {
+            throw std::runtime_error("Generator " + generator.name + " places too many instances");
+        }
+
+        const auto instanceCount = count * placements.size();
+        prefab.meshInstances.push_back(assets::MeshInstance{.mesh = sourceInstance.mesh,
+                                                            .transform = identity,
+                                                            .instanceOffset = static_cast<uint32_t>(offset),
+                                                            .instanceCount = static_cast<uint32_t>(instanceCount)});
+        prefab.instanceTransforms.resize(offset + instanceCount);
+
+        auto instanceTransforms = std::span{prefab.instanceTransforms}.subspan(offset);
+        forEachInstance(jobSystem,
+                        count,
+                        [&](size_t begin, size_t end)
+                        {
+                            for (auto i = begin; i < end; ++i)
+                            {
+                                const auto instance = generateInstance(generator, sampler, i);
+                                const auto population =
+                                    glm::scale(glm::rotate(glm::translate(generatorTransform, instance.position),
+                                                           glm::radians(instance.yaw),
+                                                           glm::vec3{0.0f, 1.0f, 0.0f}),
+                                               glm::vec3{instance.scale})
+                                    * sourceInstance.transform;
+
+                                for (size_t placement = 0; placement < placements.size(); ++placement)
+                                {
+                                    instanceTransforms[i * placements.size() + placement] =
+                                        population * placements[placement];
+                                }
+                            }
+                        });
+    }
+
+    const auto handle = assetDatabase.addPrefab(generator.name, std::move(prefab));
+    update.prefabsLoaded++;
+
+    const auto entity = createEntity();
+    addComponent<TransformComponent>(entity);
+    addComponent<RenderComponent>(entity, RenderComponent{.prefab = handle});
+    assetDatabase.acquire(handle);
+    return Population{.firstEntity = entity, .entityCount = 1, .prefab = handle};
+}
+
+void World::destroyPopulation(const Population& population, StreamingUpdate& update)
+{
+    for (auto entity = population.firstEntity; entity < population.firstEntity + population.entityCount; ++entity)
+    {
+        destroyEntity(entity);
+    }
+
+    // The generated prefab is named after the generator, so it has to go before the population is generated again
+    if (population.prefab.valid())
+    {
+        assetDatabase_->evict(population.prefab, update.evicted);
+    }
+}
+
+void World::setActiveSkybox(assets::Handle<assets::Skybox> skybox)
 {
     activeSkybox_ = skybox;
 }
 
-assets::Skybox* World::activeSkybox() const
+assets::Handle<assets::Skybox> World::activeSkybox() const
 {
     return activeSkybox_;
 }
 
+const assets::AssetDatabase* World::assetDatabase() const
+{
+    return assetDatabase_;
+}
+
+assets::AssetDatabase* World::assetDatabase()
+{
+    return assetDatabase_;
+}
+
+void World::setFrameArenas(core::FrameArenas* frameArenas)
+{
+    frameArenas_ = frameArenas;
+}
+
+core::FrameArenas* World::frameArenas() const
+{
+    return frameArenas_;
+}
+
+StreamingUpdate World::stream(const glm::vec3& position, bool wait)
+{
+    return partition_ ? partition_->update(position, wait) : StreamingUpdate{};
+}
+
+StreamingUpdate World::reload(const scene::BinaryScene& scene, const scene::SceneDiff& diff)
+{
+    if (!partition_)
+    {
+        throw std::logic_error("Only a partitioned world can be reloaded");
+    }
+
+    if (diff.cameraChanged)
+    {
+        if (auto skybox = assetDatabase_->findSkybox(scene.camera().skybox); skybox.valid())
+        {
+            activeSkybox_ = skybox;
+        }
+        else
+        {
+            spdlog::warn("Skybox {} isn't loaded, keeping the current one", scene.camera().skybox);
+        }
+    }
+
+    // Moved prefabs start loading again here, and generators using them wait for the new version
+    auto update = partition_->reload(scene, diff);
+
+    for (const auto generator : diff.removedGenerators)
+    {
+        destroyPopulation(populations_[generator], update);
+    }
+    for (const auto generator : diff.modifiedGenerators)
+    {
+        destroyPopulation(populations_[diff.previousGenerators[generator]], update);
+    }
+
+    auto populations = std::vector<Population>(scene.generators().size());
+    for (size_t generator = 0; generator < populations.size(); ++generator)
+    {
+        if (const auto previous = diff.previousGenerators[generator]; previous != scene::SceneDiff::noEntity)
+        {
+            populations[generator] = populations_[previous];
+        }
+    }
+
+    // The partition is already on the new scene, so a generator that fails to build is left empty rather than failing
+    // the reload
+    const auto rebuild = [&](uint32_t generator)
+    {
+        try
+        {
+            populations[generator] = generate(scene.generators()[generator], *assetDatabase_, update);
+        }
+        catch (const std::runtime_error& ex)
+        {
+            spdlog::error("Failed to rebuild generator {}: {}", scene.generators()[generator].name, ex.what());
+        }
+    };
+
+    for (const auto generator : diff.addedGenerators)
+    {
+        rebuild(generator);
+    }
+    for (const auto generator : diff.modifiedGenerators)
+    {
+        rebuild(generator);
+    }
+    populations_ = std::move(populations);
+
+    return update;
+}
+
+const WorldPartition* World::partition() const
+{
+    return partition_.get();
+}
+
 void World::update(const renderer::Camera& camera)
 {
+    auto allocationZone = core::AllocationZone{"World::update"};
     renderSystem_.update(camera);
 }
 } // namespace world
@@ -0,0 +1,776 @@
+/// SPDX-License-Identifier: MIT
+// Copyright (c) 2025 Mark Rapson
+
+#include "world/world_partition.h"
+#include "world/world.h"
+
+#include <assets/asset_database.h>
+#include <assets/gltf_loader.h>
+#include <core/job_system.h>
+#include <core/task.h>
+#include <scene/binary_scene.h>
+#include <scene/scene_diff.h>
+
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <numeric>
+#include <stdexcept>
+#include <unordered_set>
+
+namespace world
+{
+uint64_t cellKey(int32_t x, int32_t z)
+{
+    return (uint64_t{static_cast<uint32_t>(x)} << 32) | static_cast<uint32_t>(z);
+}
+
+int32_t cellCoordinate(float position, float cellSize)
+{
+    return static_cast<int32_t>(std::floor(position / cellSize));
+}
+
+template <typename T>
+bool ready(const std::future<T>& future)
+{
+    return future.wait_for(std::chrono::seconds{0}) == std::future_status::ready;
+}
+
+WorldPartition::WorldPartition(const scene::BinaryScene& scene,
+                               World& world,
+                               assets::AssetDatabase& assetDatabase,
+                               const WorldPartitionConfig& config)
+    : scene_{&scene}
+    , world_{world}
+    , assetDatabase_{assetDatabase}
+    , config_{config}
+{
+    if (!(config_.cellSize > 0.0f))
+    {
+        throw std::runtime_error("World partition cell size must be positive");
+    }
+
+    worldEntities_.resize(scene_->entityCount());
+    std::iota(worldEntities_.begin(), worldEntities_.end(), world_.createEntities(scene_->entityCount()));
+    prefabs_.resize(scene_->prefabs().size());
+
+    const auto startTime = std::chrono::steady_clock::now();
+    buildCells();
+    spdlog::info("Partitioned {} entities into {} cells of {} in {:.1f} ms",
+                 scene_->entityCount(),
+                 cellCount(),
+                 config_.cellSize,
+                 std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count());
+
+    if (unplaced_ != unplacedCell)
+    {
+        startLoad(unplaced_);
+
+        auto budget = std::numeric_limits<uint32_t>::max();
+        auto loaded = StreamingUpdate{};
+        do
+        {
+            waitForLoads();
+            finishPrefabLoads(loaded);
+            commitStagedCells(budget, loaded);
+        } while (!pendingCells_.empty());
+    }
+}
+
+WorldPartition::~WorldPartition()
+{
+    waitForLoads();
+
+    // Loaded cells' references belong to their entities now, which the world releases
+    for (const auto& pending : pendingCells_)
+    {
+        if (pending.referenced && !pending.cancelled)
+        {
+            releaseReferences(cells_[pending.cell]);
+        }
+    }
+}
+
+StreamingUpdate WorldPartition::update(const glm::vec3& position, bool wait)
+{
+    auto result = StreamingUpdate{};
+    auto budget = wait ? std::numeric_limits<uint32_t>::max() : std::max(config_.entityBudget, 1u);
+
+    unloadDistantCells(position, budget, result);
+    requestCells(position);
+
+    do
+    {
+        if (wait)
+        {
+            waitForLoads();
+        }
+
+        finishPrefabLoads(result);
+        commitStagedCells(budget, result);
+    } while (wait && !pendingCells_.empty());
+
+    return result;
+}
+
+StreamingUpdate WorldPartition::reload(const scene::BinaryScene& scene, const scene::SceneDiff& diff)
+{
+    auto result = StreamingUpdate{};
+
+    // Copies in flight read the current scene and prefab loads are numbered by its prefabs. Cells still loading
+    // start again under the new scene.
+    waitForLoads();
+    finishPrefabLoads(result);
+    for (const auto& pending : pendingCells_)
+    {
+        if (pending.cancelled)
+        {
+            continue;
+        }
+
+        if (pending.referenced)
+        {
+            releaseReferences(cells_[pending.cell]);
+        }
+        cells_[pending.cell].state = CellState::Unloaded;
+    }
+    pendingCells_.clear();
+
+    // Cells are identified across the reload by position
+    auto loadedCells = std::unordered_set<uint64_t>{};
+    for (const auto cell : activeCells_)
+    {
+        if (cells_[cell].state == CellState::Loaded)
+        {
+            loadedCells.insert(cellKey(cells_[cell].x, cells_[cell].z));
+        }
+    }
+    const auto unplacedLoaded = unplaced_ != unplacedCell && cells_[unplaced_].state == CellState::Loaded;
+
+    // Unchanged entities have the same position, so are in a cell at the same position as before and already in the
+    // world if it's loaded
+    for (const auto entity : diff.removed)
+    {
+        world_.destroyEntity(worldEntities_[entity]);
+    }
+    for (const auto entity : diff.modified)
+    {
+        world_.destroyEntity(worldEntities_[diff.previous[entity]]);
+    }
+
+    auto worldEntities = std::vector<Entity>(scene.entityCount());
+    auto changed = std::vector<bool>(scene.entityCount());
+    auto added = world_.createEntities(static_cast<uint32_t>(diff.added.size()));
+    for (size_t entity = 0; entity < worldEntities.size(); ++entity)
+    {
+        const auto previous = diff.previous[entity];
+        worldEntities[entity] = previous != scene::SceneDiff::noEntity ? worldEntities_[previous] : added++;
+        changed[entity] = previous == scene::SceneDiff::noEntity;
+    }
+    for (const auto entity : diff.modified)
+    {
+        changed[entity] = true;
+    }
+
+    scene_ = &scene;
+    worldEntities_ = std::move(worldEntities);
+    prefabs_.assign(scene_->prefabs().size(), assets::Handle<assets::Prefab>{});
+
+    cells_.clear();
+    cellIndices_.clear();
+    cellEntities_.clear();
+    cellPrefabs_.clear();
+    activeCells_.clear();
+    unplaced_ = unplacedCell;
+    loadedEntityCount_ = 0;
+    buildCells();
+
+    for (auto i = uint32_t{0}; i < cells_.size(); ++i)
+    {
+        auto& cell = cells_[i];
+        const auto loaded = i == unplaced_ ? unplacedLoaded : loadedCells.contains(cellKey(cell.x, cell.z));
+        if (loaded)
+        {
+            cell.state = CellState::Loaded;
+            loadedEntityCount_ += cell.entityCount;
+            if (i != unplaced_)
+            {
+                activeCells_.push_back(i);
+            }
+
+            if (!addChangedEntities(cell, changed))
+            {
+                unloadCell(cell);
+                cell.state = CellState::Unloaded;
+                if (i != unplaced_)
+                {
+                    activeCells_.pop_back();
+                }
+                result.cellsUnloaded++;
+            }
+        }
+
+        // Nothing else loads entities without a transform
+        if (i == unplaced_ && cell.state == CellState::Unloaded)
+        {
+            startLoad(i);
+        }
+    }
+
+    // Cells keep using the version already loaded until the new one replaces it. One that isn't loaded is loaded from
+    // the new path when next needed.
+    for (const auto prefab : diff.movedPrefabs)
+    {
+        if (assetDatabase_.findPrefab(scene_->prefabs()[prefab].name).valid())
+        {
+            spdlog::info("Reloading prefab {} from {}", scene_->prefabs()[prefab].name, scene_->prefabs()[prefab].path);
+            startPrefabLoad(prefab, true);
+        }
+    }
+
+    return result;
+}
+
+assets::Handle<assets::Prefab> WorldPartition::loadPrefab(std::string_view name, StreamingUpdate& update)
+{
+    const auto& definitions = scene_->prefabs();
+    const auto itr = std::ranges::find(definitions, name, &scene::Prefab::name);
+    if (itr == definitions.end())
+    {
+        return {};
+    }
+
+    const auto prefab = static_cast<uint32_t>(itr - definitions.begin());
+    while (!resolvePrefab(prefab).valid()
+           || std::ranges::find(prefabLoads_, prefab, &PrefabLoad::prefab) != prefabLoads_.end())
+    {
+        waitForLoads();
+        finishPrefabLoads(update);
+    }
+
+    return prefabs_[prefab];
+}
+
+const WorldPartitionConfig& WorldPartition::config() const
+{
+    return config_;
+}
+
+size_t WorldPartition::cellCount() const
+{
+    return cells_.size() - (unplaced_ != unplacedCell ? 1 : 0);
+}
+
+size_t WorldPartition::loadedCellCount() const
+{
+    return static_cast<size_t>(std::ranges::count_if(activeCells_,
+                                                     [this](uint32_t cell)
+                                                     { return cells_[cell].state == CellState::Loaded; }));
+}
+
+size_t WorldPartition::loadedEntityCount() const
+{
+    return loadedEntityCount_;
+}
+
+// Groups entities by cell with a counting sort, keeping scene order within each cell, and totals each cell's use of
+// each prefab. Only the entity columns are read, so this is one pass over the mapped scene.
+void WorldPartition::buildCells()
+{
+    const auto transformEntities = scene_->transformEntities();
+    const auto transforms = scene_->transforms();
+    const auto renderEntities = scene_->renderEntities();
+    const auto renderPrefabs = scene_->renderPrefabs();
+    const auto entityCount = scene_->entityCount();
+
+    auto entityCells = std::vector<uint32_t>(entityCount);
+    auto transform = size_t{0};
+    for (auto entity = uint32_t{0}; entity < entityCount; ++entity)
+    {
+        auto cell = unplaced_;
+        if (transform < transformEntities.size() && transformEntities[transform] == entity)
+        {
+            const auto& position = transforms[transform++].position;
+            const auto x = cellCoordinate(position.x, config_.cellSize);
+            const auto z = cellCoordinate(position.z, config_.cellSize);
+
+            auto [itr, inserted] = cellIndices_.try_emplace(cellKey(x, z), static_cast<uint32_t>(cells_.size()));
+            if (inserted)
+            {
+                cells_.push_back(Cell{.x = x, .z = z});
+            }
+            cell = itr->second;
+        }
+        else if (unplaced_ == unplacedCell)
+        {
+            unplaced_ = static_cast<uint32_t>(cells_.size());
+            cells_.push_back(Cell{});
+            cell = unplaced_;
+        }
+
+        entityCells[entity] = cell;
+        cells_[cell].entityCount++;
+    }
+
+    auto offset = uint32_t{0};
+    for (auto& cell : cells_)
+    {
+        cell.firstEntity = offset;
+        offset += cell.entityCount;
+        cell.entityCount = 0;
+    }
+
+    cellEntities_.resize(entityCount);
+    for (auto entity = uint32_t{0}; entity < entityCount; ++entity)
+    {
+        auto& cell = cells_[entityCells[entity]];
+        cellEntities_[cell.firstEntity + cell.entityCount++] = entity;
+    }
+
+    // Scenes use a handful of prefabs, so each cell's totals are a short list searched linearly
+    auto prefabCounts = std::vector<std::vector<CellPrefab>>(cells_.size());
+    for (size_t i = 0; i < renderEntities.size(); ++i)
+    {
+        auto& counts = prefabCounts[entityCells[renderEntities[i]]];
+        auto itr = std::ranges::find(counts, renderPrefabs[i], &CellPrefab::prefab);
+        if (itr == counts.end())
+        {
+            counts.push_back(CellPrefab{.prefab = renderPrefabs[i], .count = 1});
+        }
+        else
+        {
+            itr->count++;
+        }
+    }
+
+    for (size_t i = 0; i < cells_.size(); ++i)
+    {
+        cells_[i].firstPrefab = static_cast<uint32_t>(cellPrefabs_.size());
+        cells_[i].prefabCount = static_cast<uint32_t>(prefabCounts[i].size());
+        cellPrefabs_.insert(cellPrefabs_.end(), prefabCounts[i].begin(), prefabCounts[i].end());
+    }
+}
+
+// Starts the unloaded cells in range, nearest first
+void WorldPartition::requestCells(const glm::vec3& position)
+{
+    const auto radius = config_.loadRadius;
+    const auto minX = cellCoordinate(position.x - radius, config_.cellSize);
+    const auto maxX = cellCoordinate(position.x + radius, config_.cellSize);
+    const auto minZ = cellCoordinate(position.z - radius, config_.cellSize);
+    const auto maxZ = cellCoordinate(position.z + radius, config_.cellSize);
+
+    requests_.clear();
+    for (auto x = minX; x <= maxX; ++x)
+    {
+        for (auto z = minZ; z <= maxZ; ++z)
+        {
+            const auto itr = cellIndices_.find(cellKey(x, z));
+            if (itr == cellIndices_.end())
+            {
+                continue;
+            }
+
+            const auto& cell = cells_[itr->second];
+            if (cell.state == CellState::Unloaded && distanceTo(cell, position) <= radius)
+            {
+                requests_.push_back(itr->second);
+            }
+        }
+    }
+
+    std::ranges::sort(requests_,
+                      [&](uint32_t lhs, uint32_t rhs)
+                      { return distanceTo(cells_[lhs], position) < distanceTo(cells_[rhs], position); });
+
+    for (const auto cell : requests_)
+    {
+        startLoad(cell);
+    }
+}
+
+void WorldPartition::startLoad(uint32_t cell)
+{
+    cells_[cell].state = CellState::Loading;
+    if (cell != unplaced_)
+    {
+        activeCells_.push_back(cell);
+    }
+
+    const auto entities = entitiesOf(cells_[cell]);
+
+    auto pending = PendingCell{};
+    pending.cell = cell;
+    if (auto* jobSystem = assetDatabase_.jobSystem())
+    {
+        pending.staged = core::startTask(stageAsync(*scene_, worldEntities_, entities, *jobSystem));
+    }
+    else
+    {
+        pending.staged =
+            std::async(std::launch::async, [this, entities] { return stage(*scene_, worldEntities_, entities); });
+    }
+
+    // Take the references straight away if the prefabs are loaded, so none of them can be evicted before the cell
+    // is added; otherwise this starts loading them
+    reference(pending);
+    pendingCells_.push_back(std::move(pending));
+}
+
+void WorldPartition::unloadDistantCells(const glm::vec3& position, uint32_t& budget, StreamingUpdate& update)
+{
+    const auto unloadRadius = config_.loadRadius + config_.hysteresis;
+
+    for (size_t i = 0; i < activeCells_.size() && budget > 0;)
+    {
+        auto& cell = cells_[activeCells_[i]];
+        if (distanceTo(cell, position) <= unloadRadius)
+        {
+            ++i;
+            continue;
+        }
+
+        if (cell.state == CellState::Loading)
+        {
+            auto pending = std::ranges::find_if(pendingCells_,
+                                                [&](const PendingCell& pendingCell)
+                                                { return pendingCell.cell == activeCells_[i] && !pendingCell.cancelled; });
+            if (pending->referenced)
+            {
+                releaseReferences(cell);
+            }
+            pending->cancelled = true;
+        }
+        else
+        {
+            unloadCell(cell);
+            budget -= std::min(budget, cell.entityCount);
+            update.cellsUnloaded++;
+
+            spdlog::debug("Unloaded cell ({}, {}) with {} entities", cell.x, cell.z, cell.entityCount);
+        }
+
+        cell.state = CellState::Unloaded;
+        activeCells_[i] = activeCells_.back();
+        activeCells_.pop_back();
+    }
+}
+
+void WorldPartition::finishPrefabLoads(StreamingUpdate& update)
+{
+    for (auto itr = prefabLoads_.begin(); itr != prefabLoads_.end();)
+    {
+        if (!ready(itr->result))
+        {
+            ++itr;
+            continue;
+        }
+
+        auto load = std::move(*itr);
+        itr = prefabLoads_.erase(itr);
+
+        const auto& definition = scene_->prefabs()[load.prefab];
+        auto prefab = assets::Prefab{};
+        try
+        {
+            prefab = load.result.get();
+        }
+        catch (const std::exception& ex)
+        {
+            throw std::runtime_error("Failed to load prefab " + definition.name + ": " + ex.what());
+        }
+
+        // A replacement keeps the handle, so entities already using the prefab switch to the new version
+        const auto existing = assetDatabase_.findPrefab(definition.name);
+        if (existing.valid() && load.replace)
+        {
+            update.evicted.append(assetDatabase_.replacePrefab(existing, *load.source, prefab));
+            prefabs_[load.prefab] = existing;
+            update.prefabsLoaded++;
+            continue;
+        }
+
+        // Adding it again would replace the one loaded in the meantime, along with the references already taken
+        if (existing.valid())
+        {
+            prefabs_[load.prefab] = existing;
+            continue;
+        }
+
+        prefabs_[load.prefab] = assetDatabase_.addPrefab(definition.name, *load.source, prefab);
+        update.prefabsLoaded++;
+    }
+}
+
+bool WorldPartition::reference(PendingCell& pending)
+{
+    if (pending.referenced)
+    {
+        return true;
+    }
+
+    // Resolve every prefab before giving up, so all the missing ones load at once
+    const auto prefabs = prefabsOf(cells_[pending.cell]);
+    auto resolved = true;
+    for (const auto& cellPrefab : prefabs)
+    {
+        resolved = resolvePrefab(cellPrefab.prefab).valid() && resolved;
+    }
+
+    if (!resolved)
+    {
+        return false;
+    }
+
+    for (const auto& cellPrefab : prefabs)
+    {
+        assetDatabase_.acquire(prefabs_[cellPrefab.prefab], cellPrefab.count);
+    }
+
+    pending.referenced = true;
+    return true;
+}
+
+void WorldPartition::releaseReferences(const Cell& cell)
+{
+    for (const auto& cellPrefab : prefabsOf(cell))
+    {
+        assetDatabase_.release(prefabs_[cellPrefab.prefab], cellPrefab.count);
+    }
+}
+
+// Adds staged cells to the world in the order they were requested. A cell's references pass to its render
+// components, which release them when destroyed.
+void WorldPartition::commitStagedCells(uint32_t& budget, StreamingUpdate& update)
+{
+    for (auto itr = pendingCells_.begin(); itr != pendingCells_.end() && budget > 0;)
+    {
+        if (!ready(itr->staged))
+        {
+            ++itr;
+            continue;
+        }
+
+        if (itr->cancelled)
+        {
+            itr = pendingCells_.erase(itr);
+            continue;
+        }
+
+        if (!reference(*itr))
+        {
+            ++itr;
+            continue;
+        }
+
+        const auto staged = itr->staged.get();
+        auto& cell = cells_[itr->cell];
+        itr = pendingCells_.erase(itr);
+
+        addToWorld(staged);
+
+        cell.state = CellState::Loaded;
+        loadedEntityCount_ += cell.entityCount;
+        budget -= std::min(budget, cell.entityCount);
+        update.cellsLoaded++;
+
+        spdlog::debug("Loaded cell ({}, {}) with {} entities", cell.x, cell.z, cell.entityCount);
+    }
+}
+
+void WorldPartition::addToWorld(const StagedCell& staged)
+{
+    auto transforms = world_.addComponents<TransformComponent>(staged.transformEntities);
+    std::ranges::copy(staged.transforms, transforms.begin());
+
+    auto renderComponents = world_.addComponents<RenderComponent>(staged.renderEntities);
+    for (size_t i = 0; i < renderComponents.size(); ++i)
+    {
+        renderComponents[i].prefab = prefabs_[staged.renderPrefabs[i]];
+    }
+}
+
+// The cell's entities release their prefab references as they're destroyed
+void WorldPartition::unloadCell(const Cell& cell)
+{
+    scratchEntities_.clear();
+    for (const auto entity : entitiesOf(cell))
+    {
+        scratchEntities_.push_back(worldEntities_[entity]);
+    }
+
+    world_.destroyEntities(scratchEntities_);
+    loadedEntityCount_ -= cell.entityCount;
+}
+
+// An edit changes a handful of entities, so they're copied on this thread rather than waiting a frame for a job.
+// Fails, adding nothing, if any of them use a prefab that isn't loaded, which starts loading it.
+bool WorldPartition::addChangedEntities(const Cell& cell, const std::vector<bool>& changed)
+{
+    scratchIndices_.clear();
+    for (const auto entity : entitiesOf(cell))
+    {
+        if (changed[entity])
+        {
+            scratchIndices_.push_back(entity);
+        }
+    }
+
+    if (scratchIndices_.empty())
+    {
+        return true;
+    }
+
+    const auto staged = stage(*scene_, worldEntities_, scratchIndices_);
+
+    auto resolved = true;
+    for (const auto prefab : staged.renderPrefabs)
+    {
+        resolved = resolvePrefab(prefab).valid() && resolved;
+    }
+
+    if (!resolved)
+    {
+        return false;
+    }
+
+    for (const auto prefab : staged.renderPrefabs)
+    {
+        assetDatabase_.acquire(prefabs_[prefab]);
+    }
+
+    addToWorld(staged);
+    return true;
+}
+
+void WorldPartition::waitForLoads()
+{
+    for (const auto& pending : pendingCells_)
+    {
+        pending.staged.wait();
+    }
+
+    for (const auto& load : prefabLoads_)
+    {
+        load.result.wait();
+    }
+}
+
+assets::Handle<assets::Prefab> WorldPartition::resolvePrefab(uint32_t prefab)
+{
+    auto& handle = prefabs_[prefab];
+    if (assetDatabase_.pool<assets::Prefab>().contains(handle))
+    {
+        return handle;
+    }
+
+    const auto& definition = scene_->prefabs()[prefab];
+    handle = assetDatabase_.findPrefab(definition.name);
+    if (handle.valid() || std::ranges::find(prefabLoads_, prefab, &PrefabLoad::prefab) != prefabLoads_.end())
+    {
+        return handle;
+    }
+
+    spdlog::info("Loading prefab {} for streamed cells", definition.name);
+    startPrefabLoad(prefab, false);
+    return {};
+}
+
+void WorldPartition::startPrefabLoad(uint32_t prefab, bool replace)
+{
+    const auto& definition = scene_->prefabs()[prefab];
+
+    // The scratch database loads with the same cache and threads as the one it will be added to
+    auto source = std::make_unique<assets::AssetDatabase>();
+    source->setImageCache(assetDatabase_.imageCache());
+    source->setJobSystem(assetDatabase_.jobSystem());
+    source->setFileReadQueue(assetDatabase_.fileReadQueue());
+
+    const auto path = config_.prefabDirectory / definition.path;
+    auto result = std::future<assets::Prefab>{};
+    if (source->jobSystem() && source->fileReadQueue())
+    {
+        result = core::startTask(assets::loadGLTFModelAsync(path, *source));
+    }
+    else
+    {
+        result = std::async(std::launch::async,
+                            [path, database = source.get()] { return assets::loadGLTFModel(path, *database); });
+    }
+
+    prefabLoads_.push_back(
+        PrefabLoad{.prefab = prefab, .source = std::move(source), .result = std::move(result), .replace = replace});
+}
+
+std::span<const uint32_t> WorldPartition::entitiesOf(const Cell& cell) const
+{
+    return std::span{cellEntities_}.subspan(cell.firstEntity, cell.entityCount);
+}
+
+std::span<const WorldPartition::CellPrefab> WorldPartition::prefabsOf(const Cell& cell) const
+{
+    return std::span{cellPrefabs_}.subspan(cell.firstPrefab, cell.prefabCount);
+}
+
+// Distance across the ground plane to the nearest point of the cell, zero from inside it
+float WorldPartition::distanceTo(const Cell& cell, const glm::vec3& position) const
+{
+    const auto minX = static_cast<float>(cell.x) * config_.cellSize;
+    const auto minZ = static_cast<float>(cell.z) * config_.cellSize;
+    const auto dx = std::max({minX - position.x, 0.0f, position.x - (minX + config_.cellSize)});
+    const auto dz = std::max({minZ - position.z, 0.0f, position.z - (minZ + config_.cellSize)});
+    return std::sqrt(dx * dx + dz * dz);
+}
+
+core::Task<WorldPartition::StagedCell> WorldPartition::stageAsync(const scene::BinaryScene& scene,
+                                                                  std::span<const Entity> worldEntities,
+                                                                  std::span<const uint32_t> entities,
+                                                                  core::JobSystem& jobSystem)
+{
+    co_await jobSystem.schedule();
+    co_return stage(scene, worldEntities, entities);
+}
+
+// Reading the columns here is what pages the cell in from the mapped scene, so it's kept off the calling thread
+WorldPartition::StagedCell WorldPartition::stage(const scene::BinaryScene& scene,
+                                                 std::span<const Entity> worldEntities,
+                                                 std::span<const uint32_t> entities)
+{
+    const auto transformEntities = scene.transformEntities();
+    const auto transforms = scene.transforms();
+    const auto renderEntities = scene.renderEntities();
+    const auto renderPrefabs = scene.renderPrefabs();
+
+    auto staged = StagedCell{};
+    staged.transformEntities.reserve(entities.size());
+    staged.transforms.reserve(entities.size());
+    staged.renderEntities.reserve(entities.size());
+    staged.renderPrefabs.reserve(entities.size());
+
+    // A cell's entities are in scene order, so each search carries on from the last match
+    auto transform = transformEntities.begin();
+    auto render = renderEntities.begin();
+    for (const auto entity : entities)
+    {
+        transform = std::lower_bound(transform, transformEntities.end(), entity);
+        if (transform != transformEntities.end() && *transform == entity)
+        {
+            const auto& source = transforms[static_cast<size_t>(transform - transformEntities.begin())];
+            staged.transformEntities.push_back(worldEntities[entity]);
+            staged.transforms.push_back(
+                TransformComponent{.position = source.position, .rotation = source.rotation, .scale = source.scale});
+        }
+
+        render = std::lower_bound(render, renderEntities.end(), entity);
+        if (render != renderEntities.end() && *render == entity)
+        {
+            staged.renderEntities.push_back(worldEntities[entity]);
+            staged.renderPrefabs.push_back(renderPrefabs[static_cast<size_t>(render - renderEntities.begin())]);
+        }
+    }
+
+    return staged;
+}
+} // namespace world